@@ -83,12 +83,15 @@ endif
 # additional manufacturing type commands
 ADD_MANUFACTURING ?= 1
 
+# function entry/exit tracing, build with NVM_TRACE=0 to compile it out
+NVM_TRACE ?= 1
+
 #Uncomment this line if you wish to use Intel I18N
 INTEL_I18N=-D__INTEL_I18N__
 
 # initialize/define compilation flag helper variables
 C_CPP_FLAGS_CMN = -Wall -Werror -Wfatal-errors -Wformat -Wformat-security -fstack-protector-all -D_FORTIFY_SOURCE=2 -D_XOPEN_SOURCE=500 
-C_CPP_FLAGS_SRC = -MMD -D__VERSION_MAJOR__=$(VERSION_MAJOR) -D__VERSION_MINOR__=$(VERSION_MINOR) -D__VERSION_HOTFIX__=$(VERSION_HOTFIX) -D__VERSION_BUILDNUM__=$(VERSION_BUILDNUM) -D__VERSION_NUMBER__=$(BUILDNUM) -D__ADD_MANUFACTURING__=$(ADD_MANUFACTURING)  -D__WBEM_PREFIX__='$(WBEM_PREFIX_INPUT)' $(INTEL_I18N)
+C_CPP_FLAGS_SRC = -MMD -D__VERSION_MAJOR__=$(VERSION_MAJOR) -D__VERSION_MINOR__=$(VERSION_MINOR) -D__VERSION_HOTFIX__=$(VERSION_HOTFIX) -D__VERSION_BUILDNUM__=$(VERSION_BUILDNUM) -D__VERSION_NUMBER__=$(BUILDNUM) -D__ADD_MANUFACTURING__=$(ADD_MANUFACTURING) -D__NVM_TRACE__=$(NVM_TRACE)  -D__WBEM_PREFIX__='$(WBEM_PREFIX_INPUT)' $(INTEL_I18N)
 LDFLAGS = -z noexecstack -z relro -z now -pie
 
 CFLAGS_CMN = -std=c99
@@ -65,6 +65,8 @@ const framework::CommandSpecPart TARGET_SENSOR_R = {"-sensor", true, "", false,
 const framework::CommandSpecPart TARGET_SOCKET = {"-socket", false, SOCKETIDS_STR, true, N_TR("Socket target.")};
 const framework::CommandSpecPart TARGET_GOAL_R = {"-goal", true, "", false,
 		N_TR("The memory allocation goal."), "", false};
+const framework::CommandSpecPart TARGET_PLAN_R = {"-plan", true, "", false,
+		N_TR("A memory allocation plan for a topology file."), "", false};
 const framework::CommandSpecPart TARGET_POOL = {"-pool", false, POOLIDS_STR, false, N_TR("Pool target.")};
 const framework::CommandSpecPart TARGET_POOL_R = {"-pool", true, POOLIDS_STR, false, N_TR("Pool target is required.")};
 const framework::CommandSpecPart TARGET_SUPPORT = {"-support", false, "", true, N_TR("Support target.")};
@@ -78,6 +80,19 @@ const framework::CommandSpecPart TARGET_JOB = {"-job", true, "", false, N_TR("Jo
 const framework::CommandSpecPart TARGET_PREFERENCES = {"-preferences", true, "", false, N_TR("The user preferences."), "", true};
 const framework::CommandSpecPart TARGET_FIRMWARE_R = {"-firmware", true, "", false, N_TR("The firmware information.")};
 
+/*
+ * Common options
+ */
+const framework::CommandSpecPart OPTION_FORMAT = {"-format", false, "json|ndjson", true,
+		N_TR("Write the results as a JSON array (json) or as one JSON object per line (ndjson). "
+		"Each object is written as soon as it is retrieved.")};
+const framework::CommandSpecPart OPTION_SEARCH = {"-search", false, "", false,
+		N_TR("Try alternative layouts for the goal, varying the reserved " NVM_DIMM_NAME " and the "
+		"widest interleave set on each socket, and use the valid layout closest to the request.")};
+const framework::CommandSpecPart OPTION_PROBE = {"-probe", false, "", false,
+		N_TR("Gather the details of each " NVM_DIMM_NAME " and show the firmware commands this took, "
+		"instead of those the monitor service has published.")};
+
 const std::string UNKNOWN_ERROR_STR = N_TR("An unknown error occurred.");
 const std::string NOTSUPPORTED_ERROR_STR = N_TR("The command is not supported in the current context.");
 const std::string NOMEMORY_ERROR_STR = N_TR("There is not enough memory to complete the requested operation.");
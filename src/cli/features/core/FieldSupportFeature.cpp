@@ -71,6 +71,10 @@
 #include <persistence/lib_persistence.h>
 #include <exception/NvmExceptionLibError.h>
 #include <core/device/DeviceFirmwareService.h>
+#include "ShowMailboxPerformanceCommand.h"
+#include "framework/DisplayOptions.h"
+#include "framework/JsonStreamWriter.h"
+#include "framework/EnumStringTable.h"
 #include <framework_interface/FrameworkExtensions.h>
 #include <libintelnvm-cim/ExceptionNoMemory.h>
 
@@ -79,6 +83,7 @@ const std::string LOG_PROPERTY_NAME = "LogLevel";
 
 static const std::string NAME_PROPERTY_NAME = "Name";
 static const std::string PERFORMANCE_TARGET = "-performance";
+static const std::string MAILBOX_TARGET = "-mailbox";
 static const std::string FWLOGLEVEL_PROPERTY = "FwLogLevel";
 static const std::string DIAGNOSTIC_TARGET = "-diagnostic";
 
@@ -137,6 +142,25 @@ void cli::nvmcli::FieldSupportFeature::getPaths(cli::framework::CommandSpecList
 		"BytesRead|BytesWritten|HostReads|HostWrites|BlockWrites|BlockReads", false,
 			TR("Restrict output to a specific performance metric by supplying the metric name. "
 					"The default is to display all performance metrics."));
+	showPerformance.addOption(OPTION_FORMAT);
+
+	cli::framework::CommandSpec showMailboxPerformance(SHOW_MAILBOX_PERFORMANCE,
+			TR("Show Mailbox Performance"), framework::VERB_SHOW,
+			TR("Show firmware mailbox statistics for one or more " NVM_DIMM_NAME "s. The count, "
+					"errors and latency of every firmware command the monitor service has sent "
+					"are shown, as of the end of its last monitor pass."));
+	showMailboxPerformance.addOption(OPTION_PROBE);
+	showMailboxPerformance.addOption(framework::OPTION_DISPLAY);
+	showMailboxPerformance.addOption(framework::OPTION_ALL);
+	showMailboxPerformance.addOption(OPTION_FORMAT);
+	showMailboxPerformance.addTarget(PERFORMANCE_TARGET, true, "", false,
+			TR("The performance metrics."));
+	showMailboxPerformance.addTarget(MAILBOX_TARGET, true, "", false,
+			TR("Restrict output to the firmware mailbox statistics."));
+	showMailboxPerformance.addTarget(TARGET_DIMM.name, false, DIMMIDS_STR, true,
+			TR("Restrict output to the mailbox statistics for specific " NVM_DIMM_NAME "s by "
+					"supplying one or more comma-separated " NVM_DIMM_NAME " identifiers. The default is to "
+					"display the mailbox statistics for all manageable " NVM_DIMM_NAME "s."));
 
 	cli::framework::CommandSpec runDiag(RUN_DIAGNOSTIC, TR("Run Diagnostic"), framework::VERB_START,
 			TR("Run a diagnostic test on one or more " NVM_DIMM_NAME "s."));
@@ -242,6 +266,7 @@ void cli::nvmcli::FieldSupportFeature::getPaths(cli::framework::CommandSpecList
 			.isValueRequired(true)
 			.valueText("1|0")
 			.helpText(TR("Filter output to events that require corrective action or acknowledgment."));
+	showEvents.addOption(OPTION_FORMAT);
 
 	cli::framework::CommandSpec showPreferences(SHOW_PREFERENCES, TR("Show Preferences"), framework::VERB_SHOW,
 			TR("Display a list of the " NVM_DIMM_NAME " management software user preferences and their current values."));
@@ -280,6 +305,7 @@ void cli::nvmcli::FieldSupportFeature::getPaths(cli::framework::CommandSpecList
 	list.push_back(showDeviceFirmware);
 	list.push_back(updateFirmware);
 	list.push_back(showPerformance);
+	list.push_back(showMailboxPerformance);
 	list.push_back(runDiag);
 	list.push_back(createSupport);
 	list.push_back(dumpSupport);
@@ -356,6 +382,9 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::run(
 		case SHOW_DEVICE_FIRMWARE:
 			pResult = showDeviceFirmware(parsedCommand);
 			break;
+		case SHOW_MAILBOX_PERFORMANCE:
+			pResult = showMailboxPerformance(parsedCommand);
+			break;
 	}
 	return pResult;
 }
@@ -711,6 +740,13 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::showPerformance(
 	std::vector<std::string> dimms;
 	pResult = cli::nvmcli::getDimms(parsedCommand, dimms);
 
+	framework::DisplayOptions displayOptions(parsedCommand.options);
+	if (NULL == pResult && !displayOptions.isFormatValid())
+	{
+		pResult = new framework::SyntaxErrorBadValueResult(framework::TOKENTYPE_OPTION,
+				framework::FORMAT_OPTION_NAME, displayOptions.getFormat());
+	}
+
 	if (NULL == pResult)
 	{
 		try
@@ -761,19 +797,37 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::showPerformance(
 				wbem::performance::NVDIMMPerformanceViewFactory perfProvider;
 				wbem::framework::instances_t *pInstances = perfProvider.getInstances(requestedAttributes);
 
-				framework::ObjectListResult *pTable =
-						NvmInstanceToObjectListResult(*pInstances, "DimmPerformance",
-						wbem::INSTANCEID_KEY, displayAttributes, filters);
-				if (!dimmTarget.empty() && pTable->getCount() == 0)
+				if (displayOptions.isStreamed())
 				{
-					delete pTable;
-					pResult = new framework::SyntaxErrorBadValueResult(framework::TOKENTYPE_TARGET,
-							TARGET_DIMM.name, dimmTarget);
+					wbem::framework::instances_t matchedInstances;
+					filterInstances(*pInstances, "DimmPerformance", filters, matchedInstances);
+					if (!dimmTarget.empty() && matchedInstances.empty())
+					{
+						pResult = new framework::SyntaxErrorBadValueResult(framework::TOKENTYPE_TARGET,
+								TARGET_DIMM.name, dimmTarget);
+					}
+					else
+					{
+						pResult = NvmInstancesToJsonStream(matchedInstances, displayAttributes,
+								displayOptions.isNdjson());
+					}
 				}
 				else
 				{
-					pTable->setOutputType(framework::ResultBase::OUTPUT_TEXTTABLE);
-					pResult = pTable;
+					framework::ObjectListResult *pTable =
+							NvmInstanceToObjectListResult(*pInstances, "DimmPerformance",
+							wbem::INSTANCEID_KEY, displayAttributes, filters);
+					if (!dimmTarget.empty() && pTable->getCount() == 0)
+					{
+						delete pTable;
+						pResult = new framework::SyntaxErrorBadValueResult(framework::TOKENTYPE_TARGET,
+								TARGET_DIMM.name, dimmTarget);
+					}
+					else
+					{
+						pTable->setOutputType(framework::ResultBase::OUTPUT_TEXTTABLE);
+						pResult = pTable;
+					}
 				}
 
 				delete pInstances;
@@ -1085,6 +1139,26 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::runDiagnostic(
 						{
 							// keep running the test on the next dimm
 							bool perDimm = true;
+							wbem::framework::UINT16_LIST ignoreResults;
+
+							// the quick test checks all dimms concurrently up front
+							std::vector<int> quickRcs(dimmTargets.size(), NVM_SUCCESS);
+							if (CLIDIAGNOSTIC_TEST_QUICK == diagTestTypes[i])
+							{
+								try
+								{
+									std::vector<struct device_quick_diagnostic_result> quickResults =
+											provider.RunQuickDiagnosticService(dimmTargets, ignoreResults);
+									for (size_t r = 0; r < quickResults.size(); r++)
+									{
+										quickRcs[r] = quickResults[r].rc;
+									}
+								}
+								catch (wbem::exception::NvmExceptionLibError &e)
+								{
+									quickRcs.assign(dimmTargets.size(), e.getLibError());
+								}
+							}
 
 							// for each dimm in the list
 							for (std::vector<std::string>::const_iterator dimmTargetIter = dimmTargets.begin();
@@ -1104,12 +1178,23 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::runDiagnostic(
 								// convert guid string to guid
 								COMMON_GUID guid;
 								str_to_guid((*dimmTargetIter).c_str(), guid);
-								wbem::framework::UINT16_LIST ignoreResults;
 
 								try
 								{
 									// run diagnostic test
-									provider.RunDiagnosticService(guid, ignoreResults, wbem::support::validTestTypes[i]);
+									if (CLIDIAGNOSTIC_TEST_QUICK == diagTestTypes[i])
+									{
+										int quickRc = quickRcs[dimmTargetIter - dimmTargets.begin()];
+										if (quickRc != NVM_SUCCESS)
+										{
+											throw wbem::exception::NvmExceptionLibError(quickRc);
+										}
+									}
+									else
+									{
+										provider.RunDiagnosticService(guid, ignoreResults,
+												wbem::support::validTestTypes[i]);
+									}
 									// if we got this far, pull the results out of the event table for this test
 									// there should only be one event table entry per test,
 									// and per guid if it's guid specific
@@ -1244,8 +1329,14 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::showEvents(
 	else
 	{
 		wbem::support::EventLogFilter filter;
+		framework::DisplayOptions displayOptions(parsedCommand.options);
 
-		if ((pResult = showEvents_inputToFilter(parsedCommand, filter)) == NULL)
+		if (!displayOptions.isFormatValid())
+		{
+			pResult = new framework::SyntaxErrorBadValueResult(framework::TOKENTYPE_OPTION,
+					framework::FORMAT_OPTION_NAME, displayOptions.getFormat());
+		}
+		else if ((pResult = showEvents_inputToFilter(parsedCommand, filter)) == NULL)
 		{
 			wbem::framework::instances_t *pInstances = NULL;
 			try
@@ -1267,7 +1358,15 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::showEvents(
 					{
 						delete pResult;
 					}
-					pResult = showEvents_logEntriesToObjectList(pInstances);
+					if (displayOptions.isStreamed())
+					{
+						pResult = showEvents_logEntriesToJsonStream(pInstances,
+								displayOptions.isNdjson());
+					}
+					else
+					{
+						pResult = showEvents_logEntriesToObjectList(pInstances);
+					}
 				}
 			}
 			catch (wbem::framework::Exception &e)
@@ -1289,6 +1388,98 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::showEvents(
 	return pResult;
 }
 
+/*
+ * Convert a NVDIMMLogEntry instance to the list of properties shown for the event,
+ * formatting them appropriately. Returns false if the instance is missing an attribute.
+ */
+bool cli::nvmcli::FieldSupportFeature::showEvents_logEntryToProperties(
+		wbem::framework::Instance &instance, eventProperties_t &properties)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	bool result = true;
+
+	wbem::framework::Attribute instanceIdAttribute;
+	wbem::framework::Attribute creationTimeAttribute;
+	wbem::framework::Attribute severityAttribute;
+	wbem::framework::Attribute messageAttribute;
+	wbem::framework::Attribute messageArgsAttribute;
+	wbem::framework::Attribute actionRequiredAttribute;
+
+	if (instance.getAttribute(wbem::INSTANCEID_KEY, instanceIdAttribute)
+				!= wbem::framework::SUCCESS ||
+		instance.getAttribute(wbem::CREATIONTIMESTAMP_KEY, creationTimeAttribute)
+				!= wbem::framework::SUCCESS ||
+		instance.getAttribute(wbem::PERCEIVEDSEVERITY_KEY, severityAttribute)
+				!= wbem::framework::SUCCESS ||
+		instance.getAttribute(wbem::MESSAGE_KEY, messageAttribute)
+				!= wbem::framework::SUCCESS ||
+		instance.getAttribute(wbem::MESSAGEARGS_KEY, messageArgsAttribute)
+				!= wbem::framework::SUCCESS ||
+		instance.getAttribute(wbem::ACTIONREQUIRED_KEY, actionRequiredAttribute)
+				!= wbem::framework::SUCCESS)
+	{
+		COMMON_LOG_ERROR("Issue getting expected attributes from NVDIMMLogEntry.");
+		result = false;
+	}
+	else
+	{
+		// Convert the attributes to appropriate output for the user
+
+		/*
+		 * date/time
+		 */
+		char datetime[255];
+		time_t t = (time_t) creationTimeAttribute.uint64Value();
+		struct tm *p_localTime = localtime(&t);
+		if (!p_localTime)
+		{
+			// this should never happen
+			COMMON_LOG_ERROR("Unable to get local time for log entry.");
+			s_strcpy(datetime, "00:00:0000:00:00:00", 255);
+		}
+		else
+		{
+			strftime(datetime, sizeof(datetime), "%m:%d:%Y:%H:%M:%S", p_localTime);
+		}
+		properties.push_back(std::make_pair("Time", std::string(datetime)));
+
+		/*
+		 * Event ID
+		 */
+		properties.push_back(std::make_pair("EventID", instanceIdAttribute.asStr()));
+
+		/*
+		 * Severity
+		 */
+		properties.push_back(std::make_pair("Severity", severityAttribute.asStr()));
+
+		/*
+		 * ActionRequired
+		 */
+		if (actionRequiredAttribute.boolValue())
+		{
+			properties.push_back(std::make_pair("ActionRequired", std::string("1")));
+		}
+		else
+		{
+			properties.push_back(std::make_pair("ActionRequired", std::string("0")));
+		}
+
+		/*
+		 * Message
+		 */
+		char msg[NVM_EVENT_MSG_LEN + (3 * NVM_EVENT_ARG_LEN)];
+		s_snprintf(msg, (NVM_EVENT_MSG_LEN + (3 * NVM_EVENT_ARG_LEN)),
+				messageAttribute.asStr().c_str(),
+				messageArgsAttribute.strListValue()[0].c_str(),
+				messageArgsAttribute.strListValue()[1].c_str(),
+				messageArgsAttribute.strListValue()[2].c_str());
+		properties.push_back(std::make_pair("Message", std::string(msg)));
+	}
+
+	return result;
+}
+
 /*
  * Convert NVDIMMLogEntry instances to and object list result formatting the properties
  * appropriately
@@ -1306,32 +1497,9 @@ cli::nvmcli::FieldSupportFeature::showEvents_logEntriesToObjectList(
 	size_t events_to_show = pInstances->size() < MAX_EVENTS ? pInstances->size() : MAX_EVENTS;
 	for (size_t i = 0; i < events_to_show; i++)
 	{
-		// Get the attributes from the CIM Instance
-		wbem::framework::Instance &instance = (*pInstances)[i];
-		cli::framework::PropertyListResult propertyList;
-		propertyList.setName("Event");
-
-		wbem::framework::Attribute instanceIdAttribute;
-		wbem::framework::Attribute creationTimeAttribute;
-		wbem::framework::Attribute severityAttribute;
-		wbem::framework::Attribute messageAttribute;
-		wbem::framework::Attribute messageArgsAttribute;
-		wbem::framework::Attribute actionRequiredAttribute;
-
-		if (instance.getAttribute(wbem::INSTANCEID_KEY, instanceIdAttribute)
-					!= wbem::framework::SUCCESS ||
-			instance.getAttribute(wbem::CREATIONTIMESTAMP_KEY, creationTimeAttribute)
-					!= wbem::framework::SUCCESS ||
-			instance.getAttribute(wbem::PERCEIVEDSEVERITY_KEY, severityAttribute)
-					!= wbem::framework::SUCCESS ||
-			instance.getAttribute(wbem::MESSAGE_KEY, messageAttribute)
-					!= wbem::framework::SUCCESS ||
-			instance.getAttribute(wbem::MESSAGEARGS_KEY, messageArgsAttribute)
-					!= wbem::framework::SUCCESS ||
-			instance.getAttribute(wbem::ACTIONREQUIRED_KEY, actionRequiredAttribute)
-					!= wbem::framework::SUCCESS)
+		eventProperties_t properties;
+		if (!showEvents_logEntryToProperties((*pInstances)[i], properties))
 		{
-			COMMON_LOG_ERROR("Issue getting expected attributes from NVDIMMLogEntry.");
 			delete pListResult;
 			pListResult = NULL;
 			pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_UNKNOWN,
@@ -1340,61 +1508,20 @@ cli::nvmcli::FieldSupportFeature::showEvents_logEntriesToObjectList(
 		}
 		else
 		{
-			// Convert the attributes to appropriate output for the user
-
-			/*
-			 * date/time
-			 */
-			char datetime[255];
-			time_t t = (time_t) creationTimeAttribute.uint64Value();
-			struct tm *p_localTime = localtime(&t);
-			if (!p_localTime)
-			{
-				// this should never happen
-				COMMON_LOG_ERROR("Unable to get local time for log entry.");
-				s_strcpy(datetime, "00:00:0000:00:00:00", 255);
-			}
-			else
+			cli::framework::PropertyListResult propertyList;
+			propertyList.setName("Event");
+			std::string eventId;
+			for (eventProperties_t::const_iterator iter = properties.begin();
+					iter != properties.end(); iter++)
 			{
-				strftime(datetime, sizeof(datetime), "%m:%d:%Y:%H:%M:%S", p_localTime);
-			}
-			propertyList.insert("Time", datetime);
-
-			/*
-			 * Event ID
-			 */
-			propertyList.insert("EventID", instanceIdAttribute.asStr());
-
-			/*
-			 * Severity
-			 */
-			propertyList.insert("Severity", severityAttribute.asStr());
-
-			/*
-			 * ActionRequired
-			 */
-			if (actionRequiredAttribute.boolValue())
-			{
-				propertyList.insert("ActionRequired", "1");
-			}
-			else
-			{
-				propertyList.insert("ActionRequired", "0");
+				propertyList.insert(iter->first, iter->second);
+				if (iter->first == "EventID")
+				{
+					eventId = iter->second;
+				}
 			}
 
-			/*
-			 * Message
-			 */
-			char msg[NVM_EVENT_MSG_LEN + (3 * NVM_EVENT_ARG_LEN)];
-			s_snprintf(msg, (NVM_EVENT_MSG_LEN + (3 * NVM_EVENT_ARG_LEN)),
-					messageAttribute.asStr().c_str(),
-					messageArgsAttribute.strListValue()[0].c_str(),
-					messageArgsAttribute.strListValue()[1].c_str(),
-					messageArgsAttribute.strListValue()[2].c_str());
-			std::string message(msg);
-			propertyList.insert("Message", message);
-
-			pListResult->insert(instanceIdAttribute.asStr(), propertyList);
+			pListResult->insert(eventId, propertyList);
 		}
 		pListResult->setOutputType(cli::framework::ResultBase::OUTPUT_TEXTTABLE);
 	}
@@ -1402,6 +1529,48 @@ cli::nvmcli::FieldSupportFeature::showEvents_logEntriesToObjectList(
 	return pResult;
 }
 
+/*
+ * Write NVDIMMLogEntry instances as JSON objects as each one is converted. The provider
+ * returns every matching event at once, so the output is capped like the text output.
+ */
+cli::framework::ResultBase *
+cli::nvmcli::FieldSupportFeature::showEvents_logEntriesToJsonStream(
+		wbem::framework::instances_t *pInstances, bool ndjson)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	cli::framework::ResultBase *pResult = NULL;
+	framework::JsonStreamWriter writer(ndjson);
+
+	size_t events_to_show = pInstances->size() < MAX_EVENTS ? pInstances->size() : MAX_EVENTS;
+	for (size_t i = 0; i < events_to_show && !pResult; i++)
+	{
+		eventProperties_t properties;
+		if (!showEvents_logEntryToProperties((*pInstances)[i], properties))
+		{
+			// earlier events may already be written, so the stream must be closed
+			pResult = writer.getErrorResult(new framework::ErrorResult(
+					framework::ErrorResult::ERRORCODE_UNKNOWN, TRS(nvmcli::UNKNOWN_ERROR_STR)));
+		}
+		else
+		{
+			writer.beginObject();
+			for (eventProperties_t::const_iterator iter = properties.begin();
+					iter != properties.end(); iter++)
+			{
+				writer.addProperty(iter->first, iter->second);
+			}
+			writer.endObject();
+		}
+	}
+
+	if (!pResult)
+	{
+		pResult = writer.getResult();
+	}
+
+	return pResult;
+}
+
 /*
  * Convert the user input (options/targets/properties) into a filter that can be passed
  * to WBEM to filter the results of events. Returns a Syntax error if there is an error
@@ -1898,6 +2067,14 @@ cli::framework::ErrorResult *cli::nvmcli::FieldSupportFeature::wbemToCliGetNames
 	return wbemToCliProvider.getNamespaces(parsedCommand, namespaces);
 }
 
+static const cli::framework::EnumString FW_TYPE_STRINGS[] =
+{
+	{DEVICE_FW_TYPE_UNKNOWN, N_TR("Unknown")},
+	{DEVICE_FW_TYPE_PRODUCTION, N_TR("Production")},
+	{DEVICE_FW_TYPE_DFX, N_TR("DFx")},
+	{DEVICE_FW_TYPE_DEBUG, N_TR("Debug")}
+};
+
 cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::getDeviceFirmwareInstances(
 		const framework::ParsedCommand& parsedCommand,
 		wbem::framework::instances_t &instances)
@@ -1906,12 +2083,6 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::getDeviceFirmwareI
 
 	std::vector<std::string> guids;
 
-	std::map<device_fw_type, std::string> fwTypeMap;
-	fwTypeMap[DEVICE_FW_TYPE_UNKNOWN] = TR("Unknown");
-	fwTypeMap[DEVICE_FW_TYPE_PRODUCTION] = TR("Production");
-	fwTypeMap[DEVICE_FW_TYPE_DFX] = TR("DFx");
-	fwTypeMap[DEVICE_FW_TYPE_DEBUG] = TR("Debug");
-
 	wbem::framework::Instance instance;
 
 	pResult = cli::nvmcli::getDimms(parsedCommand, guids);
@@ -1930,7 +2101,9 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::getDeviceFirmwareI
 			instance.setAttribute(wbem::ACTIVEFWVERSION_KEY, fwRevAttr);
 
 			instance.setAttribute(wbem::ACTIVEFWTYPE_KEY,
-					wbem::framework::Attribute(fwTypeMap[fwInfoResult.getValue().getActiveType()], false));
+					wbem::framework::Attribute(
+							framework::enumToString(FW_TYPE_STRINGS, fwInfoResult.getValue().getActiveType()),
+							false));
 
 			// commit ID is displayed as N/A if it's not available
 			std::string commitIdStr = fwInfoResult.getValue().getActiveCommitId();
@@ -1945,7 +2118,8 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::getDeviceFirmwareI
 			std::string stagedFwRevStr = wbem::NA;
 			if (fwInfoResult.getValue().isStagedPending())
 			{
-				stagedFwTypeStr =  fwTypeMap[fwInfoResult.getValue().getStagedType()];
+				stagedFwTypeStr = framework::enumToString(FW_TYPE_STRINGS,
+						fwInfoResult.getValue().getStagedType());
 				stagedFwRevStr = fwInfoResult.getValue().getStagedRevision();
 			}
 
@@ -2017,3 +2191,15 @@ cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::showDeviceFirmware
 	}
 	return pResult;
 }
+
+/*
+ * Show the firmware mailbox statistics
+ */
+cli::framework::ResultBase *cli::nvmcli::FieldSupportFeature::showMailboxPerformance(
+		const framework::ParsedCommand &parsedCommand)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	ShowMailboxPerformanceCommand cmd;
+	return cmd.execute(parsedCommand);
+}
@@ -149,6 +149,7 @@ public:
 		SHOW_PREFERENCES,
 		CHANGE_PREFERENCES,
 		SHOW_DEVICE_FIRMWARE,
+		SHOW_MAILBOX_PERFORMANCE,
 	};
 
 	/*!
@@ -298,8 +299,13 @@ private:
 	cli::framework::ErrorResult *showEvents_inputToFilter(
 			cli::framework::ParsedCommand const &parsedCommand,
 			wbem::support::EventLogFilter &filter);
+	typedef std::vector<std::pair<std::string, std::string> > eventProperties_t;
+	bool showEvents_logEntryToProperties(wbem::framework::Instance &instance,
+			eventProperties_t &properties);
 	cli::framework::ResultBase *showEvents_logEntriesToObjectList(
 			wbem::framework::instances_t *pInstances);
+	cli::framework::ResultBase *showEvents_logEntriesToJsonStream(
+			wbem::framework::instances_t *pInstances, bool ndjson);
 	static wbem::framework::instances_t *wbemGetEvents(wbem::support::EventLogFilter &filter);
 	bool parseCliDateTime(std::string timeString, tm *pTm);
 	bool isInRange(int val, int min, int max);
@@ -323,6 +329,11 @@ private:
 	 * Show Device Firmware
 	 */
 	cli::framework::ResultBase *showDeviceFirmware(const framework::ParsedCommand &parsedCommand);
+
+	/*!
+	 * Show the firmware mailbox statistics
+	 */
+	cli::framework::ResultBase *showMailboxPerformance(const framework::ParsedCommand &parsedCommand);
 };
 
 };
@@ -95,6 +95,7 @@ void cli::nvmcli::NamespaceFeature::getPaths(cli::framework::CommandSpecList &li
 				"address space."));
 	createGoal.addOption(framework::OPTION_FORCE).helpText(TR("Reconfiguring " NVM_DIMM_NAME "s is a destructive operation "
 			"which requires confirmation from the user. This option suppresses the confirmation."));;
+	createGoal.addOption(OPTION_SEARCH);
 	createGoal.addTarget(TARGET_DIMM)
 			.isValueRequired(true)
 			.helpText(TR("Create a memory allocation goal on specific " NVM_DIMM_NAME "s by "
@@ -271,6 +272,46 @@ void cli::nvmcli::NamespaceFeature::getPaths(cli::framework::CommandSpecList &li
 			"specific sockets by supplying the socket target and one or more comma-separated socket identifiers. "
 			"The default is to load the memory allocation goal onto all manageable " NVM_DIMM_NAME "s on all sockets."));
 
+	framework::CommandSpec planGoal(PLAN_GOAL, TR("Plan Memory Allocation Goal"), framework::VERB_CREATE,
+			TR("Show the memory allocation goal that would be created for a synthetic " NVM_DIMM_NAME " "
+				"topology described in a file. The request is checked and laid out exactly as it would be "
+				"for Create Memory Allocation Goal, but nothing is written to the " NVM_DIMM_NAME "s."));
+	planGoal.addOption(framework::OPTION_SOURCE_R).helpText(TR("File path of the topology to plan for. "
+			"Each line is a setting such as Dimm=<socket>,<memory controller>,<channel>,<GiB>[,Locked], "
+			"InterleaveFormat=<ways>,<iMC size>,<channel size>[,Recommended], Sockets=<count> or "
+			"MemoryMode|AppDirect|Storage=0|1."));
+	planGoal.addOption(OPTION_SEARCH);
+	planGoal.addTarget(TARGET_PLAN_R).isValueAccepted(false);
+	planGoal.addProperty(MEMORYSIZE_PROPERTYNAME).isValueRequired(true)
+		.valueText("GiB")
+		.helpText(TR("Gibibytes of the " NVM_DIMM_NAME "s' capacity to use in Memory Mode or \"Remaining\"."));
+	planGoal.addProperty(APPDIRECTSIZE_PROPERTYNAME).isValueRequired(true)
+		.valueText("GiB")
+		.helpText(TR(APPDIRECT1SIZE_PROPERTYDESC.c_str()));
+	planGoal.addProperty(APPDIRECTSETTINGS_PROPERTYNAME).isValueRequired(true)
+		.valueText("value")
+		.helpText(TR(APPDIRECT1SETTING_PROPERTYDESC.c_str()));
+	planGoal.addProperty(APPDIRECT1SIZE_PROPERTYNAME).isValueRequired(true)
+		.valueText("GiB")
+		.helpText(TR(APPDIRECT1SIZE_PROPERTYDESC.c_str()));
+	planGoal.addProperty(APPDIRECT1SETTINGS_PROPERTYNAME).isValueRequired(true)
+		.valueText("value")
+		.helpText(TR(APPDIRECT1SETTING_PROPERTYDESC.c_str()));
+	planGoal.addProperty(APPDIRECT2SIZE_PROPERTYNAME).isValueRequired(true)
+		.valueText("GiB")
+		.helpText(TR(APPDIRECT2SIZE_PROPERTYDESC.c_str()));
+	planGoal.addProperty(APPDIRECT2SETTINGS_PROPERTYNAME).isValueRequired(true)
+		.valueText("value")
+		.helpText(TR(APPDIRECT2SETTING_PROPERTYDESC.c_str()));
+	planGoal.addProperty(RESERVEDIMM_PROPERTYNAME)
+		.isValueRequired(true)
+		.valueText("0|1")
+		.helpText(TRS(RESERVEDIMM_PROPERTYDESC));
+	planGoal.addProperty(STORAGECAPACITY_PROPERTYNAME)
+		.isValueRequired(true)
+		.valueText("Remaining")
+		.helpText(TRS(STORAGECAPACITY_PROPERTYDESC));
+
 	list.push_back(showNamespace);
 	list.push_back(createNamespace);
 	list.push_back(modifyNamespace);
@@ -281,6 +322,7 @@ void cli::nvmcli::NamespaceFeature::getPaths(cli::framework::CommandSpecList &li
 	list.push_back(showPools);
 	list.push_back(dumpConfig);
 	list.push_back(loadGoal);
+	list.push_back(planGoal);
  }
 
 
@@ -345,6 +387,9 @@ cli::framework::ResultBase * cli::nvmcli::NamespaceFeature::run(
 		case LOAD_CONFIG_GOAL:
 			pResult = loadGoal(parsedCommand);
 			break;
+		case PLAN_GOAL:
+			pResult = planGoal(parsedCommand);
+			break;
 		case SHOW_NAMESPACE:
 			pResult = showNamespaces(parsedCommand);
 			break;
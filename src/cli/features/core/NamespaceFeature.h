@@ -91,6 +91,7 @@ static const std::string STORAGECAPACITY_PROPERTYDESC =
 		"AppDirectSize are specified (i.e. set the entire "
 		NVM_DIMM_NAME " to Storage Mode.";
 
+static const std::string CREATECONFIGGOAL_ONDIMM_MSG = "Create configuration goal on " NVM_DIMM_NAME;
 static const std::string DELETECONFIGGOAL_FROMDIMM_MSG = "Delete configuration goal from " NVM_DIMM_NAME;
 static const std::string DUMPSYSTEMCONFIG_FROMDIMM_MSG = "Dump system configuration to file";
 
@@ -119,6 +120,9 @@ static const std::string NS_ALIGNMENT_PROMPT = TR(
 static const std::string CREATE_NS_SMALL_BLOCK_SIZE_PROMPT = TR(
 		"The requested namespace capacity %llu requires %llu physical space due to "
 		"the selected block size. Are you sure you want to continue?");
+static const std::string PLAN_GOAL_PREFIX = TR("The following configuration would be created:");
+static const std::string PLAN_GOAL_CAPACITY_MSG = TR(
+		"Total capacity - Memory Mode: %llu GiB, App Direct: %llu GiB, Storage: %llu GiB");
 static const std::string DELETE_CONFIG_GOAL_MSG = TR("Delete configuration goal: ");
 static const std::string DELETE_GOAL_PROMPT = TR(
 		"Delete the current configuration goal so that it is not applied by the BIOS on the next reboot?"); //!< prompt for user if not forced
@@ -180,7 +184,8 @@ class NVM_API NamespaceFeature : public cli::framework::FeatureBase
 			CREATE_GOAL,
 			SHOW_POOLS,
 			DUMP_CONFIG,
-			LOAD_CONFIG_GOAL
+			LOAD_CONFIG_GOAL,
+			PLAN_GOAL
 		};
 
 		// Interface for WBEM deleteNamespace functionality
@@ -232,6 +237,12 @@ class NVM_API NamespaceFeature : public cli::framework::FeatureBase
 		framework::ResultBase *showConfigGoal(const framework::ParsedCommand &parsedCommand);
 		framework::ResultBase *deleteConfigGoal(const framework::ParsedCommand &parsedCommand);
 		framework::ResultBase *createGoal(const framework::ParsedCommand &parsedCommand);
+
+		/*
+		 * Lay out a goal against the topology file given as the source
+		 * without touching the hardware.
+		 */
+		framework::ResultBase *planGoal(const framework::ParsedCommand &parsedCommand);
 		framework::ResultBase *showPools(const framework::ParsedCommand &parsedCommand);
 		framework::ResultBase *showNamespaces(const framework::ParsedCommand &parsedCommand);
 		framework::ResultBase *deleteNamespaces(const framework::ParsedCommand &parsedCommand);
@@ -343,6 +354,12 @@ class NVM_API NamespaceFeature : public cli::framework::FeatureBase
 		cli::framework::ResultBase* parsedCreateGoalParamsToRequest(
 				const framework::ParsedCommand& parsedCommand,
 				wbem::logic::MemoryAllocationRequest &request);
+		cli::framework::ResultBase* parsedGoalPropertiesToRequest(
+				const framework::ParsedCommand& parsedCommand,
+				wbem::logic::MemoryAllocationRequest &request);
+		cli::framework::ResultBase* planLayoutToResult(
+				const wbem::logic::MemoryAllocationLayout &layout,
+				const std::vector<struct device_discovery> &devices);
 		cli::framework::ResultBase* validateSocketList(const std::vector<std::string> &socketList);
 		cli::framework::ResultBase* addDimmsToRequestFromSocketList(
 				const std::vector<std::string> &socketList,
@@ -357,6 +374,9 @@ class NVM_API NamespaceFeature : public cli::framework::FeatureBase
 				const cli::nvmcli::filters_t &filters,
 				wbem::framework::attribute_names_t &displayAttributes,
 				wbem::framework::instances_t *pWbemInstances);
+		framework::ResultBase *createGoalResultsToListResult(
+				const wbem::logic::MemoryAllocationResults &results,
+				framework::ErrorResult *pError);
 		bool promptUserConfirmationForLayout(const wbem::logic::MemoryAllocationLayout &layout);
 		std::string getPromptStringForLayout(const wbem::logic::MemoryAllocationLayout &layout);
 		std::string getStringForLayoutWarning(enum wbem::logic::LayoutWarningCode warningCode);
@@ -36,6 +36,7 @@
 #include <guid/guid.h>
 #include <logic/MemoryAllocationTypes.h>
 #include <logic/MemoryAllocator.h>
+#include <logic/MemoryAllocationPlanner.h>
 #include <mem_config/MemoryConfigurationFactory.h>
 #include <pmem_config/PersistentMemoryCapabilitiesFactory.h>
 #include <memory/SystemProcessorFactory.h>
@@ -688,6 +689,7 @@ cli::framework::ResultBase* cli::nvmcli::NamespaceFeature::createGoal(
 	if (!pResult)
 	{
 		wbem::logic::MemoryAllocator *pAllocator = NULL;
+		wbem::logic::MemoryAllocationResults results;
 		try
 		{
 			pAllocator = wbem::logic::MemoryAllocator::getNewMemoryAllocator();
@@ -695,7 +697,7 @@ cli::framework::ResultBase* cli::nvmcli::NamespaceFeature::createGoal(
 
 			if (forceOption || promptUserConfirmationForLayout(layout))
 			{
-				pAllocator->allocate(layout);
+				pAllocator->allocate(layout, results);
 			}
 			else
 			{
@@ -705,7 +707,15 @@ cli::framework::ResultBase* cli::nvmcli::NamespaceFeature::createGoal(
 		}
 		catch (wbem::framework::Exception &e)
 		{
-			pResult = NvmExceptionToResult(e);
+			framework::ErrorResult *pError = NvmExceptionToResult(e);
+			if (results.empty())
+			{
+				pResult = pError;
+			}
+			else
+			{
+				pResult = createGoalResultsToListResult(results, pError);
+			}
 		}
 
 		if (pAllocator)
@@ -723,6 +733,42 @@ cli::framework::ResultBase* cli::nvmcli::NamespaceFeature::createGoal(
 	return pResult;
 }
 
+/*
+ * Report the outcome of a failed goal request on each DIMM. Goals are applied
+ * all together, so a DIMM without an error of its own was left unchanged.
+ */
+cli::framework::ResultBase* cli::nvmcli::NamespaceFeature::createGoalResultsToListResult(
+		const wbem::logic::MemoryAllocationResults &results,
+		framework::ErrorResult *pError)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	framework::SimpleListResult *pListResults = new framework::SimpleListResult();
+	for (wbem::logic::MemoryAllocationResults::const_iterator resultIter = results.begin();
+			resultIter != results.end(); resultIter++)
+	{
+		std::string prefix = cli::framework::ResultBase::stringFromArgList(
+				(TRS(CREATECONFIGGOAL_ONDIMM_MSG) + " %s").c_str(),
+				wbem::physical_asset::NVDIMMFactory::guidToDimmIdStr(
+						resultIter->first).c_str()) + ": ";
+		if (resultIter->second == NVM_SUCCESS)
+		{
+			pListResults->insert(prefix + TRS(cli::framework::UNCHANGED_MSG));
+		}
+		else
+		{
+			wbem::exception::NvmExceptionLibError dimmError(resultIter->second);
+			framework::ErrorResult *pDimmResult = NvmExceptionToResult(dimmError);
+			pListResults->insert(prefix + pDimmResult->outputText());
+			delete pDimmResult;
+		}
+	}
+	pListResults->setErrorCode(pError->getErrorCode());
+	delete pError;
+
+	return pListResults;
+}
+
 bool cli::nvmcli::NamespaceFeature::promptUserConfirmationForLayout(
 		const wbem::logic::MemoryAllocationLayout &layout)
 {
@@ -834,16 +880,10 @@ cli::framework::ResultBase* cli::nvmcli::NamespaceFeature::parsedCreateGoalParam
 
 	cli::framework::ResultBase *pResult = NULL;
 
-	MemoryProperty memoryModeProp(parsedCommand, MEMORYSIZE_PROPERTYNAME);
-	MemoryProperty appDirect0Prop(parsedCommand, APPDIRECTSIZE_PROPERTYNAME,
-			APPDIRECTSETTINGS_PROPERTYNAME);
-	MemoryProperty appDirect1Prop(parsedCommand, APPDIRECT1SIZE_PROPERTYNAME,
-			APPDIRECT1SETTINGS_PROPERTYNAME);
-	MemoryProperty appDirect2Prop(parsedCommand, APPDIRECT2SIZE_PROPERTYNAME,
-			APPDIRECT2SETTINGS_PROPERTYNAME);
-
 	pResult = parseReserveDimmProperty(parsedCommand);
 	request.reserveDimm = m_reserveDimm;
+	request.searchLayouts = parsedCommand.options.find(OPTION_SEARCH.name)
+			!= parsedCommand.options.end();
 
 	if (!pResult)
 	{
@@ -852,109 +892,134 @@ cli::framework::ResultBase* cli::nvmcli::NamespaceFeature::parsedCreateGoalParam
 
 	if (!pResult)
 	{
-		m_storageIsRemaining = false;
-		std::string storageCapacityValue = framework::Parser::getPropertyValue(parsedCommand,
-				STORAGECAPACITY_PROPERTYNAME,
-				&m_storageIsRemaining);
+		pResult = parsedGoalPropertiesToRequest(parsedCommand, request);
+	}
 
-		// AppDirect or AppDirect1 is valid, not both
-		MemoryProperty &appDirectProp = appDirect0Prop.getSizeExists() ? appDirect0Prop : appDirect1Prop;
+	return pResult;
+}
 
-		// If at least one of the App Direct regions is specified as "remaining"
-		// then set a flag
-		if (appDirect0Prop.getIsRemaining() || appDirect1Prop.getIsRemaining() || appDirect2Prop.getIsRemaining())
-		{
-			m_appDirectIsRemaining = true;
-		}
+/*
+ * Fill in the requested capacities from the goal properties. Expects the
+ * reserve DIMM property to be parsed already.
+ */
+cli::framework::ResultBase* cli::nvmcli::NamespaceFeature::parsedGoalPropertiesToRequest(
+		const framework::ParsedCommand& parsedCommand,
+		wbem::logic::MemoryAllocationRequest &request)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
-		// if reserveDimm property is set when creating a goal on a single
-		// NVM-DIMM, the only valid property is StorageCapacity=Remaining.
-		std::vector<std::string> dimmList =
-			cli::framework::Parser::getTargetValues(parsedCommand, TARGET_DIMM.name);
-		if ((dimmList.size() == 1) && (m_reserveDimm))
-		{
-			if (appDirect2Prop.getSizeExists() || appDirectProp.getSizeExists() ||
-				appDirect1Prop.getSizeExists() || memoryModeProp.getSizeExists())
-			{
-				pResult = new framework::SyntaxErrorResult(
-						framework::ResultBase::stringFromArgList(
-						TR("'%s' is the only valid property that can be used in "
-						"conjunction with '%s' property when creating a goal on a "
-						"single " NVM_DIMM_NAME "."),
-						STORAGECAPACITY_PROPERTYNAME.c_str(),
-						RESERVEDIMM_PROPERTYNAME.c_str()));
-			}
-			request.memoryCapacity = 0;
-		}
-		// StorageCapacity can only be "Remaining" if it exists
-		else if (m_storageIsRemaining && !framework::stringsIEqual(storageCapacityValue, wbem::mem_config::SIZE_REMAINING))
-		{
-			pResult = new framework::SyntaxErrorBadValueResult(framework::TOKENTYPE_PROPERTY,
-					STORAGECAPACITY_PROPERTYNAME, storageCapacityValue);
-		}
-		// Only one can have 'Remaining' keyword
-		else if ((memoryModeProp.getIsRemaining() +
-				appDirectProp.getIsRemaining() +
-				appDirect2Prop.getIsRemaining() +
-				m_storageIsRemaining) > 1)
-		{
-			pResult = new framework::SyntaxErrorResult(framework::ResultBase::stringFromArgList(
-					TR("'%s' can only be used once."), wbem::mem_config::SIZE_REMAINING.c_str()));
-		}
-		// must have at least one property
-		else if (!(memoryModeProp.getSizeExists() || appDirectProp.getSizeExists() || m_storageIsRemaining))
-		{
-			pResult = new framework::SyntaxErrorResult(framework::ResultBase::stringFromArgList(
-					TR("'%s' or '%s' or '%s' is required."),
-					MEMORYSIZE_PROPERTYNAME.c_str(),
-					APPDIRECTSIZE_PROPERTYNAME.c_str(),
-					STORAGECAPACITY_PROPERTYNAME.c_str()));
-		}
-		// using AD and AD1 is redundant
-		else if (appDirect0Prop.getSizeExists() && appDirect1Prop.getSizeExists())
-		{
-			pResult = new framework::SyntaxErrorResult(
-					framework::ResultBase::stringFromArgList(
-							TR("'%s' and '%s' cannot be used together."),
-							APPDIRECTSIZE_PROPERTYNAME.c_str(),
-							APPDIRECT1SIZE_PROPERTYNAME.c_str()));
-		}
-		// AD2 without AD or AD1 is invalid
-		else if (appDirect2Prop.getSizeExists() && !appDirectProp.getSizeExists() && !appDirect1Prop.getSizeExists())
+	cli::framework::ResultBase *pResult = NULL;
+
+	MemoryProperty memoryModeProp(parsedCommand, MEMORYSIZE_PROPERTYNAME);
+	MemoryProperty appDirect0Prop(parsedCommand, APPDIRECTSIZE_PROPERTYNAME,
+			APPDIRECTSETTINGS_PROPERTYNAME);
+	MemoryProperty appDirect1Prop(parsedCommand, APPDIRECT1SIZE_PROPERTYNAME,
+			APPDIRECT1SETTINGS_PROPERTYNAME);
+	MemoryProperty appDirect2Prop(parsedCommand, APPDIRECT2SIZE_PROPERTYNAME,
+			APPDIRECT2SETTINGS_PROPERTYNAME);
+
+	m_storageIsRemaining = false;
+	std::string storageCapacityValue = framework::Parser::getPropertyValue(parsedCommand,
+			STORAGECAPACITY_PROPERTYNAME,
+			&m_storageIsRemaining);
+
+	// AppDirect or AppDirect1 is valid, not both
+	MemoryProperty &appDirectProp = appDirect0Prop.getSizeExists() ? appDirect0Prop : appDirect1Prop;
+
+	// If at least one of the App Direct regions is specified as "remaining"
+	// then set a flag
+	if (appDirect0Prop.getIsRemaining() || appDirect1Prop.getIsRemaining() || appDirect2Prop.getIsRemaining())
+	{
+		m_appDirectIsRemaining = true;
+	}
+
+	// if reserveDimm property is set when creating a goal on a single
+	// NVM-DIMM, the only valid property is StorageCapacity=Remaining.
+	std::vector<std::string> dimmList =
+		cli::framework::Parser::getTargetValues(parsedCommand, TARGET_DIMM.name);
+	if ((dimmList.size() == 1) && (m_reserveDimm))
+	{
+		if (appDirect2Prop.getSizeExists() || appDirectProp.getSizeExists() ||
+			appDirect1Prop.getSizeExists() || memoryModeProp.getSizeExists())
 		{
 			pResult = new framework::SyntaxErrorResult(
 					framework::ResultBase::stringFromArgList(
-							TR("'%s' is invalid without '%s' or '%s'."),
-							APPDIRECT2SIZE_PROPERTYNAME.c_str(),
-							APPDIRECTSIZE_PROPERTYNAME.c_str(),
-							APPDIRECT1SIZE_PROPERTYNAME.c_str()
-							)
-					);
+					TR("'%s' is the only valid property that can be used in "
+					"conjunction with '%s' property when creating a goal on a "
+					"single " NVM_DIMM_NAME "."),
+					STORAGECAPACITY_PROPERTYNAME.c_str(),
+					RESERVEDIMM_PROPERTYNAME.c_str()));
 		}
-		// all properties used must be valid
-		else if ((pResult = memoryModeProp.validate()) == NULL &&
-				(pResult = appDirect0Prop.validate()) == NULL &&
-				(pResult = appDirect1Prop.validate()) == NULL &&
-				(pResult = appDirect2Prop.validate()) == NULL)
-		{
-			// Set memory size
-			request.memoryCapacity = memoryModeProp.getIsRemaining() ?
-					wbem::logic::REQUEST_REMAINING_CAPACITY :
-					memoryModeProp.getSizeGiB();
+		request.memoryCapacity = 0;
+	}
+	// StorageCapacity can only be "Remaining" if it exists
+	else if (m_storageIsRemaining && !framework::stringsIEqual(storageCapacityValue, wbem::mem_config::SIZE_REMAINING))
+	{
+		pResult = new framework::SyntaxErrorBadValueResult(framework::TOKENTYPE_PROPERTY,
+				STORAGECAPACITY_PROPERTYNAME, storageCapacityValue);
+	}
+	// Only one can have 'Remaining' keyword
+	else if ((memoryModeProp.getIsRemaining() +
+			appDirectProp.getIsRemaining() +
+			appDirect2Prop.getIsRemaining() +
+			m_storageIsRemaining) > 1)
+	{
+		pResult = new framework::SyntaxErrorResult(framework::ResultBase::stringFromArgList(
+				TR("'%s' can only be used once."), wbem::mem_config::SIZE_REMAINING.c_str()));
+	}
+	// must have at least one property
+	else if (!(memoryModeProp.getSizeExists() || appDirectProp.getSizeExists() || m_storageIsRemaining))
+	{
+		pResult = new framework::SyntaxErrorResult(framework::ResultBase::stringFromArgList(
+				TR("'%s' or '%s' or '%s' is required."),
+				MEMORYSIZE_PROPERTYNAME.c_str(),
+				APPDIRECTSIZE_PROPERTYNAME.c_str(),
+				STORAGECAPACITY_PROPERTYNAME.c_str()));
+	}
+	// using AD and AD1 is redundant
+	else if (appDirect0Prop.getSizeExists() && appDirect1Prop.getSizeExists())
+	{
+		pResult = new framework::SyntaxErrorResult(
+				framework::ResultBase::stringFromArgList(
+						TR("'%s' and '%s' cannot be used together."),
+						APPDIRECTSIZE_PROPERTYNAME.c_str(),
+						APPDIRECT1SIZE_PROPERTYNAME.c_str()));
+	}
+	// AD2 without AD or AD1 is invalid
+	else if (appDirect2Prop.getSizeExists() && !appDirectProp.getSizeExists() && !appDirect1Prop.getSizeExists())
+	{
+		pResult = new framework::SyntaxErrorResult(
+				framework::ResultBase::stringFromArgList(
+						TR("'%s' is invalid without '%s' or '%s'."),
+						APPDIRECT2SIZE_PROPERTYNAME.c_str(),
+						APPDIRECTSIZE_PROPERTYNAME.c_str(),
+						APPDIRECT1SIZE_PROPERTYNAME.c_str()
+						)
+				);
+	}
+	// all properties used must be valid
+	else if ((pResult = memoryModeProp.validate()) == NULL &&
+			(pResult = appDirect0Prop.validate()) == NULL &&
+			(pResult = appDirect1Prop.validate()) == NULL &&
+			(pResult = appDirect2Prop.validate()) == NULL)
+	{
+		// Set memory size
+		request.memoryCapacity = memoryModeProp.getIsRemaining() ?
+				wbem::logic::REQUEST_REMAINING_CAPACITY :
+				memoryModeProp.getSizeGiB();
 
-			request.storageRemaining = m_storageIsRemaining;
+		request.storageRemaining = m_storageIsRemaining;
 
-			// Set information for first interleave set
-			if (appDirectProp.getSizeExists())
-			{
-				request.appDirectExtents.push_back(memoryPropToAppDirectExtent(appDirectProp));
-			}
+		// Set information for first interleave set
+		if (appDirectProp.getSizeExists())
+		{
+			request.appDirectExtents.push_back(memoryPropToAppDirectExtent(appDirectProp));
+		}
 
-			// Set information for second interleave set
-			if (appDirect2Prop.getSizeExists())
-			{
-				request.appDirectExtents.push_back(memoryPropToAppDirectExtent(appDirect2Prop));
-			}
+		// Set information for second interleave set
+		if (appDirect2Prop.getSizeExists())
+		{
+			request.appDirectExtents.push_back(memoryPropToAppDirectExtent(appDirect2Prop));
 		}
 	}
 
@@ -1319,6 +1384,151 @@ cli::framework::ResultBase *cli::nvmcli::NamespaceFeature::loadGoal(const framew
 	return pResult;
 }
 
+/*
+ * Lay out a goal against a topology file without touching the hardware
+ */
+cli::framework::ResultBase *cli::nvmcli::NamespaceFeature::planGoal(
+		const framework::ParsedCommand &parsedCommand)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	framework::ResultBase *pResult = NULL;
+
+	std::string path = framework::Parser::getOptionValue(parsedCommand,
+			framework::OPTION_SOURCE_R.name, NULL);
+
+	try
+	{
+		wbem::logic::MemoryAllocationPlanner planner;
+		planner.loadTopology(path);
+
+		wbem::logic::MemoryAllocationRequest request;
+		pResult = parseReserveDimmProperty(parsedCommand);
+		request.reserveDimm = m_reserveDimm;
+		request.searchLayouts = parsedCommand.options.find(OPTION_SEARCH.name)
+				!= parsedCommand.options.end();
+		request.dimms = planner.getDimms();
+
+		if (!pResult)
+		{
+			pResult = parsedGoalPropertiesToRequest(parsedCommand, request);
+		}
+
+		if (!pResult)
+		{
+			wbem::logic::MemoryAllocationLayout layout = planner.plan(request);
+			pResult = planLayoutToResult(layout, planner.getDevices());
+		}
+	}
+	catch (wbem::framework::Exception &e)
+	{
+		if (pResult)
+		{
+			delete pResult;
+		}
+		pResult = NvmExceptionToResult(e);
+	}
+
+	return pResult;
+}
+
+/*
+ * The topology DIMMs don't exist, so the goal table is built from the layout
+ * rather than from the MemoryConfiguration instances.
+ */
+cli::framework::ResultBase* cli::nvmcli::NamespaceFeature::planLayoutToResult(
+		const wbem::logic::MemoryAllocationLayout &layout,
+		const std::vector<struct device_discovery> &devices)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	wbem::framework::attribute_names_t displayAttributes;
+	populateCreateConfigGoalPromptDefaultAttributes(displayAttributes);
+
+	wbem::framework::instances_t displayInstances;
+	for (std::vector<struct device_discovery>::const_iterator deviceIter = devices.begin();
+			deviceIter != devices.end(); deviceIter++)
+	{
+		NVM_GUID_STR guidStr;
+		guid_to_str(deviceIter->guid, guidStr);
+		std::map<std::string, struct config_goal>::const_iterator goalIter =
+				layout.goals.find(guidStr);
+		if (goalIter == layout.goals.end())
+		{
+			continue;
+		}
+		const struct config_goal &goal = goalIter->second;
+
+		wbem::framework::Instance instance;
+		instance.setAttribute(wbem::DIMMGUID_KEY,
+				wbem::framework::Attribute(std::string(guidStr), false));
+		instance.setAttribute(wbem::DIMMID_KEY,
+				wbem::framework::Attribute(deviceIter->device_handle.handle, false),
+				displayAttributes);
+		instance.setAttribute(wbem::SOCKETID_KEY,
+				wbem::framework::Attribute(deviceIter->socket_id, false),
+				displayAttributes);
+		instance.setAttribute(wbem::MEMORYSIZE_KEY,
+				wbem::framework::Attribute(goal.memory_size * BYTES_PER_GB, false),
+				displayAttributes);
+		cli::nvmcli::convertCapacityAttribute(instance, wbem::MEMORYSIZE_KEY);
+
+		NVM_UINT64 appDirect1SizeB = goal.app_direct_count > 0 ?
+				goal.app_direct_1_size * BYTES_PER_GB : 0;
+		instance.setAttribute(wbem::APPDIRECT1SIZE_KEY,
+				wbem::framework::Attribute(appDirect1SizeB, false),
+				displayAttributes);
+		cli::nvmcli::convertCapacityAttribute(instance, wbem::APPDIRECT1SIZE_KEY);
+
+		NVM_UINT64 appDirect2SizeB = goal.app_direct_count > 1 ?
+				goal.app_direct_2_size * BYTES_PER_GB : 0;
+		instance.setAttribute(wbem::APPDIRECT2SIZE_KEY,
+				wbem::framework::Attribute(appDirect2SizeB, false),
+				displayAttributes);
+		cli::nvmcli::convertCapacityAttribute(instance, wbem::APPDIRECT2SIZE_KEY);
+
+		NVM_UINT64 storageCapacity = wbem::mem_config::MemoryConfigurationFactory::
+				getDimmStorageCapacityFromGoal(&(*deviceIter), goal);
+		instance.setAttribute(wbem::STORAGECAPACITY_KEY,
+				wbem::framework::Attribute(storageCapacity, false),
+				displayAttributes);
+		cli::nvmcli::convertCapacityAttribute(instance, wbem::STORAGECAPACITY_KEY);
+
+		displayInstances.push_back(instance);
+	}
+
+	filters_t noFilters;
+	framework::ResultBase *pDisplayGoal = NvmInstanceToObjectListResult(displayInstances,
+			wbem::CONFIGGOALTABLENAME, wbem::DIMMID_KEY, displayAttributes, noFilters);
+	pDisplayGoal->setOutputType(framework::ResultBase::OUTPUT_TEXTTABLE);
+
+	NVM_UINT64 appDirectCapacity = 0;
+	for (std::vector<NVM_UINT64>::const_iterator capacityIter = layout.appDirectCapacities.begin();
+			capacityIter != layout.appDirectCapacities.end(); capacityIter++)
+	{
+		appDirectCapacity += *capacityIter;
+	}
+
+	std::stringstream planStr;
+	planStr << PLAN_GOAL_PREFIX << std::endl << std::endl;
+	planStr << pDisplayGoal->output() << std::endl;
+	planStr << framework::ResultBase::stringFromArgList(PLAN_GOAL_CAPACITY_MSG.c_str(),
+			layout.memoryCapacity, appDirectCapacity, layout.storageCapacity);
+	delete pDisplayGoal;
+
+	for (std::vector<enum wbem::logic::LayoutWarningCode>::const_iterator warningIter = layout.warnings.begin();
+			warningIter != layout.warnings.end(); warningIter++)
+	{
+		std::string warningStr = getStringForLayoutWarning(*warningIter);
+		if (!warningStr.empty())
+		{
+			planStr << std::endl << warningStr;
+		}
+	}
+
+	return new framework::SimpleResult(planStr.str());
+}
+
 cli::framework::ResultBase* cli::nvmcli::NamespaceFeature::parseReserveDimmProperty(
 		const framework::ParsedCommand& parsedCommand)
 {
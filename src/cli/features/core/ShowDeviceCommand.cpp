@@ -32,6 +32,8 @@
 #include <persistence/config_settings.h>
 #include <persistence/lib_persistence.h>
 #include <cli/features/core/framework/CliHelper.h>
+#include <cli/features/core/framework/JsonStreamWriter.h>
+#include <cli/features/core/framework/EnumStringTable.h>
 
 #include "ShowDeviceCommand.h"
 
@@ -133,124 +135,174 @@ framework::ResultBase *ShowDeviceCommand::execute(const framework::ParsedCommand
 				if (socketIdsAreValid())
 				{
 					filterDevicesOnSocketIds();
-
-					createResults();
+					m_service.prefetchDetails(m_devices);
+
+					if (m_displayOptions.isStreamed())
+					{
+						streamResults();
+					}
+					else
+					{
+						createResults();
+					}
 				}
 			}
 		}
 		catch (core::LibraryException &e)
 		{
-			int libRc = e.getErrorCode();
-			if (libRc == NVM_ERR_NOMEMORY)
-			{
-				m_pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_OUTOFMEMORY, NOMEMORY_ERROR_STR);
-			}
-			else if (libRc == NVM_ERR_NOTSUPPORTED)
-			{
-				m_pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_NOTSUPPORTED, NOTSUPPORTED_ERROR_STR);
-			}
-			else
-			{
-				// return the library message
-				m_pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_UNKNOWN, e.what());
-			}
+			m_pResult = libraryExceptionToResult(e);
 		}
 	}
 
 	return m_pResult;
 }
 
+framework::ErrorResult *ShowDeviceCommand::libraryExceptionToResult(core::LibraryException &e)
+{
+	framework::ErrorResult *pResult = NULL;
+	int libRc = e.getErrorCode();
+	if (libRc == NVM_ERR_NOMEMORY)
+	{
+		pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_OUTOFMEMORY, NOMEMORY_ERROR_STR);
+	}
+	else if (libRc == NVM_ERR_NOTSUPPORTED)
+	{
+		pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_NOTSUPPORTED, NOTSUPPORTED_ERROR_STR);
+	}
+	else
+	{
+		// return the library message
+		pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_UNKNOWN, e.what());
+	}
+	return pResult;
+}
+
+static const framework::EnumString LOCK_STATE_STRINGS[] =
+{
+	{LOCK_STATE_UNKNOWN, N_TR("Unknown")},
+	{LOCK_STATE_DISABLED, N_TR("Disabled")},
+	{LOCK_STATE_UNLOCKED, N_TR("Unlocked")},
+	{LOCK_STATE_LOCKED, N_TR("Locked")},
+	{LOCK_STATE_FROZEN, N_TR("Frozen")},
+	{LOCK_STATE_PASSPHRASE_LIMIT, N_TR("Exceeded")},
+	{LOCK_STATE_NOT_SUPPORTED, N_TR("Not Supported")}
+};
+
+static const framework::EnumString HEALTH_STATE_STRINGS[] =
+{
+	{DEVICE_HEALTH_UNKNOWN, N_TR("Unknown")},
+	{DEVICE_HEALTH_NORMAL, N_TR("Healthy")},
+	{DEVICE_HEALTH_NONCRITICAL, N_TR("Minor Failure")},
+	{DEVICE_HEALTH_CRITICAL, N_TR("Critical Failure")},
+	{DEVICE_HEALTH_FATAL, N_TR("Non-recoverable error")},
+	{DEVICE_HEALTH_UNMANAGEABLE, N_TR("Unmanageable")}
+};
+
+static const framework::EnumString MANAGEABILITY_STATE_STRINGS[] =
+{
+	{MANAGEMENT_UNKNOWN, N_TR("Unknown")},
+	{MANAGEMENT_VALIDCONFIG, N_TR("Manageable")},
+	{MANAGEMENT_INVALIDCONFIG, N_TR("Unmanageable")}
+};
+
+static const framework::EnumString MEMORY_TYPE_STRINGS[] =
+{
+	{MEMORY_TYPE_UNKNOWN, N_TR("Unknown")},
+	{MEMORY_TYPE_DDR4, N_TR("DDR4")},
+	{MEMORY_TYPE_NVMDIMM, N_TR("NVM-DIMM")}
+};
+
+static const framework::EnumString FORM_FACTOR_STRINGS[] =
+{
+	{DEVICE_FORM_FACTOR_UNKNOWN, N_TR("Unknown")},
+	{DEVICE_FORM_FACTOR_DIMM, N_TR("DIMM")},
+	{DEVICE_FORM_FACTOR_SODIMM, N_TR("SODIMM")}
+};
+
+static const framework::EnumString FW_LOG_LEVEL_STRINGS[] =
+{
+	{FW_LOG_LEVEL_DISABLED, N_TR("Disabled")},
+	{FW_LOG_LEVEL_ERROR, N_TR("Error")},
+	{FW_LOG_LEVEL_WARN, N_TR("Warning")},
+	{FW_LOG_LEVEL_INFO, N_TR("Info")},
+	{FW_LOG_LEVEL_DEBUG, N_TR("Debug")},
+	{FW_LOG_LEVEL_UNKNOWN, N_TR("Unknown")}
+};
+
+static const framework::EnumString CONFIG_STATUS_STRINGS[] =
+{
+	{CONFIG_STATUS_NOT_CONFIGURED, N_TR("Not configured")},
+	{CONFIG_STATUS_VALID, N_TR("Valid")},
+	{CONFIG_STATUS_ERR_CORRUPT, N_TR("Failed - Bad configuration")},
+	{CONFIG_STATUS_ERR_BROKEN_INTERLEAVE, N_TR("Failed - Broken interleave")},
+	{CONFIG_STATUS_ERR_REVERTED, N_TR("Failed - Reverted")},
+	{CONFIG_STATUS_ERR_NOT_SUPPORTED, N_TR("Failed - Unsupported")}
+};
+
+static const framework::EnumString LAST_SHUTDOWN_STATUS_STRINGS[] =
+{
+	{DEVICE_LAST_SHUTDOWN_STATUS_UKNOWN, N_TR("Unknown")},
+	{DEVICE_LAST_SHUTDOWN_STATUS_FW_FLUSH_COMPLETE, N_TR("FW Flush Complete")},
+	{DEVICE_LAST_SHUTDOWN_STATUS_PM_ADR_COMMAND, N_TR("PM ADR Command")},
+	{DEVICE_LAST_SHUTDOWN_STATUS_PM_S3, N_TR("PM S3")},
+	{DEVICE_LAST_SHUTDOWN_STATUS_PM_S5, N_TR("PM S5")},
+	{DEVICE_LAST_SHUTDOWN_STATUS_DDRT_POWER_FAIL, N_TR("DDRT Power Fail Command")},
+	{DEVICE_LAST_SHUTDOWN_STATUS_PMIC_12V_POWER_FAIL, N_TR("PMIC 12V Power Fail")},
+	{DEVICE_LAST_SHUTDOWN_STATUS_PM_WARM_RESET, N_TR("PM Warm Reset")},
+	{DEVICE_LAST_SHUTDOWN_STATUS_THERMAL_SHUTDOWN, N_TR("Thermal Shutdown")}
+};
+
+static const framework::EnumString MEMORY_MODE_STRINGS[] =
+{
+	{MEMORY_CAPABILITY_MEMORYMODE, N_TR("Memory")},
+	{MEMORYTYPE_CAPABILITY_STORAGEMODE, N_TR("Storage")},
+	{MEMORYTYPE_CAPABILITY_APPDIRECTMODE, N_TR("App Direct")}
+};
+
+static const framework::EnumString SECURITY_CAPABILITY_STRINGS[] =
+{
+	{SECURITY_PASSPHRASE, N_TR("Encryption")},
+	{SECURITY_ERASE, N_TR("Erase")}
+};
+
 std::string ShowDeviceCommand::convertLockState(lock_state lockState)
 {
-	std::map<lock_state, std::string> map;
-	map[LOCK_STATE_UNKNOWN] = TR("Unknown");
-	map[LOCK_STATE_DISABLED] = TR("Disabled");
-	map[LOCK_STATE_UNLOCKED] = TR("Unlocked");
-	map[LOCK_STATE_LOCKED] = TR("Locked");
-	map[LOCK_STATE_FROZEN] = TR("Frozen");
-	map[LOCK_STATE_PASSPHRASE_LIMIT] = TR("Exceeded");
-	map[LOCK_STATE_NOT_SUPPORTED] = TR("Not Supported");
-	return map[lockState];
+	return framework::enumToString(LOCK_STATE_STRINGS, lockState);
 }
 
 std::string ShowDeviceCommand::convertHealthState(NVM_UINT16 healthState)
 {
-	std::map<NVM_UINT64, std::string> map;
-	map[DEVICE_HEALTH_UNKNOWN] = TR("Unknown");
-	map[DEVICE_HEALTH_NORMAL] = TR("Healthy");
-	map[DEVICE_HEALTH_NONCRITICAL] = TR("Minor Failure");
-	map[DEVICE_HEALTH_CRITICAL] = TR("Critical Failure");
-	map[DEVICE_HEALTH_FATAL] = TR("Non-recoverable error");
-	map[DEVICE_HEALTH_UNMANAGEABLE] = TR("Unmanageable");
-	return map[healthState];
+	return framework::enumToString(HEALTH_STATE_STRINGS, healthState);
 }
 
 std::string ShowDeviceCommand::convertManageabilityState(manageability_state state)
 {
-	std::map<NVM_UINT64, std::string> map;
-	map[MANAGEMENT_VALIDCONFIG] = TR("Manageable");
-	map[MANAGEMENT_INVALIDCONFIG] = TR("Unmanageable");
-	map[MANAGEMENT_UNKNOWN] = TR("Unknown");
-	return map[state];
+	return framework::enumToString(MANAGEABILITY_STATE_STRINGS, state);
 }
 
 std::string ShowDeviceCommand::convertMemoryType(memory_type type)
 {
-	std::map<NVM_UINT64, std::string> map;
-	map[MEMORY_TYPE_UNKNOWN] = TR("Unknown");
-	map[MEMORY_TYPE_DDR4] = TR("DDR4");
-	map[MEMORY_TYPE_NVMDIMM] = TR("NVM-DIMM");
-	return map[type];
+	return framework::enumToString(MEMORY_TYPE_STRINGS, type);
 }
 
 std::string ShowDeviceCommand::convertFormFactor(device_form_factor formFactor)
 {
-	std::map<NVM_UINT64, std::string> map;
-	map[DEVICE_FORM_FACTOR_DIMM] = TR("DIMM");
-	map[DEVICE_FORM_FACTOR_SODIMM] = TR("SODIMM");
-	map[DEVICE_FORM_FACTOR_UNKNOWN] = TR("Unknown");
-
-	return map[formFactor];
+	return framework::enumToString(FORM_FACTOR_STRINGS, formFactor);
 }
 
 std::string ShowDeviceCommand::convertFwLogLevel(fw_log_level logLevel)
 {
-	std::map<NVM_UINT64, std::string> map;
-	map[FW_LOG_LEVEL_DISABLED] = TR("Disabled");
-	map[FW_LOG_LEVEL_ERROR] = TR("Error");
-	map[FW_LOG_LEVEL_WARN] = TR("Warning");
-	map[FW_LOG_LEVEL_INFO] = TR("Info");
-	map[FW_LOG_LEVEL_DEBUG] = TR("Debug");
-	map[FW_LOG_LEVEL_UNKNOWN] = TR("Unknown");
-
-	return map[logLevel];
+	return framework::enumToString(FW_LOG_LEVEL_STRINGS, logLevel);
 }
 
 std::string ShowDeviceCommand::convertConfigStatus(config_status status)
 {
-	std::map<config_status, std::string> map;
-	map[CONFIG_STATUS_NOT_CONFIGURED] = TR("Not configured");
-	map[CONFIG_STATUS_VALID] = TR("Valid");
-	map[CONFIG_STATUS_ERR_CORRUPT] = TR("Failed - Bad configuration");
-	map[CONFIG_STATUS_ERR_BROKEN_INTERLEAVE] = TR("Failed - Broken interleave");
-	map[CONFIG_STATUS_ERR_REVERTED] = TR("Failed - Reverted");
-	map[CONFIG_STATUS_ERR_NOT_SUPPORTED] = TR("Failed - Unsupported");
-	return map[status];
+	return framework::enumToString(CONFIG_STATUS_STRINGS, status);
 }
 
 std::string ShowDeviceCommand::convertLastShutdownStatus(NVM_UINT16 status)
 {
-	std::map<NVM_UINT16, std::string> map;
-	map[DEVICE_LAST_SHUTDOWN_STATUS_UKNOWN] = TR("Unknown");
-	map[DEVICE_LAST_SHUTDOWN_STATUS_FW_FLUSH_COMPLETE] = TR("FW Flush Complete");
-	map[DEVICE_LAST_SHUTDOWN_STATUS_PM_ADR_COMMAND] = TR("PM ADR Command");
-	map[DEVICE_LAST_SHUTDOWN_STATUS_PM_S3] = TR("PM S3");
-	map[DEVICE_LAST_SHUTDOWN_STATUS_PM_S5] = TR("PM S5");
-	map[DEVICE_LAST_SHUTDOWN_STATUS_DDRT_POWER_FAIL] = TR("DDRT Power Fail Command");
-	map[DEVICE_LAST_SHUTDOWN_STATUS_PMIC_12V_POWER_FAIL] = TR("PMIC 12V Power Fail");
-	map[DEVICE_LAST_SHUTDOWN_STATUS_PM_WARM_RESET] = TR("PM Warm Reset");
-	map[DEVICE_LAST_SHUTDOWN_STATUS_THERMAL_SHUTDOWN] = TR("Thermal Shutdown");
-	return map[status];
+	return framework::enumToString(LAST_SHUTDOWN_STATUS_STRINGS, status);
 }
 
 std::string ShowDeviceCommand::convertToDate(NVM_UINT64 timeValue)
@@ -267,19 +319,12 @@ std::string ShowDeviceCommand::convertToDate(NVM_UINT64 timeValue)
 
 std::string ShowDeviceCommand::convertMemoryModes(NVM_UINT16 mode)
 {
-	std::map<NVM_UINT16, std::string> map;
-	map[MEMORY_CAPABILITY_MEMORYMODE] = TR("Memory");
-	map[MEMORYTYPE_CAPABILITY_STORAGEMODE] = TR("Storage");
-	map[MEMORYTYPE_CAPABILITY_APPDIRECTMODE] = TR("App Direct");
-	return map[mode];
+	return framework::enumToString(MEMORY_MODE_STRINGS, mode);
 }
 
 std::string ShowDeviceCommand::convertSecurityCapabilities(NVM_UINT16 capability)
 {
-	std::map<NVM_UINT32, std::string> map;
-	map[SECURITY_PASSPHRASE] = ENCRYPTION_STR;
-	map[SECURITY_ERASE] = ERASE_STR;
-	return map[capability];
+	return framework::enumToString(SECURITY_CAPABILITY_STRINGS, capability);
 }
 
 std::string ShowDeviceCommand::convertCapacity(NVM_UINT64 value)
@@ -420,6 +465,36 @@ void ShowDeviceCommand::createResults()
 		framework::ResultBase::OUTPUT_TEXTTABLE :
 		framework::ResultBase::OUTPUT_TEXT);
 }
+
+void ShowDeviceCommand::streamResults()
+{
+	framework::JsonStreamWriter writer(m_displayOptions.isNdjson());
+
+	try
+	{
+		for (size_t i = 0; i < m_devices.size(); i++)
+		{
+			writer.beginObject();
+			for (size_t j = 0; j < m_props.size(); j++)
+			{
+				framework::IPropertyDefinition<core::device::Device> &p = m_props[j];
+				if (isPropertyDisplayed(p))
+				{
+					writer.addProperty(p.getName(), p.getValue(m_devices[i]));
+				}
+			}
+			writer.endObject();
+		}
+
+		m_pResult = writer.getResult();
+	}
+	catch (core::LibraryException &e)
+	{
+		// a device property is read as it is written, earlier devices may already be out
+		m_pResult = writer.getErrorResult(libraryExceptionToResult(e));
+	}
+}
+
 bool ShowDeviceCommand::displayOptionsAreValid()
 {
 	std::string invalidDisplay;
@@ -437,6 +512,11 @@ bool ShowDeviceCommand::displayOptionsAreValid()
 		m_pResult = new framework::SyntaxErrorBadValueResult(framework::TOKENTYPE_OPTION,
 			framework::OPTION_DISPLAY.name, invalidDisplay);
 	}
+	else if (!m_displayOptions.isFormatValid())
+	{
+		m_pResult = new framework::SyntaxErrorBadValueResult(framework::TOKENTYPE_OPTION,
+			framework::FORMAT_OPTION_NAME, m_displayOptions.getFormat());
+	}
 	return m_pResult == NULL;
 }
 
@@ -36,6 +36,7 @@
 #include <lib/nvm_types.h>
 #include <core/device/DeviceService.h>
 #include <core/StringList.h>
+#include <core/exceptions/LibraryException.h>
 #include <cli/features/core/framework/CommandBase.h>
 
 namespace cli
@@ -106,6 +107,18 @@ public:
 
 	framework::ResultBase *execute(const framework::ParsedCommand &parsedCommand);
 
+	static std::string convertLockState(lock_state lockState);
+	static std::string convertHealthState(NVM_UINT16 healthState);
+	static std::string convertManageabilityState(manageability_state state);
+	static std::string convertMemoryType(memory_type type);
+	static std::string convertFormFactor(device_form_factor formFactor);
+	static std::string convertFwLogLevel(fw_log_level logLevel);
+	static std::string convertConfigStatus(config_status status);
+	static std::string convertLastShutdownStatus(NVM_UINT16 status);
+	static std::string convertToDate(NVM_UINT64 timeValue);
+	static std::string convertMemoryModes(NVM_UINT16 mode);
+	static std::string convertSecurityCapabilities(NVM_UINT16 capability);
+
 private:
 	core::device::DeviceService &m_service;
 
@@ -116,23 +129,14 @@ private:
 	bool socketIdsAreValid();
 	void filterDevicesOnSocketIds();
 	void createResults();
+	void streamResults();
 	bool displayOptionsAreValid();
 
+	static framework::ErrorResult *libraryExceptionToResult(core::LibraryException &e);
 	std::string getFirstBadDimmId(core::device::DeviceCollection &devices) const;
 	std::string getFirstBadSocketId(core::device::DeviceCollection &devices) const;
 
 	static std::string getDimmId(core::device::Device &);
-	static std::string convertLockState(lock_state lockState);
-	static std::string convertHealthState(NVM_UINT16 healthState);
-	static std::string convertManageabilityState(manageability_state state);
-	static std::string convertMemoryType(memory_type type);
-	static std::string convertFormFactor(device_form_factor formFactor);
-	static std::string convertFwLogLevel(fw_log_level logLevel);
-	static std::string convertConfigStatus(config_status status);
-	static std::string convertLastShutdownStatus(NVM_UINT16 status);
-	static std::string convertToDate(NVM_UINT64 timeValue);
-	static std::string convertMemoryModes(NVM_UINT16 mode);
-	static std::string convertSecurityCapabilities(NVM_UINT16 capability);
 	static std::string convertCapacity(NVM_UINT64 capacity);
 	static std::string toHex(NVM_UINT16 value);
 
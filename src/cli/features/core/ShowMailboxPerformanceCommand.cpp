@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LogEnterExit.h>
+#include <libintelnvm-cli/CliFrameworkTypes.h>
+#include <cli/features/core/WbemToCli_utilities.h>
+#include <cli/features/core/CommandParts.h>
+#include <cli/features/core/framework/CliHelper.h>
+#include <cli/features/core/framework/JsonStreamWriter.h>
+#include <cli/features/core/framework/EnumStringTable.h>
+#include <persistence/config_settings.h>
+#include <persistence/lib_persistence.h>
+#include <iomanip>
+#include <sstream>
+
+#include "ShowMailboxPerformanceCommand.h"
+
+namespace cli
+{
+namespace nvmcli
+{
+
+static const std::string MAILBOX_ROOT = "MailboxCommand";
+
+ShowMailboxPerformanceCommand::ShowMailboxPerformanceCommand(core::device::DeviceService &service)
+	: m_service(service)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	m_props.addCustom("DimmID", getDimmId).setIsRequired();
+	m_props.addCustom("Command", getCommand).setIsRequired();
+	m_props.addOther("Type", &core::device::MailboxStats::getType, &convertType).setIsDefault();
+	m_props.addUint64("Count", &core::device::MailboxStats::getCount).setIsDefault();
+	m_props.addUint64("Errors", &core::device::MailboxStats::getErrors).setIsDefault();
+	m_props.addUint64("Busy", &core::device::MailboxStats::getBusy);
+	m_props.addUint64("Bytes", &core::device::MailboxStats::getBytes);
+	m_props.addUint64("AvgLatencyUs", &core::device::MailboxStats::getAverageLatency).setIsDefault();
+	m_props.addUint64("P50LatencyUs", &core::device::MailboxStats::getMedianLatency);
+	m_props.addUint64("P99LatencyUs", &core::device::MailboxStats::getP99Latency).setIsDefault();
+	m_props.addUint64("MaxLatencyUs", &core::device::MailboxStats::getMaxLatency).setIsDefault();
+}
+
+framework::ResultBase *ShowMailboxPerformanceCommand::execute(
+		const framework::ParsedCommand &parsedCommand)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	m_parsedCommand = parsedCommand;
+	m_dimmIds = framework::CliHelper::splitCommaSeperatedString(
+			m_parsedCommand.targets[TARGET_DIMM.name]);
+	m_displayOptions = framework::DisplayOptions(m_parsedCommand.options);
+
+	if (displayOptionsAreValid())
+	{
+		try
+		{
+			m_devices = m_service.getAllDevices();
+
+			if (dimmIdsAreValid())
+			{
+				filterDevicesOnDimmIds();
+
+				// the monitor service sends most of the firmware commands, the stats of
+				// this process only cover what it sends while running the command
+				if (m_parsedCommand.options.find(OPTION_PROBE.name) !=
+						m_parsedCommand.options.end())
+				{
+					probeDevices();
+					m_stats = m_service.getMailboxStats();
+				}
+				else
+				{
+					m_stats = m_service.getPublishedMailboxStats();
+				}
+				filterStatsOnDevices();
+
+				if (m_displayOptions.isStreamed())
+				{
+					streamResults();
+				}
+				else
+				{
+					createResults();
+				}
+			}
+		}
+		catch (core::LibraryException &e)
+		{
+			int libRc = e.getErrorCode();
+			if (libRc == NVM_ERR_NOMEMORY)
+			{
+				m_pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_OUTOFMEMORY, NOMEMORY_ERROR_STR);
+			}
+			else if (libRc == NVM_ERR_NOTSUPPORTED)
+			{
+				m_pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_NOTSUPPORTED, NOTSUPPORTED_ERROR_STR);
+			}
+			else
+			{
+				// return the library message
+				m_pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_UNKNOWN, e.what());
+			}
+		}
+	}
+
+	return m_pResult;
+}
+
+bool ShowMailboxPerformanceCommand::dimmIdsAreValid()
+{
+	std::string badDimmId = "";
+	for (size_t i = 0; i < m_dimmIds.size() && badDimmId.empty(); i++)
+	{
+		bool dimmIdFound = false;
+		for (size_t j = 0; j < m_devices.size() && !dimmIdFound; j++)
+		{
+			if (framework::stringsIEqual(m_dimmIds[i], m_devices[j].getGuid()) ||
+				m_dimmIds[i] == uint64ToString(m_devices[j].getDeviceHandle()))
+			{
+				dimmIdFound = true;
+			}
+		}
+		if (!dimmIdFound)
+		{
+			badDimmId = m_dimmIds[i];
+		}
+	}
+
+	if (!badDimmId.empty())
+	{
+		m_pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_UNKNOWN,
+			getInvalidDimmIdErrorString(badDimmId));
+	}
+	return m_pResult == NULL;
+}
+
+void ShowMailboxPerformanceCommand::filterDevicesOnDimmIds()
+{
+	for (size_t i = m_devices.size(); i > 0; i--)
+	{
+		core::device::Device &device = m_devices[i - 1];
+		if (!device.isManageable() ||
+			(m_dimmIds.size() > 0 && !m_dimmIds.contains(device.getGuid()) &&
+			!m_dimmIds.contains(uint64ToString(device.getDeviceHandle()))))
+		{
+			m_devices.removeAt(i - 1);
+		}
+	}
+}
+
+/*
+ * Exercise the mailbox of each device the way show -dimm does
+ */
+void ShowMailboxPerformanceCommand::probeDevices()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	for (size_t i = 0; i < m_devices.size(); i++)
+	{
+		m_devices[i].getHealthState();
+	}
+}
+
+void ShowMailboxPerformanceCommand::filterStatsOnDevices()
+{
+	for (size_t i = m_stats.size(); i > 0; i--)
+	{
+		bool deviceFound = false;
+		for (size_t j = 0; j < m_devices.size() && !deviceFound; j++)
+		{
+			deviceFound = m_stats[i - 1].getDeviceHandle() == m_devices[j].getDeviceHandle();
+		}
+		if (!deviceFound)
+		{
+			m_stats.removeAt(i - 1);
+		}
+	}
+}
+
+void ShowMailboxPerformanceCommand::createResults()
+{
+	framework::ObjectListResult *pList = new framework::ObjectListResult();
+	pList->setRoot(MAILBOX_ROOT);
+	m_pResult = pList;
+
+	for (size_t i = 0; i < m_stats.size(); i++)
+	{
+		framework::PropertyListResult value;
+		for (size_t j = 0; j < m_props.size(); j++)
+		{
+			framework::IPropertyDefinition<core::device::MailboxStats> &p = m_props[j];
+			if (isPropertyDisplayed(p))
+			{
+				value.insert(p.getName(), p.getValue(m_stats[i]));
+			}
+		}
+
+		pList->insert(MAILBOX_ROOT, value);
+	}
+
+	m_pResult->setOutputType(
+		m_displayOptions.isDefault() ?
+		framework::ResultBase::OUTPUT_TEXTTABLE :
+		framework::ResultBase::OUTPUT_TEXT);
+}
+
+void ShowMailboxPerformanceCommand::streamResults()
+{
+	framework::JsonStreamWriter writer(m_displayOptions.isNdjson());
+
+	for (size_t i = 0; i < m_stats.size(); i++)
+	{
+		writer.beginObject();
+		for (size_t j = 0; j < m_props.size(); j++)
+		{
+			framework::IPropertyDefinition<core::device::MailboxStats> &p = m_props[j];
+			if (isPropertyDisplayed(p))
+			{
+				writer.addProperty(p.getName(), p.getValue(m_stats[i]));
+			}
+		}
+		writer.endObject();
+	}
+
+	m_pResult = writer.getResult();
+}
+
+bool ShowMailboxPerformanceCommand::displayOptionsAreValid()
+{
+	std::string invalidDisplay;
+	const std::vector<std::string> &display = m_displayOptions.getDisplay();
+	for (size_t i = 0; i < display.size() && invalidDisplay.empty(); i++)
+	{
+		if (!m_props.contains(display[i]))
+		{
+			invalidDisplay = display[i];
+		}
+	}
+
+	if (!invalidDisplay.empty())
+	{
+		m_pResult = new framework::SyntaxErrorBadValueResult(framework::TOKENTYPE_OPTION,
+			framework::OPTION_DISPLAY.name, invalidDisplay);
+	}
+	else if (!m_displayOptions.isFormatValid())
+	{
+		m_pResult = new framework::SyntaxErrorBadValueResult(framework::TOKENTYPE_OPTION,
+			framework::FORMAT_OPTION_NAME, m_displayOptions.getFormat());
+	}
+	return m_pResult == NULL;
+}
+
+bool ShowMailboxPerformanceCommand::isPropertyDisplayed(
+	framework::IPropertyDefinition<core::device::MailboxStats> &p)
+{
+	return p.isRequired() ||
+		   m_displayOptions.isAll() ||
+		   (p.isDefault() && m_displayOptions.isDefault()) ||
+		   m_displayOptions.contains(p.getName());
+}
+
+std::string ShowMailboxPerformanceCommand::getDimmId(core::device::MailboxStats &stats)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	std::stringstream result;
+	bool useHandle = true;
+	char value[CONFIG_VALUE_LEN];
+	if (get_config_value(SQL_KEY_CLI_DIMM_ID, value) == COMMON_SUCCESS)
+	{
+		// switch to guid
+		if (s_strncmpi("GUID", value, strlen("GUID")) == 0)
+		{
+			useHandle = false;
+		}
+	}
+
+	if (useHandle || stats.getGuid().empty())
+	{
+		result << stats.getDeviceHandle();
+	}
+	else
+	{
+		result << stats.getGuid();
+	}
+	return result.str();
+}
+
+/*
+ * The command as <opcode>.<sub-opcode> in hex, as the firmware interface spec lists them
+ */
+std::string ShowMailboxPerformanceCommand::getCommand(core::device::MailboxStats &stats)
+{
+	std::stringstream result;
+	result << "0x" << std::hex << std::setw(2) << std::setfill('0') << (int)stats.getOpcode()
+		<< ".0x" << std::setw(2) << std::setfill('0') << (int)stats.getSubOpcode();
+	return result.str();
+}
+
+static const framework::EnumString COMMAND_TYPE_STRINGS[] =
+{
+	{MAILBOX_COMMAND_PASSTHROUGH, N_TR("Passthrough")},
+	{MAILBOX_COMMAND_LARGE_WRITE, N_TR("Large Payload Write")},
+	{MAILBOX_COMMAND_LARGE_READ, N_TR("Large Payload Read")}
+};
+
+std::string ShowMailboxPerformanceCommand::convertType(enum mailbox_command_type type)
+{
+	return framework::enumToString(COMMAND_TYPE_STRINGS, type);
+}
+
+}
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef CR_MGMT_SHOWMAILBOXPERFORMANCECOMMAND_H
+#define CR_MGMT_SHOWMAILBOXPERFORMANCECOMMAND_H
+
+#include <libintelnvm-cli/CliFrameworkTypes.h>
+#include <libintelnvm-cli/ResultBase.h>
+#include "framework/PropertyDefinitionList.h"
+#include <cli/features/core/framework/CommandBase.h>
+
+#include <core/device/DeviceService.h>
+#include <core/StringList.h>
+
+namespace cli
+{
+namespace nvmcli
+{
+
+/*
+ * Show the firmware mailbox statistics of the selected DIMMs. The statistics are counted
+ * per process, so the command reports those the monitor service publishes after each pass,
+ * or with -probe those of the commands it sends itself gathering the details of each DIMM.
+ */
+class NVM_API ShowMailboxPerformanceCommand : framework::CommandBase
+{
+public:
+	ShowMailboxPerformanceCommand(
+			core::device::DeviceService &service = core::device::DeviceService::getService());
+
+	framework::ResultBase *execute(const framework::ParsedCommand &parsedCommand);
+
+private:
+	core::device::DeviceService &m_service;
+
+	framework::PropertyDefinitionList<core::device::MailboxStats> m_props;
+	core::StringList m_dimmIds;
+	core::device::DeviceCollection m_devices;
+	core::device::MailboxStatsCollection m_stats;
+
+	bool dimmIdsAreValid();
+	void filterDevicesOnDimmIds();
+	void probeDevices();
+	void filterStatsOnDevices();
+	void createResults();
+	void streamResults();
+	bool displayOptionsAreValid();
+	bool isPropertyDisplayed(framework::IPropertyDefinition<core::device::MailboxStats> &p);
+
+	static std::string getDimmId(core::device::MailboxStats &stats);
+	static std::string getCommand(core::device::MailboxStats &stats);
+	static std::string convertType(enum mailbox_command_type type);
+};
+
+}
+}
+
+#endif //CR_MGMT_SHOWMAILBOXPERFORMANCECOMMAND_H
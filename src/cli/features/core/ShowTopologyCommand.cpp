@@ -32,6 +32,7 @@
 #include <persistence/config_settings.h>
 #include <persistence/lib_persistence.h>
 #include <cli/features/core/framework/CliHelper.h>
+#include <cli/features/core/framework/EnumStringTable.h>
 
 #include "ShowTopologyCommand.h"
 
@@ -102,13 +103,16 @@ framework::ResultBase *ShowTopologyCommand::execute(const framework::ParsedComma
 	return m_pResult;
 }
 
+static const framework::EnumString MEMORY_TYPE_STRINGS[] =
+{
+	{MEMORY_TYPE_UNKNOWN, N_TR("Unknown")},
+	{MEMORY_TYPE_DDR4, N_TR("DDR4")},
+	{MEMORY_TYPE_NVMDIMM, N_TR("NVM-DIMM")}
+};
+
 std::string ShowTopologyCommand::convertMemoryType(memory_type type)
 {
-	std::map<NVM_UINT64, std::string> map;
-	map[MEMORY_TYPE_UNKNOWN] = TR("Unknown");
-	map[MEMORY_TYPE_DDR4] = TR("DDR4");
-	map[MEMORY_TYPE_NVMDIMM] = TR("NVM-DIMM");
-	return map[type];
+	return framework::enumToString(MEMORY_TYPE_STRINGS, type);
 }
 
 std::string ShowTopologyCommand::convertCapacity(NVM_UINT64 value)
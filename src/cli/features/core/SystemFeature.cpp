@@ -34,6 +34,7 @@
 #include <string.h>
 #include <algorithm>
 #include <fstream>
+#include <sstream>
 
 #include <LogEnterExit.h>
 
@@ -41,6 +42,7 @@
 #include <erasure/ErasureServiceFactory.h>
 #include <mem_config/MemoryResourcesFactory.h>
 #include <server/SystemCapabilitiesFactory.h>
+#include <support/SanitizeJobFactory.h>
 #include <libintelnvm-cim/Types.h>
 
 #include <libintelnvm-cli/CliFrameworkTypes.h>
@@ -58,6 +60,7 @@
 #include "SystemFeature.h"
 #include <exception/NvmExceptionBadTarget.h>
 #include <exception/NvmExceptionLibError.h>
+#include <guid/guid.h>
 
 #ifdef __WINDOWS__
 #include <windows.h>
@@ -92,6 +95,7 @@ void cli::nvmcli::SystemFeature::getPaths(cli::framework::CommandSpecList &list)
 			.helpText(TR("Filter the returned attributes by explicitly specifying a comma separated "
 				"list of attributes."));
 	showDevices.addOption(framework::OPTION_ALL);
+	showDevices.addOption(OPTION_FORMAT);
 	showDevices.addTarget(TARGET_DIMM_R)
 			.helpText(TR("Restrict output to specific " NVM_DIMM_NAME "s by supplying the dimm target and one "
 				"or more comma-separated " NVM_DIMM_NAME " identifiers. The default is to display "
@@ -226,6 +230,15 @@ void cli::nvmcli::SystemFeature::getPaths(cli::framework::CommandSpecList &list)
 				"socket target and one or more comma-separated socket identifiers. The default is "
 				"to display all sockets."));
 
+	cli::framework::CommandSpec showJobs(SHOW_JOBS, TR("Show Jobs"), framework::VERB_SHOW,
+			TR("Show the long running jobs, such as erasing the data on an " NVM_DIMM_NAME ", "
+				"with their progress and timing."));
+	showJobs.addOption(framework::OPTION_DISPLAY);
+	showJobs.addOption(framework::OPTION_ALL);
+	showJobs.addTarget(TARGET_JOB.name, true, JOBIDS_STR, false,
+			TR("Restrict output to specific jobs by supplying one or more comma-separated "
+				"job identifiers. The default is to display all jobs."));
+
 	list.push_back(showSystem);
 	list.push_back(showDevices);
 	list.push_back(modifyDevice);
@@ -237,6 +250,7 @@ void cli::nvmcli::SystemFeature::getPaths(cli::framework::CommandSpecList &list)
 	list.push_back(showMemoryResources);
 	list.push_back(showSystemCap);
 	list.push_back(showTopology);
+	list.push_back(showJobs);
 }
 
 // Constructor, just calls super class
@@ -304,6 +318,9 @@ cli::framework::ResultBase *cli::nvmcli::SystemFeature::run(
 	case SHOW_TOPOLOGY:
 		pResult = showTopology(parsedCommand);
 		break;
+	case SHOW_JOBS:
+		pResult = showJobs(parsedCommand);
+		break;
 	case MODIFY_DEVICE:
 		pResult = modifyDevice(parsedCommand);
 		break;
@@ -932,6 +949,29 @@ cli::framework::ResultBase *cli::nvmcli::SystemFeature::changeDeviceSecurity(
 	return pResults;
 }
 
+std::string cli::nvmcli::SystemFeature::getEraseDeviceDataPrefix(const std::string &basePrefix,
+		const std::string &dimmGuid)
+{
+	std::string dimmStr = wbem::physical_asset::NVDIMMFactory::guidToDimmIdStr(dimmGuid);
+	std::string prefix = cli::framework::ResultBase::stringFromArgList((basePrefix + " %s").c_str(),
+			dimmStr.c_str());
+	prefix += ": ";
+	return prefix;
+}
+
+void cli::nvmcli::SystemFeature::insertEraseDeviceDataError(
+		framework::SimpleListResult *pListResults, const std::string &prefix,
+		wbem::framework::Exception &e)
+{
+	cli::framework::ErrorResult *eResult = NvmExceptionToResult(e);
+	if (eResult)
+	{
+		pListResults->insert(prefix + eResult->outputText());
+		pListResults->setErrorCode(eResult->getErrorCode());
+		delete eResult;
+	}
+}
+
 /*
  * erase all devices in list
  */
@@ -1002,43 +1042,75 @@ cli::framework::ResultBase *cli::nvmcli::SystemFeature::eraseDeviceData(
 				framework::SimpleListResult *pListResults = new framework::SimpleListResult();
 				pResults = pListResults;
 
+				bool forceOption = parsedCommand.options.find(framework::OPTION_FORCE.name)
+									!= parsedCommand.options.end();
+
+				// if user didn't specify the force option, prompt them to continue
+				std::vector<std::string> confirmedDimms;
 				for (std::vector<std::string>::const_iterator dimmIter = dimms.begin();
 						dimmIter != dimms.end(); dimmIter++)
 				{
 					std::string dimmStr = wbem::physical_asset::NVDIMMFactory::guidToDimmIdStr((*dimmIter));
-					std::string prefix = cli::framework::ResultBase::stringFromArgList((basePrefix + " %s").c_str(),
-							dimmStr.c_str());
-					prefix += ": ";
-					try
+					std::string prompt = framework::ResultBase::stringFromArgList(
+							ERASE_DEV_PROMPT.c_str(), dimmStr.c_str());
+					if (!forceOption && !promptUserYesOrNo(prompt))
+					{
+						pListResults->insert(getEraseDeviceDataPrefix(basePrefix, *dimmIter) +
+								cli::framework::UNCHANGED_MSG);
+					}
+					else
 					{
-						bool forceOption = parsedCommand.options.find(framework::OPTION_FORCE.name)
-											!= parsedCommand.options.end();
+						confirmedDimms.push_back(*dimmIter);
+					}
+				}
 
-						// if user didn't specify the force option, prompt them to continue
-						std::string prompt = framework::ResultBase::stringFromArgList(
-								ERASE_DEV_PROMPT.c_str(), dimmStr.c_str());
-						if (!forceOption && !promptUserYesOrNo(prompt))
+				// every manageable dimm is erased at once, a failure doesn't stop the others
+				bool allDimms = framework::Parser::getTargetValues(parsedCommand, TARGET_DIMM.name).empty();
+				if (allDimms && !confirmedDimms.empty() && confirmedDimms.size() == dimms.size())
+				{
+					try
+					{
+						std::vector<struct device_erase_result> results =
+								erasureProvider.eraseAllDevices(passphrase, eraseType);
+						for (size_t i = 0; i < results.size(); i++)
 						{
-							pListResults->insert(prefix + cli::framework::UNCHANGED_MSG);
+							NVM_GUID_STR guidStr;
+							guid_to_str(results[i].device_guid, guidStr);
+							std::string prefix = getEraseDeviceDataPrefix(basePrefix, guidStr);
+							if (results[i].rc == NVM_SUCCESS)
+							{
+								pListResults->insert(prefix + TRS(cli::framework::SUCCESS_MSG));
+							}
+							else
+							{
+								wbem::exception::NvmExceptionLibError e(results[i].rc);
+								insertEraseDeviceDataError(pListResults, prefix, e);
+							}
 						}
-						else
+					}
+					catch (wbem::framework::Exception &e)
+					{
+						insertEraseDeviceDataError(pListResults, basePrefix + ": ", e);
+					}
+				}
+				else
+				{
+					for (std::vector<std::string>::const_iterator dimmIter = confirmedDimms.begin();
+							dimmIter != confirmedDimms.end(); dimmIter++)
+					{
+						std::string prefix = getEraseDeviceDataPrefix(basePrefix, *dimmIter);
+						try
 						{
 							erasureProvider.eraseDevice((*dimmIter), passphrase,
 									eraseType);
 
 							pListResults->insert(prefix + TRS(cli::framework::SUCCESS_MSG));
 						}
-					}
-					catch (wbem::framework::Exception &e)
-					{
-						cli::framework::ErrorResult *eResult = NvmExceptionToResult(e);
-						if (eResult)
+						catch (wbem::framework::Exception &e)
 						{
-							pListResults->insert(prefix + eResult->outputText());
-							pListResults->setErrorCode(eResult->getErrorCode());
-							delete eResult;
+							insertEraseDeviceDataError(pListResults, prefix, e);
+							break; // don't continue on failure
 						}
-						break; // don't continue on failure
 					}
 				}
 			}
@@ -1264,6 +1336,125 @@ cli::framework::ResultBase *cli::nvmcli::SystemFeature::showTopology(
 	return pResult;
 }
 
+cli::framework::ResultBase *cli::nvmcli::SystemFeature::showJobs(
+		const framework::ParsedCommand &parsedCommand)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	framework::ResultBase *pResult = NULL;
+	wbem::framework::instances_t *pInstances = NULL;
+	try
+	{
+		// define default display attributes
+		wbem::framework::attribute_names_t defaultAttributes;
+		defaultAttributes.push_back(wbem::INSTANCEID_KEY);
+		defaultAttributes.push_back(wbem::JOBSTATE_KEY);
+		defaultAttributes.push_back(wbem::PERCENTCOMPLETE_KEY);
+		defaultAttributes.push_back(wbem::ELAPSEDTIME_KEY);
+		defaultAttributes.push_back(wbem::ESTIMATEDCOMPLETIONTIME_KEY);
+
+		wbem::framework::attribute_names_t allAttributes = defaultAttributes;
+		allAttributes.push_back(wbem::NAME_KEY);
+		allAttributes.push_back(wbem::OPERATIONALSTATUS_KEY);
+		allAttributes.push_back(wbem::OWNER_KEY);
+		allAttributes.push_back(wbem::STARTTIME_KEY);
+		allAttributes.push_back(wbem::TIMEOFLASTSTATECHANGE_KEY);
+
+		// update the display attributes based on what the user passed in
+		wbem::framework::attribute_names_t displayAttributes =
+				GetAttributeNames(parsedCommand.options, defaultAttributes, allAttributes);
+
+		cli::nvmcli::filters_t filters;
+		generateJobFilter(parsedCommand, displayAttributes, filters);
+
+		// get all instances
+		wbem::support::SanitizeJobFactory provider;
+		pInstances = provider.getInstances(displayAttributes);
+		if (pInstances)
+		{
+			for (size_t i = 0; i < pInstances->size(); i++)
+			{
+				convertJobTimes((*pInstances)[i]);
+			}
+
+			// format the return data
+			pResult = NvmInstanceToObjectListResult(*pInstances, wbem::JOBTABLENAME,
+					wbem::INSTANCEID_KEY, displayAttributes, filters);
+			delete pInstances;
+
+			// Set layout to table unless the -all or -display option is present
+			if (!framework::parsedCommandContains(parsedCommand, framework::OPTION_DISPLAY) &&
+			    !framework::parsedCommandContains(parsedCommand, framework::OPTION_ALL))
+			{
+				pResult->setOutputType(framework::ResultBase::OUTPUT_TEXTTABLE);
+			}
+		}
+		// failures will throw an exception, this would prevent a crash due to an unexpected error
+		else
+		{
+			pResult = new framework::ErrorResult(framework::ErrorResult::ERRORCODE_UNKNOWN,
+				TRS(nvmcli::UNKNOWN_ERROR_STR));
+		}
+	}
+	catch (wbem::framework::Exception &e)
+	{
+		if (pInstances)
+		{
+			delete pInstances;
+		}
+
+		if (pResult)
+		{
+			delete pResult;
+		}
+		pResult = NvmExceptionToResult(e);
+	}
+
+	return pResult;
+}
+
+/*
+ * Display job times as dates and the elapsed time in seconds.
+ * A time of 0 means the job did not report it.
+ */
+void cli::nvmcli::SystemFeature::convertJobTimes(wbem::framework::Instance &instance)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	wbem::framework::attribute_names_t timeKeys;
+	timeKeys.push_back(wbem::STARTTIME_KEY);
+	timeKeys.push_back(wbem::TIMEOFLASTSTATECHANGE_KEY);
+	timeKeys.push_back(wbem::ESTIMATEDCOMPLETIONTIME_KEY);
+	for (size_t i = 0; i < timeKeys.size(); i++)
+	{
+		wbem::framework::Attribute a;
+		if (wbem::framework::SUCCESS == instance.getAttribute(timeKeys[i], a))
+		{
+			std::string timeStr = wbem::NA;
+			time_t time = (time_t) (a.uint64Value());
+			if (time != 0)
+			{
+				timeStr = ctime(&time);
+				std::size_t nullpos = timeStr.find("\n");
+				if (nullpos != std::string::npos)
+				{
+					timeStr.erase(nullpos, 1);
+				}
+			}
+			wbem::framework::Attribute timeAttr(timeStr, false);
+			instance.setAttribute(timeKeys[i], timeAttr);
+		}
+	}
+
+	wbem::framework::Attribute elapsed;
+	if (wbem::framework::SUCCESS == instance.getAttribute(wbem::ELAPSEDTIME_KEY, elapsed))
+	{
+		std::stringstream elapsedStr;
+		elapsedStr << elapsed.uint64Value() << " s";
+		wbem::framework::Attribute elapsedAttr(elapsedStr.str(), false);
+		instance.setAttribute(wbem::ELAPSEDTIME_KEY, elapsedAttr);
+	}
+}
+
 void cli::nvmcli::SystemFeature::updateLastShutDownStatus(
 		wbem::framework::Instance& instance)
 {
@@ -37,6 +37,7 @@
 
 #include <libintelnvm-cli/FeatureBase.h>
 #include <libintelnvm-cli/ObjectListResult.h>
+#include <libintelnvm-cli/SimpleListResult.h>
 #include <libintelnvm-cli/SyntaxErrorBadValueResult.h>
 #include <libintelnvm-cim/Instance.h>
 #include <physical_asset/MemoryTopologyViewFactory.h>
@@ -135,7 +136,8 @@ class NVM_API SystemFeature : public cli::framework::FeatureBase
 			ERASE_DEVICE_DATA,
 			SHOW_MEMORYRESOURCES,
 			SHOW_SYSTEM_CAPABILITIES,
-			SHOW_TOPOLOGY
+			SHOW_TOPOLOGY,
+			SHOW_JOBS
 		};
 
 
@@ -160,6 +162,7 @@ private:
 		framework::ResultBase *showMemoryResources(const framework::ParsedCommand &parsedCommand);
 		framework::ResultBase *showSystemCapabilities(const framework::ParsedCommand &parsedCommand);
 		framework::ResultBase *showTopology(const framework::ParsedCommand &parsedCommand);
+		framework::ResultBase *showJobs(const framework::ParsedCommand &parsedCommand);
 		void convertCapabilitiesInstance(const wbem::framework::Instance &wbemInstance,
 					wbem::framework::Instance &displayInstance,
 					const wbem::framework::attribute_names_t &displayAttributes);
@@ -168,8 +171,13 @@ private:
 		void updateLastShutDownStatus(wbem::framework::Instance &instance);
 		void convertSecurityCapabilities(wbem::framework::Instance &wbemInstance);
 		void updateLastShutDownTime(wbem::framework::Instance &instance);
+		void convertJobTimes(wbem::framework::Instance &instance);
 		void convertSystemOpStatusToSku(wbem::framework::Instance& instance);
 		void displayUnknownIfDriverReportsNoBlockSizes(wbem::framework::Instance &wbemInstance);
+		std::string getEraseDeviceDataPrefix(const std::string &basePrefix,
+				const std::string &dimmGuid);
+		void insertEraseDeviceDataError(framework::SimpleListResult *pListResults,
+				const std::string &prefix, wbem::framework::Exception &e);
 
 		/*
 		 * Helper routine to convert a logLevel string to fw_log_level enum
@@ -62,6 +62,7 @@
 #include <framework_interface/NvmInstanceFactory.h>
 #include <core/StringList.h>
 #include <cli/features/core/framework/CliHelper.h>
+#include <cli/features/core/framework/JsonStreamWriter.h>
 
 cli::framework::PropertyListResult* cli::nvmcli::NvmInstanceToPropertyListResult(
 		const wbem::framework::Instance& instance,
@@ -281,6 +282,32 @@ cli::framework::ObjectListResult * cli::nvmcli::NvmInstanceToObjectListResult(
 	return pResult;
 }
 
+cli::framework::ResultBase *cli::nvmcli::NvmInstancesToJsonStream(
+		const wbem::framework::instances_t &instances,
+		const wbem::framework::attribute_names_t &attributes,
+		bool ndjson)
+{
+	framework::JsonStreamWriter writer(ndjson);
+
+	for (wbem::framework::instances_t::const_iterator instanceIter = instances.begin();
+			instanceIter != instances.end(); instanceIter++)
+	{
+		writer.beginObject();
+		for (wbem::framework::attribute_names_t::const_iterator iter = attributes.begin();
+				iter != attributes.end(); iter++)
+		{
+			wbem::framework::Attribute attr;
+			if (instanceIter->getAttributeI(*iter, attr) == wbem::framework::SUCCESS)
+			{
+				writer.addProperty(*iter, AttributeToString(attr));
+			}
+		}
+		writer.endObject();
+	}
+
+	return writer.getResult();
+}
+
 wbem::framework::attribute_names_t cli::nvmcli::GetAttributeNames(
 		const cli::framework::StringMap& options)
 {
@@ -100,6 +100,23 @@ cli::framework::ObjectListResult *NvmInstanceToObjectListResult(
 		const wbem::framework::attribute_names_t &attributes = wbem::framework::attribute_names_t(),
 		const filters_t &filters = filters_t());
 
+/*!
+ * Write a list of NvmInstances as JSON objects while they are converted instead of
+ * building an ObjectListResult
+ * @param instances
+ * 		instances to write
+ * @param attributes
+ * 		the attributes to write for each instance, in order
+ * @param ndjson
+ * 		write one object per line instead of a JSON array
+ * @return
+ * 		pointer to a new result holding the end of the output.  It's up to the caller to free this.
+ */
+cli::framework::ResultBase *NvmInstancesToJsonStream(
+		const wbem::framework::instances_t &instances,
+		const wbem::framework::attribute_names_t &attributes,
+		bool ndjson);
+
 /*!
  * Get display appropriate options and convert the list of attribute names that should be displayed
  * @param options
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Renders synthetic DIMM rows through the show -dimm enum converters, once with
+ * the constant string tables the CLI uses and once with a map built on every call
+ * the way the converters used to work.
+ *
+ * Usage: converter_benchmark [rows]
+ */
+
+#include <cli/features/core/ShowDeviceCommand.h>
+#include <nvm_management.h>
+#include <cr_i18n.h>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include <time.h>
+
+#define	DEFAULT_ROWS	10000
+
+// results are accumulated here so the calls can't be optimized away
+static volatile size_t g_sink = 0;
+
+struct dimm_row
+{
+	lock_state lockState;
+	NVM_UINT16 healthState;
+	manageability_state manageability;
+	memory_type memoryType;
+	device_form_factor formFactor;
+};
+
+static unsigned long long getTimeNsec()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static std::string mapLockState(lock_state lockState)
+{
+	std::map<NVM_UINT64, std::string> map;
+	map[LOCK_STATE_UNKNOWN] = TR("Unknown");
+	map[LOCK_STATE_DISABLED] = TR("Disabled");
+	map[LOCK_STATE_UNLOCKED] = TR("Unlocked");
+	map[LOCK_STATE_LOCKED] = TR("Locked");
+	map[LOCK_STATE_FROZEN] = TR("Frozen");
+	map[LOCK_STATE_PASSPHRASE_LIMIT] = TR("Exceeded");
+	map[LOCK_STATE_NOT_SUPPORTED] = TR("Not Supported");
+	return map[lockState];
+}
+
+static std::string mapHealthState(NVM_UINT16 healthState)
+{
+	std::map<NVM_UINT64, std::string> map;
+	map[DEVICE_HEALTH_UNKNOWN] = TR("Unknown");
+	map[DEVICE_HEALTH_NORMAL] = TR("Healthy");
+	map[DEVICE_HEALTH_NONCRITICAL] = TR("Minor Failure");
+	map[DEVICE_HEALTH_CRITICAL] = TR("Critical Failure");
+	map[DEVICE_HEALTH_FATAL] = TR("Non-recoverable error");
+	map[DEVICE_HEALTH_UNMANAGEABLE] = TR("Unmanageable");
+	return map[healthState];
+}
+
+static std::string mapManageabilityState(manageability_state state)
+{
+	std::map<NVM_UINT64, std::string> map;
+	map[MANAGEMENT_VALIDCONFIG] = TR("Manageable");
+	map[MANAGEMENT_INVALIDCONFIG] = TR("Unmanageable");
+	map[MANAGEMENT_UNKNOWN] = TR("Unknown");
+	return map[state];
+}
+
+static std::string mapMemoryType(memory_type type)
+{
+	std::map<NVM_UINT64, std::string> map;
+	map[MEMORY_TYPE_UNKNOWN] = TR("Unknown");
+	map[MEMORY_TYPE_DDR4] = TR("DDR4");
+	map[MEMORY_TYPE_NVMDIMM] = TR("NVM-DIMM");
+	return map[type];
+}
+
+static std::string mapFormFactor(device_form_factor formFactor)
+{
+	std::map<NVM_UINT64, std::string> map;
+	map[DEVICE_FORM_FACTOR_DIMM] = TR("DIMM");
+	map[DEVICE_FORM_FACTOR_SODIMM] = TR("SODIMM");
+	map[DEVICE_FORM_FACTOR_UNKNOWN] = TR("Unknown");
+	return map[formFactor];
+}
+
+static double runMaps(const std::vector<struct dimm_row> &rows)
+{
+	unsigned long long start = getTimeNsec();
+	for (size_t i = 0; i < rows.size(); i++)
+	{
+		g_sink += mapLockState(rows[i].lockState).size();
+		g_sink += mapHealthState(rows[i].healthState).size();
+		g_sink += mapManageabilityState(rows[i].manageability).size();
+		g_sink += mapMemoryType(rows[i].memoryType).size();
+		g_sink += mapFormFactor(rows[i].formFactor).size();
+	}
+	return (double)(getTimeNsec() - start) / rows.size();
+}
+
+static double runTables(const std::vector<struct dimm_row> &rows)
+{
+	using cli::nvmcli::ShowDeviceCommand;
+	unsigned long long start = getTimeNsec();
+	for (size_t i = 0; i < rows.size(); i++)
+	{
+		g_sink += ShowDeviceCommand::convertLockState(rows[i].lockState).size();
+		g_sink += ShowDeviceCommand::convertHealthState(rows[i].healthState).size();
+		g_sink += ShowDeviceCommand::convertManageabilityState(rows[i].manageability).size();
+		g_sink += ShowDeviceCommand::convertMemoryType(rows[i].memoryType).size();
+		g_sink += ShowDeviceCommand::convertFormFactor(rows[i].formFactor).size();
+	}
+	return (double)(getTimeNsec() - start) / rows.size();
+}
+
+int main(int argc, char *argv[])
+{
+	int rowCount = DEFAULT_ROWS;
+	if (argc > 1)
+	{
+		rowCount = atoi(argv[1]);
+	}
+	if (rowCount <= 0)
+	{
+		fprintf(stderr, "Usage: %s [rows]\n", argv[0]);
+		return 1;
+	}
+
+	static const NVM_UINT16 HEALTH_STATES[] =
+	{
+		DEVICE_HEALTH_NORMAL, DEVICE_HEALTH_NONCRITICAL, DEVICE_HEALTH_CRITICAL,
+		DEVICE_HEALTH_FATAL, DEVICE_HEALTH_UNMANAGEABLE
+	};
+	std::vector<struct dimm_row> rows(rowCount);
+	for (int i = 0; i < rowCount; i++)
+	{
+		rows[i].lockState = (lock_state)(i % (LOCK_STATE_NOT_SUPPORTED + 1));
+		rows[i].healthState = HEALTH_STATES[i % (sizeof (HEALTH_STATES) / sizeof (HEALTH_STATES[0]))];
+		rows[i].manageability = (manageability_state)(i % (MANAGEMENT_INVALIDCONFIG + 1));
+		rows[i].memoryType = (memory_type)(i % (MEMORY_TYPE_NVMDIMM + 1));
+		rows[i].formFactor = (i % 2) ? DEVICE_FORM_FACTOR_DIMM : DEVICE_FORM_FACTOR_SODIMM;
+	}
+
+	// warm up the translation catalog and the allocator before timing
+	runTables(rows);
+
+	double maps = runMaps(rows);
+	double tables = runTables(rows);
+	printf("%d rows, 5 enum columns per row\n", rowCount);
+	printf("%-16s %10s\n", "Converter", "ns/row");
+	printf("%-16s %10.2f\n", "map per call", maps);
+	printf("%-16s %10.2f\n", "constant table", tables);
+
+	return 0;
+}
@@ -76,6 +76,39 @@ std::vector<std::string> cli::framework::DisplayOptions::getDisplay() const
 	return result;
 }
 
+std::string cli::framework::DisplayOptions::getFormat() const
+{
+	std::string result;
+
+	StringMap::const_iterator format = m_options.find(FORMAT_OPTION_NAME);
+	if (format != m_options.end())
+	{
+		result = format->second;
+	}
+
+	return result;
+}
+
+bool cli::framework::DisplayOptions::isFormatValid() const
+{
+	return m_options.find(FORMAT_OPTION_NAME) == m_options.end() || isStreamed();
+}
+
+bool cli::framework::DisplayOptions::isJson() const
+{
+	return stringsIEqual(getFormat(), FORMAT_JSON);
+}
+
+bool cli::framework::DisplayOptions::isNdjson() const
+{
+	return stringsIEqual(getFormat(), FORMAT_NDJSON);
+}
+
+bool cli::framework::DisplayOptions::isStreamed() const
+{
+	return isJson() || isNdjson();
+}
+
 cli::framework::DisplayOptions &cli::framework::DisplayOptions::operator=(const cli::framework::DisplayOptions &other)
 {
 
@@ -34,6 +34,11 @@ namespace cli
 {
 namespace framework
 {
+// option and values requesting machine readable output that is streamed as it is produced
+const std::string FORMAT_OPTION_NAME = "-format";
+const std::string FORMAT_JSON = "json";
+const std::string FORMAT_NDJSON = "ndjson";
+
 class NVM_API DisplayOptions
 {
 public:
@@ -42,6 +47,11 @@ public:
 	bool isAll() const;
 	std::vector<std::string> getDisplay() const;
 	bool contains(const std::string &name) const;
+	std::string getFormat() const;
+	bool isFormatValid() const;
+	bool isJson() const;
+	bool isNdjson() const;
+	bool isStreamed() const;
 	DisplayOptions& operator= (const DisplayOptions &other);
 
 private:
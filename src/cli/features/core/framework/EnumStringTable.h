@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef CR_MGMT_ENUMSTRINGTABLE_H
+#define CR_MGMT_ENUMSTRINGTABLE_H
+
+#include <string>
+#include <cstddef>
+#include <nvm_types.h>
+#include <cr_i18n.h>
+
+namespace cli
+{
+namespace framework
+{
+
+/*
+ * One entry of a constant table mapping an enumeration value to its display string.
+ * The string is the untranslated text (mark it with N_TR), it is translated on lookup.
+ */
+struct EnumString
+{
+	NVM_UINT64 value;
+	const char *str;
+};
+
+/*
+ * Look up the translated display string for a value in a constant EnumString table.
+ * The table must be sorted by value, it is binary searched so no map has to be built
+ * for each conversion. Returns an empty string for values not in the table.
+ */
+template<size_t N>
+std::string enumToString(const EnumString (&table)[N], const NVM_UINT64 value)
+{
+	size_t low = 0;
+	size_t high = N;
+	while (low < high)
+	{
+		size_t mid = low + (high - low) / 2;
+		if (table[mid].value < value)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	std::string result;
+	if (low < N && table[low].value == value)
+	{
+		result = TR(table[low].str);
+	}
+	return result;
+}
+
+}
+}
+
+#endif //CR_MGMT_ENUMSTRINGTABLE_H
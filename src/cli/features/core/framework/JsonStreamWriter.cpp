@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <LogEnterExit.h>
+#include <libintelnvm-cli/CliFrameworkTypes.h>
+#include <libintelnvm-cli/SimpleResult.h>
+#include "JsonStreamWriter.h"
+
+cli::framework::JsonStreamWriter::JsonStreamWriter(bool ndjson, std::ostream &out) :
+	m_ndjson(ndjson), m_out(out), m_objectCount(0), m_firstProperty(true)
+{
+}
+
+void cli::framework::JsonStreamWriter::beginObject()
+{
+	m_current = "{";
+	m_firstProperty = true;
+}
+
+void cli::framework::JsonStreamWriter::addProperty(const std::string &name,
+	const std::string &value)
+{
+	if (!m_firstProperty)
+	{
+		m_current += ",";
+	}
+	m_current += "\"" + escape(name) + "\":\"" + escape(value) + "\"";
+	m_firstProperty = false;
+}
+
+void cli::framework::JsonStreamWriter::endObject()
+{
+	m_current += "}";
+
+	// write the previous object now that it is known not to be the last one
+	if (m_objectCount > 0)
+	{
+		if (m_ndjson)
+		{
+			m_out << m_pending << "\n";
+		}
+		else
+		{
+			if (m_objectCount == 1)
+			{
+				m_out << "[\n";
+			}
+			m_out << m_pending << ",\n";
+		}
+		m_out.flush();
+	}
+
+	m_pending.swap(m_current);
+	m_current.clear();
+	m_objectCount++;
+}
+
+cli::framework::ResultBase *cli::framework::JsonStreamWriter::getResult()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	std::string tail;
+	if (m_ndjson)
+	{
+		tail = m_pending;
+	}
+	else if (m_objectCount == 0)
+	{
+		tail = "[]";
+	}
+	else if (m_objectCount == 1)
+	{
+		tail = "[\n" + m_pending + "\n]";
+	}
+	else
+	{
+		tail = m_pending + "\n]";
+	}
+
+	m_pending.clear();
+	return new SimpleResult(tail);
+}
+
+cli::framework::ResultBase *cli::framework::JsonStreamWriter::getErrorResult(
+	ErrorResult *pError)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	ResultBase *pResult = pError;
+	// the first object is held back, so nothing has been written before the second one
+	if (m_objectCount > 1)
+	{
+		beginObject();
+		addProperty("Error", pError->output());
+		endObject();
+
+		pResult = getResult();
+		pResult->setErrorCode(pError->getErrorCode());
+		delete pError;
+	}
+	else
+	{
+		m_pending.clear();
+		m_objectCount = 0;
+	}
+
+	return pResult;
+}
+
+std::string cli::framework::JsonStreamWriter::escape(const std::string &value)
+{
+	std::string result;
+	result.reserve(value.size());
+
+	for (size_t i = 0; i < value.size(); i++)
+	{
+		unsigned char c = (unsigned char)value[i];
+		if (c == '"')
+		{
+			result += "\\\"";
+		}
+		else if (c == '\\')
+		{
+			result += "\\\\";
+		}
+		else if (c == '\n')
+		{
+			result += "\\n";
+		}
+		else if (c == '\r')
+		{
+			result += "\\r";
+		}
+		else if (c == '\t')
+		{
+			result += "\\t";
+		}
+		else if (c < 0x20)
+		{
+			char unicode[7];
+			snprintf(unicode, sizeof (unicode), "\\u%04x", c);
+			result += unicode;
+		}
+		else
+		{
+			result += value[i];
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef CR_MGMT_JSONSTREAMWRITER_H
+#define CR_MGMT_JSONSTREAMWRITER_H
+
+#include <string>
+#include <ostream>
+#include <iostream>
+#include <libintelnvm-cli/ResultBase.h>
+#include <lib/nvm_types.h>
+
+namespace cli
+{
+namespace framework
+{
+class ErrorResult;
+
+/*
+ * JsonStreamWriter writes the objects of a show command as they are produced instead of
+ * collecting them in an ObjectListResult first. With -format json the objects form a single
+ * JSON array, with -format ndjson each object is written on its own line.
+ *
+ * Each completed object is held back until the next one begins so the last object (and the
+ * closing bracket) can be returned by getResult(). The CLI prints that result followed by a
+ * newline like any other command output.
+ */
+class NVM_API JsonStreamWriter
+{
+public:
+	JsonStreamWriter(bool ndjson, std::ostream &out = std::cout);
+
+	void beginObject();
+	void addProperty(const std::string &name, const std::string &value);
+	void endObject();
+
+	/*
+	 * Finish the stream. Caller is responsible for freeing the result.
+	 */
+	ResultBase *getResult();
+
+	/*
+	 * Finish the stream after a failure. Once objects have been written the array is
+	 * closed with an object holding the error message and the result carries the error
+	 * code, otherwise the error is returned as is. Takes ownership of pError, caller is
+	 * responsible for freeing the result.
+	 */
+	ResultBase *getErrorResult(ErrorResult *pError);
+
+	static std::string escape(const std::string &value);
+
+private:
+	bool m_ndjson;
+	std::ostream &m_out;
+	size_t m_objectCount;
+	bool m_firstProperty;
+	std::string m_current;
+	std::string m_pending;
+};
+
+}
+}
+
+#endif //CR_MGMT_JSONSTREAMWRITER_H
@@ -45,6 +45,7 @@
 #include <sys/types.h>
 #include <sys/ipc.h>
 #include <string.h>
+#include <pwd.h>
 
 #include <string/s_str.h>
 #include <string/unicode_utilities.h>
@@ -156,15 +157,23 @@ int stop_process(unsigned int process_id)
 /*
  * Create a thread on the current process
  */
-void create_thread(COMMON_UINT64 *p_thread_id, void *(*callback)(void *), void *callback_arg)
+int create_thread(COMMON_UINT64 *p_thread_id, void *(*callback)(void *), void *callback_arg)
 {
-	pthread_create(
+	return pthread_create(
 			(pthread_t *)p_thread_id,
 			NULL, // default attributes
 			callback,
 			callback_arg);
 }
 
+/*
+ * Wait for a thread to finish
+ */
+void join_thread(COMMON_UINT64 thread_id)
+{
+	pthread_join((pthread_t)thread_id, NULL);
+}
+
 /*
  * Retrieve the id of the current thread
  */
@@ -345,6 +354,36 @@ int get_host_name(char *name, const COMMON_SIZE name_len)
 	return rc;
 }
 
+/*
+ * Retrieve the name of the user the calling process is running as.
+ */
+int get_user_name(char *name, const COMMON_SIZE name_len)
+{
+	int rc = COMMON_SUCCESS;
+
+	// check input parameters
+	if (name == NULL || name_len == 0)
+	{
+		rc = COMMON_ERR_INVALIDPARAMETER;
+	}
+	else
+	{
+		struct passwd pwd;
+		struct passwd *p_result = NULL;
+		char buf[1024];
+		if (getpwuid_r(geteuid(), &pwd, buf, sizeof (buf), &p_result) != 0 ||
+				p_result == NULL)
+		{
+			rc = COMMON_ERR_UNKNOWN;
+		}
+		else
+		{
+			s_strcpy(name, p_result->pw_name, name_len);
+		}
+	}
+	return rc;
+}
+
 /*
  * Retrieve the operating system name.
  */
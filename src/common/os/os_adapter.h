@@ -176,10 +176,21 @@ extern void nvm_sleep(unsigned long time);
 
 /*!
  * Create a thread on the current process
+ * @param[out] p_thread_id
+ * 		The ID of the thread, if successfully created
+ * @return
+ * 		0 if the thread was created, else the OS error code
  */
-extern void create_thread(COMMON_UINT64 *p_thread_id, void *(*callback)(void *),
+extern int create_thread(COMMON_UINT64 *p_thread_id, void *(*callback)(void *),
 	void *callback_arg);
 
+/*!
+ * Block until a thread created with create_thread has finished
+ * @param[in] thread_id
+ * 		The ID of the thread returned by create_thread
+ */
+extern void join_thread(COMMON_UINT64 thread_id);
+
 /*!
  * Gets the current threads ID.  Useful in logging.
  * @return
@@ -304,6 +315,19 @@ extern int rwlock_delete(OS_RWLOCK *p_rwlock);
  */
 extern int get_host_name(char *name, const COMMON_SIZE name_len);
 
+/*!
+ * Retrieve the name of the user the calling process is running as.
+ * @param[in,out] name
+ * 		A buffer to hold the user name.
+ * @param[in] name_len
+ * 		The length of the buffer.  Should be <= 256.
+ * @return
+ * 		COMMON_SUCCESS
+ * 		COMMON_ERR_INVALIDPARAMETER
+ * 		COMMON_ERR_UNKNOWN
+ */
+extern int get_user_name(char *name, const COMMON_SIZE name_len);
+
 /*!
  * Retrieve the operating system name.
  * @param[in,out] os_name
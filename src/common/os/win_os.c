@@ -131,15 +131,40 @@ void nvm_sleep(unsigned long time)
 /*
  * Create a thread on the current process
  */
-void create_thread(COMMON_UINT64 *p_thread_id, void *(*callback)(void *), void * callback_arg)
+int create_thread(COMMON_UINT64 *p_thread_id, void *(*callback)(void *), void * callback_arg)
 {
-	CreateThread(
+	int rc = 0;
+	HANDLE thread = CreateThread(
 			NULL, // default security
 			0,  // default stack size
 			(LPTHREAD_START_ROUTINE)callback,
 			(LPVOID)callback_arg,
 			0, // Immediately run thread
 			(LPDWORD)p_thread_id);
+	if (thread == NULL)
+	{
+		rc = (int)GetLastError();
+	}
+	else
+	{
+		// join_thread opens the thread by ID
+		CloseHandle(thread);
+	}
+	return rc;
+}
+
+/*
+ * Wait for a thread to finish
+ */
+void join_thread(COMMON_UINT64 thread_id)
+{
+	HANDLE thread = OpenThread(SYNCHRONIZE, FALSE, (DWORD)thread_id);
+	// the thread may already be gone
+	if (thread != NULL)
+	{
+		WaitForSingleObject(thread, INFINITE);
+		CloseHandle(thread);
+	}
 }
 
 /*
@@ -336,6 +361,29 @@ int get_host_name(char *name, const COMMON_SIZE name_len)
 	return rc;
 }
 
+/*
+ * Retrieve the name of the user the calling process is running as.
+ */
+int get_user_name(char *name, const COMMON_SIZE name_len)
+{
+	int rc = COMMON_SUCCESS;
+
+	// check input parameters
+	if (name == NULL || name_len == 0)
+	{
+		rc = COMMON_ERR_INVALIDPARAMETER;
+	}
+	else
+	{
+		DWORD len = (DWORD)name_len;
+		if (!GetUserNameA(name, &len))
+		{
+			rc = COMMON_ERR_UNKNOWN;
+		}
+	}
+	return rc;
+}
+
 /*
  * Retrieve the operating system name.
  */
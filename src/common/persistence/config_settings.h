@@ -113,6 +113,12 @@ extern "C"
 //! SQL Key name for the maximum number of logs to keep
 #define	SQL_KEY_LOG_MAX "LOG_MAX"
 
+//! SQL Key name for whether the config database uses write-ahead logging
+#define	SQL_KEY_DB_WAL_MODE "DB_WAL_MODE"
+
+//! SQL Key name for the number of WAL pages between automatic checkpoints
+#define	SQL_KEY_DB_WAL_CHECKPOINT_PAGES "DB_WAL_CHECKPOINT_PAGES"
+
 //! SQL Key name for the default temperature threshold in Celsius
 #define	SQL_KEY_DEFAULT_TEMPERATURE_THRESHOLD "DEFAULT_TEMPERATURE_THRESHOLD"
 
@@ -146,6 +152,12 @@ extern "C"
 //! SQL Key name for the default die sparing policy aggressiveness
 #define	SQL_KEY_DEFAULT_DIE_SPARING_AGGRESSIVENESS "FW_DIE_SPARING_AGGRESSIVENESS"
 
+//! SQL Key name for the site firmware consistency rules, a list of <scope>:<setting>
+#define	SQL_KEY_FW_CONSISTENCY_RULES "FW_CONSISTENCY_RULES"
+
+//! SQL Key name for the file firmware passthrough commands are recorded to, empty to disable
+#define	SQL_KEY_FW_TRACE_FILE "FW_TRACE_FILE"
+
 //! SQL Key name for whether the topology state has been initialized
 #define	SQL_KEY_TOPOLOGY_STATE_VALID "TOPOLOGY_STATE_VALID"
 
@@ -155,6 +167,9 @@ extern "C"
 //! SQL Key name for the event polling interval
 #define	SQL_KEY_EVENT_POLLING_INTERVAL_SECONDS "EVENT_POLLING_INTERVAL_SECONDS"
 
+//! SQL Key name for the window in which repeated sensor indications are merged, 0 to disable
+#define	SQL_KEY_INDICATION_COALESCE_SECONDS "INDICATION_COALESCE_SECONDS"
+
 //! SQL Key name for default CLI device identifier
 #define	SQL_KEY_CLI_DIMM_ID	"CLI_DEFAULT_DIMM_ID"
 
@@ -188,6 +203,26 @@ extern "C"
 //! SQL Key name for the % of performance logs to be trimmed if max number of rows is exceeded
 #define	SQL_KEY_PERFORMANCE_LOG_TRIM_PERCENT "PERFORMANCE_LOG_TRIM_PERCENT"
 
+// JOB MONITOR KEYS
+//! SQL Key name for job monitor enabled
+#define	SQL_KEY_JOB_MONITOR_ENABLED "JOB_MONITOR_ENABLED"
+
+//! SQL Key name for job monitor interval
+#define	SQL_KEY_JOB_MONITOR_INTERVAL "JOB_MONITOR_INTERVAL_SECONDS"
+
+//! SQL Key name for the time the devices were last polled for jobs
+#define	SQL_KEY_JOB_LAST_POLL_TIME "JOB_LAST_POLL_TIME"
+
+//! SQL Key name for how long a completed job is still reported
+#define	SQL_KEY_JOB_RETENTION "JOB_RETENTION_SECONDS"
+
+// METRICS EXPORT KEYS
+//! SQL Key name for the file the monitor writes Prometheus metrics to, empty to disable
+#define	SQL_KEY_METRICS_EXPORT_FILE "METRICS_EXPORT_FILE"
+
+//! SQL Key name for the local socket the monitor serves Prometheus metrics on, empty to disable
+#define	SQL_KEY_METRICS_EXPORT_SOCKET "METRICS_EXPORT_SOCKET"
+
 #ifdef __cplusplus
 }
 #endif
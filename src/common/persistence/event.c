@@ -32,6 +32,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 
 #include "event.h"
 #include "lib_persistence.h"
@@ -348,6 +349,10 @@ const char *EVENT_MESSAGES_FW_DIAG[EVENT_CODE_DIAG_FW_UNKNOWN -
 	N_TR("The firmware consistency and settings check detected that "NVM_DIMM_NAME" %s is "
 			"reporting that die sparing policy is not set in accordance with best practice, "
 			"due to field '%s'. Valid range is %s."),
+	// EVENT_CODE_DIAG_FW_SITE_RULE_MISMATCH
+	N_TR("The firmware consistency and settings check detected that "NVM_DIMM_NAME" %s is "
+			"reporting field '%s' which does not match the value %s required by a site "
+			"consistency rule."),
 	// EVENT_CODE_DIAG_FW_UNKNOWN
 	N_TR("The firmware consistency and settings check logged an unknown error code %d."),
 };
@@ -671,9 +676,9 @@ void params_to_event(const enum event_type type, const enum event_severity sever
 }
 
 /*
- * Store an event log entry in the db
+ * Write an event log entry to the db
  */
-int store_event(struct event *p_event, COMMON_BOOL syslog)
+int db_store_event(struct event *p_event, const time_t event_time, COMMON_BOOL syslog)
 {
 	COMMON_LOG_ENTRY();
 	int rc = NVM_SUCCESS;
@@ -688,10 +693,7 @@ int store_event(struct event *p_event, COMMON_BOOL syslog)
 		memset(&db_event, 0, sizeof (struct db_event));
 
 		// Note: db_event.id will be auto generated by sqlite
-		// get current time
-		time_t time_now;
-		time_now = time(NULL);
-		db_event.time = time_now;
+		db_event.time = event_time;
 
 		// translate event struct into db event struct
 		db_event.type = p_event->type;
@@ -755,6 +757,93 @@ int store_event(struct event *p_event, COMMON_BOOL syslog)
 	return rc;
 }
 
+// event batch of the current thread, NULL when its events go straight to the db
+static __thread struct event_batch *tl_p_event_batch = NULL;
+
+/*
+ * Store an event log entry in the db, or in the thread's event batch
+ */
+int store_event(struct event *p_event, COMMON_BOOL syslog)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	struct event_batch *p_batch = tl_p_event_batch;
+	if (!p_batch)
+	{
+		rc = db_store_event(p_event, time(NULL), syslog);
+	}
+	else
+	{
+		if (p_batch->count == p_batch->capacity)
+		{
+			NVM_UINT32 capacity = p_batch->capacity ? (p_batch->capacity * 2) : 16;
+			struct event *p_events = realloc(p_batch->p_events, capacity * sizeof (struct event));
+			if (!p_events)
+			{
+				COMMON_LOG_ERROR("Failed to allocate memory for the event batch");
+				rc = NVM_ERR_NOMEMORY;
+			}
+			else
+			{
+				p_batch->p_events = p_events;
+				p_batch->capacity = capacity;
+			}
+		}
+		if (rc == NVM_SUCCESS)
+		{
+			// keep the time it happened, not the time it is written
+			p_batch->p_events[p_batch->count] = *p_event;
+			p_batch->p_events[p_batch->count].time = time(NULL);
+			p_batch->count++;
+		}
+
+		if (syslog)
+		{
+			populate_event_message(p_event);
+			log_event_in_syslog(p_event, NVM_SYSLOG_SOURCE);
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+void begin_event_batch(struct event_batch *p_batch)
+{
+	COMMON_LOG_ENTRY();
+	tl_p_event_batch = p_batch;
+	COMMON_LOG_EXIT();
+}
+
+void end_event_batch()
+{
+	COMMON_LOG_ENTRY();
+	tl_p_event_batch = NULL;
+	COMMON_LOG_EXIT();
+}
+
+int store_event_batch(struct event_batch *p_batch)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	for (NVM_UINT32 i = 0; i < p_batch->count; i++)
+	{
+		// already in the syslog
+		int temprc = db_store_event(&p_batch->p_events[i], p_batch->p_events[i].time, 0);
+		if (temprc != NVM_SUCCESS)
+		{
+			rc = temprc;
+		}
+	}
+	free(p_batch->p_events);
+	memset(p_batch, 0, sizeof (*p_batch));
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
 /*
  * Store an event log entry in the db
  */
@@ -891,6 +980,92 @@ NVM_BOOL event_matches_filter(const struct event_filter *p_filter,
 	return rc;
 }
 
+/*
+ * Narrow an event filter down to the guid and time bounds that can be
+ * answered by the event table indexes.
+ * Returns 1 if the filter selects on a device, 0 otherwise.
+ */
+int get_event_index_bounds(const struct event_filter *p_filter,
+		NVM_GUID_STR guid_str, COMMON_UINT64 *p_time_min, COMMON_UINT64 *p_time_max)
+{
+	int by_guid = 0;
+	*p_time_min = 0;
+	*p_time_max = LLONG_MAX;
+	if (p_filter)
+	{
+		if (p_filter->filter_mask & NVM_FILTER_ON_GUID)
+		{
+			guid_to_str(p_filter->guid, guid_str);
+			by_guid = 1;
+		}
+		// the filter times are exclusive, the index range is inclusive
+		if ((p_filter->filter_mask & NVM_FILTER_ON_AFTER) && p_filter->after >= 0)
+		{
+			*p_time_min = (COMMON_UINT64)p_filter->after + 1;
+		}
+		if (p_filter->filter_mask & NVM_FILTER_ON_BEFORE)
+		{
+			if (p_filter->before > 0)
+			{
+				*p_time_max = (COMMON_UINT64)p_filter->before - 1;
+			}
+			else
+			{
+				// nothing is before the epoch, make the range empty
+				*p_time_min = 1;
+				*p_time_max = 0;
+			}
+		}
+	}
+	return by_guid;
+}
+
+/*
+ * Count the events that could match the filter. Uses the event indexes so
+ * only the rows for the requested device and time range are visited.
+ */
+int get_db_event_count_for_filter(PersistentStore *p_store,
+		const struct event_filter *p_filter, int *p_count)
+{
+	NVM_GUID_STR guid_str;
+	COMMON_UINT64 time_min;
+	COMMON_UINT64 time_max;
+	int rc;
+	if (get_event_index_bounds(p_filter, guid_str, &time_min, &time_max))
+	{
+		rc = db_get_event_count_by_guid_time_range(p_store, guid_str,
+				time_min, time_max, p_count);
+	}
+	else
+	{
+		rc = db_get_event_count_by_time_range(p_store, time_min, time_max, p_count);
+	}
+	return rc;
+}
+
+/*
+ * Retrieve the events that could match the filter, highest id first like db_get_events. The
+ * caller still applies event_matches_filter to the results.
+ */
+int get_db_events_for_filter(PersistentStore *p_store,
+		const struct event_filter *p_filter, struct db_event *p_events, int count)
+{
+	NVM_GUID_STR guid_str;
+	COMMON_UINT64 time_min;
+	COMMON_UINT64 time_max;
+	int rc;
+	if (get_event_index_bounds(p_filter, guid_str, &time_min, &time_max))
+	{
+		rc = db_get_events_by_guid_time_range(p_store, guid_str,
+				time_min, time_max, p_events, count);
+	}
+	else
+	{
+		rc = db_get_events_by_time_range(p_store, time_min, time_max, p_events, count);
+	}
+	return rc;
+}
+
 /*
  * Retrieve all events from the database and then filter on the specified
  * filter.
@@ -905,16 +1080,17 @@ int process_events_matching_filter(const struct event_filter *p_filter,
 	int rc = 0;
 	COMMON_LOG_ENTRY();
 
-	PersistentStore *p_store = get_lib_store();
+	// queries don't need to wait behind the writer
+	PersistentStore *p_store = purge ? get_lib_store() : get_lib_read_store();
 	if (!p_store)
 	{
 		rc = NVM_ERR_UNKNOWN;
 	}
 	else
 	{
-		// get all the events
+		// get the candidate events
 		int db_event_count = 0;
-		if (db_get_event_count(p_store, &db_event_count) != DB_SUCCESS)
+		if (get_db_event_count_for_filter(p_store, p_filter, &db_event_count) != DB_SUCCESS)
 		{
 			COMMON_LOG_ERROR("Unable to retrieve the number of events from the database");
 			rc = NVM_ERR_UNKNOWN;
@@ -925,7 +1101,8 @@ int process_events_matching_filter(const struct event_filter *p_filter,
 			struct db_event *db_events = malloc(db_event_count * sizeof (struct db_event));
 			if (db_events)
 			{
-				db_event_count = db_get_events(p_store, db_events, db_event_count);
+				db_event_count = get_db_events_for_filter(p_store, p_filter,
+						db_events, db_event_count);
 				if (db_event_count < 0)
 				{
 					COMMON_LOG_ERROR("Unable to retrieve the events from the database");
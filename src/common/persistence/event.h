@@ -155,9 +155,10 @@ enum event_code_diag_fw_consistency
 	EVENT_CODE_DIAG_FW_SYSTEM_TIME_DRIFT = EVENT_CODE_OFFSET_DIAG_FW_CONSISTENCY + 7,
 	EVENT_CODE_DIAG_FW_BAD_POWER_MGMT_POLICY = EVENT_CODE_OFFSET_DIAG_FW_CONSISTENCY + 8,
 	EVENT_CODE_DIAG_FW_BAD_DIE_SPARING_POLICY = EVENT_CODE_OFFSET_DIAG_FW_CONSISTENCY + 9,
+	EVENT_CODE_DIAG_FW_SITE_RULE_MISMATCH = EVENT_CODE_OFFSET_DIAG_FW_CONSISTENCY + 10,
 
 	// for checking validity of code
-	EVENT_CODE_DIAG_FW_UNKNOWN = EVENT_CODE_OFFSET_DIAG_FW_CONSISTENCY + 10
+	EVENT_CODE_DIAG_FW_UNKNOWN = EVENT_CODE_OFFSET_DIAG_FW_CONSISTENCY + 11
 };
 
 /*
@@ -266,11 +267,41 @@ enum event_code_config
 	EVENT_CODE_CONFIG_UNKNOWN = EVENT_CODE_OFFSET_CONFIG + 14
 };
 
+/*
+ * Events kept in memory by a thread between begin_event_batch and end_event_batch
+ */
+struct event_batch
+{
+	struct event *p_events;
+	NVM_UINT32 count;
+	NVM_UINT32 capacity;
+};
+
 /*
  * Store an event log entry in the db
+ * @remark While the calling thread has an event batch open the event is only
+ * added to the batch, see begin_event_batch.
  */
 int store_event(struct event *p_event, COMMON_BOOL syslog);
 
+/*
+ * Keep the events the calling thread stores in p_batch instead of writing them
+ * to the db, until end_event_batch is called. The events are still written to
+ * the syslog straight away.
+ */
+void begin_event_batch(struct event_batch *p_batch);
+
+/*
+ * Stop keeping the calling thread's events in its batch
+ */
+void end_event_batch();
+
+/*
+ * Write the events kept in a batch to the db and free them.
+ * The caller decides whether this happens in a transaction.
+ */
+int store_event_batch(struct event_batch *p_batch);
+
 /*
  * Helper method to convert event info into a struct to store in the db
  */
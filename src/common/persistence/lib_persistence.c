@@ -53,8 +53,13 @@ const char *max_snapshots = MAX_SUPPORT_SNAPSHOTS_DEFAULT;
 const char *log_destination = "0"; // log to DB by default
 #endif
 
+// default number of WAL pages between automatic checkpoints (~4MB with 4K pages)
+#define	DEFAULT_WAL_CHECKPOINT_PAGES	1000
+
 // GLOBAL database pointer for this process
 PersistentStore *p_store;
+// GLOBAL read-only connection used for queries when the database is in WAL mode
+PersistentStore *p_read_store;
 
 // helper function
 void add_config_value_to_pstore(const PersistentStore *p_ps, const char *key, const char *value);
@@ -147,6 +152,9 @@ int open_lib_store(const char *path)
 			}
 			else
 			{
+				// databases installed by an older version may lack newer indexes
+				db_create_indexes(p_store);
+				open_lib_read_store(path);
 				rc = log_init();
 			}
 		}
@@ -155,6 +163,24 @@ int open_lib_store(const char *path)
 }
 
 
+/*
+ * Put the database in WAL mode if configured and open a read-only
+ * connection for queries alongside the read/write one.
+ */
+void open_lib_read_store(const char *path)
+{
+	int wal_mode = 0;
+	int checkpoint_pages = DEFAULT_WAL_CHECKPOINT_PAGES;
+	get_config_value_int(SQL_KEY_DB_WAL_MODE, &wal_mode);
+	get_config_value_int(SQL_KEY_DB_WAL_CHECKPOINT_PAGES, &checkpoint_pages);
+
+	// only worth a second connection if readers won't block on the writer
+	if (wal_mode && db_set_wal_mode(p_store, checkpoint_pages) == DB_SUCCESS)
+	{
+		p_read_store = open_PersistentStore_readonly(path);
+	}
+}
+
 /*
  * Close the configuration database and flush the log to the database.
  */
@@ -162,6 +188,10 @@ int close_lib_store()
 {
 	int rc = COMMON_SUCCESS;
 	log_close();
+	if (p_read_store && free_PersistentStore(&p_read_store) != DB_SUCCESS)
+	{
+		rc = COMMON_ERR_UNKNOWN;
+	}
 	if (free_PersistentStore(&p_store) != DB_SUCCESS)
 	{
 		rc = COMMON_ERR_UNKNOWN;
@@ -178,6 +208,16 @@ PersistentStore *get_lib_store()
 	return p_store;
 }
 
+/*
+ * Return a pointer to the read-only configuration database connection.
+ * While a transaction is open on the read/write connection its uncommitted
+ * changes are only visible through that connection, so it is used instead.
+ */
+PersistentStore *get_lib_read_store()
+{
+	return (p_read_store && !db_in_transaction(p_store)) ? p_read_store : p_store;
+}
+
 /*
  * Return a pointer to the configuration database
  */
@@ -231,10 +271,11 @@ int get_config_value(const char *key, char *value)
 	}
 	else
 	{
-		if (p_store)
+		PersistentStore *p_ps = get_lib_read_store();
+		if (p_ps)
 		{
 			struct db_config config;
-			if ((rc == db_get_config_by_key(p_store, key, &config)) == DB_SUCCESS)
+			if ((rc == db_get_config_by_key(p_ps, key, &config)) == DB_SUCCESS)
 			{
 				s_strcpy(value, config.value, CONFIG_VALUE_LEN);
 				rc = COMMON_SUCCESS;
@@ -322,6 +363,7 @@ int set_default_config_settings(PersistentStore *p_ps)
 		// Add default configuration settings
 		add_config_value_to_pstore(p_ps, SQL_KEY_LOG_LEVEL, "0");
 		add_config_value_to_pstore(p_ps, SQL_KEY_EVENT_POLLING_INTERVAL_SECONDS, "60");
+		add_config_value_to_pstore(p_ps, SQL_KEY_INDICATION_COALESCE_SECONDS, "300");
 		add_config_value_to_pstore(p_ps, SQL_KEY_ENCRYPT_GATHER_SUPPORT, "1");
 		add_config_value_to_pstore(p_ps, SQL_KEY_GATHER_SUPPORT_FILTER,
 			"15"); // GSF_HOST_DATA | GSF_NAMESPACE_DATA | GSF_SERIAL_NUMS | GSF_SYSTEM_LOG
@@ -347,6 +389,8 @@ int set_default_config_settings(PersistentStore *p_ps)
 		add_config_value_to_pstore(p_ps, SQL_KEY_MAX_HEALTH_STATUS, "0"); // 0 means normal
 		add_config_value_to_pstore(p_ps, SQL_KEY_LOG_DESTINATION, log_destination);
 		add_config_value_to_pstore(p_ps, SQL_KEY_LOG_MAX, "10000");
+		add_config_value_to_pstore(p_ps, SQL_KEY_DB_WAL_MODE, "1");
+		add_config_value_to_pstore(p_ps, SQL_KEY_DB_WAL_CHECKPOINT_PAGES, "1000");
 		add_config_value_to_pstore(p_ps, SQL_KEY_DEFAULT_TEMPERATURE_THRESHOLD, "81.5");
 		add_config_value_to_pstore(p_ps, SQL_KEY_DEFAULT_SPARE_BLOCK_THRESHOLD, "50");
 		add_config_value_to_pstore(p_ps, SQL_KEY_FW_LOG_LEVEL, "1");
@@ -358,6 +402,8 @@ int set_default_config_settings(PersistentStore *p_ps)
 		add_config_value_to_pstore(p_ps, SQL_KEY_DEFAULT_AVG_POW_BUDGET_MIN, "100");
 		add_config_value_to_pstore(p_ps, SQL_KEY_DEFAULT_AVG_POW_BUDGET_MAX, "18000");
 		add_config_value_to_pstore(p_ps, SQL_KEY_DEFAULT_DIE_SPARING_AGGRESSIVENESS, "128");
+		add_config_value_to_pstore(p_ps, SQL_KEY_FW_CONSISTENCY_RULES, "");
+		add_config_value_to_pstore(p_ps, SQL_KEY_FW_TRACE_FILE, "");
 
 		// monitor configs
 		add_config_value_to_pstore(p_ps, SQL_KEY_PERFORMANCE_MONITOR_ENABLED, "1");
@@ -370,6 +416,13 @@ int set_default_config_settings(PersistentStore *p_ps)
 		add_config_value_to_pstore(p_ps, SQL_KEY_EVENT_MONITOR_INTERVAL, "60");
 		add_config_value_to_pstore(p_ps, SQL_KEY_EVENT_LOG_MAX, "10000");
 		add_config_value_to_pstore(p_ps, SQL_KEY_EVENT_LOG_TRIM_PERCENT, "10");
+
+		add_config_value_to_pstore(p_ps, SQL_KEY_JOB_MONITOR_ENABLED, "1");
+		add_config_value_to_pstore(p_ps, SQL_KEY_JOB_MONITOR_INTERVAL, "60");
+		// 3600 = 1 hour
+		add_config_value_to_pstore(p_ps, SQL_KEY_JOB_RETENTION, "3600");
+		add_config_value_to_pstore(p_ps, SQL_KEY_METRICS_EXPORT_FILE, "");
+		add_config_value_to_pstore(p_ps, SQL_KEY_METRICS_EXPORT_SOCKET, "");
 		add_config_value_to_pstore(p_ps, SQL_KEY_TOPOLOGY_STATE_VALID, "0");
 
 		// CLI default device identifier output - HANDLE (or GUID)
@@ -79,6 +79,22 @@ extern int close_lib_store();
  */
 extern PersistentStore *get_lib_store();
 
+/*!
+ * Return a pointer to the connection to use for read-only queries.
+ * @return
+ * 		A read-only connection if the configuration database is in WAL mode and no
+ * 		transaction is open on get_lib_store(), otherwise the same pointer as get_lib_store().
+ */
+extern PersistentStore *get_lib_read_store();
+
+/*!
+ * Switch the configuration database to WAL mode when enabled by
+ * #SQL_KEY_DB_WAL_MODE and open the read-only connection used by get_lib_read_store().
+ * @param[in] path
+ * 		The absolute path to the database
+ */
+extern void open_lib_read_store(const char *path);
+
 /*!
  * Open the default configuration database and return the pointer to it.
  */
@@ -45,6 +45,11 @@
 #include "lib_persistence.h"
 
 #define	SYSLOG_SOURCE	"IntelNVM"
+#define	LOG_LEVEL_REFRESH_COUNT	4096 // rejected log calls between reads of the log level
+
+// start at the highest level so the first log call reads the real one
+volatile int g_log_level = LOGGING_LEVEL_DEBUG;
+__thread int tl_log_level_countdown = LOG_LEVEL_REFRESH_COUNT;
 
 void print_buffer_to_file(const char *filename, char *p_buf, size_t buf_size, char *p_prefix)
 {
@@ -214,7 +219,18 @@ void log_trace_f(int level, const char *file_name, int line_number, const char *
  */
 int log_level_check(int log_level)
 {
-	return (log_level <= get_current_log_level());
+	int current_log_level = get_current_log_level();
+	g_log_level = current_log_level;
+	return (log_level <= current_log_level);
+}
+
+/*
+ * re-read the log level after the logging macros rejected a number of calls on this thread
+ */
+int log_level_refresh(int log_level)
+{
+	tl_log_level_countdown = LOG_LEVEL_REFRESH_COUNT;
+	return log_level_check(log_level);
 }
 
 int log_gather()
@@ -257,6 +273,7 @@ COMMON_BOOL set_current_log_level(int level)
 	snprintf(level_str, CONFIG_VALUE_LEN, "%d", level);
 	if (add_config_value(SQL_KEY_LOG_LEVEL, level_str) == COMMON_SUCCESS)
 	{
+		g_log_level = level;
 		set = 1;
 	}
 	return set;
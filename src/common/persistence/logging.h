@@ -50,35 +50,94 @@ enum log_dest
 	LOG_DEST_SYSLOG = 1//!< LOG_DEST_SYSLOG - write to the syslog
 };
 
+/*
+ * Function entry/exit tracing is compiled in unless the build sets NVM_TRACE=0
+ */
+#ifndef	__NVM_TRACE__
+#define	__NVM_TRACE__ 1
+#endif
+
+/*!
+ * The last log level read from the config database, shared by all threads.
+ * An aligned int is read and written whole, so plain loads and stores are used.
+ */
+extern volatile int g_log_level;
+
+/*!
+ * Number of rejected log calls left on this thread before the log level is
+ * read again, so a level changed by another process is eventually seen.
+ */
+extern __thread int tl_log_level_countdown;
+
+/*!
+ * Read the log level from the config database and check the given level against it
+ * @param[in] log_level
+ * 		log_level to check
+ * @return
+ * 		1 if True, 0 if False
+ */
+int log_level_refresh(int log_level);
+
+/*!
+ * Inexpensive check, without a database read, used by the logging macros before
+ * the log call and formatting of its arguments
+ * @param[in] log_level
+ * 		log_level to check
+ * @return
+ * 		1 if the level may be logged, 0 if not
+ */
+static inline int log_level_enabled(int log_level)
+{
+	return (log_level <= g_log_level) ||
+			((--tl_log_level_countdown <= 0) && log_level_refresh(log_level));
+}
+
+//! Log the message only if the level is enabled
+#define	COMMON_LOG(level, statement)  \
+	do { if (log_level_enabled(level)) { \
+		log_trace(level, __FILE__, __LINE__, statement); } } while (0)
+
+//! Log the formatted message only if the level is enabled
+#define	COMMON_LOG_F(level, ...)  \
+	do { if (log_level_enabled(level)) { \
+		log_trace_f(level, __FILE__, __LINE__, __VA_ARGS__); } } while (0)
+
+//! Log the formatted entry/exit trace only if tracing is compiled in and the level is enabled
+#if __NVM_TRACE__
+#define	COMMON_LOG_TRACE_F(...)  COMMON_LOG_F(LOGGING_LEVEL_INFO, __VA_ARGS__)
+#else
+// arguments still reference the variables, but the call is never made
+#define	COMMON_LOG_TRACE_F(...)  \
+	do { if (0) { log_trace_f(LOGGING_LEVEL_INFO, __FILE__, __LINE__, __VA_ARGS__); } } while (0)
+#endif
+
 /*
  * Macros to facilitate logging
  */
 
 //! Log Macro: Log Level = Debug
 #define	COMMON_LOG_DEBUG(statement)  \
-	log_trace(LOGGING_LEVEL_DEBUG, __FILE__, __LINE__, statement)
+	COMMON_LOG(LOGGING_LEVEL_DEBUG, statement)
 
 //! Log Macro: Log Level = Info
 #define	COMMON_LOG_INFO(statement)  \
-	log_trace(LOGGING_LEVEL_INFO, __FILE__, __LINE__, statement)
+	COMMON_LOG(LOGGING_LEVEL_INFO, statement)
 
 //! Log Macro: Log Level = Warning
 #define	COMMON_LOG_WARN(statement)  \
-	log_trace(LOGGING_LEVEL_WARN,  __FILE__, __LINE__, statement)
+	COMMON_LOG(LOGGING_LEVEL_WARN, statement)
 
 //! Log Macro: Log Level = Error
 #define	COMMON_LOG_ERROR(statement)  \
-	log_trace(LOGGING_LEVEL_ERROR, __FILE__, __LINE__, statement)
+	COMMON_LOG(LOGGING_LEVEL_ERROR, statement)
 
 //! Function Entry Log Macro: Log Level = Info
-#define	COMMON_LOG_ENTRY()  log_trace_f \
-	(LOGGING_LEVEL_INFO, __FILE__, __LINE__, \
-	"Entering %s()", ((char *)__func__))
+#define	COMMON_LOG_ENTRY()  \
+	COMMON_LOG_TRACE_F("Entering %s()", ((char *)__func__))
 
 //! Function Exit Log Macro: Log Level = Info
 #define	COMMON_LOG_EXIT()  \
-	log_trace_f(LOGGING_LEVEL_INFO, __FILE__, __LINE__, \
-	"Exiting %s", ((char *)__func__))
+	COMMON_LOG_TRACE_F("Exiting %s", ((char *)__func__))
 
 /*
  * Macros to facilitate logging w/ formatted messages
@@ -86,19 +145,19 @@ enum log_dest
 
 //! Formatted Log Macro: Log Level = Debug
 #define	COMMON_LOG_DEBUG_F(format, ...)  \
-	log_trace_f(LOGGING_LEVEL_DEBUG, __FILE__, __LINE__, format, __VA_ARGS__)
+	COMMON_LOG_F(LOGGING_LEVEL_DEBUG, format, __VA_ARGS__)
 
 //! Formatted Log Macro: Log Level = Info
 #define	COMMON_LOG_INFO_F(format, ...)  \
-	log_trace_f(LOGGING_LEVEL_INFO, __FILE__, __LINE__, format, __VA_ARGS__)
+	COMMON_LOG_F(LOGGING_LEVEL_INFO, format, __VA_ARGS__)
 
 //! Formatted Log Macro: Log Level = Warning
 #define	COMMON_LOG_WARN_F(format, ...)  \
-	log_trace_f(LOGGING_LEVEL_WARN, __FILE__, __LINE__, format, __VA_ARGS__)
+	COMMON_LOG_F(LOGGING_LEVEL_WARN, format, __VA_ARGS__)
 
 //! Formatted Log Macro: Log Level = Error
 #define	COMMON_LOG_ERROR_F(format, ...)  \
-	log_trace_f(LOGGING_LEVEL_ERROR, __FILE__, __LINE__, format, __VA_ARGS__)
+	COMMON_LOG_F(LOGGING_LEVEL_ERROR, format, __VA_ARGS__)
 
 //! Error message for when get_* != get_*_count - in most cases they should return the same count
 #define	COMMON_LOG_ERROR_BAD_COUNT(base, count, base_rc) \
@@ -107,13 +166,11 @@ enum log_dest
 
 //! Formatted Function Entry Log Macro: Log Level = Info
 #define	COMMON_LOG_ENTRY_PARAMS(param_format, ...)  \
-	log_trace_f(LOGGING_LEVEL_INFO, __FILE__, __LINE__, \
-	"Entering %s(" param_format ")", ((char *)__func__), __VA_ARGS__)
+	COMMON_LOG_TRACE_F("Entering %s(" param_format ")", ((char *)__func__), __VA_ARGS__)
 
 //! Formatted Function Exit Log Macro: Log Level = Info
 #define	COMMON_LOG_EXIT_RETURN(return_format, ...)  \
-	log_trace_f(LOGGING_LEVEL_INFO, __FILE__, __LINE__, \
-	"Exiting %s(): " return_format, ((char *)__func__), __VA_ARGS__)
+	COMMON_LOG_TRACE_F("Exiting %s(): " return_format, ((char *)__func__), __VA_ARGS__)
 
 //! Formatted Function Exit w/ Return Value Log Macro: Log Level = Info
 #define	COMMON_LOG_EXIT_RETURN_I(return_value) \
@@ -28,10 +28,14 @@
 #define CR_MGMT_DEVICECOLLECTION_H
 
 #include <vector>
+#include <tr1/memory>
 #include <stddef.h>
 
 namespace core
 {
+/*
+ * Items are shared, copying a collection doesn't copy the items in it
+ */
 template<class T>
 class Collection
 {
@@ -42,7 +46,7 @@ public:
 	void removeAt(size_t index);
 
 protected:
-	std::vector<T *> m_collection;
+	std::vector<std::tr1::shared_ptr<T> > m_collection;
 };
 
 template<class T>
@@ -54,7 +58,7 @@ T &Collection<T>::operator[](const int i)
 template<class T>
 void Collection<T>::push_back(T &item)
 {
-	T *copy = item.clone();
+	std::tr1::shared_ptr<T> copy(item.clone());
 	m_collection.push_back(copy);
 }
 
@@ -160,6 +160,38 @@ int LibWrapper::getDevicePerformance(const NVM_GUID deviceGuid,
 	return nvm_get_device_performance(deviceGuid, pPerformance);
 }
 
+int LibWrapper::getMailboxStatsCount() const
+{
+	LogEnterExit(__FUNCTION__, __FILE__, __LINE__);
+	return nvm_get_mailbox_stats_count();
+}
+
+int LibWrapper::getMailboxStats(struct device_mailbox_stats *pStats,
+	const NVM_UINT32 count) const
+{
+	LogEnterExit(__FUNCTION__, __FILE__, __LINE__);
+	return nvm_get_mailbox_stats(pStats, count);
+}
+
+void LibWrapper::resetMailboxStats() const
+{
+	LogEnterExit(__FUNCTION__, __FILE__, __LINE__);
+	nvm_reset_mailbox_stats();
+}
+
+int LibWrapper::getPublishedMailboxStatsCount() const
+{
+	LogEnterExit(__FUNCTION__, __FILE__, __LINE__);
+	return nvm_get_published_mailbox_stats_count();
+}
+
+int LibWrapper::getPublishedMailboxStats(struct device_mailbox_stats *pStats,
+	const NVM_UINT32 count) const
+{
+	LogEnterExit(__FUNCTION__, __FILE__, __LINE__);
+	return nvm_get_published_mailbox_stats(pStats, count);
+}
+
 int LibWrapper::updateDeviceFw(const NVM_GUID deviceGuid, const NVM_PATH path,
 	const NVM_SIZE path_len, const NVM_BOOL activate, const NVM_BOOL force) const
 {
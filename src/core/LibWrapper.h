@@ -77,6 +77,17 @@ public:
 	virtual int getDevicePerformance(const NVM_GUID deviceGuid,
 		struct device_performance *pPerformance) const;
 
+	virtual int getMailboxStatsCount() const;
+
+	virtual int getMailboxStats(struct device_mailbox_stats *pStats, const NVM_UINT32 count) const;
+
+	virtual void resetMailboxStats() const;
+
+	virtual int getPublishedMailboxStatsCount() const;
+
+	virtual int getPublishedMailboxStats(struct device_mailbox_stats *pStats,
+		const NVM_UINT32 count) const;
+
 	virtual int updateDeviceFw(const NVM_GUID deviceGuid, const NVM_PATH path,
 		const NVM_SIZE path_len, const NVM_BOOL activate, const NVM_BOOL force) const;
 
@@ -396,6 +396,77 @@ struct device_performance NvmLibrary::getDevicePerformance(const std::string &de
 
 }
 
+std::vector<struct device_mailbox_stats> NvmLibrary::getMailboxStats()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	int rc;
+
+	std::vector<struct device_mailbox_stats> result;
+	rc = m_lib.getMailboxStatsCount();
+	if (rc < 0)
+	{
+		throw core::LibraryException(rc);
+	}
+	// commands may be counted in between, leave room for a few new entries
+	int count = rc + 16;
+	struct device_mailbox_stats *fromLib = new struct device_mailbox_stats[count];
+
+	rc = m_lib.getMailboxStats(fromLib, count);
+	if (rc < 0)
+	{
+		delete[] fromLib;
+		throw core::LibraryException(rc);
+	}
+
+	for (int i = 0; i < rc; i++)
+	{
+		result.push_back(fromLib[i]);
+	}
+	delete[] fromLib;
+	return result;
+
+}
+
+void NvmLibrary::resetMailboxStats()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	m_lib.resetMailboxStats();
+}
+
+std::vector<struct device_mailbox_stats> NvmLibrary::getPublishedMailboxStats()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	int rc;
+
+	std::vector<struct device_mailbox_stats> result;
+	rc = m_lib.getPublishedMailboxStatsCount();
+	if (rc < 0)
+	{
+		throw core::LibraryException(rc);
+	}
+	if (rc > 0)
+	{
+		// the file may be republished in between, leave room for a few new entries
+		int count = rc + 16;
+		struct device_mailbox_stats *fromLib = new struct device_mailbox_stats[count];
+
+		rc = m_lib.getPublishedMailboxStats(fromLib, count);
+		if (rc < 0)
+		{
+			delete[] fromLib;
+			throw core::LibraryException(rc);
+		}
+
+		for (int i = 0; i < rc; i++)
+		{
+			result.push_back(fromLib[i]);
+		}
+		delete[] fromLib;
+	}
+	return result;
+
+}
+
 void NvmLibrary::updateDeviceFw(const std::string &deviceGuid, const std::string path,
 	const bool activate, const bool force)
 {
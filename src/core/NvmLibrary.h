@@ -64,6 +64,9 @@ public:
 		const struct device_settings &settings);
 	virtual struct device_details getDeviceDetails(const std::string &deviceGuid);
 	virtual struct device_performance getDevicePerformance(const std::string &deviceGuid);
+	virtual std::vector<struct device_mailbox_stats> getMailboxStats();
+	virtual void resetMailboxStats();
+	virtual std::vector<struct device_mailbox_stats> getPublishedMailboxStats();
 	virtual void updateDeviceFw(const std::string &deviceGuid, const std::string path,
 		const bool activate, const bool force);
 	virtual void examineDeviceFw(const std::string &deviceGuid, const std::string path,
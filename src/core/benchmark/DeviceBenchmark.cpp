@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Times the core Device getters that only read the discovery data, to show
+ * the cost of entry/exit tracing per call when trace logging is off.
+ * Compare a default build with one made with NVM_TRACE=0.
+ *
+ * Usage: device_benchmark [iterations]
+ */
+
+#include <core/device/Device.h>
+#include <core/NvmLibrary.h>
+#include <persistence/logging.h>
+#include <common_types.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+
+#define	DEFAULT_ITERATIONS	10000000
+
+// results are accumulated here so the calls can't be optimized away
+static volatile NVM_UINT64 g_sink = 0;
+
+static unsigned long long getTimeNsec()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static NVM_UINT64 readSocketId(core::device::Device &device)
+{
+	return device.getSocketId();
+}
+
+static NVM_UINT64 readChannelId(core::device::Device &device)
+{
+	return device.getChannelId();
+}
+
+static NVM_UINT64 readPhysicalId(core::device::Device &device)
+{
+	return device.getPhysicalId();
+}
+
+static NVM_UINT64 readVendorId(core::device::Device &device)
+{
+	return device.getVendorId();
+}
+
+static NVM_UINT64 readGuid(core::device::Device &device)
+{
+	return device.getGuid().size();
+}
+
+static const struct
+{
+	const char *name;
+	NVM_UINT64 (*read)(core::device::Device &device);
+} GETTERS[] =
+{
+	{ "getSocketId", readSocketId },
+	{ "getChannelId", readChannelId },
+	{ "getPhysicalId", readPhysicalId },
+	{ "getVendorId", readVendorId },
+	{ "getGuid", readGuid }
+};
+
+/*
+ * The same field read straight from the discovery struct, the cost of a getter
+ * without any tracing
+ */
+static double runBaseline(const struct device_discovery &discovery, const int iterations)
+{
+	const volatile struct device_discovery *pDiscovery = &discovery;
+	unsigned long long start = getTimeNsec();
+	for (int i = 0; i < iterations; i++)
+	{
+		g_sink += pDiscovery->socket_id;
+	}
+	return (double)(getTimeNsec() - start) / iterations;
+}
+
+static double runGetter(core::device::Device &device,
+		NVM_UINT64 (*read)(core::device::Device &device), const int iterations)
+{
+	unsigned long long start = getTimeNsec();
+	for (int i = 0; i < iterations; i++)
+	{
+		g_sink += read(device);
+	}
+	return (double)(getTimeNsec() - start) / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+	int iterations = DEFAULT_ITERATIONS;
+	if (argc > 1)
+	{
+		iterations = atoi(argv[1]);
+	}
+	if (iterations <= 0)
+	{
+		fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	struct device_discovery discovery;
+	memset(&discovery, 0, sizeof (discovery));
+	discovery.socket_id = 1;
+	discovery.device_handle.parts.mem_channel_id = 2;
+	discovery.physical_id = 3;
+	discovery.vendor_id = 0x8089;
+	discovery.guid[0] = 1;
+	core::device::Device device(core::NvmLibrary::getNvmLibrary(), discovery);
+
+	printf("Entry/exit tracing: %s, trace logging %s\n",
+			__NVM_TRACE__ ? "compiled in" : "compiled out",
+			log_level_check(LOGGING_LEVEL_INFO) ? "on" : "off");
+	double baseline = runBaseline(discovery, iterations);
+	printf("%-16s %10s %14s\n", "Getter", "ns/call", "overhead (ns)");
+	printf("%-16s %10.2f %14s\n", "(field read)", baseline, "-");
+	for (size_t i = 0; i < sizeof (GETTERS) / sizeof (GETTERS[0]); i++)
+	{
+		double perCall = runGetter(device, GETTERS[i].read, iterations);
+		printf("%-16s %10.2f %14.2f\n", GETTERS[i].name, perCall, perCall - baseline);
+	}
+
+	return 0;
+}
@@ -34,27 +34,21 @@ namespace device
 
 Device::Device() :
 	m_lib(NvmLibrary::getNvmLibrary()),
-	m_discovery(device_discovery()),
-	m_pDetails(NULL),
-	m_pActionRequiredEvents(NULL)
+	m_pDiscovery(new device_discovery())
 {
 
 }
 
 Device::Device(NvmLibrary &lib, const device_discovery &discovery) :
 	m_lib(lib),
-	m_pDetails(NULL),
-	m_pActionRequiredEvents(NULL)
+	m_pDiscovery(new device_discovery(discovery))
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
-	memmove(&m_discovery, &discovery, sizeof(m_discovery));
-	m_deviceGuid = Helper::guidToString(m_discovery.guid);
+	m_deviceGuid = Helper::guidToString(m_pDiscovery->guid);
 }
 
 Device::Device(const Device &other) :
-	m_lib(other.m_lib),
-	m_pDetails(NULL),
-	m_pActionRequiredEvents(NULL)
+	m_lib(other.m_lib)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 	copy(other);
@@ -75,35 +69,15 @@ void Device::copy(const Device &other)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 	this->m_lib = other.m_lib;
-	this->m_discovery = other.m_discovery;
+	this->m_pDiscovery = other.m_pDiscovery;
+	this->m_pDetails = other.m_pDetails;
+	this->m_pActionRequiredEvents = other.m_pActionRequiredEvents;
 	this->m_deviceGuid = other.m_deviceGuid;
-	if (other.m_pDetails)
-	{
-		this->m_pDetails = new device_details();
-		memmove(this->m_pDetails, other.m_pDetails, sizeof(device_details));
-	}
-
-	if (other.m_pActionRequiredEvents)
-	{
-		this->m_pActionRequiredEvents = new std::vector<std::string>();
-		for (size_t i = 0; i < other.m_pActionRequiredEvents->size(); i++)
-		{
-			(*this->m_pActionRequiredEvents).push_back((*other.m_pActionRequiredEvents)[i]);
-		}
-	}
 }
 
 Device::~Device()
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
-	if (m_pDetails)
-	{
-		delete m_pDetails;
-	}
-	if (m_pActionRequiredEvents)
-	{
-		delete m_pActionRequiredEvents;
-	}
 }
 
 Device *Device::clone()
@@ -654,38 +628,44 @@ std::vector<std::string> Device::getActionRequiredEvents()
 const device_discovery &Device::getDiscovery()
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
-	return m_discovery;
+	return *m_pDiscovery;
 }
 
 const device_details &Device::getDetails()
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
-	if (m_pDetails == NULL)
+	if (!m_pDetails)
 	{
-		m_pDetails = new device_details();
+		device_details *pDetails = new device_details();
 		try
 		{
-			const device_details &details = m_lib.getDeviceDetails(m_deviceGuid);
-			memmove(m_pDetails, &details, sizeof(details));
+			*pDetails = m_lib.getDeviceDetails(m_deviceGuid);
 		}
 		catch (core::LibraryException &e)
 		{
 			if (e.getErrorCode() != NVM_ERR_NOTMANAGEABLE)
 			{
+				delete pDetails;
 				throw;
 			}
 		}
-
+		m_pDetails.reset(pDetails);
 	}
 	return *m_pDetails;
 }
 
+void Device::prefetchDetails()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	getDetails();
+}
+
 const std::vector<std::string> &Device::getEvents()
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
-	if (m_pActionRequiredEvents == NULL)
+	if (!m_pActionRequiredEvents)
 	{
-		m_pActionRequiredEvents = new std::vector<std::string>();
+		std::vector<std::string> *pEvents = new std::vector<std::string>();
 		event_filter filter;
 		memset(&filter, 0, sizeof(filter));
 		filter.filter_mask = NVM_FILTER_ON_AR | NVM_FILTER_ON_GUID;
@@ -706,13 +686,14 @@ const std::vector<std::string> &Device::getEvents()
 					events[i].args[1],
 					events[i].args[2]);
 				eventMsg << " - " << msg;
-				m_pActionRequiredEvents->push_back(eventMsg.str());
+				pEvents->push_back(eventMsg.str());
 			}
 		}
 		catch (core::LibraryException &)
 		{
 			// don't throw
 		}
+		m_pActionRequiredEvents.reset(pEvents);
 	}
 	return *m_pActionRequiredEvents;
 }
@@ -37,6 +37,7 @@
 
 #include <string>
 #include <vector>
+#include <tr1/memory>
 #include <string/s_str.h>
 #include <sstream>
 #include <core/exceptions/LibraryException.h>
@@ -155,11 +156,18 @@ public:
 	virtual bool isActionRequired();
 	virtual std::vector<std::string> getActionRequiredEvents();
 
+	/*
+	 * Fetch the device details now if they haven't been yet. Copies made afterwards
+	 * share the same details instead of fetching them again.
+	 */
+	void prefetchDetails();
+
 private:
 	NvmLibrary &m_lib;
-	device_discovery m_discovery;
-	device_details *m_pDetails;
-	std::vector<std::string> *m_pActionRequiredEvents;
+	// discovery, details and events never change once read so copies share them
+	std::tr1::shared_ptr<const device_discovery> m_pDiscovery;
+	std::tr1::shared_ptr<const device_details> m_pDetails;
+	std::tr1::shared_ptr<const std::vector<std::string> > m_pActionRequiredEvents;
 	std::string m_deviceGuid;
 
 	const device_discovery &getDiscovery();
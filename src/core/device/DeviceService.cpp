@@ -99,3 +99,62 @@ core::Result<core::device::Device> core::device::DeviceService::getDevice(std::s
 
 	return Result<Device>(result);
 }
+
+/*
+ * Fetch the details for all the devices up front, once each, so displaying
+ * or copying them afterwards doesn't go back to the library
+ */
+void core::device::DeviceService::prefetchDetails(DeviceCollection &devices)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		devices[i].prefetchDetails();
+	}
+}
+
+core::device::MailboxStatsCollection core::device::DeviceService::getMailboxStats()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return toMailboxStatsCollection(m_lib.getMailboxStats());
+}
+
+void core::device::DeviceService::resetMailboxStats()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	m_lib.resetMailboxStats();
+}
+
+/*
+ * The mailbox stats the monitor service published, rather than those of this process
+ */
+core::device::MailboxStatsCollection core::device::DeviceService::getPublishedMailboxStats()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return toMailboxStatsCollection(m_lib.getPublishedMailboxStats());
+}
+
+core::device::MailboxStatsCollection core::device::DeviceService::toMailboxStatsCollection(
+		const std::vector<struct device_mailbox_stats> &stats)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	MailboxStatsCollection result;
+
+	// the stats only know the device handle
+	const std::vector<device_discovery> &discoveries = m_lib.getDevices();
+	for (size_t i = 0; i < stats.size(); i++)
+	{
+		std::string guid;
+		for (size_t j = 0; j < discoveries.size() && guid.empty(); j++)
+		{
+			if (discoveries[j].device_handle.handle == stats[i].device_handle)
+			{
+				guid = Helper::guidToString(discoveries[j].guid);
+			}
+		}
+		MailboxStats mailboxStats(stats[i], guid);
+		result.push_back(mailboxStats);
+	}
+
+	return result;
+}
@@ -34,6 +34,7 @@
 #include <nvm_types.h>
 #include <core/Result.h>
 #include "Device.h"
+#include "MailboxStats.h"
 #include <core/Collection.h>
 
 namespace core
@@ -50,12 +51,20 @@ public:
 	virtual std::vector<std::string> getManageableGuids();
 	virtual DeviceCollection getAllDevices();
 	virtual Result<Device> getDevice(std::string guid);
+	virtual void prefetchDetails(DeviceCollection &devices);
+	virtual MailboxStatsCollection getMailboxStats();
+	virtual void resetMailboxStats();
+	virtual MailboxStatsCollection getPublishedMailboxStats();
 
 	static DeviceService &getService();
 
 protected:
 	NvmLibrary &m_lib;
 	static DeviceService *m_pSingleton;
+
+private:
+	MailboxStatsCollection toMailboxStatsCollection(
+		const std::vector<struct device_mailbox_stats> &stats);
 };
 }
 }
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LogEnterExit.h>
+#include "MailboxStats.h"
+
+core::device::MailboxStats *core::device::MailboxStats::clone()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return new MailboxStats(*this);
+}
+
+std::string core::device::MailboxStats::getGuid()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_guid;
+}
+
+NVM_UINT32 core::device::MailboxStats::getDeviceHandle()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_stats.device_handle;
+}
+
+enum mailbox_command_type core::device::MailboxStats::getType()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_stats.type;
+}
+
+NVM_UINT8 core::device::MailboxStats::getOpcode()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_stats.opcode;
+}
+
+NVM_UINT8 core::device::MailboxStats::getSubOpcode()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_stats.sub_opcode;
+}
+
+NVM_UINT64 core::device::MailboxStats::getCount()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_stats.count;
+}
+
+NVM_UINT64 core::device::MailboxStats::getBytes()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_stats.bytes;
+}
+
+NVM_UINT64 core::device::MailboxStats::getErrors()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_stats.errors;
+}
+
+NVM_UINT64 core::device::MailboxStats::getBusy()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_stats.busy;
+}
+
+NVM_UINT64 core::device::MailboxStats::getAverageLatency()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_stats.count ? m_stats.total_latency_usec / m_stats.count : 0;
+}
+
+NVM_UINT64 core::device::MailboxStats::getMedianLatency()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return nvm_get_mailbox_latency_percentile(&m_stats, 50);
+}
+
+NVM_UINT64 core::device::MailboxStats::getP99Latency()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return nvm_get_mailbox_latency_percentile(&m_stats, 99);
+}
+
+NVM_UINT64 core::device::MailboxStats::getMaxLatency()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_stats.max_latency_usec;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef CR_MGMT_MAILBOXSTATS_H
+#define CR_MGMT_MAILBOXSTATS_H
+
+#include <string>
+#include <string.h>
+#include <nvm_management.h>
+#include <core/Collection.h>
+
+namespace core
+{
+namespace device
+{
+/*
+ * Mailbox statistics of one firmware command on one device
+ */
+class NVM_API MailboxStats
+{
+public:
+	MailboxStats(const device_mailbox_stats &stats, const std::string &guid) : m_guid(guid)
+	{
+		memmove(&m_stats, &stats, sizeof (m_stats));
+	}
+
+	MailboxStats(const MailboxStats &other) : m_guid(other.m_guid)
+	{
+		memmove(&m_stats, &other.m_stats, sizeof (m_stats));
+	}
+
+	MailboxStats &operator=(const MailboxStats &other)
+	{
+		if (&other == this)
+			return *this;
+		this->m_guid = other.m_guid;
+		memmove(&m_stats, &other.m_stats, sizeof (m_stats));
+		return *this;
+	}
+
+	virtual ~MailboxStats() { }
+
+	virtual MailboxStats *clone();
+	virtual std::string getGuid();
+	virtual NVM_UINT32 getDeviceHandle();
+	virtual enum mailbox_command_type getType();
+	virtual NVM_UINT8 getOpcode();
+	virtual NVM_UINT8 getSubOpcode();
+	virtual NVM_UINT64 getCount();
+	virtual NVM_UINT64 getBytes();
+	virtual NVM_UINT64 getErrors();
+	virtual NVM_UINT64 getBusy();
+	virtual NVM_UINT64 getAverageLatency();
+	virtual NVM_UINT64 getMedianLatency();
+	virtual NVM_UINT64 getP99Latency();
+	virtual NVM_UINT64 getMaxLatency();
+
+private:
+	std::string m_guid;
+	device_mailbox_stats m_stats;
+};
+
+class NVM_API MailboxStatsCollection : public Collection<MailboxStats>
+{
+};
+}
+}
+#endif //CR_MGMT_MAILBOXSTATS_H
@@ -55,21 +55,34 @@ class LogEnterExit
 		 *	is to copy the strings internal to this obj during construction.
 		 *
 		 */
+#if __NVM_TRACE__
 		LogEnterExit(const char *funcName, const char *srcFile, const int lineNum) :
 			m_FuncName(funcName), m_SrcFile(srcFile), m_LineNum(lineNum)
 		{
-			log_trace_f(LOGGING_LEVEL_INFO, m_SrcFile, m_LineNum, "Entering: %s", m_FuncName);
+			if (log_level_enabled(LOGGING_LEVEL_INFO))
+			{
+				log_trace_f(LOGGING_LEVEL_INFO, m_SrcFile, m_LineNum, "Entering: %s", m_FuncName);
+			}
 		}
 
-		virtual ~LogEnterExit()
+		~LogEnterExit()
 		{
-			log_trace_f(LOGGING_LEVEL_INFO, m_SrcFile, m_LineNum, "Exiting: %s", m_FuncName);
+			if (log_level_enabled(LOGGING_LEVEL_INFO))
+			{
+				log_trace_f(LOGGING_LEVEL_INFO, m_SrcFile, m_LineNum, "Exiting: %s", m_FuncName);
+			}
 		}
 
 	private:
 		const char *m_FuncName;
 		const char *m_SrcFile;
 		const int m_LineNum;
+#else
+		// tracing is compiled out, the compiler removes the object entirely
+		LogEnterExit(const char *funcName, const char *srcFile, const int lineNum)
+		{
+		}
+#endif
 };
 
 
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Stress test for the library context cache. Reader threads repeatedly copy the
+ * device list and device details out of the context while an optional writer
+ * thread keeps replacing the details, and the rate of reads is reported for an
+ * increasing number of readers.
+ *
+ * Usage: context_benchmark [seconds per run] [writer 0|1]
+ */
+
+#include <nvm_context.h>
+#include <os/os_adapter.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define	BENCHMARK_DEVICES	NVM_MAX_DEVICES_PER_SOCKET
+#define	BENCHMARK_MAX_THREADS	16
+#define	DEFAULT_SECONDS	2
+
+// defined by nvm_management.c in the library
+pthread_mutex_t g_context_lock;
+
+static volatile int g_running = 0;
+static volatile int g_errors = 0;
+
+struct reader_thread_args
+{
+	NVM_UINT64 reads;
+};
+
+static unsigned long long get_time_nsec()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static void make_guid(NVM_GUID guid, const int index)
+{
+	memset(guid, 0, sizeof (NVM_GUID));
+	guid[0] = 0xBE;
+	guid[1] = (unsigned char)index;
+}
+
+static void *reader_thread(void *p_arg)
+{
+	struct reader_thread_args *p_args = p_arg;
+	struct device_discovery devices[BENCHMARK_DEVICES];
+	struct device_details details;
+
+	while (g_running)
+	{
+		int count = get_nvm_context_devices(devices, BENCHMARK_DEVICES);
+		if (count != BENCHMARK_DEVICES)
+		{
+			__sync_add_and_fetch(&g_errors, 1);
+		}
+		for (int i = 0; i < count; i++)
+		{
+			if (get_nvm_context_device_details(devices[i].guid, &details) != NVM_SUCCESS ||
+					details.discovery.device_id != devices[i].device_id)
+			{
+				__sync_add_and_fetch(&g_errors, 1);
+			}
+		}
+		p_args->reads++;
+	}
+	return NULL;
+}
+
+static void *writer_thread(void *p_arg)
+{
+	NVM_UINT64 *p_writes = p_arg;
+	struct device_details details;
+	memset(&details, 0, sizeof (details));
+
+	int i = 0;
+	while (g_running)
+	{
+		make_guid(details.discovery.guid, i);
+		details.discovery.device_id = i;
+		details.data_width = *p_writes;
+		if (set_nvm_context_device_details(details.discovery.guid, &details) != NVM_SUCCESS)
+		{
+			__sync_add_and_fetch(&g_errors, 1);
+		}
+		i = (i + 1) % BENCHMARK_DEVICES;
+		(*p_writes)++;
+	}
+	return NULL;
+}
+
+static int populate_context()
+{
+	struct device_discovery devices[BENCHMARK_DEVICES];
+	struct device_details details;
+	memset(devices, 0, sizeof (devices));
+
+	int rc = nvm_create_context();
+	for (int i = 0; i < BENCHMARK_DEVICES; i++)
+	{
+		make_guid(devices[i].guid, i);
+		devices[i].device_id = i;
+	}
+	if (rc == NVM_SUCCESS)
+	{
+		rc = set_nvm_context_devices(devices, BENCHMARK_DEVICES);
+	}
+	for (int i = 0; i < BENCHMARK_DEVICES && rc == NVM_SUCCESS; i++)
+	{
+		memset(&details, 0, sizeof (details));
+		memmove(&details.discovery, &devices[i], sizeof (struct device_discovery));
+		rc = set_nvm_context_device_details(devices[i].guid, &details);
+	}
+	return rc;
+}
+
+static void run(const int reader_count, const int with_writer, const int seconds)
+{
+	NVM_UINT64 thread_handles[BENCHMARK_MAX_THREADS + 1];
+	struct reader_thread_args args[BENCHMARK_MAX_THREADS];
+	NVM_UINT64 writes = 0;
+	memset(args, 0, sizeof (args));
+
+	g_running = 1;
+	unsigned long long start = get_time_nsec();
+	for (int i = 0; i < reader_count; i++)
+	{
+		create_thread(&thread_handles[i], reader_thread, &args[i]);
+	}
+	if (with_writer)
+	{
+		create_thread(&thread_handles[reader_count], writer_thread, &writes);
+	}
+
+	nvm_sleep(seconds * 1000);
+	g_running = 0;
+
+	for (int i = 0; i < reader_count + (with_writer ? 1 : 0); i++)
+	{
+		join_thread(thread_handles[i]);
+	}
+	unsigned long long elapsed = get_time_nsec() - start;
+
+	NVM_UINT64 reads = 0;
+	for (int i = 0; i < reader_count; i++)
+	{
+		reads += args[i].reads;
+	}
+	printf("%2d readers%s: %12.0f device list reads/s, %10.0f writes/s\n",
+			reader_count, with_writer ? " + writer" : "",
+			(double)reads * 1e9 / elapsed, (double)writes * 1e9 / elapsed);
+}
+
+int main(int argc, char **argv)
+{
+	int seconds = DEFAULT_SECONDS;
+	int with_writer = 1;
+	if (argc > 1)
+	{
+		seconds = atoi(argv[1]);
+	}
+	if (argc > 2)
+	{
+		with_writer = atoi(argv[2]);
+	}
+
+	int rc = NVM_SUCCESS;
+	if (!mutex_init((OS_MUTEX*)&g_context_lock, NULL))
+	{
+		printf("Failed to initialize the context lock\n");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if ((rc = populate_context()) != NVM_SUCCESS)
+	{
+		printf("Failed to populate the context: %d\n", rc);
+	}
+	else
+	{
+		for (int readers = 1; readers <= BENCHMARK_MAX_THREADS; readers *= 2)
+		{
+			run(readers, with_writer, seconds);
+		}
+		nvm_free_context();
+		mutex_delete((OS_MUTEX*)&g_context_lock, NULL);
+
+		if (g_errors)
+		{
+			printf("%d inconsistent reads\n", g_errors);
+			rc = NVM_ERR_UNKNOWN;
+		}
+	}
+	return rc == NVM_SUCCESS ? 0 : 1;
+}
@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Multi-process contention benchmark for the config database. One writer process
+ * stores events in transactions the way the monitor does while a growing number
+ * of reader processes look up config values the way the CLI and CIM provider do.
+ * Each run is done with the rollback journal and a single connection per process,
+ * then in WAL mode with the readers on a read-only connection. In WAL mode the
+ * reader latency should stay flat as the writer holds its transactions.
+ *
+ * Usage: db_contention_benchmark [database path]
+ */
+
+#include <persistence/schema.h>
+#include <nvm_management.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define	BENCHMARK_MAX_READERS	16
+#define	BENCHMARK_DURATION_MSEC	2000
+#define	BENCHMARK_EVENTS_PER_TRANSACTION	50
+#define	BENCHMARK_MAX_SAMPLES	1000000
+#define	BENCHMARK_KEY	"BENCHMARK_KEY"
+#define	DEFAULT_DB_PATH	"db_contention_benchmark.db"
+
+/*
+ * What a child process reports back through its pipe
+ */
+struct process_result
+{
+	int rc;
+	int operations;
+	unsigned long long p50_usec;
+	unsigned long long p99_usec;
+	unsigned long long max_usec;
+};
+
+static unsigned long long get_time_usec()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000ull + now.tv_nsec / 1000;
+}
+
+static int compare_usec(const void *p_a, const void *p_b)
+{
+	unsigned long long a = *(const unsigned long long *)p_a;
+	unsigned long long b = *(const unsigned long long *)p_b;
+	return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static void remove_database(const char *path)
+{
+	char wal_path[256];
+	remove(path);
+	// the WAL and shared memory files may be left behind by the last connection
+	snprintf(wal_path, sizeof (wal_path), "%s-wal", path);
+	remove(wal_path);
+	snprintf(wal_path, sizeof (wal_path), "%s-shm", path);
+	remove(wal_path);
+}
+
+static int create_database(const char *path, const int wal)
+{
+	int rc = 0;
+	PersistentStore *p_ps = create_PersistentStore(path, 1);
+	if (p_ps == NULL)
+	{
+		printf("Failed to create the database %s\n", path);
+		rc = -1;
+	}
+	else
+	{
+		struct db_config config;
+		memset(&config, 0, sizeof (config));
+		snprintf(config.key, sizeof (config.key), BENCHMARK_KEY);
+		snprintf(config.value, sizeof (config.value), "1");
+		if (db_add_config(p_ps, &config) != DB_SUCCESS)
+		{
+			rc = -1;
+		}
+		else if (wal && db_set_wal_mode(p_ps, 1000) != DB_SUCCESS)
+		{
+			printf("Failed to switch %s to WAL mode\n", path);
+			rc = -1;
+		}
+		free_PersistentStore(&p_ps);
+	}
+	return rc;
+}
+
+/*
+ * Store events in transactions until the deadline, like the event monitor does
+ */
+static void run_writer(const char *path, const unsigned long long deadline,
+		struct process_result *p_result)
+{
+	PersistentStore *p_ps = open_PersistentStore(path);
+	if (p_ps == NULL)
+	{
+		p_result->rc = -1;
+	}
+	else
+	{
+		struct db_event event;
+		memset(&event, 0, sizeof (event));
+		event.type = EVENT_TYPE_HEALTH;
+		while (get_time_usec() < deadline && p_result->rc == 0)
+		{
+			db_begin_transaction(p_ps);
+			for (int i = 0; i < BENCHMARK_EVENTS_PER_TRANSACTION; i++)
+			{
+				event.id = 0;
+				event.time = time(NULL);
+				db_add_event(p_ps, &event);
+			}
+			if (db_end_transaction(p_ps) != DB_SUCCESS)
+			{
+				p_result->rc = -1;
+			}
+			p_result->operations++;
+		}
+		free_PersistentStore(&p_ps);
+	}
+}
+
+/*
+ * Look up a config value until the deadline, like get_config_value does
+ */
+static void run_reader(const char *path, const int wal, const unsigned long long deadline,
+		struct process_result *p_result)
+{
+	unsigned long long *p_samples = calloc(BENCHMARK_MAX_SAMPLES, sizeof (unsigned long long));
+	PersistentStore *p_ps = wal ? open_PersistentStore_readonly(path) : open_PersistentStore(path);
+	if (p_ps == NULL || p_samples == NULL)
+	{
+		p_result->rc = -1;
+	}
+	else
+	{
+		struct db_config config;
+		while (get_time_usec() < deadline && p_result->rc == 0 &&
+				p_result->operations < BENCHMARK_MAX_SAMPLES)
+		{
+			unsigned long long start = get_time_usec();
+			if (db_get_config_by_key(p_ps, BENCHMARK_KEY, &config) != DB_SUCCESS)
+			{
+				p_result->rc = -1;
+			}
+			p_samples[p_result->operations++] = get_time_usec() - start;
+		}
+
+		if (p_result->operations > 0)
+		{
+			qsort(p_samples, p_result->operations, sizeof (unsigned long long), compare_usec);
+			p_result->p50_usec = p_samples[p_result->operations / 2];
+			p_result->p99_usec = p_samples[(p_result->operations * 99) / 100];
+			p_result->max_usec = p_samples[p_result->operations - 1];
+		}
+	}
+	if (p_ps)
+	{
+		free_PersistentStore(&p_ps);
+	}
+	free(p_samples);
+}
+
+/*
+ * Fork a process running the writer or a reader, it reports back through p_fd
+ */
+static pid_t start_process(const char *path, const int wal, const int writer,
+		const unsigned long long deadline, int *p_fd)
+{
+	int fds[2];
+	pid_t pid = -1;
+	if (pipe(fds) == 0)
+	{
+		pid = fork();
+		if (pid == 0)
+		{
+			struct process_result result;
+			memset(&result, 0, sizeof (result));
+			close(fds[0]);
+			if (writer)
+			{
+				run_writer(path, deadline, &result);
+			}
+			else
+			{
+				run_reader(path, wal, deadline, &result);
+			}
+			ssize_t written = write(fds[1], &result, sizeof (result));
+			close(fds[1]);
+			_exit(written == sizeof (result) ? 0 : 1);
+		}
+		close(fds[1]);
+		*p_fd = fds[0];
+	}
+	return pid;
+}
+
+static int collect_process(const pid_t pid, const int fd, struct process_result *p_result)
+{
+	int status = 0;
+	memset(p_result, 0, sizeof (*p_result));
+	if (read(fd, p_result, sizeof (*p_result)) != sizeof (*p_result))
+	{
+		p_result->rc = -1;
+	}
+	close(fd);
+	waitpid(pid, &status, 0);
+	return p_result->rc;
+}
+
+static int run(const char *path, const int wal, const int reader_count)
+{
+	int rc = create_database(path, wal);
+	if (rc == 0)
+	{
+		pid_t pids[BENCHMARK_MAX_READERS + 1];
+		int fds[BENCHMARK_MAX_READERS + 1];
+		int started = 0;
+		unsigned long long deadline = get_time_usec() + BENCHMARK_DURATION_MSEC * 1000ull;
+
+		// process 0 is the writer
+		for (int i = 0; i <= reader_count && rc == 0; i++)
+		{
+			pids[i] = start_process(path, wal, i == 0, deadline, &fds[i]);
+			if (pids[i] < 0)
+			{
+				rc = -1;
+			}
+			else
+			{
+				started++;
+			}
+		}
+
+		struct process_result writer;
+		unsigned long long reads = 0;
+		unsigned long long worst_p50 = 0;
+		unsigned long long worst_p99 = 0;
+		unsigned long long worst_max = 0;
+		for (int i = 0; i < started; i++)
+		{
+			struct process_result result;
+			if (collect_process(pids[i], fds[i], &result) != 0)
+			{
+				rc = -1;
+			}
+			else if (i == 0)
+			{
+				writer = result;
+			}
+			else
+			{
+				reads += result.operations;
+				worst_p50 = result.p50_usec > worst_p50 ? result.p50_usec : worst_p50;
+				worst_p99 = result.p99_usec > worst_p99 ? result.p99_usec : worst_p99;
+				worst_max = result.max_usec > worst_max ? result.max_usec : worst_max;
+			}
+		}
+
+		if (rc == 0)
+		{
+			printf("%-6s %8d %12d %12llu %10llu %10llu %10llu\n",
+					wal ? "wal" : "delete", reader_count, writer.operations,
+					reads * 1000 / BENCHMARK_DURATION_MSEC, worst_p50, worst_p99, worst_max);
+		}
+	}
+	remove_database(path);
+	return rc;
+}
+
+int main(int argc, char **argv)
+{
+	const char *path = DEFAULT_DB_PATH;
+	if (argc > 1)
+	{
+		path = argv[1];
+	}
+
+	printf("%-6s %8s %12s %12s %10s %10s %10s\n", "mode", "readers", "commits",
+			"reads/s", "p50 (us)", "p99 (us)", "max (us)");
+	int rc = 0;
+	for (int wal = 0; wal <= 1 && rc == 0; wal++)
+	{
+		for (int readers = 1; readers <= BENCHMARK_MAX_READERS && rc == 0; readers *= 2)
+		{
+			rc = run(path, wal, readers);
+		}
+	}
+
+	if (rc != 0)
+	{
+		printf("FAILED\n");
+	}
+	return rc == 0 ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Stress test for clearing stored diagnostic results. The event table is filled
+ * with an increasing number of quick diagnostic events spread over the DIMMs, up
+ * to 100k, and the results of one DIMM and then of all DIMMs are cleared with the
+ * DELETE statements diag_clear_results uses. The old way of loading every event
+ * of the type and deleting the matches one at a time is timed alongside, with its
+ * rows on the heap instead of the stack. Clearing should scale linearly.
+ *
+ * Usage: diag_clear_benchmark [database path]
+ */
+
+#include <persistence/schema.h>
+#include <nvm_management.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define	BENCHMARK_DEVICES	NVM_MAX_DEVICES_PER_SOCKET
+#define	BENCHMARK_MAX_EVENTS	100000
+#define	DEFAULT_DB_PATH	"diag_clear_benchmark.db"
+
+static unsigned long long get_time_nsec()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static void make_guid_str(NVM_GUID_STR guid_str, const int index)
+{
+	snprintf(guid_str, NVM_GUIDSTR_LEN, "be%02x0000-0000-0000-0000-000000000000", index);
+}
+
+static int add_events(PersistentStore *p_ps, const int count)
+{
+	int rc = 0;
+	struct db_event event;
+	memset(&event, 0, sizeof (event));
+	event.type = EVENT_TYPE_DIAG_QUICK;
+	event.diag_result = DIAGNOSTIC_RESULT_OK;
+
+	db_begin_transaction(p_ps);
+	for (int i = 0; i < count && rc == 0; i++)
+	{
+		event.id = i + 1;
+		event.time = i;
+		make_guid_str(event.guid, i % BENCHMARK_DEVICES);
+		if (db_add_event(p_ps, &event) != DB_SUCCESS)
+		{
+			rc = -1;
+		}
+	}
+	if (db_end_transaction(p_ps) != DB_SUCCESS)
+	{
+		rc = -1;
+	}
+	return rc;
+}
+
+/*
+ * The row by row clear diag_clear_results used to do
+ */
+static int clear_device_by_rows(PersistentStore *p_ps, const char *guid_str)
+{
+	int rc = 0;
+	int count = 0;
+	db_get_event_count_by_event_type_type(p_ps, EVENT_TYPE_DIAG_QUICK, &count);
+	struct db_event *p_events = calloc(count, sizeof (struct db_event));
+	if (p_events == NULL)
+	{
+		rc = -1;
+	}
+	else
+	{
+		db_get_events_by_event_type_type(p_ps, EVENT_TYPE_DIAG_QUICK, p_events, count);
+		for (int i = 0; i < count; i++)
+		{
+			if (strncmp(p_events[i].guid, guid_str, EVENT_GUID_LEN) == 0 &&
+					db_delete_event_by_id(p_ps, p_events[i].id) != DB_SUCCESS)
+			{
+				rc = -1;
+			}
+		}
+		free(p_events);
+	}
+	return rc;
+}
+
+/*
+ * Number of the events added by add_events that belong to a device
+ */
+static int get_device_event_count(const int event_count, const int device_index)
+{
+	return (event_count + BENCHMARK_DEVICES - 1 - device_index) / BENCHMARK_DEVICES;
+}
+
+static int get_event_count(PersistentStore *p_ps)
+{
+	int count = -1;
+	db_get_event_count_by_event_type_type(p_ps, EVENT_TYPE_DIAG_QUICK, &count);
+	return count;
+}
+
+static int run(const char *path, const int event_count)
+{
+	int rc = 0;
+	PersistentStore *p_ps = create_PersistentStore(path, 1);
+	if (p_ps == NULL)
+	{
+		printf("Failed to create the database %s\n", path);
+		rc = -1;
+	}
+	else
+	{
+		NVM_GUID_STR guid_str;
+		int remaining = event_count;
+
+		unsigned long long start = get_time_nsec();
+		rc = add_events(p_ps, event_count);
+		double add_msec = (get_time_nsec() - start) / 1e6;
+
+		// the old row by row clear of one device
+		make_guid_str(guid_str, 0);
+		start = get_time_nsec();
+		if (rc == 0)
+		{
+			rc = clear_device_by_rows(p_ps, guid_str);
+		}
+		double rows_msec = (get_time_nsec() - start) / 1e6;
+		remaining -= get_device_event_count(event_count, 0);
+		if (rc == 0 && get_event_count(p_ps) != remaining)
+		{
+			printf("Row by row clear left the wrong number of events\n");
+			rc = -1;
+		}
+
+		// the DELETE by type and guid of another device
+		make_guid_str(guid_str, 1);
+		start = get_time_nsec();
+		if (rc == 0 && db_delete_events_by_type_guid(p_ps, EVENT_TYPE_DIAG_QUICK,
+				guid_str) != DB_SUCCESS)
+		{
+			rc = -1;
+		}
+		double device_msec = (get_time_nsec() - start) / 1e6;
+		remaining -= get_device_event_count(event_count, 1);
+		if (rc == 0 && get_event_count(p_ps) != remaining)
+		{
+			printf("Clearing one device left the wrong number of events\n");
+			rc = -1;
+		}
+
+		// the DELETE by type of everything left
+		start = get_time_nsec();
+		if (rc == 0 && db_delete_event_by_event_type_type(p_ps,
+				EVENT_TYPE_DIAG_QUICK) != DB_SUCCESS)
+		{
+			rc = -1;
+		}
+		double all_msec = (get_time_nsec() - start) / 1e6;
+		if (rc == 0 && get_event_count(p_ps) != 0)
+		{
+			printf("Clearing all devices left events behind\n");
+			rc = -1;
+		}
+
+		if (rc == 0)
+		{
+			printf("%8d %12.1f %14.1f %14.1f %12.1f %12.0f\n",
+					event_count, add_msec, rows_msec, device_msec, all_msec,
+					all_msec * 1e6 / remaining);
+		}
+		free_PersistentStore(&p_ps);
+	}
+	return rc;
+}
+
+int main(int argc, char **argv)
+{
+	const char *path = DEFAULT_DB_PATH;
+	if (argc > 1)
+	{
+		path = argv[1];
+	}
+
+	printf("%8s %12s %14s %14s %12s %12s\n", "events", "store (ms)",
+			"rows/DIMM (ms)", "DELETE/DIMM", "DELETE all", "ns/event");
+	int rc = 0;
+	for (int event_count = BENCHMARK_MAX_EVENTS / 8;
+			event_count <= BENCHMARK_MAX_EVENTS && rc == 0; event_count *= 2)
+	{
+		rc = run(path, event_count);
+	}
+	remove(path);
+
+	if (rc != 0)
+	{
+		printf("FAILED\n");
+	}
+	return rc == 0 ? 0 : 1;
+}
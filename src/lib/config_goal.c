@@ -692,6 +692,52 @@ int update_config_goal(const struct device_discovery *p_discovery,
 	return rc;
 }
 
+/*
+ * Verify a config goal can be applied to the specified NVM-DIMM.
+ */
+int validate_device_for_config_goal(const NVM_GUID device_guid,
+		const struct config_goal *p_goal,
+		const struct nvm_capabilities *p_capabilities,
+		struct device_discovery *p_discovery)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	if ((rc = exists_and_manageable(device_guid, p_discovery, 1)) == NVM_SUCCESS)
+	{
+		// Check that no namespaces exist on this DIMM
+		if ((rc = dimm_has_namespaces_of_type(p_discovery->device_handle,
+				NAMESPACE_TYPE_UNKNOWN)) != 0)
+		{
+			if (rc > 0)
+			{
+				rc = NVM_ERR_NAMESPACESEXIST;
+			}
+		}
+		else
+		{
+			rc = validate_config_goal(p_goal, p_capabilities, p_discovery);
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Log an event indicating we successfully applied the goal
+ */
+void log_config_goal_created(const NVM_GUID device_guid)
+{
+	NVM_EVENT_ARG guid_arg;
+	guid_to_event_arg(device_guid, guid_arg);
+	log_mgmt_event(EVENT_SEVERITY_INFO,
+			EVENT_CODE_MGMT_CONFIG_GOAL_CREATED,
+			device_guid,
+			0, // no action required
+			guid_arg, NULL, NULL);
+}
+
 /*
  * Provision the capacity of the specified NVM-DIMM into one or more pools.
  */
@@ -728,34 +774,188 @@ int nvm_create_config_goal(const NVM_GUID device_guid,
 				COMMON_LOG_ERROR("Invalid parameter, p_goal is NULL");
 				rc = NVM_ERR_INVALIDPARAMETER;
 			}
-			else if ((rc = exists_and_manageable(device_guid, &discovery, 1)) == NVM_SUCCESS)
+			else if ((rc = validate_device_for_config_goal(device_guid, p_goal,
+					&capabilities, &discovery)) == NVM_SUCCESS)
 			{
-				// Check that no namespaces exist on this DIMM
-				if ((rc = dimm_has_namespaces_of_type(discovery.device_handle,
-						NAMESPACE_TYPE_UNKNOWN)) != 0)
+				rc = update_config_goal(&discovery, p_goal, &capabilities);
+				if (rc == NVM_SUCCESS)
 				{
-					if (rc > 0)
-					{
-						rc = NVM_ERR_NAMESPACESEXIST;
-					}
+					log_config_goal_created(device_guid);
 				}
-				else if ((rc = validate_config_goal(p_goal, &capabilities, &discovery))
-						== NVM_SUCCESS)
+			}
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Restore the platform config data captured before a batch of goals was written
+ * to every DIMM that already received its goal.
+ */
+void rollback_config_goals(struct device_config_goal *p_goals,
+		const struct device_discovery *p_discoveries,
+		struct platform_config_data **pp_snapshots,
+		const NVM_UINT32 count)
+{
+	COMMON_LOG_ENTRY();
+
+	for (NVM_UINT32 i = 0; i < count; i++)
+	{
+		if (p_goals[i].goal_applied)
+		{
+			int restore_rc = set_dimm_platform_config(p_discoveries[i].device_handle,
+					pp_snapshots[i]);
+			if (restore_rc == NVM_SUCCESS)
+			{
+				p_goals[i].goal_applied = 0;
+			}
+			else
+			{
+				// the goal is left on the DIMM, report why it couldn't be removed
+				COMMON_LOG_ERROR_F("Failed to restore the platform config data on "
+						"device handle %u, rc = %d",
+						p_discoveries[i].device_handle.handle, restore_rc);
+				p_goals[i].rc = restore_rc;
+			}
+		}
+	}
+
+	COMMON_LOG_EXIT();
+}
+
+/*
+ * Validate and write a batch of goals, restoring the original platform config data
+ * of every DIMM if any write fails.
+ */
+int create_config_goals(struct device_config_goal *p_goals, const NVM_UINT32 count,
+		const struct nvm_capabilities *p_capabilities,
+		struct device_discovery *p_discoveries,
+		struct platform_config_data **pp_snapshots)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	// Validate every goal before any DIMM is touched
+	for (NVM_UINT32 i = 0; i < count && rc == NVM_SUCCESS; i++)
+	{
+		for (NVM_UINT32 j = 0; j < i; j++)
+		{
+			if (memcmp(p_goals[i].device_guid, p_goals[j].device_guid, NVM_GUID_LEN) == 0)
+			{
+				COMMON_LOG_ERROR("Invalid parameter, more than one goal for the same device");
+				p_goals[i].rc = NVM_ERR_INVALIDPARAMETER;
+				break;
+			}
+		}
+		if (p_goals[i].rc == NVM_SUCCESS)
+		{
+			p_goals[i].rc = validate_device_for_config_goal(p_goals[i].device_guid,
+					&p_goals[i].goal, p_capabilities, &p_discoveries[i]);
+		}
+		rc = p_goals[i].rc;
+	}
+
+	// Snapshot the current platform config data so the batch can be undone
+	for (NVM_UINT32 i = 0; i < count && rc == NVM_SUCCESS; i++)
+	{
+		p_goals[i].rc = get_dimm_platform_config(p_discoveries[i].device_handle,
+				&pp_snapshots[i]);
+		rc = p_goals[i].rc;
+	}
+
+	for (NVM_UINT32 i = 0; i < count && rc == NVM_SUCCESS; i++)
+	{
+		p_goals[i].rc = update_config_goal(&p_discoveries[i], &p_goals[i].goal,
+				p_capabilities);
+		if (p_goals[i].rc == NVM_SUCCESS)
+		{
+			p_goals[i].goal_applied = 1;
+		}
+		rc = p_goals[i].rc;
+	}
+
+	if (rc != NVM_SUCCESS)
+	{
+		rollback_config_goals(p_goals, p_discoveries, pp_snapshots, count);
+	}
+	else
+	{
+		for (NVM_UINT32 i = 0; i < count; i++)
+		{
+			log_config_goal_created(p_goals[i].device_guid);
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Provision the capacity of several NVM-DIMMs as a single operation.
+ */
+int nvm_create_config_goals(struct device_config_goal *p_goals, const NVM_UINT32 count)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	if (check_caller_permissions() != COMMON_SUCCESS)
+	{
+		rc = NVM_ERR_INVALIDPERMISSIONS;
+	}
+	else if (p_goals == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_goals is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (count == 0)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, count is 0");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else
+	{
+		for (NVM_UINT32 i = 0; i < count; i++)
+		{
+			p_goals[i].rc = NVM_SUCCESS;
+			p_goals[i].goal_applied = 0;
+		}
+
+		// Get system capabilities so we can validate
+		struct nvm_capabilities capabilities;
+		rc = nvm_get_nvm_capabilities(&capabilities);
+		if (rc == NVM_SUCCESS && !capabilities.nvm_features.modify_device_capacity)
+		{
+			COMMON_LOG_WARN("Modifying device capacity is not supported.");
+			rc = NVM_ERR_NOTSUPPORTED;
+		}
+		else if (rc == NVM_SUCCESS)
+		{
+			struct device_discovery *p_discoveries =
+					calloc(count, sizeof (struct device_discovery));
+			struct platform_config_data **pp_snapshots =
+					calloc(count, sizeof (struct platform_config_data *));
+			if (p_discoveries == NULL || pp_snapshots == NULL)
+			{
+				COMMON_LOG_ERROR("Failed to allocate memory for the config goals");
+				rc = NVM_ERR_NOMEMORY;
+			}
+			else
+			{
+				rc = create_config_goals(p_goals, count, &capabilities,
+						p_discoveries, pp_snapshots);
+			}
+
+			if (pp_snapshots)
+			{
+				for (NVM_UINT32 i = 0; i < count; i++)
 				{
-					rc = update_config_goal(&discovery, p_goal, &capabilities);
-					if (rc == NVM_SUCCESS)
-					{
-						// Log an event indicating we successfully applied the goal
-						NVM_EVENT_ARG guid_arg;
-						guid_to_event_arg(device_guid, guid_arg);
-						log_mgmt_event(EVENT_SEVERITY_INFO,
-								EVENT_CODE_MGMT_CONFIG_GOAL_CREATED,
-								device_guid,
-								0, // no action required
-								guid_arg, NULL, NULL);
-					}
+					free(pp_snapshots[i]);
 				}
+				free(pp_snapshots);
 			}
+			free(p_discoveries);
 		}
 	}
 
@@ -583,8 +583,6 @@ int ioctl_passthrough_cmd(struct fw_cmd *p_cmd);
  */
 int get_dimm_power_limited(NVM_UINT16 socket_id);
 
-int get_job_count();
-
 /*
  * Get the expected result count of a test run
  */
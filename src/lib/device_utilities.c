@@ -897,3 +897,37 @@ int dimm_has_namespaces_of_type(const NVM_NFIT_DEVICE_HANDLE dimm_handle,
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
+
+void run_device_workers(void *(*callback)(void *), void *workers,
+		const size_t worker_size, const NVM_UINT32 worker_count)
+{
+	COMMON_LOG_ENTRY();
+
+	if (worker_count > 0)
+	{
+		COMMON_UINT64 thread_ids[worker_count];
+		NVM_BOOL started[worker_count];
+		for (NVM_UINT32 i = 0; i < worker_count; i++)
+		{
+			void *p_worker = (char *)workers + (i * worker_size);
+			thread_ids[i] = 0;
+			int thread_rc = create_thread(&thread_ids[i], callback, p_worker);
+			started[i] = (thread_rc == 0);
+			if (!started[i])
+			{
+				COMMON_LOG_ERROR_F("Failed to create worker thread %u, error %d. "
+						"Running it on the calling thread.", i, thread_rc);
+				callback(p_worker);
+			}
+		}
+		for (NVM_UINT32 i = 0; i < worker_count; i++)
+		{
+			if (started[i])
+			{
+				join_thread(thread_ids[i]);
+			}
+		}
+	}
+
+	COMMON_LOG_EXIT();
+}
@@ -144,6 +144,14 @@ int get_dimm_capacities(const NVM_NFIT_DEVICE_HANDLE device_handle,
 int dimm_has_namespaces_of_type(const NVM_NFIT_DEVICE_HANDLE dimm_handle,
 		const enum namespace_type ns_type);
 
+/*
+ * Run callback once for each of the worker_count workers in the workers array,
+ * each on its own thread. A worker whose thread can't be created is run on the
+ * calling thread instead. Returns when all of them have finished.
+ */
+void run_device_workers(void *(*callback)(void *), void *workers,
+		const size_t worker_size, const NVM_UINT32 worker_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,9 +34,32 @@
 #include "diagnostic.h"
 #include <persistence/logging.h>
 #include <persistence/lib_persistence.h>
+#include <persistence/event.h>
 #include <string/s_str.h>
 #include <guid/guid.h>
+#include <os/os_adapter.h>
 #include "system.h"
+#include "capabilities.h"
+#include "device_utilities.h"
+
+/*
+ * Upper limit on the threads used to run the quick diagnostic on several devices.
+ * The checks are dominated by passthrough round trips, so allow one per DIMM on a socket.
+ */
+#define	QUICK_DIAGNOSTIC_MAX_THREADS	NVM_MAX_DEVICES_PER_SOCKET
+
+/*
+ * The slice of devices checked by one quick diagnostic thread
+ */
+struct quick_diagnostic_worker
+{
+	const struct diagnostic *p_diagnostic;
+	struct device_quick_diagnostic_result *p_results;
+	NVM_UINT32 count;
+	NVM_UINT32 first; // index of the first device checked by this thread
+	NVM_UINT32 stride; // number of threads
+	struct event_batch events; // events of the devices checked by this thread
+};
 
 /*
  * Run a diagnostic test on the device specified.
@@ -87,6 +110,117 @@ int nvm_run_diagnostic(const NVM_GUID device_guid,
 	return rc;
 }
 
+/*
+ * Thread body checking every stride'th device starting at first
+ */
+void *quick_diagnostic_worker_thread(void *arg)
+{
+	struct quick_diagnostic_worker *p_worker = (struct quick_diagnostic_worker *)arg;
+
+	// keep the events until all devices are done so they can be written at once
+	begin_event_batch(&p_worker->events);
+	for (NVM_UINT32 i = p_worker->first; i < p_worker->count; i += p_worker->stride)
+	{
+		diag_quick_health_check_device(p_worker->p_diagnostic, &p_worker->p_results[i]);
+	}
+	end_event_batch();
+	return NULL;
+}
+
+/*
+ * Run the quick health diagnostic on several devices concurrently.
+ */
+int nvm_run_quick_diagnostics(const struct diagnostic *p_diagnostic,
+		struct device_quick_diagnostic_result *p_results, const NVM_UINT32 count)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	if (p_diagnostic == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_diagnostic is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (p_diagnostic->test != DIAG_TYPE_QUICK)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, only the quick diagnostic can be run on several devices");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (p_results == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_results is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (check_caller_permissions() != NVM_SUCCESS)
+	{
+		rc = NVM_ERR_INVALIDPERMISSIONS;
+	}
+	else if ((rc = IS_NVM_FEATURE_SUPPORTED(quick_diagnostic)) != NVM_SUCCESS)
+	{
+		COMMON_LOG_ERROR("The quick health diagnostic is not supported.");
+	}
+	else if (count > 0)
+	{
+		for (NVM_UINT32 i = 0; i < count; i++)
+		{
+			p_results[i].rc = NVM_ERR_UNKNOWN;
+			p_results[i].results = 0;
+			memset(p_results[i].check_failures, 0, sizeof (p_results[i].check_failures));
+		}
+
+		NVM_UINT32 thread_count = count;
+		if (thread_count > QUICK_DIAGNOSTIC_MAX_THREADS)
+		{
+			thread_count = QUICK_DIAGNOSTIC_MAX_THREADS;
+		}
+
+		struct quick_diagnostic_worker workers[thread_count];
+		memset(workers, 0, sizeof (workers));
+		for (NVM_UINT32 t = 0; t < thread_count; t++)
+		{
+			workers[t].p_diagnostic = p_diagnostic;
+			workers[t].p_results = p_results;
+			workers[t].count = count;
+			workers[t].first = t;
+			workers[t].stride = thread_count;
+		}
+		run_device_workers(quick_diagnostic_worker_thread, workers,
+				sizeof (workers[0]), thread_count);
+
+		// replace the previous results of all devices in one short transaction
+		PersistentStore *p_store = get_lib_store();
+		if (p_store)
+		{
+			db_begin_transaction(p_store);
+		}
+
+		int store_rc = NVM_SUCCESS;
+		for (NVM_UINT32 i = 0; i < count; i++)
+		{
+			diag_clear_results(EVENT_TYPE_DIAG_QUICK, 1, p_results[i].device_guid);
+		}
+		for (NVM_UINT32 t = 0; t < thread_count; t++)
+		{
+			int temprc = store_event_batch(&workers[t].events);
+			KEEP_ERROR(store_rc, temprc);
+		}
+
+		if (p_store && db_end_transaction(p_store) != DB_SUCCESS)
+		{
+			db_rollback_transaction(p_store);
+			store_rc = NVM_ERR_UNKNOWN;
+		}
+		if (store_rc != NVM_SUCCESS)
+		{
+			COMMON_LOG_ERROR("Failed to store the quick diagnostic results");
+			rc = store_rc;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
 /*
  * Perform an integer value compare as part of a diagnostic test
  */
@@ -237,30 +371,24 @@ NVM_BOOL diag_check_str(const struct diagnostic *p_diagnostic,
 void diag_clear_results(const enum diagnostic_test type,
 		const NVM_BOOL clear_specific_device, const NVM_GUID device_guid)
 {
-	int event_count;
 	PersistentStore *p_store = get_lib_store();
 	if (p_store)
 	{
-		db_get_event_count_by_event_type_type(p_store, type, &event_count);
-		struct db_event events[event_count];
-		db_get_events_by_event_type_type(p_store, type, events, event_count);
-		for (int i = 0; i < event_count; i++)
+		enum db_return_codes db_rc = DB_SUCCESS;
+		if (!clear_specific_device)
 		{
-			NVM_BOOL matched = 1;
-			// check for a matching guid is requested
-			if (clear_specific_device)
-			{
-				COMMON_GUID guid;
-				str_to_guid(events[i].guid, guid);
-				if (guid_cmp(guid, device_guid) != 1)
-				{
-					matched = 0;
-				}
-			}
-			if (matched)
-			{
-				db_delete_event_by_id(p_store, events[i].id);
-			}
+			db_rc = db_delete_event_by_event_type_type(p_store, type);
+		}
+		else if (device_guid)
+		{
+			NVM_GUID_STR guid_str;
+			guid_to_str(device_guid, guid_str);
+			db_rc = db_delete_events_by_type_guid(p_store, type, guid_str);
+		}
+
+		if (db_rc != DB_SUCCESS)
+		{
+			COMMON_LOG_ERROR_F("Failed to clear the previous results of diagnostic %d", type);
 		}
 	}
 }
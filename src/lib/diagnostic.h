@@ -81,6 +81,8 @@ void diag_clear_results(const enum diagnostic_test type,
  */
 int diag_quick_health_check(const NVM_GUID device_guid,
 		const struct diagnostic *p_diagnostic, NVM_UINT32 *p_results);
+int diag_quick_health_check_device(const struct diagnostic *p_diagnostic,
+		struct device_quick_diagnostic_result *p_result);
 int diag_security_check(const struct diagnostic *p_diagnostic, NVM_UINT32 *p_results);
 int diag_firmware_check(const struct diagnostic *p_diagnostic, NVM_UINT32 *p_results);
 int diag_platform_config_check(const struct diagnostic *p_diagnostic, NVM_UINT32 *p_results);
@@ -43,6 +43,13 @@
 #include <guid/guid.h>
 #include "device_utilities.h"
 #include "capabilities.h"
+#include <string/x_str.h>
+#include <os/os_adapter.h>
+#include <stdlib.h>
+
+#define	FW_CHECK_MAX_THREADS	NVM_MAX_DEVICES_PER_SOCKET
+#define	FW_CHECK_RULE_DELIMITERS	", \t\n"
+#define	FW_CHECK_RULE_SCOPE_DELIMITER	":"
 
 /*
  * Used in firmware consistency and settings check diagnostic to display
@@ -51,16 +58,285 @@
 static const char *fw_log_level_strings[] =
 { "Disabled", "Error", "Warning", "Info", "Debug", "Unknown" };
 
-void find_optimal_fw_revision(char *optimal_fw_revision, char *model_number,
-		const struct device_discovery *p_dimms, int dev_count);
 int get_fw_system_time(NVM_NFIT_DEVICE_HANDLE dimm_handle,
 		struct pt_payload_system_time *payload);
+int get_fw_log_level(NVM_NFIT_DEVICE_HANDLE dimm_handle, enum fw_log_level *p_log_level);
 
 extern int get_fw_power_mgmt_policy(NVM_NFIT_DEVICE_HANDLE dimm_handle,
 		struct pt_payload_power_mgmt_policy *payload);
 extern int get_fw_die_spare_policy(NVM_NFIT_DEVICE_HANDLE dimm_handle,
 		struct pt_get_die_spare_policy *payload);
 
+/*
+ * The firmware settings of one DIMM.
+ * All of them are collected before any rule is checked.
+ */
+struct fw_settings
+{
+	struct device_discovery discovery;
+	NVM_GUID_STR guid_str;
+	NVM_BOOL manageable;
+	int sensors_rc;
+	struct sensor sensors[NVM_MAX_DEVICE_SENSORS];
+	int log_level_rc;
+	enum fw_log_level log_level;
+	int time_rc;
+	time_t host_time; // host time when the DIMM time was read
+	struct pt_payload_system_time time;
+	int power_rc;
+	struct pt_payload_power_mgmt_policy power;
+	int spare_rc;
+	struct pt_get_die_spare_policy spare;
+};
+
+/*
+ * The slice of DIMMs whose settings are collected by one thread
+ */
+struct fw_settings_worker
+{
+	const struct diagnostic *p_diagnostic;
+	struct fw_settings *p_settings;
+	int count;
+	int first; // index of the first DIMM collected by this thread
+	int stride; // number of threads
+};
+
+/*
+ * The best practice values the settings are checked against
+ */
+struct fw_check_defaults
+{
+	NVM_REAL32 max_temp_threshold;
+	char temp_threshold_str[NVM_EVENT_ARG_LEN];
+	NVM_UINT64 min_spare_block_threshold;
+	char spare_block_threshold_str[NVM_EVENT_ARG_LEN];
+	int log_level;
+	char log_level_str[NVM_EVENT_ARG_LEN];
+	int time_drift;
+	NVM_UINT64 tdp_power_min;
+	NVM_UINT64 tdp_power_max;
+	char tdp_power_range_str[NVM_EVENT_ARG_LEN];
+	NVM_UINT64 peak_power_budget_min;
+	NVM_UINT64 peak_power_budget_max;
+	char peak_power_budget_range_str[NVM_EVENT_ARG_LEN];
+	NVM_UINT64 avg_power_budget_min;
+	NVM_UINT64 avg_power_budget_max;
+	char avg_power_budget_range_str[NVM_EVENT_ARG_LEN];
+	NVM_UINT64 die_sparing_level;
+	char die_sparing_level_str[NVM_EVENT_ARG_LEN];
+};
+
+/*
+ * A check run over the settings of all DIMMs, returning the number of events logged
+ */
+typedef NVM_UINT32 (*fw_check_rule)(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count);
+
+NVM_UINT32 check_fw_revisions(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count);
+NVM_UINT32 check_fw_sensor_thresholds(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count);
+NVM_UINT32 check_fw_log_level(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count);
+NVM_UINT32 check_fw_system_time(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count);
+NVM_UINT32 check_fw_power_mgmt_policy(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count);
+NVM_UINT32 check_fw_die_sparing_policy(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count);
+NVM_UINT32 check_fw_site_rules(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count);
+
+/*
+ * The rules of the firmware consistency and settings check, in the order they are run.
+ * A rule is skipped when the caller excludes its threshold.
+ */
+static const struct
+{
+	NVM_UINT64 exclude;
+	fw_check_rule check;
+} fw_check_rules[] =
+{
+	{ DIAG_THRESHOLD_FW_CONSISTENT, check_fw_revisions },
+	{ 0, check_fw_sensor_thresholds }, // each threshold is excluded on its own
+	{ DIAG_THRESHOLD_FW_DEBUGLOG, check_fw_log_level },
+	{ DIAG_THRESHOLD_FW_TIME, check_fw_system_time },
+	{ DIAG_THRESHOLD_FW_POW_MGMT_POLICY, check_fw_power_mgmt_policy },
+	{ DIAG_THRESHOLD_FW_DIE_SPARING_POLICY, check_fw_die_sparing_policy },
+	{ DIAG_THRESHOLD_FW_SITE_RULES, check_fw_site_rules }
+};
+
+/*
+ * A setting is only read from the DIMMs if a check using it isn't excluded
+ */
+#define	FW_CHECK_SENSOR_THRESHOLDS	(DIAG_THRESHOLD_FW_MEDIA_TEMP | \
+		DIAG_THRESHOLD_FW_CONTROLLER_TEMP | DIAG_THRESHOLD_FW_SPARE)
+
+static NVM_BOOL fw_setting_is_checked(const NVM_UINT64 excludes, const NVM_UINT64 checks)
+{
+	return (excludes & checks) != checks;
+}
+
+/*
+ * Read the settings of every stride'th DIMM starting at first
+ */
+void *fw_settings_worker_thread(void *arg)
+{
+	struct fw_settings_worker *p_worker = (struct fw_settings_worker *)arg;
+	NVM_UINT64 excludes = p_worker->p_diagnostic->excludes;
+	for (int i = p_worker->first; i < p_worker->count; i += p_worker->stride)
+	{
+		struct fw_settings *p_settings = &p_worker->p_settings[i];
+		if (p_settings->manageable)
+		{
+			NVM_NFIT_DEVICE_HANDLE handle = p_settings->discovery.device_handle;
+			if (fw_setting_is_checked(excludes, FW_CHECK_SENSOR_THRESHOLDS))
+			{
+				p_settings->sensors_rc = nvm_get_sensors(p_settings->discovery.guid,
+						p_settings->sensors, NVM_MAX_DEVICE_SENSORS);
+			}
+			if (fw_setting_is_checked(excludes,
+					DIAG_THRESHOLD_FW_DEBUGLOG | DIAG_THRESHOLD_FW_SITE_RULES))
+			{
+				p_settings->log_level_rc = get_fw_log_level(handle, &p_settings->log_level);
+			}
+			if (fw_setting_is_checked(excludes, DIAG_THRESHOLD_FW_TIME))
+			{
+				p_settings->host_time = time(0);
+				p_settings->time_rc = get_fw_system_time(handle, &p_settings->time);
+			}
+			if (fw_setting_is_checked(excludes,
+					DIAG_THRESHOLD_FW_POW_MGMT_POLICY | DIAG_THRESHOLD_FW_SITE_RULES))
+			{
+				p_settings->power_rc = get_fw_power_mgmt_policy(handle, &p_settings->power);
+			}
+			if (fw_setting_is_checked(excludes,
+					DIAG_THRESHOLD_FW_DIE_SPARING_POLICY | DIAG_THRESHOLD_FW_SITE_RULES))
+			{
+				p_settings->spare_rc = get_fw_die_spare_policy(handle, &p_settings->spare);
+			}
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Collect the firmware settings of all DIMMs at once
+ */
+void collect_fw_settings(const struct diagnostic *p_diagnostic,
+		const struct device_discovery *p_dimms, struct fw_settings *p_settings,
+		const int count)
+{
+	COMMON_LOG_ENTRY();
+
+	memset(p_settings, 0, sizeof (struct fw_settings) * count);
+	for (int i = 0; i < count; i++)
+	{
+		memmove(&p_settings[i].discovery, &p_dimms[i], sizeof (struct device_discovery));
+		guid_to_str(p_dimms[i].guid, p_settings[i].guid_str);
+		p_settings[i].manageable = (p_dimms[i].manageability == MANAGEMENT_VALIDCONFIG);
+	}
+
+	int thread_count = count;
+	if (thread_count > FW_CHECK_MAX_THREADS)
+	{
+		thread_count = FW_CHECK_MAX_THREADS;
+	}
+
+	struct fw_settings_worker workers[thread_count];
+	for (int t = 0; t < thread_count; t++)
+	{
+		workers[t].p_diagnostic = p_diagnostic;
+		workers[t].p_settings = p_settings;
+		workers[t].count = count;
+		workers[t].first = t;
+		workers[t].stride = thread_count;
+	}
+	run_device_workers(fw_settings_worker_thread, workers,
+			sizeof (struct fw_settings_worker), thread_count);
+
+	COMMON_LOG_EXIT();
+}
+
+/*
+ * Read the best practice values from the config database
+ */
+void get_fw_check_defaults(struct fw_check_defaults *p_defaults)
+{
+	COMMON_LOG_ENTRY();
+	memset(p_defaults, 0, sizeof (struct fw_check_defaults));
+
+	// get default temperature and spare capacity thresholds
+	char max_threshold_str[CONFIG_VALUE_LEN];
+	get_config_value(SQL_KEY_DEFAULT_TEMPERATURE_THRESHOLD, max_threshold_str);
+	p_defaults->max_temp_threshold = strtof(max_threshold_str, NULL);
+	s_snprintf(p_defaults->temp_threshold_str, NVM_EVENT_ARG_LEN, "%.4f",
+			p_defaults->max_temp_threshold);
+
+	int min_spare_block_threshold = 0;
+	get_config_value_int(SQL_KEY_DEFAULT_SPARE_BLOCK_THRESHOLD, &min_spare_block_threshold);
+	s_snprintf(p_defaults->spare_block_threshold_str, NVM_EVENT_ARG_LEN, "%u",
+			min_spare_block_threshold);
+	p_defaults->min_spare_block_threshold = min_spare_block_threshold;
+
+	// get default FW debug log level
+	get_config_value_int(SQL_KEY_FW_LOG_LEVEL, &p_defaults->log_level);
+	if (p_defaults->log_level >= 0 && p_defaults->log_level <= FW_LOG_LEVEL_UNKNOWN)
+	{
+		s_strcpy(p_defaults->log_level_str, fw_log_level_strings[p_defaults->log_level],
+				NVM_EVENT_ARG_LEN);
+	}
+	else
+	{
+		s_strcpy(p_defaults->log_level_str, fw_log_level_strings[FW_LOG_LEVEL_UNKNOWN],
+				NVM_EVENT_ARG_LEN);
+	}
+
+	// get default reasonable time drift
+	get_config_value_int(SQL_KEY_DEFAULT_TIME_DRIFT, &p_defaults->time_drift);
+
+	// get default current TDP power, peak power budget, avg power budget min/max's
+	int min = 0;
+	int max = 0;
+	get_config_value_int(SQL_KEY_DEFAULT_TDP_POW_MIN, &min);
+	get_config_value_int(SQL_KEY_DEFAULT_TDP_POW_MAX, &max);
+	s_snprintf(p_defaults->tdp_power_range_str, NVM_EVENT_ARG_LEN, "[%d - %d] W", min, max);
+	p_defaults->tdp_power_min = min;
+	p_defaults->tdp_power_max = max;
+
+	min = max = 0;
+	get_config_value_int(SQL_KEY_DEFAULT_PEAK_POW_BUDGET_MIN, &min);
+	get_config_value_int(SQL_KEY_DEFAULT_PEAK_POW_BUDGET_MAX, &max);
+	s_snprintf(p_defaults->peak_power_budget_range_str, NVM_EVENT_ARG_LEN,
+			"[%d - %d] mW.", min, max);
+	p_defaults->peak_power_budget_min = min;
+	p_defaults->peak_power_budget_max = max;
+
+	min = max = 0;
+	get_config_value_int(SQL_KEY_DEFAULT_AVG_POW_BUDGET_MIN, &min);
+	get_config_value_int(SQL_KEY_DEFAULT_AVG_POW_BUDGET_MAX, &max);
+	s_snprintf(p_defaults->avg_power_budget_range_str, NVM_EVENT_ARG_LEN,
+			"[%d - %d] mW.", min, max);
+	p_defaults->avg_power_budget_min = min;
+	p_defaults->avg_power_budget_max = max;
+
+	// get default die sparing policy aggressiveness
+	int die_sparing_level = 0;
+	get_config_value_int(SQL_KEY_DEFAULT_DIE_SPARING_AGGRESSIVENESS, &die_sparing_level);
+	s_snprintf(p_defaults->die_sparing_level_str, NVM_EVENT_ARG_LEN, "%d", die_sparing_level);
+	p_defaults->die_sparing_level = die_sparing_level;
+
+	COMMON_LOG_EXIT();
+}
+
 /*
  * Run the firmware consistency and settings check diagnostic algorithm
  */
@@ -95,457 +371,40 @@ int diag_firmware_check(const struct diagnostic *p_diagnostic, NVM_UINT32 *p_res
 
 			if (dev_count > 0)
 			{
-				if (!(p_diagnostic->excludes & DIAG_THRESHOLD_FW_CONSISTENT))
-				{
-					// construct an array of model numbers
-					char model_list[NVM_MAX_TOPO_SIZE][NVM_MODEL_LEN] = {};
-					int model_count = 0;
-					NVM_BOOL model_exists = 0;
-					for (int dev_index = 0; dev_index < dev_count; dev_index++)
-					{
-						for (int model_index = 0; model_index < model_count; model_index++)
-						{
-							if (strncmp(model_list[model_index], dimms[dev_index].model_number,
-									NVM_MODEL_LEN) == 0)
-							{
-								model_exists = 1;
-								break;
-							}
-							model_exists = 0;
-						}
-						if (model_exists == 0)
-						{
-							s_strncpy(model_list[model_count], NVM_MODEL_LEN,
-									dimms[dev_index].model_number, NVM_MODEL_LEN);
-							model_count++;
-						}
-					}
-
-					// get optimal FW revision per model number
-					NVM_VERSION optimal_fw_rev[model_count];
-					for (int current_model = 0; current_model < model_count; current_model++)
-					{
-						find_optimal_fw_revision(optimal_fw_rev[current_model],
-								model_list[current_model], dimms, dev_count);
-					}
-
-					// compare firmware revisions of dimms having the same model number
-					char inconsistent_guids_event_str[NVM_EVENT_ARG_LEN] = {0};
-					NVM_BOOL inconsistency_flag = 0;
-					for (int model_num = 0; model_num < model_count; model_num++)
-					{
-						for (int dev_num = 0; dev_num < dev_count; dev_num++)
-						{
-							if (strncmp(model_list[model_num], dimms[dev_num].model_number,
-									NVM_MODEL_LEN) == 0)
-							{
-								if (strncmp(optimal_fw_rev[model_num],
-										dimms[dev_num].fw_revision, NVM_VERSION_LEN) != 0)
-								{
-									NVM_GUID_STR guid_str;
-									guid_to_str(dimms[dev_num].guid, guid_str);
-									s_strcat(guid_str, (NVM_GUIDSTR_LEN + 2), ", ");
-									s_strcat(inconsistent_guids_event_str,
-											NVM_EVENT_ARG_LEN, guid_str);
-									inconsistency_flag = 1;
-								}
-							}
-						}
-						// log an event per model number if fw version is inconsistent
-						if (inconsistency_flag)
-						{
-							store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
-									EVENT_SEVERITY_WARN,
-									EVENT_CODE_DIAG_FW_INCONSISTENT, NULL, 0,
-									inconsistent_guids_event_str,
-									model_list[model_num], optimal_fw_rev[model_num],
-									DIAGNOSTIC_RESULT_FAILED);
-							(*p_results)++;
-						}
-						inconsistency_flag = 0;
-					}
-				}
-
-				// get default temperature and spare capacity thresholds
-				char max_threshold_str[CONFIG_VALUE_LEN];
-				get_config_value(SQL_KEY_DEFAULT_TEMPERATURE_THRESHOLD, max_threshold_str);
-				float max_temp_threshold_config = strtof(max_threshold_str, NULL);
-
-				char expected_temp_threshold_str[NVM_EVENT_ARG_LEN];
-				s_snprintf(expected_temp_threshold_str, NVM_EVENT_ARG_LEN, "%.4f",
-						max_temp_threshold_config);
-
-				int min_spare_block_threshold_config = 0;
-				get_config_value_int(SQL_KEY_DEFAULT_SPARE_BLOCK_THRESHOLD,
-						&min_spare_block_threshold_config);
-				char expected_spare_block_threshold_str[NVM_EVENT_ARG_LEN];
-				s_snprintf(expected_spare_block_threshold_str, NVM_EVENT_ARG_LEN, "%u",
-						min_spare_block_threshold_config);
-				NVM_UINT64 min_spare_block_threshold = min_spare_block_threshold_config;
-
-				// get default FW debug log level
-				int default_log_level = 0;
-				get_config_value_int(SQL_KEY_FW_LOG_LEVEL, &default_log_level);
-				char default_log_level_str[NVM_EVENT_ARG_LEN];
-				if (default_log_level <= FW_LOG_LEVEL_UNKNOWN)
+				// stage 1: one snapshot of the firmware settings of all DIMMs
+				struct fw_settings *p_settings = (struct fw_settings *)
+						calloc(dev_count, sizeof (struct fw_settings));
+				if (!p_settings)
 				{
-					s_snprintf(default_log_level_str, NVM_EVENT_ARG_LEN, "%s",
-							fw_log_level_strings[default_log_level]);
+					COMMON_LOG_ERROR("Not enough memory to collect the firmware settings");
+					rc = NVM_ERR_NOMEMORY;
 				}
 				else
 				{
-					s_strcpy(default_log_level_str,
-							fw_log_level_strings[FW_LOG_LEVEL_UNKNOWN],
-							NVM_EVENT_ARG_LEN);
-				}
+					collect_fw_settings(p_diagnostic, dimms, p_settings, dev_count);
 
-				// get default reasonable time drift
-				int default_time_drift = 0;
-				get_config_value_int(SQL_KEY_DEFAULT_TIME_DRIFT, &default_time_drift);
-				char default_time_drift_str[10];
-				s_snprintf(default_time_drift_str, 10, "%u", default_time_drift);
-
-				// get default current TDP power, peak power budget, avg power budget min/max's
-				int default_tdp_power_min_config = 0;
-				int default_tdp_power_max_config = 0;
-				get_config_value_int(SQL_KEY_DEFAULT_TDP_POW_MIN, &default_tdp_power_min_config);
-				get_config_value_int(SQL_KEY_DEFAULT_TDP_POW_MAX, &default_tdp_power_max_config);
-				char expected_tdp_power_range_str[NVM_EVENT_ARG_LEN];
-				s_snprintf(expected_tdp_power_range_str, NVM_EVENT_ARG_LEN, "[%d - %d] W",
-						default_tdp_power_min_config, default_tdp_power_max_config);
-				NVM_UINT64 default_tdp_power_min = default_tdp_power_min_config;
-				NVM_UINT64 default_tdp_power_max = default_tdp_power_max_config;
-
-				int default_peak_power_budget_min_config = 0;
-				int default_peak_power_budget_max_config = 0;
-				get_config_value_int(SQL_KEY_DEFAULT_PEAK_POW_BUDGET_MIN,
-						&default_peak_power_budget_min_config);
-				get_config_value_int(SQL_KEY_DEFAULT_PEAK_POW_BUDGET_MAX,
-						&default_peak_power_budget_max_config);
-				char expected_peak_power_budget_range_str[NVM_EVENT_ARG_LEN];
-				s_snprintf(expected_peak_power_budget_range_str, NVM_EVENT_ARG_LEN, "[%d - %d] mW.",
-						default_peak_power_budget_min_config, default_peak_power_budget_max_config);
-				NVM_UINT64 default_peak_power_budget_min = default_peak_power_budget_min_config;
-				NVM_UINT64 default_peak_power_budget_max = default_peak_power_budget_max_config;
-
-				int default_avg_power_budget_min_config = 0;
-				int default_avg_power_budget_max_config = 0;
-				get_config_value_int(SQL_KEY_DEFAULT_AVG_POW_BUDGET_MIN,
-						&default_avg_power_budget_min_config);
-				get_config_value_int(SQL_KEY_DEFAULT_AVG_POW_BUDGET_MAX,
-						&default_avg_power_budget_max_config);
-				char expected_avg_power_budget_range_str[NVM_EVENT_ARG_LEN];
-				s_snprintf(expected_avg_power_budget_range_str, NVM_EVENT_ARG_LEN, "[%d - %d] mW.",
-						default_avg_power_budget_min_config, default_avg_power_budget_max_config);
-				NVM_UINT64 default_avg_power_budget_min = default_avg_power_budget_min_config;
-				NVM_UINT64 default_avg_power_budget_max = default_avg_power_budget_max_config;
-
-				// get default die sparing policy aggressiveness
-				int default_die_sparing_level_config = 0;
-				get_config_value_int(SQL_KEY_DEFAULT_DIE_SPARING_AGGRESSIVENESS,
-						&default_die_sparing_level_config);
-				char expected_die_sparing_aggressiveness_str[NVM_EVENT_ARG_LEN];
-				s_snprintf(expected_die_sparing_aggressiveness_str, NVM_EVENT_ARG_LEN, "%d",
-						default_die_sparing_level_config);
-				NVM_UINT64 default_die_sparing_level = default_die_sparing_level_config;
-
-				struct sensor sensors[NVM_MAX_DEVICE_SENSORS];
-				NVM_GUID_STR device_guid_str;
-				struct device_discovery discovery;
-				for (int current_dev = 0; current_dev < dev_count; current_dev++)
-				{
-					if ((rc = exists_and_manageable(dimms[current_dev].guid,
-							&discovery, 1)) == NVM_SUCCESS)
+					// stage 2: check the rules against the snapshot
+					struct fw_check_defaults defaults;
+					get_fw_check_defaults(&defaults);
+					int rule_count = sizeof (fw_check_rules) / sizeof (fw_check_rules[0]);
+					for (int i = 0; i < rule_count; i++)
 					{
-						NVM_GUID_STR guid_str;
-						guid_to_str(dimms[current_dev].guid, guid_str);
-						// verify if threshold values of temperature and spare capacity are
-						// in accordance with best practices
-						nvm_get_sensors(dimms[current_dev].guid, sensors, NVM_MAX_DEVICE_SENSORS);
-						guid_to_str(dimms[current_dev].guid, device_guid_str);
-						if (!diag_check_real(p_diagnostic,
-							DIAG_THRESHOLD_FW_MEDIA_TEMP,
-							nvm_decode_temperature(
-							sensors[SENSOR_MEDIA_TEMPERATURE].settings.upper_critical_threshold),
-							&max_temp_threshold_config, EQUALITY_LESSTHANEQUAL))
+						if (!(p_diagnostic->excludes & fw_check_rules[i].exclude))
 						{
-							NVM_UINT64 actual_temp_threshold =
-								sensors[SENSOR_MEDIA_TEMPERATURE].settings.upper_critical_threshold;
-							char actual_temp_threshold_str[10];
-							s_snprintf(actual_temp_threshold_str, 10, "%.4f",
-									nvm_decode_temperature(actual_temp_threshold));
-							store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
-									EVENT_SEVERITY_WARN,
-								EVENT_CODE_DIAG_FW_BAD_TEMP_MEDIA_THRESHOLD,
-								dimms[current_dev].guid, 0, guid_str, actual_temp_threshold_str,
-								expected_temp_threshold_str,
-								DIAGNOSTIC_RESULT_FAILED);
-						(*p_results)++;
+							*p_results += fw_check_rules[i].check(p_diagnostic, &defaults,
+									p_settings, dev_count);
+						}
 					}
+					free(p_settings);
 
-					NVM_UINT64 actual_temp_threshold =
-						sensors[SENSOR_CONTROLLER_TEMPERATURE].settings.upper_critical_threshold;
-					if (!diag_check_real(p_diagnostic,
-							DIAG_THRESHOLD_FW_CONTROLLER_TEMP,
-							nvm_decode_temperature(actual_temp_threshold),
-							&max_temp_threshold_config, EQUALITY_LESSTHANEQUAL))
+					if (*p_results == 0) // No errors/warnings
 					{
-						char actual_temp_threshold_str[10];
-						s_snprintf(actual_temp_threshold_str, 10, "%.4f",
-								nvm_decode_temperature(actual_temp_threshold));
 						store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
-								EVENT_SEVERITY_WARN,
-								EVENT_CODE_DIAG_FW_BAD_TEMP_CONTROLLER_THRESHOLD,
-									dimms[current_dev].guid, 0, guid_str, actual_temp_threshold_str,
-									expected_temp_threshold_str,
-									DIAGNOSTIC_RESULT_FAILED);
-							(*p_results)++;
-						}
-
-						if (!diag_check(p_diagnostic,
-								DIAG_THRESHOLD_FW_SPARE,
-								sensors[SENSOR_SPARECAPACITY].settings.lower_critical_threshold,
-								&min_spare_block_threshold, EQUALITY_GREATERTHANEQUAL))
-						{
-							char actual_spare_block_threshold_str[10];
-							s_snprintf(actual_spare_block_threshold_str, 10, "%u",
-								sensors[SENSOR_SPARECAPACITY].settings.lower_critical_threshold);
-							store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
-									EVENT_SEVERITY_WARN,
-									EVENT_CODE_DIAG_FW_BAD_SPARE_BLOCK,
-									dimms[current_dev].guid, 0, guid_str,
-									expected_spare_block_threshold_str,
-									actual_spare_block_threshold_str,
-									DIAGNOSTIC_RESULT_FAILED);
-							(*p_results)++;
-						}
-
-						// verify FW debug log level is set in accordance with best practices
-						enum fw_log_level log_level;
-						if (NVM_SUCCESS == nvm_get_fw_log_level(dimms[current_dev].guid,
-								&log_level))
-						{
-							if ((!(p_diagnostic->excludes & DIAG_THRESHOLD_FW_DEBUGLOG)) &&
-										(log_level != default_log_level))
-							{
-								char current_log_level_str[NVM_EVENT_ARG_LEN];
-								s_snprintf(current_log_level_str, NVM_EVENT_ARG_LEN, "%s",
-										fw_log_level_strings[log_level]);
-								store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
-										EVENT_SEVERITY_WARN,
-										EVENT_CODE_DIAG_FW_BAD_FW_LOG_LEVEL,
-										dimms[current_dev].guid, 0, guid_str, current_log_level_str,
-										default_log_level_str,
-										DIAGNOSTIC_RESULT_FAILED);
-								(*p_results)++;
-							}
-						}
-
-						if (!(p_diagnostic->excludes & DIAG_THRESHOLD_FW_TIME))
-						{
-							// verify host time and NVM DIMM time are within reasonable window.
-							struct pt_payload_system_time time_payload;
-							memset(&time_payload, 0, sizeof (time_payload));
-							time_t now = time(0); // returns system time in seconds
-							if ((rc = get_fw_system_time(dimms[current_dev].device_handle,
-									&time_payload)) == NVM_SUCCESS)
-							{
-								time_t current_time_drift = now - time_payload.time;
-								char current_time_drift_str[NVM_EVENT_ARG_LEN];
-								char time_drift_lag_str[NVM_EVENT_ARG_LEN];
-								if ((current_time_drift > 0) &&
-										(current_time_drift > default_time_drift))
-								{
-									s_snprintf(current_time_drift_str,
-											NVM_EVENT_ARG_LEN, "%llu",
-											(unsigned long long) current_time_drift);
-									s_snprintf(time_drift_lag_str, NVM_EVENT_ARG_LEN,
-											"%s", "<");
-									store_event_by_parts(
-											EVENT_TYPE_DIAG_FW_CONSISTENCY,
-											EVENT_SEVERITY_WARN,
-											EVENT_CODE_DIAG_FW_SYSTEM_TIME_DRIFT,
-											dimms[current_dev].guid, 0, guid_str,
-											time_drift_lag_str, current_time_drift_str,
-											DIAGNOSTIC_RESULT_FAILED);
-									(*p_results)++;
-								}
-								else if ((current_time_drift < 0) &&
-										(abs(current_time_drift) > default_time_drift))
-								{
-									s_snprintf(current_time_drift_str,
-											NVM_EVENT_ARG_LEN, "%llu", abs(
-													current_time_drift));
-									s_snprintf(time_drift_lag_str, NVM_EVENT_ARG_LEN,
-											"%s", ">");
-									store_event_by_parts(
-											EVENT_TYPE_DIAG_FW_CONSISTENCY,
-											EVENT_SEVERITY_WARN,
-											EVENT_CODE_DIAG_FW_SYSTEM_TIME_DRIFT,
-											dimms[current_dev].guid, 0, guid_str,
-											time_drift_lag_str, current_time_drift_str,
-											DIAGNOSTIC_RESULT_FAILED);
-									(*p_results)++;
-								}
-							}
-						}
-
-						if (!(p_diagnostic->excludes & DIAG_THRESHOLD_FW_POW_MGMT_POLICY))
-						{
-							// verify power management policies meet best practices
-							struct pt_payload_power_mgmt_policy power_payload;
-							memset(&power_payload, 0, sizeof (power_payload));
-							get_fw_power_mgmt_policy(dimms[current_dev].device_handle,
-									&power_payload);
-
-							char field_str[NVM_EVENT_ARG_LEN];
-							if (power_payload.enabled)
-							{
-								if ((diag_check(p_diagnostic,
-										DIAG_THRESHOLD_FW_TDP_POW_MIN,
-										power_payload.tdp, &default_tdp_power_min,
-										EQUALITY_LESSTHAN)) ||
-										(diag_check(p_diagnostic,
-										DIAG_THRESHOLD_FW_TDP_POW_MAX,
-										power_payload.tdp, &default_tdp_power_max,
-										EQUALITY_GREATHERTHAN)))
-								{
-									s_snprintf(field_str, NVM_EVENT_ARG_LEN,
-											"%s: %hhu", "TDP power limit",
-											power_payload.tdp);
-									store_event_by_parts(
-											EVENT_TYPE_DIAG_FW_CONSISTENCY,
-											EVENT_SEVERITY_WARN,
-											EVENT_CODE_DIAG_FW_BAD_POWER_MGMT_POLICY,
-											dimms[current_dev].guid, 0, guid_str,
-											field_str, expected_tdp_power_range_str,
-											DIAGNOSTIC_RESULT_FAILED);
-									(*p_results)++;
-								}
-
-								if ((diag_check(p_diagnostic,
-										DIAG_THRESHOLD_FW_AVG_POW_BUDGET_MIN,
-										power_payload.average_power_budget,
-										&default_avg_power_budget_min,
-										EQUALITY_LESSTHAN)) ||
-										(diag_check(p_diagnostic,
-										DIAG_THRESHOLD_FW_AVG_POW_BUDGET_MAX,
-										power_payload.average_power_budget,
-										&default_avg_power_budget_max,
-										EQUALITY_GREATHERTHAN)))
-								{
-									s_snprintf(field_str, NVM_EVENT_ARG_LEN, "%s: %hu",
-											"average power budget",
-											power_payload.average_power_budget);
-									store_event_by_parts(
-											EVENT_TYPE_DIAG_FW_CONSISTENCY,
-											EVENT_SEVERITY_WARN,
-											EVENT_CODE_DIAG_FW_BAD_POWER_MGMT_POLICY,
-											dimms[current_dev].guid, 0, guid_str,
-											field_str,
-											expected_avg_power_budget_range_str,
-											DIAGNOSTIC_RESULT_FAILED);
-									(*p_results)++;
-								}
-
-								if ((diag_check(p_diagnostic,
-										DIAG_THRESHOLD_FW_PEAK_POW_BUDGET_MIN,
-										power_payload.peak_power_budget,
-										&default_peak_power_budget_min,
-										EQUALITY_LESSTHAN)) ||
-										(diag_check(p_diagnostic,
-										DIAG_THRESHOLD_FW_PEAK_POW_BUDGET_MAX,
-										power_payload.peak_power_budget,
-										&default_peak_power_budget_max,
-										EQUALITY_GREATHERTHAN)))
-								{
-									s_snprintf(field_str, NVM_EVENT_ARG_LEN, "%s: %hu",
-											"peak power budget",
-											power_payload.peak_power_budget);
-									store_event_by_parts(
-											EVENT_TYPE_DIAG_FW_CONSISTENCY,
-											EVENT_SEVERITY_WARN,
-											EVENT_CODE_DIAG_FW_BAD_POWER_MGMT_POLICY,
-											dimms[current_dev].guid, 0, guid_str,
-											field_str,
-											expected_peak_power_budget_range_str,
-											DIAGNOSTIC_RESULT_FAILED);
-									(*p_results)++;
-								}
-							}
-							else
-							{
-								s_snprintf(field_str, NVM_EVENT_ARG_LEN, "%s: %hhu",
-										"power management policy enable",
-										power_payload.enabled);
-								char expected_power_mgmt_enabled_str[NVM_EVENT_ARG_LEN];
-								s_snprintf(expected_power_mgmt_enabled_str,
-										NVM_EVENT_ARG_LEN, "%u", 1);
-								store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
-										EVENT_SEVERITY_WARN,
-										EVENT_CODE_DIAG_FW_BAD_POWER_MGMT_POLICY,
-										dimms[current_dev].guid, 0, guid_str, field_str,
-										expected_power_mgmt_enabled_str,
-										DIAGNOSTIC_RESULT_FAILED);
-								(*p_results)++;
-							}
-						}
-
-						if (!(p_diagnostic->excludes & DIAG_THRESHOLD_FW_DIE_SPARING_POLICY))
-						{
-							// verify die sparing policies are in accordance with best practices
-							struct pt_get_die_spare_policy spare_payload;
-							memset(&spare_payload, 0, sizeof (spare_payload));
-							get_fw_die_spare_policy(discovery.device_handle,
-									&spare_payload);
-							char field_str[NVM_EVENT_ARG_LEN];
-							if (spare_payload.enable)
-							{
-								if (!diag_check(p_diagnostic,
-										DIAG_THRESHOLD_FW_DIE_SPARING_LEVEL,
-										spare_payload.aggressiveness,
-										&default_die_sparing_level, EQUALITY_EQUAL))
-								{
-									s_snprintf(field_str, NVM_EVENT_ARG_LEN,
-											"%s: %hhu", "die sparing aggressiveness",
-											spare_payload.aggressiveness);
-									store_event_by_parts(
-											EVENT_TYPE_DIAG_FW_CONSISTENCY,
-											EVENT_SEVERITY_WARN,
-											EVENT_CODE_DIAG_FW_BAD_DIE_SPARING_POLICY,
-											dimms[current_dev].guid, 0, guid_str, field_str,
-											expected_die_sparing_aggressiveness_str,
-											DIAGNOSTIC_RESULT_FAILED);
-									(*p_results)++;
-								}
-							}
-							else
-							{
-								s_snprintf(field_str, NVM_EVENT_ARG_LEN, "%s: %hhu",
-										"die sparing policy enable",
-										spare_payload.enable);
-								char expected_die_sparing_enabled_str[NVM_EVENT_ARG_LEN];
-								s_snprintf(expected_die_sparing_enabled_str,
-										NVM_EVENT_ARG_LEN, "%u", 1);
-								store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
-										EVENT_SEVERITY_WARN,
-										EVENT_CODE_DIAG_FW_BAD_DIE_SPARING_POLICY,
-										dimms[current_dev].guid, 0, guid_str, field_str,
-										expected_die_sparing_enabled_str,
-										DIAGNOSTIC_RESULT_FAILED);
-								(*p_results)++;
-							}
-						}
+								EVENT_SEVERITY_INFO, EVENT_CODE_DIAG_FW_SUCCESS, NULL, 0,
+								NULL, NULL, NULL, DIAGNOSTIC_RESULT_OK);
+						(*p_results)++;
 					}
 				}
-
-				if ((rc == NVM_SUCCESS) && (*p_results == 0)) // No errors/warnings
-				{
-					store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
-							EVENT_SEVERITY_INFO, EVENT_CODE_DIAG_FW_SUCCESS, NULL, 0,
-							NULL, NULL, NULL, DIAGNOSTIC_RESULT_OK);
-					(*p_results)++;
-				}
 			}// nvm_get_devices failed
 			else
 			{
@@ -563,56 +422,684 @@ int diag_firmware_check(const struct diagnostic *p_diagnostic, NVM_UINT32 *p_res
 }
 
 /*
- * Helper function to find the optimal firmware version
+ * Helper function to compare two firmware revisions.
+ * Returns less than, equal to or greater than 0 like strcmp.
+ */
+int compare_fw_revisions(const char *revision1, const char *revision2)
+{
+	NVM_UINT16 major1, minor1, hotfix1, build1;
+	NVM_UINT16 major2, minor2, hotfix2, build2;
+	parse_main_revision(&major1, &minor1, &hotfix1, &build1, revision1, NVM_VERSION_LEN);
+	parse_main_revision(&major2, &minor2, &hotfix2, &build2, revision2, NVM_VERSION_LEN);
+
+	int result = major1 - major2;
+	if (result == 0)
+	{
+		result = minor1 - minor2;
+	}
+	if (result == 0)
+	{
+		result = hotfix1 - hotfix2;
+	}
+	if (result == 0)
+	{
+		result = build1 - build2;
+	}
+	return result;
+}
+
+/*
+ * qsort callback ordering DIMM settings by model number
+ */
+int compare_fw_settings_model(const void *p_left, const void *p_right)
+{
+	const struct fw_settings *p_settings1 = *(const struct fw_settings **)p_left;
+	const struct fw_settings *p_settings2 = *(const struct fw_settings **)p_right;
+	return strncmp(p_settings1->discovery.model_number,
+			p_settings2->discovery.model_number, NVM_MODEL_LEN);
+}
+
+/*
+ * Verify the DIMMs of each model number run the newest firmware of that model
  */
-void find_optimal_fw_revision(char *optimal_fw_revision, char *model_number,
-		const struct device_discovery *p_dimms, int dev_count)
+NVM_UINT32 check_fw_revisions(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count)
 {
-	s_strncpy(optimal_fw_revision, NVM_VERSION_LEN,
-							"00.00.00.0000", NVM_VERSION_LEN);
-	for (int i = 0; i < dev_count; i++)
+	COMMON_LOG_ENTRY();
+	NVM_UINT32 results = 0;
+
+	// group the DIMMs by model number
+	const struct fw_settings *p_sorted[count];
+	for (int i = 0; i < count; i++)
+	{
+		p_sorted[i] = &p_settings[i];
+	}
+	qsort(p_sorted, count, sizeof (p_sorted[0]), compare_fw_settings_model);
+
+	int group_start = 0;
+	while (group_start < count)
 	{
-		if (strncmp(model_number, p_dimms[i].model_number, NVM_MODEL_LEN) == 0)
+		int group_end = group_start + 1;
+		while (group_end < count &&
+				compare_fw_settings_model(&p_sorted[group_start], &p_sorted[group_end]) == 0)
+		{
+			group_end++;
+		}
+
+		// the newest revision of the model is the optimal one
+		NVM_VERSION optimal_fw_rev;
+		s_strncpy(optimal_fw_rev, NVM_VERSION_LEN, "00.00.00.0000", NVM_VERSION_LEN);
+		for (int i = group_start; i < group_end; i++)
 		{
-			// parse the version string into parts
-			NVM_UINT16 opt_major, opt_minor, opt_hotfix, opt_build;
-			NVM_UINT16 major, minor, hotfix, build;
-			parse_main_revision(&opt_major, &opt_minor, &opt_hotfix,
-					&opt_build, optimal_fw_revision, NVM_VERSION_LEN);
-			parse_main_revision(&major, &minor, &hotfix, &build,
-					p_dimms[i].fw_revision, NVM_VERSION_LEN);
-
-			if (opt_major < major)
+			if (compare_fw_revisions(optimal_fw_rev, p_sorted[i]->discovery.fw_revision) < 0)
 			{
-				s_strncpy(optimal_fw_revision, NVM_VERSION_LEN,
-						p_dimms[i].fw_revision, NVM_VERSION_LEN);
+				s_strncpy(optimal_fw_rev, NVM_VERSION_LEN,
+						p_sorted[i]->discovery.fw_revision, NVM_VERSION_LEN);
 			}
-			else if (opt_major == major)
+		}
+
+		// log an event per model number if fw version is inconsistent
+		char inconsistent_guids_event_str[NVM_EVENT_ARG_LEN] = {0};
+		for (int i = group_start; i < group_end; i++)
+		{
+			if (strncmp(optimal_fw_rev, p_sorted[i]->discovery.fw_revision,
+					NVM_VERSION_LEN) != 0)
 			{
-				if (opt_minor < minor)
-				{
-					s_strncpy(optimal_fw_revision, NVM_VERSION_LEN,
-							p_dimms[i].fw_revision, NVM_VERSION_LEN);
-				}
-				else if (opt_minor == minor)
+				s_strcat(inconsistent_guids_event_str, NVM_EVENT_ARG_LEN,
+						p_sorted[i]->guid_str);
+				s_strcat(inconsistent_guids_event_str, NVM_EVENT_ARG_LEN, ", ");
+			}
+		}
+		if (inconsistent_guids_event_str[0] != '\0')
+		{
+			char model_number[NVM_MODEL_LEN];
+			s_strncpy(model_number, NVM_MODEL_LEN,
+					p_sorted[group_start]->discovery.model_number, NVM_MODEL_LEN);
+			store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
+					EVENT_SEVERITY_WARN,
+					EVENT_CODE_DIAG_FW_INCONSISTENT, NULL, 0,
+					inconsistent_guids_event_str,
+					model_number, optimal_fw_rev,
+					DIAGNOSTIC_RESULT_FAILED);
+			results++;
+		}
+		group_start = group_end;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(results);
+	return results;
+}
+
+/*
+ * Verify the temperature and spare capacity thresholds follow best practices
+ */
+NVM_UINT32 check_fw_sensor_thresholds(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count)
+{
+	COMMON_LOG_ENTRY();
+	NVM_UINT32 results = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (!p_settings[i].manageable || p_settings[i].sensors_rc < 0)
+		{
+			continue;
+		}
+
+		const struct sensor *p_sensors = p_settings[i].sensors;
+		NVM_UINT64 media_temp_threshold =
+				p_sensors[SENSOR_MEDIA_TEMPERATURE].settings.upper_critical_threshold;
+		if (!diag_check_real(p_diagnostic,
+				DIAG_THRESHOLD_FW_MEDIA_TEMP,
+				nvm_decode_temperature(media_temp_threshold),
+				&p_defaults->max_temp_threshold, EQUALITY_LESSTHANEQUAL))
+		{
+			char actual_temp_threshold_str[10];
+			s_snprintf(actual_temp_threshold_str, 10, "%.4f",
+					nvm_decode_temperature(media_temp_threshold));
+			store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
+					EVENT_SEVERITY_WARN,
+					EVENT_CODE_DIAG_FW_BAD_TEMP_MEDIA_THRESHOLD,
+					p_settings[i].discovery.guid, 0, p_settings[i].guid_str,
+					actual_temp_threshold_str, p_defaults->temp_threshold_str,
+					DIAGNOSTIC_RESULT_FAILED);
+			results++;
+		}
+
+		NVM_UINT64 controller_temp_threshold =
+				p_sensors[SENSOR_CONTROLLER_TEMPERATURE].settings.upper_critical_threshold;
+		if (!diag_check_real(p_diagnostic,
+				DIAG_THRESHOLD_FW_CONTROLLER_TEMP,
+				nvm_decode_temperature(controller_temp_threshold),
+				&p_defaults->max_temp_threshold, EQUALITY_LESSTHANEQUAL))
+		{
+			char actual_temp_threshold_str[10];
+			s_snprintf(actual_temp_threshold_str, 10, "%.4f",
+					nvm_decode_temperature(controller_temp_threshold));
+			store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
+					EVENT_SEVERITY_WARN,
+					EVENT_CODE_DIAG_FW_BAD_TEMP_CONTROLLER_THRESHOLD,
+					p_settings[i].discovery.guid, 0, p_settings[i].guid_str,
+					actual_temp_threshold_str, p_defaults->temp_threshold_str,
+					DIAGNOSTIC_RESULT_FAILED);
+			results++;
+		}
+
+		if (!diag_check(p_diagnostic,
+				DIAG_THRESHOLD_FW_SPARE,
+				p_sensors[SENSOR_SPARECAPACITY].settings.lower_critical_threshold,
+				&p_defaults->min_spare_block_threshold, EQUALITY_GREATERTHANEQUAL))
+		{
+			char actual_spare_block_threshold_str[10];
+			s_snprintf(actual_spare_block_threshold_str, 10, "%llu",
+					p_sensors[SENSOR_SPARECAPACITY].settings.lower_critical_threshold);
+			store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
+					EVENT_SEVERITY_WARN,
+					EVENT_CODE_DIAG_FW_BAD_SPARE_BLOCK,
+					p_settings[i].discovery.guid, 0, p_settings[i].guid_str,
+					p_defaults->spare_block_threshold_str,
+					actual_spare_block_threshold_str,
+					DIAGNOSTIC_RESULT_FAILED);
+			results++;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(results);
+	return results;
+}
+
+/*
+ * Verify the FW debug log level is set in accordance with best practices
+ */
+NVM_UINT32 check_fw_log_level(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count)
+{
+	COMMON_LOG_ENTRY();
+	NVM_UINT32 results = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (p_settings[i].manageable && p_settings[i].log_level_rc == NVM_SUCCESS &&
+				p_settings[i].log_level != p_defaults->log_level)
+		{
+			enum fw_log_level log_level = p_settings[i].log_level;
+			if (log_level > FW_LOG_LEVEL_UNKNOWN)
+			{
+				log_level = FW_LOG_LEVEL_UNKNOWN;
+			}
+			char current_log_level_str[NVM_EVENT_ARG_LEN];
+			s_strcpy(current_log_level_str, fw_log_level_strings[log_level],
+					NVM_EVENT_ARG_LEN);
+			store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
+					EVENT_SEVERITY_WARN,
+					EVENT_CODE_DIAG_FW_BAD_FW_LOG_LEVEL,
+					p_settings[i].discovery.guid, 0, p_settings[i].guid_str,
+					current_log_level_str, p_defaults->log_level_str,
+					DIAGNOSTIC_RESULT_FAILED);
+			results++;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(results);
+	return results;
+}
+
+/*
+ * Verify host time and NVM DIMM time are within reasonable window
+ */
+NVM_UINT32 check_fw_system_time(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count)
+{
+	COMMON_LOG_ENTRY();
+	NVM_UINT32 results = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (!p_settings[i].manageable || p_settings[i].time_rc != NVM_SUCCESS)
+		{
+			continue;
+		}
+
+		long long current_time_drift =
+				(long long)p_settings[i].host_time - (long long)p_settings[i].time.time;
+		if (llabs(current_time_drift) > p_defaults->time_drift)
+		{
+			char current_time_drift_str[NVM_EVENT_ARG_LEN];
+			s_snprintf(current_time_drift_str, NVM_EVENT_ARG_LEN, "%llu",
+					(unsigned long long)llabs(current_time_drift));
+			store_event_by_parts(
+					EVENT_TYPE_DIAG_FW_CONSISTENCY,
+					EVENT_SEVERITY_WARN,
+					EVENT_CODE_DIAG_FW_SYSTEM_TIME_DRIFT,
+					p_settings[i].discovery.guid, 0, p_settings[i].guid_str,
+					(current_time_drift > 0) ? "<" : ">", current_time_drift_str,
+					DIAGNOSTIC_RESULT_FAILED);
+			results++;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(results);
+	return results;
+}
+
+/*
+ * Verify power management policies meet best practices
+ */
+NVM_UINT32 check_fw_power_mgmt_policy(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count)
+{
+	COMMON_LOG_ENTRY();
+	NVM_UINT32 results = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (!p_settings[i].manageable || p_settings[i].power_rc != NVM_SUCCESS)
+		{
+			continue;
+		}
+
+		const struct pt_payload_power_mgmt_policy *p_power = &p_settings[i].power;
+		char field_str[NVM_EVENT_ARG_LEN];
+		if (p_power->enabled)
+		{
+			if ((diag_check(p_diagnostic,
+					DIAG_THRESHOLD_FW_TDP_POW_MIN,
+					p_power->tdp, &p_defaults->tdp_power_min,
+					EQUALITY_LESSTHAN)) ||
+					(diag_check(p_diagnostic,
+					DIAG_THRESHOLD_FW_TDP_POW_MAX,
+					p_power->tdp, &p_defaults->tdp_power_max,
+					EQUALITY_GREATHERTHAN)))
+			{
+				s_snprintf(field_str, NVM_EVENT_ARG_LEN,
+						"%s: %hhu", "TDP power limit", p_power->tdp);
+				store_event_by_parts(
+						EVENT_TYPE_DIAG_FW_CONSISTENCY,
+						EVENT_SEVERITY_WARN,
+						EVENT_CODE_DIAG_FW_BAD_POWER_MGMT_POLICY,
+						p_settings[i].discovery.guid, 0, p_settings[i].guid_str,
+						field_str, p_defaults->tdp_power_range_str,
+						DIAGNOSTIC_RESULT_FAILED);
+				results++;
+			}
+
+			if ((diag_check(p_diagnostic,
+					DIAG_THRESHOLD_FW_AVG_POW_BUDGET_MIN,
+					p_power->average_power_budget,
+					&p_defaults->avg_power_budget_min,
+					EQUALITY_LESSTHAN)) ||
+					(diag_check(p_diagnostic,
+					DIAG_THRESHOLD_FW_AVG_POW_BUDGET_MAX,
+					p_power->average_power_budget,
+					&p_defaults->avg_power_budget_max,
+					EQUALITY_GREATHERTHAN)))
+			{
+				s_snprintf(field_str, NVM_EVENT_ARG_LEN, "%s: %hu",
+						"average power budget", p_power->average_power_budget);
+				store_event_by_parts(
+						EVENT_TYPE_DIAG_FW_CONSISTENCY,
+						EVENT_SEVERITY_WARN,
+						EVENT_CODE_DIAG_FW_BAD_POWER_MGMT_POLICY,
+						p_settings[i].discovery.guid, 0, p_settings[i].guid_str,
+						field_str, p_defaults->avg_power_budget_range_str,
+						DIAGNOSTIC_RESULT_FAILED);
+				results++;
+			}
+
+			if ((diag_check(p_diagnostic,
+					DIAG_THRESHOLD_FW_PEAK_POW_BUDGET_MIN,
+					p_power->peak_power_budget,
+					&p_defaults->peak_power_budget_min,
+					EQUALITY_LESSTHAN)) ||
+					(diag_check(p_diagnostic,
+					DIAG_THRESHOLD_FW_PEAK_POW_BUDGET_MAX,
+					p_power->peak_power_budget,
+					&p_defaults->peak_power_budget_max,
+					EQUALITY_GREATHERTHAN)))
+			{
+				s_snprintf(field_str, NVM_EVENT_ARG_LEN, "%s: %hu",
+						"peak power budget", p_power->peak_power_budget);
+				store_event_by_parts(
+						EVENT_TYPE_DIAG_FW_CONSISTENCY,
+						EVENT_SEVERITY_WARN,
+						EVENT_CODE_DIAG_FW_BAD_POWER_MGMT_POLICY,
+						p_settings[i].discovery.guid, 0, p_settings[i].guid_str,
+						field_str, p_defaults->peak_power_budget_range_str,
+						DIAGNOSTIC_RESULT_FAILED);
+				results++;
+			}
+		}
+		else
+		{
+			s_snprintf(field_str, NVM_EVENT_ARG_LEN, "%s: %hhu",
+					"power management policy enable", p_power->enabled);
+			store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
+					EVENT_SEVERITY_WARN,
+					EVENT_CODE_DIAG_FW_BAD_POWER_MGMT_POLICY,
+					p_settings[i].discovery.guid, 0, p_settings[i].guid_str, field_str,
+					"1", DIAGNOSTIC_RESULT_FAILED);
+			results++;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(results);
+	return results;
+}
+
+/*
+ * Verify die sparing policies are in accordance with best practices
+ */
+NVM_UINT32 check_fw_die_sparing_policy(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count)
+{
+	COMMON_LOG_ENTRY();
+	NVM_UINT32 results = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (!p_settings[i].manageable || p_settings[i].spare_rc != NVM_SUCCESS)
+		{
+			continue;
+		}
+
+		const struct pt_get_die_spare_policy *p_spare = &p_settings[i].spare;
+		char field_str[NVM_EVENT_ARG_LEN];
+		if (p_spare->enable)
+		{
+			if (!diag_check(p_diagnostic,
+					DIAG_THRESHOLD_FW_DIE_SPARING_LEVEL,
+					p_spare->aggressiveness,
+					&p_defaults->die_sparing_level, EQUALITY_EQUAL))
+			{
+				s_snprintf(field_str, NVM_EVENT_ARG_LEN,
+						"%s: %hhu", "die sparing aggressiveness", p_spare->aggressiveness);
+				store_event_by_parts(
+						EVENT_TYPE_DIAG_FW_CONSISTENCY,
+						EVENT_SEVERITY_WARN,
+						EVENT_CODE_DIAG_FW_BAD_DIE_SPARING_POLICY,
+						p_settings[i].discovery.guid, 0, p_settings[i].guid_str, field_str,
+						p_defaults->die_sparing_level_str,
+						DIAGNOSTIC_RESULT_FAILED);
+				results++;
+			}
+		}
+		else
+		{
+			s_snprintf(field_str, NVM_EVENT_ARG_LEN, "%s: %hhu",
+					"die sparing policy enable", p_spare->enable);
+			store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
+					EVENT_SEVERITY_WARN,
+					EVENT_CODE_DIAG_FW_BAD_DIE_SPARING_POLICY,
+					p_settings[i].discovery.guid, 0, p_settings[i].guid_str, field_str,
+					"1", DIAGNOSTIC_RESULT_FAILED);
+			results++;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(results);
+	return results;
+}
+
+/*
+ * Firmware settings that a site consistency rule can require to match.
+ * Each reader returns 0 when the setting could not be read from the DIMM.
+ */
+static NVM_BOOL get_tdp(const struct fw_settings *p_settings, NVM_UINT64 *p_value)
+{
+	*p_value = p_settings->power.tdp;
+	return p_settings->power_rc == NVM_SUCCESS;
+}
+
+static NVM_BOOL get_peak_power_budget(const struct fw_settings *p_settings, NVM_UINT64 *p_value)
+{
+	*p_value = p_settings->power.peak_power_budget;
+	return p_settings->power_rc == NVM_SUCCESS;
+}
+
+static NVM_BOOL get_average_power_budget(const struct fw_settings *p_settings, NVM_UINT64 *p_value)
+{
+	*p_value = p_settings->power.average_power_budget;
+	return p_settings->power_rc == NVM_SUCCESS;
+}
+
+static NVM_BOOL get_power_mgmt_enabled(const struct fw_settings *p_settings, NVM_UINT64 *p_value)
+{
+	*p_value = p_settings->power.enabled;
+	return p_settings->power_rc == NVM_SUCCESS;
+}
+
+static NVM_BOOL get_die_sparing_enabled(const struct fw_settings *p_settings, NVM_UINT64 *p_value)
+{
+	*p_value = p_settings->spare.enable;
+	return p_settings->spare_rc == NVM_SUCCESS;
+}
+
+static NVM_BOOL get_die_sparing_aggressiveness(const struct fw_settings *p_settings,
+		NVM_UINT64 *p_value)
+{
+	*p_value = p_settings->spare.aggressiveness;
+	return p_settings->spare_rc == NVM_SUCCESS;
+}
+
+static NVM_BOOL get_log_level(const struct fw_settings *p_settings, NVM_UINT64 *p_value)
+{
+	*p_value = p_settings->log_level;
+	return p_settings->log_level_rc == NVM_SUCCESS;
+}
+
+static const struct
+{
+	const char *name;
+	NVM_BOOL (*get)(const struct fw_settings *p_settings, NVM_UINT64 *p_value);
+} fw_check_site_settings[] =
+{
+	{ "tdp", get_tdp },
+	{ "peak_power_budget", get_peak_power_budget },
+	{ "average_power_budget", get_average_power_budget },
+	{ "power_mgmt_enabled", get_power_mgmt_enabled },
+	{ "die_sparing_enabled", get_die_sparing_enabled },
+	{ "die_sparing_aggressiveness", get_die_sparing_aggressiveness },
+	{ "fw_log_level", get_log_level }
+};
+
+/*
+ * Groups of DIMMs a site consistency rule can require a setting to match across
+ */
+static NVM_BOOL same_system(const struct fw_settings *p_settings1,
+		const struct fw_settings *p_settings2)
+{
+	return 1;
+}
+
+static NVM_BOOL same_socket(const struct fw_settings *p_settings1,
+		const struct fw_settings *p_settings2)
+{
+	return p_settings1->discovery.socket_id == p_settings2->discovery.socket_id;
+}
+
+static NVM_BOOL same_memory_controller(const struct fw_settings *p_settings1,
+		const struct fw_settings *p_settings2)
+{
+	return same_socket(p_settings1, p_settings2) &&
+			p_settings1->discovery.memory_controller_id ==
+					p_settings2->discovery.memory_controller_id;
+}
+
+static NVM_BOOL same_model(const struct fw_settings *p_settings1,
+		const struct fw_settings *p_settings2)
+{
+	return strncmp(p_settings1->discovery.model_number,
+			p_settings2->discovery.model_number, NVM_MODEL_LEN) == 0;
+}
+
+static const struct
+{
+	const char *name;
+	NVM_BOOL (*same_group)(const struct fw_settings *p_settings1,
+			const struct fw_settings *p_settings2);
+} fw_check_site_scopes[] =
+{
+	{ "system", same_system },
+	{ "socket", same_socket },
+	{ "memory_controller", same_memory_controller },
+	{ "model", same_model }
+};
+
+/*
+ * Check one site rule: every DIMM in a group must report the value
+ * that most of the DIMMs in the group report.
+ */
+NVM_UINT32 check_fw_site_rule(const int scope, const int setting,
+		const struct fw_settings *p_settings, const int count)
+{
+	COMMON_LOG_ENTRY();
+	NVM_UINT32 results = 0;
+
+	NVM_BOOL valid[count];
+	NVM_UINT64 values[count];
+	NVM_BOOL checked[count];
+	for (int i = 0; i < count; i++)
+	{
+		valid[i] = p_settings[i].manageable &&
+				fw_check_site_settings[setting].get(&p_settings[i], &values[i]);
+		checked[i] = !valid[i];
+	}
+
+	for (int first = 0; first < count; first++)
+	{
+		if (checked[first])
+		{
+			continue;
+		}
+
+		// the value reported by most of the DIMMs in the group is expected
+		NVM_UINT64 expected = values[first];
+		int expected_count = 0;
+		for (int i = first; i < count; i++)
+		{
+			if (valid[i] &&
+					fw_check_site_scopes[scope].same_group(&p_settings[first], &p_settings[i]))
+			{
+				int value_count = 0;
+				for (int j = first; j < count; j++)
 				{
-					if (opt_hotfix < hotfix)
-					{
-						s_strncpy(optimal_fw_revision, NVM_VERSION_LEN,
-								p_dimms[i].fw_revision, NVM_VERSION_LEN);
-					}
-					else if (opt_hotfix == hotfix)
+					if (valid[j] && values[j] == values[i] &&
+							fw_check_site_scopes[scope].same_group(
+									&p_settings[first], &p_settings[j]))
 					{
-						if (opt_build < build)
-						{
-							s_strncpy(optimal_fw_revision, NVM_VERSION_LEN,
-									p_dimms[i].fw_revision, NVM_VERSION_LEN);
-						}
+						value_count++;
 					}
 				}
+				if (value_count > expected_count)
+				{
+					expected = values[i];
+					expected_count = value_count;
+				}
+			}
+		}
+
+		for (int i = first; i < count; i++)
+		{
+			if (!checked[i] &&
+					fw_check_site_scopes[scope].same_group(&p_settings[first], &p_settings[i]))
+			{
+				checked[i] = 1;
+				if (values[i] != expected)
+				{
+					char field_str[NVM_EVENT_ARG_LEN];
+					s_snprintf(field_str, NVM_EVENT_ARG_LEN, "%s: %llu",
+							fw_check_site_settings[setting].name, values[i]);
+					char expected_str[NVM_EVENT_ARG_LEN];
+					s_snprintf(expected_str, NVM_EVENT_ARG_LEN, "%llu across each %s",
+							expected, fw_check_site_scopes[scope].name);
+					store_event_by_parts(EVENT_TYPE_DIAG_FW_CONSISTENCY,
+							EVENT_SEVERITY_WARN,
+							EVENT_CODE_DIAG_FW_SITE_RULE_MISMATCH,
+							p_settings[i].discovery.guid, 0, p_settings[i].guid_str,
+							field_str, expected_str,
+							DIAGNOSTIC_RESULT_FAILED);
+					results++;
+				}
+			}
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(results);
+	return results;
+}
+
+/*
+ * Verify the consistency rules configured by the site.
+ * Each rule is "<scope>:<setting>", e.g. "socket:peak_power_budget"
+ * requires all DIMMs on a socket to have the same peak power budget.
+ */
+NVM_UINT32 check_fw_site_rules(const struct diagnostic *p_diagnostic,
+		struct fw_check_defaults *p_defaults,
+		const struct fw_settings *p_settings, const int count)
+{
+	COMMON_LOG_ENTRY();
+	NVM_UINT32 results = 0;
+
+	char rules_str[CONFIG_VALUE_LEN] = {0};
+	if (get_config_value(SQL_KEY_FW_CONSISTENCY_RULES, rules_str) == COMMON_SUCCESS)
+	{
+		int scope_count = sizeof (fw_check_site_scopes) / sizeof (fw_check_site_scopes[0]);
+		int setting_count = sizeof (fw_check_site_settings) /
+				sizeof (fw_check_site_settings[0]);
+
+		char *p_rules = rules_str;
+		char *rule;
+		while ((rule = x_strtok(&p_rules, FW_CHECK_RULE_DELIMITERS)) != NULL)
+		{
+			if (rule[0] == '\0')
+			{
+				continue;
+			}
+
+			// x_strtok splits the rule in place, keep the original for the log
+			char rule_str[CONFIG_VALUE_LEN];
+			s_strcpy(rule_str, rule, CONFIG_VALUE_LEN);
+
+			char *p_rule = rule;
+			char *scope_name = x_strtok(&p_rule, FW_CHECK_RULE_SCOPE_DELIMITER);
+			char *setting_name = x_strtok(&p_rule, FW_CHECK_RULE_SCOPE_DELIMITER);
+
+			int scope = -1;
+			for (int i = 0; i < scope_count && setting_name; i++)
+			{
+				if (strcmp(scope_name, fw_check_site_scopes[i].name) == 0)
+				{
+					scope = i;
+				}
+			}
+			int setting = -1;
+			for (int i = 0; i < setting_count && setting_name; i++)
+			{
+				if (strcmp(setting_name, fw_check_site_settings[i].name) == 0)
+				{
+					setting = i;
+				}
+			}
+
+			if (scope < 0 || setting < 0)
+			{
+				COMMON_LOG_ERROR_F("Ignoring invalid firmware consistency rule '%s'", rule_str);
+			}
+			else
+			{
+				results += check_fw_site_rule(scope, setting, p_settings, count);
 			}
 		}
 	}
+
+	COMMON_LOG_EXIT_RETURN_I(results);
+	return results;
 }
 
 /*
@@ -632,3 +1119,24 @@ int get_fw_system_time(NVM_NFIT_DEVICE_HANDLE dimm_handle, struct pt_payload_sys
 	rc = ioctl_passthrough_cmd(&fw_cmd);
 	return rc;
 }
+
+/*
+ * Helper function to get the firmware debug log level
+ */
+int get_fw_log_level(NVM_NFIT_DEVICE_HANDLE dimm_handle, enum fw_log_level *p_log_level)
+{
+	unsigned char log_level = 0;
+	struct fw_cmd fw_cmd;
+	memset(&fw_cmd, 0, sizeof (fw_cmd));
+	fw_cmd.device_handle = dimm_handle.handle;
+	fw_cmd.opcode = PT_GET_ADMIN_FEATURES;
+	fw_cmd.sub_opcode = SUBOP_FW_DBG_LOG_LEVEL;
+	fw_cmd.output_payload_size = sizeof (log_level);
+	fw_cmd.output_payload = &log_level;
+	int rc = ioctl_passthrough_cmd(&fw_cmd);
+	if (rc == NVM_SUCCESS)
+	{
+		*p_log_level = log_level;
+	}
+	return rc;
+}
@@ -30,6 +30,7 @@
  * for the native API.
  */
 
+#include <stdlib.h>
 #include "nvm_management.h"
 #include "diagnostic.h"
 #include "device_adapter.h"
@@ -65,8 +66,13 @@ int diag_pm_metadata_check(NVM_UINT32 *p_results)
 		if (rc > 0)
 		{
 			NVM_UINT32 result_count = (NVM_UINT32)rc;
-			struct health_event results[result_count];
-			if ((rc = run_test(DRIVER_DIAGNOSTIC_PM_METADATA_CHECK, result_count, results))
+			struct health_event *results = calloc(result_count, sizeof (struct health_event));
+			if (results == NULL)
+			{
+				COMMON_LOG_ERROR("Could not allocate memory for the driver results.");
+				rc = NVM_ERR_NOMEMORY;
+			}
+			else if ((rc = run_test(DRIVER_DIAGNOSTIC_PM_METADATA_CHECK, result_count, results))
 				== NVM_SUCCESS)
 			{
 				// store results in db
@@ -88,6 +94,7 @@ int diag_pm_metadata_check(NVM_UINT32 *p_results)
 				}
 				*p_results = result_count;
 			}
+			free(results);
 		}
 	}
 
@@ -98,46 +98,77 @@ int diag_quick_health_check(const NVM_GUID device_guid,
 	}
 	else
 	{
-		struct device_discovery discovery;
-		if ((rc = exists_and_manageable(device_guid, &discovery, 1)) == NVM_SUCCESS)
+		struct device_quick_diagnostic_result result;
+		memset(&result, 0, sizeof (result));
+		memmove(result.device_guid, device_guid, NVM_GUID_LEN);
+		rc = diag_quick_health_check_device(p_diagnostic, &result);
+		*p_results = result.results;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Run the quick health checks on a single device, recording the failures of each check.
+ * Assumes previous results have already been cleared.
+ */
+int diag_quick_health_check_device(const struct diagnostic *p_diagnostic,
+		struct device_quick_diagnostic_result *p_result)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	NVM_UINT32 *p_checks = p_result->check_failures;
+
+	struct device_discovery discovery;
+	if ((rc = exists_and_manageable(p_result->device_guid, &discovery, 1)) == NVM_SUCCESS)
+	{
+		NVM_NFIT_DEVICE_HANDLE device_handle = discovery.device_handle;
+
+		int tmp_rc = check_dimm_bsr(p_result->device_guid, device_handle, p_diagnostic,
+				&p_checks[QUICK_DIAGNOSTIC_CHECK_BSR]);
+		KEEP_ERROR(rc, tmp_rc);
+
+		if (((rc = check_dimm_identification(p_result->device_guid, device_handle,
+				p_diagnostic, &p_checks[QUICK_DIAGNOSTIC_CHECK_IDENTIFICATION])) == NVM_SUCCESS) &&
+				((p_checks[QUICK_DIAGNOSTIC_CHECK_BSR] +
+				p_checks[QUICK_DIAGNOSTIC_CHECK_IDENTIFICATION]) == 0)) // abort test if DIMM is unrecognized
 		{
-			NVM_NFIT_DEVICE_HANDLE device_handle = discovery.device_handle;
+			tmp_rc = check_dimm_health(p_result->device_guid, device_handle, p_diagnostic,
+					&p_checks[QUICK_DIAGNOSTIC_CHECK_HEALTH]);
+			KEEP_ERROR(rc, tmp_rc);
 
-			int tmp_rc = check_dimm_bsr(device_guid, device_handle, p_diagnostic, p_results);
+			check_dimm_power_limitation(p_result->device_guid, device_handle, p_diagnostic,
+					&p_checks[QUICK_DIAGNOSTIC_CHECK_POWER_LIMITATION]);
+
+			tmp_rc = check_dimm_media_errors(p_result->device_guid, device_handle, p_diagnostic,
+					&p_checks[QUICK_DIAGNOSTIC_CHECK_MEDIA_ERRORS]);
 			KEEP_ERROR(rc, tmp_rc);
+		} // end unrecognized dimm
 
-			if (((rc = check_dimm_identification(device_guid, device_handle,
-					p_diagnostic, p_results)) == NVM_SUCCESS) &&
-					((*p_results) == 0)) // abort test if DIMM is unrecognized
-			{
-				tmp_rc = check_dimm_health(device_guid, device_handle, p_diagnostic, p_results);
-				KEEP_ERROR(rc, tmp_rc);
-
-				check_dimm_power_limitation(device_guid, device_handle, p_diagnostic,
-					p_results);
-
-				tmp_rc = check_dimm_media_errors(device_guid, device_handle, p_diagnostic,
-						p_results);
-				KEEP_ERROR(rc, tmp_rc);
-
-				if ((rc == NVM_SUCCESS) && (*p_results == 0)) // No errors/warnings
-				{
-					// store success event
-					store_event_by_parts(
-						EVENT_TYPE_DIAG_QUICK,
-						EVENT_SEVERITY_INFO,
-						EVENT_CODE_DIAG_QUICK_SUCCESS,
-						device_guid,
-						0,
-						NULL,
-						NULL,
-						NULL,
-						DIAGNOSTIC_RESULT_OK);
-					(*p_results)++;
-				}
-			} // end unrecognized dimm
-		} // end dimm is unmanageable
-	}
+		p_result->results = 0;
+		for (int i = 0; i < NVM_QUICK_DIAGNOSTIC_CHECK_COUNT; i++)
+		{
+			p_result->results += p_checks[i];
+		}
+
+		if ((rc == NVM_SUCCESS) && (p_result->results == 0)) // No errors/warnings
+		{
+			// store success event
+			store_event_by_parts(
+				EVENT_TYPE_DIAG_QUICK,
+				EVENT_SEVERITY_INFO,
+				EVENT_CODE_DIAG_QUICK_SUCCESS,
+				p_result->device_guid,
+				0,
+				NULL,
+				NULL,
+				NULL,
+				DIAGNOSTIC_RESULT_OK);
+			p_result->results++;
+		}
+	} // end dimm is unmanageable
+	p_result->rc = rc;
 
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
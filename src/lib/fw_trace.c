@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file contains the implementation of the firmware passthrough trace.
+ */
+
+#include "fw_trace.h"
+#include <persistence/lib_persistence.h>
+#include <persistence/config_settings.h>
+#include <persistence/logging.h>
+#include <file_ops/file_ops_adapter.h>
+#include <string/s_str.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define	FW_TRACE_BUCKETS	64
+
+#define	FNV_OFFSET_BASIS	0xcbf29ce484222325ULL
+#define	FNV_PRIME	0x100000001b3ULL
+
+/*
+ * A recorded command, pointing into the loaded file contents
+ */
+struct fw_trace_entry
+{
+	struct fw_trace_record_header header;
+	const unsigned char *p_input;
+	const unsigned char *p_output;
+	const unsigned char *p_large_output;
+	NVM_BOOL served;
+	struct fw_trace_entry *p_next; // next entry in the same bucket, in recorded order
+};
+
+struct fw_trace
+{
+	void *p_data; // file contents
+	struct fw_trace_entry *p_entries;
+	int entry_count;
+	struct fw_trace_entry *p_buckets[FW_TRACE_BUCKETS];
+};
+
+// -1 until the config has been read, then 0 or 1
+static volatile int g_fw_trace_state = -1;
+static FILE *g_p_fw_trace_file = NULL;
+// serializes the opening of and the writes to the trace file
+static pthread_mutex_t g_fw_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * FNV-1a hash of a large input payload
+ */
+static NVM_UINT64 fw_trace_hash(const void *p_buf, const NVM_UINT32 size)
+{
+	NVM_UINT64 hash = FNV_OFFSET_BASIS;
+	const unsigned char *p_bytes = (const unsigned char *)p_buf;
+	for (NVM_UINT32 i = 0; p_bytes && i < size; i++)
+	{
+		hash ^= p_bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+/*
+ * Length of a payload without its trailing zeros
+ */
+static NVM_UINT32 fw_trace_trimmed_len(const void *p_buf, NVM_UINT32 size)
+{
+	const unsigned char *p_bytes = (const unsigned char *)p_buf;
+	while (p_bytes && size > 0 && p_bytes[size - 1] == 0)
+	{
+		size--;
+	}
+	return p_bytes ? size : 0;
+}
+
+static NVM_UINT32 fw_trace_bucket(const NVM_UINT32 device_handle,
+		const NVM_UINT8 opcode, const NVM_UINT8 sub_opcode)
+{
+	return (device_handle * 31 + opcode * 7 + sub_opcode) % FW_TRACE_BUCKETS;
+}
+
+/*
+ * Whether passthrough commands are being recorded, set by the FW_TRACE_FILE config key.
+ * The key is only read once per process.
+ */
+NVM_BOOL fw_trace_enabled()
+{
+	if (g_fw_trace_state < 0)
+	{
+		pthread_mutex_lock(&g_fw_trace_lock);
+		if (g_fw_trace_state < 0)
+		{
+			char path[CONFIG_VALUE_LEN];
+			memset(path, 0, sizeof (path));
+			if (get_config_value(SQL_KEY_FW_TRACE_FILE, path) != COMMON_SUCCESS ||
+					s_strnlen(path, CONFIG_VALUE_LEN) == 0)
+			{
+				g_fw_trace_state = 0;
+			}
+			else if ((g_p_fw_trace_file =
+					open_file(path, s_strnlen(path, CONFIG_VALUE_LEN), "ab")) == NULL)
+			{
+				COMMON_LOG_ERROR_F("Failed to open the firmware trace file %s", path);
+				g_fw_trace_state = 0;
+			}
+			else
+			{
+				// a new file gets the file header, an existing one is appended to
+				fseek(g_p_fw_trace_file, 0, SEEK_END);
+				if (ftell(g_p_fw_trace_file) == 0)
+				{
+					struct fw_trace_file_header file_header;
+					memset(&file_header, 0, sizeof (file_header));
+					memmove(file_header.magic, FW_TRACE_MAGIC, sizeof (file_header.magic));
+					file_header.version = FW_TRACE_VERSION;
+					fwrite(&file_header, sizeof (file_header), 1, g_p_fw_trace_file);
+					fflush(g_p_fw_trace_file);
+				}
+				g_fw_trace_state = 1;
+			}
+		}
+		pthread_mutex_unlock(&g_fw_trace_lock);
+	}
+	return g_fw_trace_state == 1;
+}
+
+/*
+ * Append a completed passthrough command to the trace file
+ */
+void fw_trace_record(const struct fw_cmd *p_cmd, const int rc, const NVM_UINT64 latency_usec)
+{
+	if (p_cmd && fw_trace_enabled())
+	{
+		struct fw_trace_record_header header;
+		memset(&header, 0, sizeof (header));
+		header.device_handle = p_cmd->device_handle;
+		header.opcode = p_cmd->opcode;
+		header.sub_opcode = p_cmd->sub_opcode;
+		header.rc = rc;
+		header.latency_usec = latency_usec > 0xFFFFFFFF ? 0xFFFFFFFF : latency_usec;
+		header.input_size = p_cmd->input_payload_size;
+		header.output_size = p_cmd->output_payload_size;
+		header.large_input_size = p_cmd->large_input_payload_size;
+		header.large_output_size = p_cmd->large_output_payload_size;
+		header.large_input_hash = fw_trace_hash(p_cmd->large_input_payload,
+				p_cmd->large_input_payload_size);
+
+		// security commands carry passphrases, never write them out
+		if (p_cmd->opcode == PT_SET_SEC_INFO)
+		{
+			header.flags |= FW_TRACE_FLAG_INPUT_REDACTED;
+		}
+		else if (p_cmd->input_payload)
+		{
+			header.input_len = p_cmd->input_payload_size;
+		}
+		// a failed command has no meaningful output
+		if (rc == NVM_SUCCESS)
+		{
+			header.output_len = fw_trace_trimmed_len(p_cmd->output_payload,
+					p_cmd->output_payload_size);
+			header.large_output_len = fw_trace_trimmed_len(p_cmd->large_output_payload,
+					p_cmd->large_output_payload_size);
+		}
+
+		pthread_mutex_lock(&g_fw_trace_lock);
+		if (!g_p_fw_trace_file)
+		{
+			// recording stopped on another thread
+		}
+		else if (fwrite(&header, sizeof (header), 1, g_p_fw_trace_file) != 1 ||
+				(header.input_len && fwrite(p_cmd->input_payload,
+						header.input_len, 1, g_p_fw_trace_file) != 1) ||
+				(header.output_len && fwrite(p_cmd->output_payload,
+						header.output_len, 1, g_p_fw_trace_file) != 1) ||
+				(header.large_output_len && fwrite(p_cmd->large_output_payload,
+						header.large_output_len, 1, g_p_fw_trace_file) != 1))
+		{
+			COMMON_LOG_ERROR("Failed to write to the firmware trace file, recording stopped");
+			fclose(g_p_fw_trace_file);
+			g_p_fw_trace_file = NULL;
+			g_fw_trace_state = 0;
+		}
+		else
+		{
+			fflush(g_p_fw_trace_file);
+		}
+		pthread_mutex_unlock(&g_fw_trace_lock);
+	}
+}
+
+/*
+ * Walk the records in a trace file, filling in p_entries if it is not NULL
+ * @return the number of records or NVM_ERR_BADFILE
+ */
+static int fw_trace_parse(const unsigned char *p_data, const unsigned int data_len,
+		struct fw_trace_entry *p_entries)
+{
+	int count = 0;
+	unsigned int offset = sizeof (struct fw_trace_file_header);
+	while (count >= 0 && offset < data_len)
+	{
+		struct fw_trace_record_header header;
+		if (data_len - offset < sizeof (header))
+		{
+			count = NVM_ERR_BADFILE;
+			break;
+		}
+		memmove(&header, p_data + offset, sizeof (header));
+		offset += sizeof (header);
+
+		NVM_UINT64 record_len = (NVM_UINT64)header.input_len +
+				header.output_len + header.large_output_len;
+		if (header.input_len > header.input_size ||
+				header.output_len > header.output_size ||
+				header.large_output_len > header.large_output_size ||
+				record_len > data_len - offset)
+		{
+			count = NVM_ERR_BADFILE;
+			break;
+		}
+
+		if (p_entries)
+		{
+			struct fw_trace_entry *p_entry = &p_entries[count];
+			p_entry->header = header;
+			p_entry->p_input = p_data + offset;
+			p_entry->p_output = p_entry->p_input + header.input_len;
+			p_entry->p_large_output = p_entry->p_output + header.output_len;
+		}
+		offset += record_len;
+		count++;
+	}
+	return count;
+}
+
+/*
+ * Load a trace file for replay
+ */
+int fw_trace_load(const char *path, struct fw_trace **pp_trace)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	void *p_data = NULL;
+	unsigned int data_len = 0;
+	struct fw_trace *p_trace = NULL;
+
+	if (path == NULL || pp_trace == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (copy_file_to_buffer(path, s_strnlen(path, COMMON_PATH_LEN),
+			&p_data, &data_len) != COMMON_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("Failed to read the firmware trace file %s", path);
+		rc = NVM_ERR_BADFILE;
+	}
+	else if (data_len < sizeof (struct fw_trace_file_header) ||
+			memcmp(((struct fw_trace_file_header *)p_data)->magic,
+					FW_TRACE_MAGIC, sizeof (FW_TRACE_MAGIC)) != 0 ||
+			((struct fw_trace_file_header *)p_data)->version != FW_TRACE_VERSION)
+	{
+		COMMON_LOG_ERROR_F("%s is not a firmware trace file", path);
+		rc = NVM_ERR_BADFILE;
+	}
+	else if ((rc = fw_trace_parse(p_data, data_len, NULL)) < 0)
+	{
+		COMMON_LOG_ERROR_F("The firmware trace file %s is truncated or corrupt", path);
+	}
+	else if ((p_trace = calloc(1, sizeof (struct fw_trace))) == NULL ||
+			(rc > 0 && (p_trace->p_entries =
+					calloc(rc, sizeof (struct fw_trace_entry))) == NULL))
+	{
+		COMMON_LOG_ERROR("No memory to load the firmware trace");
+		rc = NVM_ERR_NOMEMORY;
+	}
+	else
+	{
+		p_trace->entry_count = fw_trace_parse(p_data, data_len, p_trace->p_entries);
+		p_trace->p_data = p_data;
+		p_data = NULL;
+
+		// prepend in reverse so each bucket lists its entries in recorded order
+		for (int i = p_trace->entry_count - 1; i >= 0; i--)
+		{
+			struct fw_trace_entry *p_entry = &p_trace->p_entries[i];
+			NVM_UINT32 bucket = fw_trace_bucket(p_entry->header.device_handle,
+					p_entry->header.opcode, p_entry->header.sub_opcode);
+			p_entry->p_next = p_trace->p_buckets[bucket];
+			p_trace->p_buckets[bucket] = p_entry;
+		}
+
+		COMMON_LOG_DEBUG_F("Loaded %d firmware commands from %s",
+				p_trace->entry_count, path);
+		*pp_trace = p_trace;
+		p_trace = NULL;
+		rc = NVM_SUCCESS;
+	}
+
+	fw_trace_free(p_trace);
+	if (p_data)
+	{
+		free(p_data);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Free a loaded trace
+ */
+void fw_trace_free(struct fw_trace *p_trace)
+{
+	if (p_trace)
+	{
+		if (p_trace->p_entries)
+		{
+			free(p_trace->p_entries);
+		}
+		if (p_trace->p_data)
+		{
+			free(p_trace->p_data);
+		}
+		free(p_trace);
+	}
+}
+
+/*
+ * Whether a recorded command was issued with the same inputs as a new one
+ */
+static NVM_BOOL fw_trace_matches(const struct fw_trace_entry *p_entry,
+		const struct fw_cmd *p_cmd)
+{
+	const struct fw_trace_record_header *p_header = &p_entry->header;
+	NVM_BOOL match = 0;
+	if (p_header->device_handle == p_cmd->device_handle &&
+			p_header->opcode == p_cmd->opcode &&
+			p_header->sub_opcode == p_cmd->sub_opcode &&
+			p_header->input_size == p_cmd->input_payload_size &&
+			p_header->large_input_size == p_cmd->large_input_payload_size)
+	{
+		match = 1;
+		if (!(p_header->flags & FW_TRACE_FLAG_INPUT_REDACTED) && p_header->input_len > 0 &&
+				memcmp(p_entry->p_input, p_cmd->input_payload, p_header->input_len) != 0)
+		{
+			match = 0;
+		}
+		else if (p_header->large_input_size > 0 &&
+				p_header->large_input_hash != fw_trace_hash(p_cmd->large_input_payload,
+						p_cmd->large_input_payload_size))
+		{
+			match = 0;
+		}
+	}
+	return match;
+}
+
+/*
+ * Copy a recorded payload to the caller's buffer, zero filling what was trimmed
+ */
+static void fw_trace_copy_output(void *p_buf, const NVM_UINT32 size,
+		const unsigned char *p_recorded, const NVM_UINT32 recorded_len)
+{
+	if (p_buf && size > 0)
+	{
+		NVM_UINT32 len = recorded_len < size ? recorded_len : size;
+		memset(p_buf, 0, size);
+		memmove(p_buf, p_recorded, len);
+	}
+}
+
+/*
+ * Serve a passthrough command from a loaded trace
+ */
+int fw_trace_replay(struct fw_trace *p_trace, struct fw_cmd *p_cmd,
+		int *p_rc, NVM_UINT32 *p_latency_usec)
+{
+	int matched = 0;
+	if (p_trace && p_cmd && p_rc)
+	{
+		struct fw_trace_entry *p_found = NULL;
+		struct fw_trace_entry *p_entry = p_trace->p_buckets[fw_trace_bucket(
+				p_cmd->device_handle, p_cmd->opcode, p_cmd->sub_opcode)];
+		for (; p_entry; p_entry = p_entry->p_next)
+		{
+			if (fw_trace_matches(p_entry, p_cmd))
+			{
+				p_found = p_entry;
+				if (!p_entry->served)
+				{
+					break;
+				}
+			}
+		}
+
+		if (p_found)
+		{
+			p_found->served = 1;
+			fw_trace_copy_output(p_cmd->output_payload, p_cmd->output_payload_size,
+					p_found->p_output, p_found->header.output_len);
+			fw_trace_copy_output(p_cmd->large_output_payload,
+					p_cmd->large_output_payload_size,
+					p_found->p_large_output, p_found->header.large_output_len);
+			*p_rc = p_found->header.rc;
+			if (p_latency_usec)
+			{
+				*p_latency_usec = p_found->header.latency_usec;
+			}
+			matched = 1;
+		}
+	}
+	return matched;
+}
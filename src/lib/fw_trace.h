@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file declares the firmware passthrough trace.  Every passthrough command
+ * can be recorded to a binary trace file and served back later by the simulated
+ * adapter, so a host's firmware behavior can be reproduced without its hardware.
+ *
+ * A trace file is a fw_trace_file_header followed by records.  Each record is a
+ * fw_trace_record_header followed by the stored input, output and large output
+ * bytes.  Outputs are stored without their trailing zeros and large inputs are
+ * reduced to a hash, which keeps PCD and firmware image traffic small.
+ */
+
+#ifndef FW_TRACE_H_
+#define	FW_TRACE_H_
+
+#include "device_fw.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define	FW_TRACE_MAGIC	"NVMFWTR" // includes the terminator, 8 bytes
+#define	FW_TRACE_VERSION	1
+
+// The input was not stored, it is ignored when matching the record
+#define	FW_TRACE_FLAG_INPUT_REDACTED	(1 << 0)
+
+struct fw_trace_file_header
+{
+	char magic[8];
+	NVM_UINT32 version;
+	NVM_UINT32 reserved;
+} __attribute__((packed));
+
+struct fw_trace_record_header
+{
+	NVM_UINT32 device_handle;
+	NVM_UINT8 opcode;
+	NVM_UINT8 sub_opcode;
+	NVM_UINT8 flags;
+	NVM_UINT8 reserved;
+	NVM_INT32 rc; // library return code of the command
+	NVM_UINT32 latency_usec;
+	// sizes the caller passed
+	NVM_UINT32 input_size;
+	NVM_UINT32 output_size;
+	NVM_UINT32 large_input_size;
+	NVM_UINT32 large_output_size;
+	NVM_UINT64 large_input_hash;
+	// bytes stored after the header
+	NVM_UINT32 input_len;
+	NVM_UINT32 output_len;
+	NVM_UINT32 large_output_len;
+} __attribute__((packed));
+
+/*
+ * A loaded trace, see fw_trace_load
+ */
+struct fw_trace;
+
+/*
+ * Whether passthrough commands are being recorded, set by the FW_TRACE_FILE config key.
+ * Cheap enough to call for every command.
+ */
+NVM_BOOL fw_trace_enabled();
+
+/*
+ * Append a completed passthrough command to the trace file
+ */
+void fw_trace_record(const struct fw_cmd *p_cmd, const int rc, const NVM_UINT64 latency_usec);
+
+/*
+ * Load a trace file for replay
+ */
+int fw_trace_load(const char *path, struct fw_trace **pp_trace);
+
+/*
+ * Free a loaded trace
+ */
+void fw_trace_free(struct fw_trace *p_trace);
+
+/*
+ * Serve a passthrough command from a loaded trace.
+ * Matching records are served in the order they were recorded, the last one repeats
+ * once they are used up.  Not thread safe, callers serialize replays.
+ * @return 1 if a record matched and *p_rc and the outputs were set, 0 otherwise
+ */
+int fw_trace_replay(struct fw_trace *p_trace, struct fw_cmd *p_cmd,
+		int *p_rc, NVM_UINT32 *p_latency_usec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FW_TRACE_H_ */
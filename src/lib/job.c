@@ -32,22 +32,330 @@
 #include "nvm_management.h"
 #include <persistence/logging.h>
 #include <persistence/lib_persistence.h>
+#include <persistence/config_settings.h>
 #include "device_adapter.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <guid/guid.h>
+#include <string/s_str.h>
+#include <os/os_adapter.h>
 #include "system.h"
+#include "job.h"
+
+// completed jobs are reported for an hour unless configured otherwise
+#define	DEFAULT_JOB_RETENTION_SECONDS	3600
+
+/*
+ * Read the sanitize state of a device
+ */
+int get_sanitize_status(const NVM_UINT32 device_handle,
+		struct pt_payload_sanitize_dimm_status *p_status)
+{
+	struct fw_cmd cmd;
+	memset(&cmd, 0, sizeof (struct fw_cmd));
+	memset(p_status, 0, sizeof (struct pt_payload_sanitize_dimm_status));
+	cmd.device_handle = device_handle;
+	cmd.opcode = PT_GET_SEC_INFO;
+	cmd.sub_opcode = SUBOP_GET_SAN_STATE;
+	cmd.output_payload_size = sizeof (struct pt_payload_sanitize_dimm_status);
+	cmd.output_payload = p_status;
+	int rc = ioctl_passthrough_cmd(&cmd);
+	if (rc != NVM_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("Unable to get sanitize status for handle: [%d]", device_handle);
+	}
+	return rc;
+}
+
+/*
+ * Apply the sanitize state read from a device to its job
+ */
+void update_job_from_sanitize_status(struct db_job *p_job,
+		const struct pt_payload_sanitize_dimm_status *p_status, const time_t now)
+{
+	if (p_status->state == SAN_INPROGRESS)
+	{
+		// a new sanitize was started since the last one finished
+		if (p_job->status == NVM_JOB_STATUS_COMPLETE)
+		{
+			p_job->start_time = 0;
+			p_job->end_time = 0;
+			memset(p_job->requester, 0, JOB_REQUESTER_LEN);
+		}
+		p_job->status = NVM_JOB_STATUS_RUNNING;
+		p_job->percent_complete = p_status->progress;
+	}
+	// the device returns to idle once a completed sanitize has been acknowledged
+	else if (p_status->state == SAN_COMPLETED || p_status->state == SAN_IDLE)
+	{
+		if (p_job->status != NVM_JOB_STATUS_COMPLETE)
+		{
+			p_job->status = NVM_JOB_STATUS_COMPLETE;
+			p_job->percent_complete = 100;
+			p_job->end_time = now;
+		}
+	}
+	else
+	{
+		p_job->status = NVM_JOB_STATUS_UNKNOWN;
+	}
+	p_job->last_update_time = now;
+}
+
+/*
+ * Project when a job will complete from the progress made since it started
+ */
+time_t estimate_job_completion(const struct db_job *p_job)
+{
+	time_t estimate = 0;
+	if (p_job->status == NVM_JOB_STATUS_COMPLETE)
+	{
+		estimate = p_job->end_time;
+	}
+	else if (p_job->status == NVM_JOB_STATUS_RUNNING && p_job->start_time != 0 &&
+			p_job->percent_complete > 0 && p_job->last_update_time > p_job->start_time)
+	{
+		NVM_UINT64 elapsed = p_job->last_update_time - p_job->start_time;
+		estimate = p_job->start_time + (elapsed * 100) / p_job->percent_complete;
+	}
+	return estimate;
+}
+
+/*
+ * Convert a job row to the job structure returned to the caller
+ */
+void db_job_to_job(const struct db_job *p_db_job, struct job *p_job)
+{
+	memset(p_job, 0, sizeof (struct job));
+	str_to_guid(p_db_job->device_guid, p_job->guid);
+	memmove(p_job->affected_element, p_job->guid, NVM_GUID_LEN);
+	p_job->type = p_db_job->type;
+	p_job->status = p_db_job->status;
+	p_job->percent_complete = p_db_job->percent_complete;
+	s_strcpy(p_job->requester, p_db_job->requester, NVM_JOB_REQUESTER_LEN);
+	p_job->start_time = p_db_job->start_time;
+	p_job->last_update_time = p_db_job->last_update_time;
+	p_job->end_time = p_db_job->end_time;
+	p_job->estimated_completion_time = estimate_job_completion(p_db_job);
+	p_job->result = NULL;
+}
+
+/*
+ * Start tracking a sanitize job that was just started on a device
+ */
+int record_job_started(const NVM_UINT32 device_handle, const NVM_GUID device_guid)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	PersistentStore *p_store = get_lib_store();
+	if (!p_store)
+	{
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else
+	{
+		struct db_job job;
+		memset(&job, 0, sizeof (job));
+		job.device_handle = device_handle;
+		guid_to_str(device_guid, job.device_guid);
+		job.type = NVM_JOB_TYPE_SANITIZE;
+		job.status = NVM_JOB_STATUS_RUNNING;
+		if (get_user_name(job.requester, JOB_REQUESTER_LEN) != COMMON_SUCCESS)
+		{
+			memset(job.requester, 0, JOB_REQUESTER_LEN);
+		}
+		job.start_time = time(NULL);
+		job.last_update_time = job.start_time;
+		if (db_upsert_job(p_store, &job) != DB_SUCCESS)
+		{
+			COMMON_LOG_ERROR_F("Failed to record the job started on %s", job.device_guid);
+			rc = NVM_ERR_UNKNOWN;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Remove the jobs that completed more than the retention time ago. The devices
+ * are polled every job monitor interval, so they aren't reported much longer.
+ */
+int remove_expired_jobs(PersistentStore *p_store, const time_t now)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	int retention = DEFAULT_JOB_RETENTION_SECONDS;
+	if (get_config_value_int(SQL_KEY_JOB_RETENTION, &retention) != COMMON_SUCCESS)
+	{
+		retention = DEFAULT_JOB_RETENTION_SECONDS;
+	}
+
+	int job_count = 0;
+	if (db_get_job_count(p_store, &job_count) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to retrieve job count.");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if (job_count > 0)
+	{
+		struct db_job db_jobs[job_count];
+		if ((job_count = db_get_jobs(p_store, db_jobs, job_count)) < 0)
+		{
+			COMMON_LOG_ERROR("Failed to retrieve the jobs.");
+			rc = NVM_ERR_UNKNOWN;
+		}
+		for (int i = 0; i < job_count; i++)
+		{
+			if (db_jobs[i].status == NVM_JOB_STATUS_COMPLETE &&
+					(time_t)db_jobs[i].end_time + retention < now &&
+					db_delete_job_by_device_handle(p_store,
+							db_jobs[i].device_handle) != DB_SUCCESS)
+			{
+				COMMON_LOG_ERROR_F("Failed to remove the completed job on %s",
+						db_jobs[i].device_guid);
+				rc = NVM_ERR_UNKNOWN;
+			}
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Refresh every job from the devices, picking up sanitizes started outside of
+ * this library. Returns the number of jobs still running.
+ */
+int poll_device_jobs(PersistentStore *p_store)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	if ((rc = nvm_get_device_count()) > 0)
+	{
+		int device_count = rc;
+		struct device_discovery devices[device_count];
+		if ((rc = nvm_get_devices(devices, device_count)) > 0)
+		{
+			device_count = rc;
+			int running_count = 0;
+			time_t now = time(NULL);
+			for (int i = 0; i < device_count; i++)
+			{
+				struct pt_payload_sanitize_dimm_status sanitize_status;
+				if (devices[i].manageability == MANAGEMENT_VALIDCONFIG &&
+						get_sanitize_status(devices[i].device_handle.handle,
+								&sanitize_status) == NVM_SUCCESS)
+				{
+					struct db_job job;
+					NVM_BOOL tracked = (db_get_job_by_device_handle(p_store,
+							devices[i].device_handle.handle, &job) == DB_SUCCESS);
+					if (!tracked && sanitize_status.state != SAN_IDLE)
+					{
+						// started outside of this library, when is not known
+						memset(&job, 0, sizeof (job));
+						job.device_handle = devices[i].device_handle.handle;
+						guid_to_str(devices[i].guid, job.device_guid);
+						job.type = NVM_JOB_TYPE_SANITIZE;
+						job.status = NVM_JOB_STATUS_NOT_STARTED;
+						tracked = 1;
+					}
+
+					if (tracked)
+					{
+						update_job_from_sanitize_status(&job, &sanitize_status, now);
+						if (db_upsert_job(p_store, &job) != DB_SUCCESS)
+						{
+							COMMON_LOG_ERROR_F("Failed to update the job on %s",
+									job.device_guid);
+						}
+						if (job.status == NVM_JOB_STATUS_RUNNING)
+						{
+							running_count++;
+						}
+					}
+				}
+			}
+
+			remove_expired_jobs(p_store, now);
+
+			char poll_time[CONFIG_VALUE_LEN];
+			snprintf(poll_time, CONFIG_VALUE_LEN, "%lld", (long long)now);
+			add_config_value(SQL_KEY_JOB_LAST_POLL_TIME, poll_time);
+			rc = running_count;
+		}
+		else if (rc < 0)
+		{
+			COMMON_LOG_ERROR_F("Unable to get device discovery: rc = %d", rc);
+		}
+	}
+	else if (rc < 0)
+	{
+		COMMON_LOG_ERROR_F("Unable to get device count: rc = %d", rc);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * The job table only picks up sanitizes started outside of this library when the
+ * devices are polled. Treat it as current if they were polled within two job
+ * monitor intervals, i.e. the monitor is running.
+ */
+NVM_BOOL job_table_is_current()
+{
+	NVM_BOOL current = 0;
+
+	int enabled = 0;
+	int interval = 0;
+	char poll_time[CONFIG_VALUE_LEN];
+	if (get_config_value_int(SQL_KEY_JOB_MONITOR_ENABLED, &enabled) == COMMON_SUCCESS &&
+			enabled &&
+			get_config_value_int(SQL_KEY_JOB_MONITOR_INTERVAL, &interval) == COMMON_SUCCESS &&
+			get_config_value(SQL_KEY_JOB_LAST_POLL_TIME, poll_time) == COMMON_SUCCESS)
+	{
+		time_t last_poll = (time_t)strtoll(poll_time, NULL, 10);
+		time_t now = time(NULL);
+		current = (last_poll <= now && (now - last_poll) <= (2 * (time_t)interval));
+	}
+	return current;
+}
 
 int nvm_get_job_count()
 {
 	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
+	PersistentStore *p_store = NULL;
+	int job_count = 0;
 
 	if (check_caller_permissions() != NVM_SUCCESS)
 	{
 		rc = NVM_ERR_INVALIDPERMISSIONS;
 	}
+	else if ((p_store = get_lib_store()) == NULL)
+	{
+		rc = NVM_ERR_UNKNOWN;
+	}
+	// fall back to polling the devices when the job monitor isn't keeping up
+	else if (!job_table_is_current() && poll_device_jobs(p_store) < 0)
+	{
+		COMMON_LOG_ERROR("Failed to poll the devices for jobs.");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if (db_get_job_count(p_store, &job_count) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to retrieve job count.");
+		rc = NVM_ERR_UNKNOWN;
+	}
 	else
 	{
-		rc = get_job_count();
+		rc = job_count;
 	}
 
 	COMMON_LOG_EXIT_RETURN_I(rc);
@@ -58,7 +366,8 @@ int nvm_get_jobs(struct job *p_jobs, const NVM_UINT32 count)
 {
 	COMMON_LOG_ENTRY();
 	int rc = NVM_SUCCESS;
-	int job_index = 0;
+	PersistentStore *p_store = NULL;
+	int job_count = 0;
 
 	if (check_caller_permissions() != NVM_SUCCESS)
 	{
@@ -69,87 +378,85 @@ int nvm_get_jobs(struct job *p_jobs, const NVM_UINT32 count)
 		COMMON_LOG_ERROR("Invalid parameter, p_jobs is NULL");
 		rc = NVM_ERR_INVALIDPARAMETER;
 	}
-	else if ((rc = get_job_count()) < 0)
+	else if ((p_store = get_lib_store()) == NULL)
+	{
+		rc = NVM_ERR_UNKNOWN;
+	}
+	// fall back to polling the devices when the job monitor isn't keeping up
+	else if (!job_table_is_current() && poll_device_jobs(p_store) < 0)
+	{
+		COMMON_LOG_ERROR("Failed to poll the devices for jobs.");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if (db_get_job_count(p_store, &job_count) != DB_SUCCESS)
 	{
 		COMMON_LOG_ERROR("Failed to retrieve job count.");
+		rc = NVM_ERR_UNKNOWN;
 	}
-	else if (rc > 0)
+	else if (job_count > count)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, "
+				"count is smaller than number of jobs");
+		rc = NVM_ERR_ARRAYTOOSMALL;
+	}
+	else if (job_count > 0)
 	{
 		// clear the structure
 		memset(p_jobs, 0, sizeof (struct job) * count);
 
-		if ((rc = nvm_get_device_count()) >= 0)
+		struct db_job db_jobs[job_count];
+		if ((job_count = db_get_jobs(p_store, db_jobs, job_count)) < 0)
 		{
-			int device_count = rc;
-			struct device_discovery devices[rc];
-			if ((rc = nvm_get_devices(devices, device_count)) > 0)
+			COMMON_LOG_ERROR("Failed to retrieve the jobs.");
+			rc = NVM_ERR_UNKNOWN;
+		}
+		else
+		{
+			// only jobs still running need fresh progress from their device
+			time_t now = time(NULL);
+			for (int i = 0; i < job_count; i++)
 			{
-				// iterate through all devices and add up the capacities
-				for (int i = 0; i < device_count; i++)
+				struct pt_payload_sanitize_dimm_status sanitize_status;
+				if (db_jobs[i].status == NVM_JOB_STATUS_RUNNING &&
+						get_sanitize_status(db_jobs[i].device_handle,
+								&sanitize_status) == NVM_SUCCESS)
 				{
-					if (job_index >= count)
-					{
-						rc = NVM_ERR_ARRAYTOOSMALL;
-						COMMON_LOG_ERROR("Invalid parameter, "
-								"count is smaller than number of jobs");
-						break;
-					}
-
-					if (devices[i].manageability == MANAGEMENT_VALIDCONFIG)
-					{
-						struct pt_payload_sanitize_dimm_status sanitize_status;
-						struct fw_cmd cmd;
-						memset(&cmd, 0, sizeof (struct fw_cmd));
-						cmd.device_handle = devices[i].device_handle.handle;
-						cmd.opcode = PT_GET_SEC_INFO;
-						cmd.sub_opcode = SUBOP_GET_SAN_STATE;
-						cmd.output_payload_size = sizeof (sanitize_status);
-						cmd.output_payload = &sanitize_status;
-						if (NVM_SUCCESS != ioctl_passthrough_cmd(&cmd))
-						{
-							COMMON_LOG_ERROR_F(
-									"Unable to get sanitize status for handle: [%d]",
-									devices[i].device_handle.handle);
-						}
-						else
-						{
-							if (sanitize_status.state != SAN_IDLE)
-							{
-								if (sanitize_status.state == SAN_INPROGRESS)
-								{
-									p_jobs[job_index].status = NVM_JOB_STATUS_RUNNING;
-								}
-								else if (sanitize_status.state ==  SAN_COMPLETED)
-								{
-									p_jobs[job_index].status = NVM_JOB_STATUS_COMPLETE;
-								}
-								else
-								{
-									p_jobs[job_index].status = NVM_JOB_STATUS_UNKNOWN;
-								}
-
-								p_jobs[job_index].type = NVM_JOB_TYPE_SANITIZE;
-								p_jobs[job_index].percent_complete = sanitize_status.progress;
-								memmove(p_jobs[job_index].guid, devices[i].guid, NVM_GUID_LEN);
-								memmove(p_jobs[job_index].affected_element,
-									devices[i].guid, NVM_GUID_LEN);
-								p_jobs[job_index].result = NULL;
-								job_index++;
-							}
-						}
-					}
-					rc = job_index;
+					update_job_from_sanitize_status(&db_jobs[i], &sanitize_status, now);
+					db_update_job_by_device_handle(p_store,
+							db_jobs[i].device_handle, &db_jobs[i]);
 				}
+				db_job_to_job(&db_jobs[i], &p_jobs[i]);
 			}
-			else
-			{
-				COMMON_LOG_ERROR_F("Unable to get device discovery: rc = %d", rc);
-			}
-		}
-		else
-		{
-			COMMON_LOG_ERROR_F("Unable to get device count: rc = %d", rc);
+			rc = job_count;
 		}
 	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Refresh the progress of every job from the devices
+ */
+int nvm_update_jobs()
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = NULL;
+
+	if (check_caller_permissions() != NVM_SUCCESS)
+	{
+		rc = NVM_ERR_INVALIDPERMISSIONS;
+	}
+	else if ((p_store = get_lib_store()) == NULL)
+	{
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else
+	{
+		rc = poll_device_jobs(p_store);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
@@ -816,9 +816,3 @@ int run_test(enum driver_diagnostic diagnostic, const NVM_UINT32 count,
 	int rc = NVM_ERR_NOTSUPPORTED;
 	return rc;
 }
-
-int get_job_count()
-{
-	int rc = NVM_ERR_NOTSUPPORTED;
-	return rc;
-}
@@ -34,53 +34,175 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <linux/fs.h>
+#include <pthread.h>
 #include <string/s_str.h>
 #include <guid/guid.h>
 #include "utility.h"
 
 #define	DEFAULT_BTT_SECTOR_SIZE	4096
+#define	NAMESPACE_INDEX_BUCKETS	64
+#define	NAMESPACE_INDEX_END	-1
 
 /*
- * Get the number of existing namespaces
+ * One configured namespace in the index
  */
-int get_namespace_count()
+struct namespace_index_entry
+{
+	NVM_GUID guid;
+	struct ndctl_namespace *p_namespace;
+	int next; // next entry in the same hash bucket
+};
+
+/*
+ * The namespace adapter shares a single ndctl context between calls and indexes the
+ * configured namespaces in it by UUID, so finding a namespace doesn't require walking
+ * every bus, region and namespace. Entries are kept in walk order for listing.
+ * Listing rebuilds the index from a fresh context, creating or deleting a namespace
+ * invalidates it. All access is serialized by g_namespace_index_lock.
+ */
+struct namespace_index
+{
+	struct ndctl_ctx *p_ctx;
+	struct namespace_index_entry *p_entries;
+	int count;
+	int capacity;
+	int buckets[NAMESPACE_INDEX_BUCKETS];
+};
+
+static pthread_mutex_t g_namespace_index_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct namespace_index g_namespace_index;
+
+static unsigned int get_namespace_index_bucket(const NVM_GUID guid)
+{
+	// FNV-1a, UUIDs are random enough that any byte mix spreads them evenly
+	unsigned int hash = 2166136261u;
+	for (int i = 0; i < NVM_GUID_LEN; i++)
+	{
+		hash = (hash ^ guid[i]) * 16777619u;
+	}
+	return hash % NAMESPACE_INDEX_BUCKETS;
+}
+
+/*
+ * Drop the namespace index and release its ndctl context.
+ * Caller must hold g_namespace_index_lock.
+ */
+static void invalidate_namespace_index()
+{
+	if (g_namespace_index.p_ctx)
+	{
+		ndctl_unref(g_namespace_index.p_ctx);
+	}
+	free(g_namespace_index.p_entries);
+	memset(&g_namespace_index, 0, sizeof (g_namespace_index));
+}
+
+static int add_namespace_index_entry(struct ndctl_namespace *p_namespace)
+{
+	int rc = NVM_SUCCESS;
+
+	if (g_namespace_index.count == g_namespace_index.capacity)
+	{
+		int capacity = g_namespace_index.capacity ? g_namespace_index.capacity * 2 : 16;
+		struct namespace_index_entry *p_entries = realloc(g_namespace_index.p_entries,
+				capacity * sizeof (struct namespace_index_entry));
+		if (!p_entries)
+		{
+			COMMON_LOG_ERROR("Failed to allocate the namespace index");
+			rc = NVM_ERR_NOMEMORY;
+		}
+		else
+		{
+			g_namespace_index.p_entries = p_entries;
+			g_namespace_index.capacity = capacity;
+		}
+	}
+
+	if (rc == NVM_SUCCESS)
+	{
+		struct namespace_index_entry *p_entry =
+				&g_namespace_index.p_entries[g_namespace_index.count];
+		ndctl_namespace_get_uuid(p_namespace, p_entry->guid);
+		p_entry->p_namespace = p_namespace;
+
+		unsigned int bucket = get_namespace_index_bucket(p_entry->guid);
+		p_entry->next = g_namespace_index.buckets[bucket];
+		g_namespace_index.buckets[bucket] = g_namespace_index.count;
+		g_namespace_index.count++;
+	}
+
+	return rc;
+}
+
+/*
+ * Rebuild the namespace index from a fresh ndctl context.
+ * Caller must hold g_namespace_index_lock.
+ */
+static int build_namespace_index()
 {
 	COMMON_LOG_ENTRY();
-	int rc = 0; // returns the namespace count
+	int rc = NVM_SUCCESS;
 
-	int num_namespaces = 0;
-	struct ndctl_ctx *ctx;
+	invalidate_namespace_index();
+	for (int i = 0; i < NAMESPACE_INDEX_BUCKETS; i++)
+	{
+		g_namespace_index.buckets[i] = NAMESPACE_INDEX_END;
+	}
 
-	if ((rc = ndctl_new(&ctx)) >= 0)
+	if ((rc = ndctl_new(&g_namespace_index.p_ctx)) < 0)
 	{
-		struct ndctl_bus *bus;
-		ndctl_bus_foreach(ctx, bus)
+		g_namespace_index.p_ctx = NULL;
+		rc = linux_err_to_nvm_lib_err(rc);
+	}
+	else
+	{
+		rc = NVM_SUCCESS;
+		struct ndctl_bus *p_bus;
+		ndctl_bus_foreach(g_namespace_index.p_ctx, p_bus)
 		{
-			struct ndctl_region *region;
-			ndctl_region_foreach(bus, region)
+			struct ndctl_region *p_region;
+			ndctl_region_foreach(p_bus, p_region)
 			{
-				int nstype = ndctl_region_get_nstype(region);
-				if (ndctl_region_is_enabled(region) &&
+				int nstype = ndctl_region_get_nstype(p_region);
+				if (ndctl_region_is_enabled(p_region) &&
 					(nstype == ND_DEVICE_NAMESPACE_PMEM || nstype == ND_DEVICE_NAMESPACE_BLK))
 				{
-					struct ndctl_namespace *namespace;
-					ndctl_namespace_foreach(region, namespace)
+					struct ndctl_namespace *p_namespace;
+					ndctl_namespace_foreach(p_region, p_namespace)
 					{
-						if (ndctl_namespace_is_configured(namespace))
+						if (rc == NVM_SUCCESS && ndctl_namespace_is_configured(p_namespace))
 						{
-							num_namespaces++;
+							rc = add_namespace_index_entry(p_namespace);
 						}
 					}
 				}
 			}
 		}
-		rc = num_namespaces;
-		ndctl_unref(ctx);
+
+		if (rc != NVM_SUCCESS)
+		{
+			invalidate_namespace_index();
+		}
 	}
-	else
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Get the number of existing namespaces
+ */
+int get_namespace_count()
+{
+	COMMON_LOG_ENTRY();
+	int rc = 0; // returns the namespace count
+
+	pthread_mutex_lock(&g_namespace_index_lock);
+	if ((rc = build_namespace_index()) == NVM_SUCCESS)
 	{
-		rc = linux_err_to_nvm_lib_err(rc);
+		rc = g_namespace_index.count;
 	}
+	pthread_mutex_unlock(&g_namespace_index_lock);
 
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
@@ -95,58 +217,39 @@ int get_namespaces(const NVM_UINT32 count,
 	COMMON_LOG_ENTRY();
 	int rc = NVM_SUCCESS;
 
-	int namespace_index = 0;
-	struct ndctl_ctx *ctx;
-
 	if (p_namespaces == NULL)
 	{
 		COMMON_LOG_ERROR("p_namespaces is NULL");
 		rc = NVM_ERR_UNKNOWN;
 	}
-	else if ((rc = ndctl_new(&ctx)) >= 0)
+	else
 	{
-		memset(p_namespaces, 0, sizeof (struct nvm_namespace_discovery) * count);
-
-		struct ndctl_bus *bus;
-		ndctl_bus_foreach(ctx, bus)
+		pthread_mutex_lock(&g_namespace_index_lock);
+		if ((rc = build_namespace_index()) == NVM_SUCCESS)
 		{
-			struct ndctl_region *region;
-			ndctl_region_foreach(bus, region)
+			memset(p_namespaces, 0, sizeof (struct nvm_namespace_discovery) * count);
+
+			int namespace_index = 0;
+			for (; namespace_index < g_namespace_index.count; namespace_index++)
 			{
-				int nstype = ndctl_region_get_nstype(region);
-				if (ndctl_region_is_enabled(region) &&
-					(nstype == ND_DEVICE_NAMESPACE_PMEM || nstype == ND_DEVICE_NAMESPACE_BLK))
+				if (namespace_index >= count)
 				{
-					struct ndctl_namespace *namespace;
-					ndctl_namespace_foreach(region, namespace)
-					{
-						if (ndctl_namespace_is_configured(namespace))
-						{
-							if (namespace_index >= count)
-							{
-								rc = NVM_ERR_ARRAYTOOSMALL;
-								COMMON_LOG_ERROR("Invalid parameter, "
-										"count is smaller than number of "NVM_DIMM_NAME"s");
-								break;
-							}
-
-							ndctl_namespace_get_uuid(namespace,
-								p_namespaces[namespace_index].namespace_guid);
-							s_strcpy(p_namespaces[namespace_index].friendly_name,
-								ndctl_namespace_get_alt_name(namespace), NVM_NAMESPACE_NAME_LEN);
-
-							namespace_index++;
-						}
-					}
+					COMMON_LOG_ERROR("Invalid parameter, "
+							"count is smaller than number of "NVM_DIMM_NAME"s");
+					break;
 				}
+
+				struct namespace_index_entry *p_entry =
+						&g_namespace_index.p_entries[namespace_index];
+				memmove(p_namespaces[namespace_index].namespace_guid,
+					p_entry->guid, NVM_GUID_LEN);
+				s_strcpy(p_namespaces[namespace_index].friendly_name,
+					ndctl_namespace_get_alt_name(p_entry->p_namespace),
+					NVM_NAMESPACE_NAME_LEN);
 			}
+			rc = namespace_index;
 		}
-		rc = namespace_index;
-		ndctl_unref(ctx);
-	}
-	else
-	{
-		rc = linux_err_to_nvm_lib_err(rc);
+		pthread_mutex_unlock(&g_namespace_index_lock);
 	}
 
 	COMMON_LOG_EXIT_RETURN_I(rc);
@@ -263,34 +366,115 @@ int disable_namespace(struct ndctl_namespace *p_namespace)
 	return rc;
 }
 
-struct ndctl_namespace *get_ndctl_namespace_from_guid(struct ndctl_ctx *p_ctx,
-		const NVM_GUID namespace_guid)
+static struct ndctl_namespace *find_indexed_namespace(const NVM_GUID namespace_guid)
 {
-	struct ndctl_bus *p_bus;
-	ndctl_bus_foreach(p_ctx, p_bus)
+	struct ndctl_namespace *p_namespace = NULL;
+	if (g_namespace_index.p_ctx)
 	{
-		struct ndctl_region *p_region;
-		ndctl_region_foreach(p_bus, p_region)
+		int i = g_namespace_index.buckets[get_namespace_index_bucket(namespace_guid)];
+		for (; i != NAMESPACE_INDEX_END && !p_namespace; i = g_namespace_index.p_entries[i].next)
 		{
-			int nstype = ndctl_region_get_nstype(p_region);
-			if (ndctl_region_is_enabled(p_region) &&
-				(nstype == ND_DEVICE_NAMESPACE_PMEM || nstype == ND_DEVICE_NAMESPACE_BLK))
+			if (!memcmp(namespace_guid, g_namespace_index.p_entries[i].guid, NVM_GUID_LEN))
 			{
-				struct ndctl_namespace *p_namespace = NULL;
-				ndctl_namespace_foreach(p_region, p_namespace)
-				{
-					NVM_GUID index_guid;
-					ndctl_namespace_get_uuid(p_namespace, index_guid);
-					if (ndctl_namespace_is_configured(p_namespace) &&
-						!memcmp(namespace_guid, index_guid, NVM_GUID_LEN))
-					{
-						return p_namespace;
-					}
-				}
+				p_namespace = g_namespace_index.p_entries[i].p_namespace;
 			}
 		}
 	}
-	return NULL;
+	return p_namespace;
+}
+
+/*
+ * Read a namespace attribute from sysfs without the trailing newline
+ */
+static int read_namespace_sysfs_attr(struct ndctl_namespace *p_namespace,
+		const char *attr, char *buf)
+{
+	int rc = NVM_SUCCESS;
+
+	char attr_path[PATH_MAX];
+	snprintf(attr_path, PATH_MAX, "/sys/bus/nd/devices/%s/%s",
+		ndctl_namespace_get_devname(p_namespace), attr);
+
+	int fd = open(attr_path, O_RDONLY|O_CLOEXEC);
+	if (fd < 0)
+	{
+		COMMON_LOG_DEBUG_F("Failed to open %s", attr_path);
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+	else
+	{
+		int bytes_read = read(fd, buf, SYSFS_ATTR_SIZE);
+		close(fd);
+		if (bytes_read < 0 || bytes_read >= SYSFS_ATTR_SIZE)
+		{
+			COMMON_LOG_DEBUG_F("Failed to read from %s", attr_path);
+			rc = NVM_ERR_DRIVERFAILED;
+		}
+		else
+		{
+			buf[bytes_read] = 0;
+			if (bytes_read && buf[bytes_read-1] == '\n')
+			{
+				buf[bytes_read-1] = 0;
+			}
+		}
+	}
+	return rc;
+}
+
+/*
+ * The index context caches namespace attributes when it is built. Check the ones
+ * another process could have changed since then against sysfs.
+ */
+static NVM_BOOL indexed_namespace_is_current(struct ndctl_namespace *p_namespace,
+		const NVM_GUID namespace_guid)
+{
+	NVM_BOOL current = 0;
+
+	char buf[SYSFS_ATTR_SIZE];
+	COMMON_GUID_STR guid_str;
+	guid_to_str(namespace_guid, guid_str);
+	if (read_namespace_sysfs_attr(p_namespace, "uuid", buf) == NVM_SUCCESS &&
+			strcasecmp(buf, guid_str) == 0 &&
+			read_namespace_sysfs_attr(p_namespace, "size", buf) == NVM_SUCCESS &&
+			strtoull(buf, NULL, 0) == ndctl_namespace_get_size(p_namespace) &&
+			read_namespace_sysfs_attr(p_namespace, "alt_name", buf) == NVM_SUCCESS)
+	{
+		const char *alt_name = ndctl_namespace_get_alt_name(p_namespace);
+		current = (strcmp(buf, alt_name ? alt_name : "") == 0);
+	}
+	return current;
+}
+
+/*
+ * Look up a configured namespace by UUID in the namespace index. A miss, or a hit
+ * that no longer matches sysfs, rebuilds the index once in case the namespace was
+ * created or modified outside of this process.
+ * Caller must hold g_namespace_index_lock.
+ */
+static int get_ndctl_namespace_from_guid(struct ndctl_namespace **pp_namespace,
+		const NVM_GUID namespace_guid)
+{
+	int rc = NVM_SUCCESS;
+
+	*pp_namespace = find_indexed_namespace(namespace_guid);
+	if (*pp_namespace && !indexed_namespace_is_current(*pp_namespace, namespace_guid))
+	{
+		COMMON_LOG_DEBUG("Namespace index is stale");
+		*pp_namespace = NULL;
+	}
+
+	if (!*pp_namespace && (rc = build_namespace_index()) == NVM_SUCCESS)
+	{
+		*pp_namespace = find_indexed_namespace(namespace_guid);
+	}
+
+	if (rc == NVM_SUCCESS && !*pp_namespace)
+	{
+		COMMON_LOG_ERROR("Specified namespace not found");
+		rc = NVM_ERR_BADNAMESPACE;
+	}
+	return rc;
 }
 
 /*
@@ -303,7 +487,6 @@ int get_namespace_details(
 	COMMON_LOG_ENTRY();
 	int rc = NVM_SUCCESS;
 
-	struct ndctl_ctx *ctx;
 	if (namespace_guid == NULL)
 	{
 			COMMON_LOG_ERROR("namespace guid cannot be NULL.");
@@ -314,17 +497,13 @@ int get_namespace_details(
 		COMMON_LOG_ERROR("nvm_namespace_details is NULL");
 		rc = NVM_ERR_INVALIDPARAMETER;
 	}
-	else if ((rc = ndctl_new(&ctx)) >= 0)
+	else
 	{
 		memset(p_details, 0, sizeof (struct nvm_namespace_details));
-		struct ndctl_namespace *p_namespace =
-				get_ndctl_namespace_from_guid(ctx, namespace_guid);
-		if (!p_namespace)
-		{
-			COMMON_LOG_ERROR("Specified namespace not found");
-			rc = NVM_ERR_BADNAMESPACE;
-		}
-		else
+		pthread_mutex_lock(&g_namespace_index_lock);
+		struct ndctl_namespace *p_namespace;
+		if ((rc = get_ndctl_namespace_from_guid(&p_namespace, namespace_guid))
+				== NVM_SUCCESS)
 		{
 			struct ndctl_region *p_region =
 					ndctl_namespace_get_region(p_namespace);
@@ -384,11 +563,7 @@ int get_namespace_details(
 			p_details->block_count =
 				calculateBlockCount((ndctl_namespace_get_size(p_namespace)), p_details->block_size);
 		}
-		ndctl_unref(ctx);
-	}
-	else
-	{
-		rc = linux_err_to_nvm_lib_err(rc);
+		pthread_mutex_unlock(&g_namespace_index_lock);
 	}
 
 	COMMON_LOG_EXIT_RETURN_I(rc);
@@ -657,6 +832,11 @@ int create_namespace(
 			{
 				COMMON_LOG_ERROR("Failed to configure the namespace");
 			}
+
+			// the indexed context doesn't know about the new namespace
+			pthread_mutex_lock(&g_namespace_index_lock);
+			invalidate_namespace_index();
+			pthread_mutex_unlock(&g_namespace_index_lock);
 		}
 		ndctl_unref(ctx);
 	}
@@ -677,22 +857,17 @@ int delete_namespace(const NVM_GUID namespace_guid)
 	COMMON_LOG_ENTRY();
 	int rc = NVM_SUCCESS;
 
-	struct ndctl_ctx *p_ctx;
 	if (namespace_guid == NULL)
 	{
 			COMMON_LOG_ERROR("namespace guid cannot be NULL.");
 			rc = NVM_ERR_INVALIDPARAMETER;
 	}
-	else if ((rc = ndctl_new(&p_ctx)) >= 0)
+	else
 	{
-		struct ndctl_namespace *p_namespace =
-				get_ndctl_namespace_from_guid(p_ctx, namespace_guid);
-		if (!p_namespace)
-		{
-			COMMON_LOG_ERROR("Specified namespace not found");
-			rc = NVM_ERR_BADNAMESPACE;
-		}
-		else
+		pthread_mutex_lock(&g_namespace_index_lock);
+		struct ndctl_namespace *p_namespace;
+		if ((rc = get_ndctl_namespace_from_guid(&p_namespace, namespace_guid))
+				== NVM_SUCCESS)
 		{
 			// disable it
 			if ((rc = disable_namespace(p_namespace)) == NVM_SUCCESS)
@@ -700,12 +875,9 @@ int delete_namespace(const NVM_GUID namespace_guid)
 				// delete it
 				rc = linux_err_to_nvm_lib_err(ndctl_namespace_delete(p_namespace));
 			}
+			invalidate_namespace_index();
 		}
-		ndctl_unref(p_ctx);
-	}
-	else
-	{
-		rc = linux_err_to_nvm_lib_err(rc);
+		pthread_mutex_unlock(&g_namespace_index_lock);
 	}
 
 	COMMON_LOG_EXIT_RETURN_I(rc);
@@ -722,22 +894,17 @@ int modify_namespace_name(
 	COMMON_LOG_ENTRY();
 	int rc = NVM_SUCCESS;
 
-	struct ndctl_ctx *p_ctx;
 	if (namespace_guid == NULL)
 	{
 			COMMON_LOG_ERROR("namespace guid cannot be NULL.");
 			rc = NVM_ERR_INVALIDPARAMETER;
 	}
-	else if ((rc = ndctl_new(&p_ctx)) >= 0)
+	else
 	{
-		struct ndctl_namespace *p_namespace =
-				get_ndctl_namespace_from_guid(p_ctx, namespace_guid);
-		if (!p_namespace)
-		{
-			COMMON_LOG_ERROR("Specified namespace not found");
-			rc = NVM_ERR_BADNAMESPACE;
-		}
-		else
+		pthread_mutex_lock(&g_namespace_index_lock);
+		struct ndctl_namespace *p_namespace;
+		if ((rc = get_ndctl_namespace_from_guid(&p_namespace, namespace_guid))
+				== NVM_SUCCESS)
 		{
 			NVM_BOOL ns_enabled = 0;
 			struct ndctl_btt *p_btt = ndctl_namespace_get_btt(p_namespace);
@@ -767,11 +934,7 @@ int modify_namespace_name(
 				COMMON_LOG_ERROR("Failed to re-enable namespace ");
 			}
 		}
-		ndctl_unref(p_ctx);
-	}
-	else
-	{
-		rc = linux_err_to_nvm_lib_err(rc);
+		pthread_mutex_unlock(&g_namespace_index_lock);
 	}
 
 	COMMON_LOG_EXIT_RETURN_I(rc);
@@ -799,22 +962,17 @@ int modify_namespace_enabled(
 	COMMON_LOG_ENTRY();
 	int rc = NVM_SUCCESS;
 
-	struct ndctl_ctx *p_ctx;
 	if (namespace_guid == NULL)
 	{
 			COMMON_LOG_ERROR("namespace guid cannot be NULL.");
 			rc = NVM_ERR_INVALIDPARAMETER;
 	}
-	else if ((rc = ndctl_new(&p_ctx)) >= 0)
+	else
 	{
-		struct ndctl_namespace *p_namespace =
-				get_ndctl_namespace_from_guid(p_ctx, namespace_guid);
-		if (!p_namespace)
-		{
-			COMMON_LOG_ERROR("Specified namespace not found");
-			rc = NVM_ERR_BADNAMESPACE;
-		}
-		else
+		pthread_mutex_lock(&g_namespace_index_lock);
+		struct ndctl_namespace *p_namespace;
+		if ((rc = get_ndctl_namespace_from_guid(&p_namespace, namespace_guid))
+				== NVM_SUCCESS)
 		{
 			if (enabled == NAMESPACE_ENABLE_STATE_DISABLED)
 			{
@@ -825,11 +983,7 @@ int modify_namespace_enabled(
 				rc = enable_namespace(p_namespace);
 			}
 		}
-		ndctl_unref(p_ctx);
-	}
-	else
-	{
-		rc = linux_err_to_nvm_lib_err(rc);
+		pthread_mutex_unlock(&g_namespace_index_lock);
 	}
 
 	COMMON_LOG_EXIT_RETURN_I(rc);
@@ -32,6 +32,8 @@
 
 #include "device_adapter.h"
 #include "lnx_adapter.h"
+#include "fw_trace.h"
+#include "mailbox_stats.h"
 #include <os/os_adapter.h>
 
 #define	BIOS_INPUT(NAME, IN_LEN)		\
@@ -100,6 +102,8 @@ int bios_write_large_payload(struct ndctl_dimm *p_dimm, struct fw_cmd *p_fw_cmd)
 	COMMON_LOG_ENTRY();
 	int rc = NVM_SUCCESS;
 	struct pt_bios_get_size mb_size;
+	NVM_UINT64 start_usec = get_monotonic_usec();
+	unsigned int current_offset = 0;
 
 	if (!p_dimm)
 	{
@@ -115,7 +119,6 @@ int bios_write_large_payload(struct ndctl_dimm *p_dimm, struct fw_cmd *p_fw_cmd)
 		else
 		{
 			unsigned int transfer_size = mb_size.rw_size;
-			unsigned int current_offset = 0;
 
 			while (current_offset < p_fw_cmd->large_input_payload_size &&
 					rc == NVM_SUCCESS)
@@ -183,6 +186,10 @@ int bios_write_large_payload(struct ndctl_dimm *p_dimm, struct fw_cmd *p_fw_cmd)
 		}
 	}
 
+	mailbox_stats_record(MAILBOX_COMMAND_LARGE_WRITE, p_fw_cmd->device_handle,
+			p_fw_cmd->opcode, p_fw_cmd->sub_opcode, rc, current_offset,
+			get_monotonic_usec() - start_usec);
+
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
@@ -195,6 +202,8 @@ int bios_read_large_payload(struct ndctl_dimm *p_dimm, struct fw_cmd *p_fw_cmd)
 	COMMON_LOG_ENTRY();
 	int rc = NVM_SUCCESS;
 	struct pt_bios_get_size mb_size;
+	NVM_UINT64 start_usec = get_monotonic_usec();
+	unsigned int current_offset = 0;
 
 	if (!p_dimm)
 	{
@@ -210,7 +219,6 @@ int bios_read_large_payload(struct ndctl_dimm *p_dimm, struct fw_cmd *p_fw_cmd)
 		else
 		{
 			unsigned int transfer_size = mb_size.rw_size;
-			unsigned int current_offset = 0;
 			rc = NVM_SUCCESS;
 			while (current_offset < p_fw_cmd->large_output_payload_size &&
 					rc == NVM_SUCCESS)
@@ -281,6 +289,10 @@ int bios_read_large_payload(struct ndctl_dimm *p_dimm, struct fw_cmd *p_fw_cmd)
 		}
 	}
 
+	mailbox_stats_record(MAILBOX_COMMAND_LARGE_READ, p_fw_cmd->device_handle,
+			p_fw_cmd->opcode, p_fw_cmd->sub_opcode, rc, current_offset,
+			get_monotonic_usec() - start_usec);
+
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
@@ -322,6 +334,7 @@ int ioctl_passthrough_cmd(struct fw_cmd *p_fw_cmd)
 	COMMON_LOG_ENTRY();
 	int rc = NVM_SUCCESS;
 	struct ndctl_ctx *ctx;
+	NVM_UINT64 start_usec = get_monotonic_usec();
 	// check input parameters
 	if (p_fw_cmd == NULL)
 	{
@@ -411,6 +424,20 @@ int ioctl_passthrough_cmd(struct fw_cmd *p_fw_cmd)
 		ndctl_unref(ctx);
 	}
 
+	if (p_fw_cmd)
+	{
+		NVM_UINT64 latency_usec = get_monotonic_usec() - start_usec;
+		mailbox_stats_record(MAILBOX_COMMAND_PASSTHROUGH, p_fw_cmd->device_handle,
+				p_fw_cmd->opcode, p_fw_cmd->sub_opcode, rc,
+				(NVM_UINT64)p_fw_cmd->input_payload_size + p_fw_cmd->output_payload_size +
+				p_fw_cmd->large_input_payload_size + p_fw_cmd->large_output_payload_size,
+				latency_usec);
+		if (fw_trace_enabled())
+		{
+			fw_trace_record(p_fw_cmd, rc, latency_usec);
+		}
+	}
+
 	s_memset(&p_fw_cmd, sizeof (p_fw_cmd));
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
@@ -0,0 +1,578 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file contains the implementation of the firmware mailbox statistics.
+ *
+ * Each device, command and type has a slot in a fixed size open addressed table.
+ * A slot is claimed by swapping its key in and its counters are only ever added to
+ * with atomic operations, so recording a command takes no lock.
+ *
+ * Latencies go in a log-linear histogram: the first four buckets are 0 to 3
+ * microseconds, after that every power of two is split into four buckets.
+ *
+ * The counters only cover the process that sends the commands, so the monitor
+ * service publishes its own to a file next to the config database where any
+ * other process can read them back.
+ */
+
+#include "mailbox_stats.h"
+#include <persistence/logging.h>
+#include <persistence/lib_persistence.h>
+#include <file_ops/file_ops_adapter.h>
+#include <string/s_str.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#ifdef __WINDOWS__
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// enough for every command the library sends to a fully populated system
+#define	MAILBOX_STATS_SLOTS	1024
+#define	MAILBOX_STATS_LINEAR_BUCKETS	4 // the buckets holding one value each
+#define	MAILBOX_STATS_SUB_BUCKET_BITS	2 // each power of two is split in 1 << bits buckets
+
+#define	MAILBOX_STATS_FILE	"mailbox_stats.dat" // published counters, next to CONFIG_FILE
+#define	MAILBOX_STATS_TMP_SUFFIX	".tmp"
+#define	MAILBOX_STATS_MAGIC	"NVMMBXS" // includes the terminator, 8 bytes
+#define	MAILBOX_STATS_VERSION	1
+
+/*
+ * A published stats file is this header followed by entry_count device_mailbox_stats
+ */
+struct mailbox_stats_file_header
+{
+	char magic[8];
+	NVM_UINT32 version;
+	NVM_UINT32 entry_size; // sizeof (struct device_mailbox_stats) of the publisher
+	NVM_UINT32 entry_count;
+	NVM_UINT32 reserved;
+};
+
+/*
+ * The counters of one device, command and type
+ */
+struct mailbox_stats_slot
+{
+	volatile NVM_UINT64 key; // 0 while the slot is free
+	volatile NVM_UINT64 count;
+	volatile NVM_UINT64 bytes;
+	volatile NVM_UINT64 errors;
+	volatile NVM_UINT64 busy;
+	volatile NVM_UINT64 total_latency_usec;
+	volatile NVM_UINT64 max_latency_usec;
+	volatile NVM_UINT32 latency_histogram[NVM_MAILBOX_LATENCY_BUCKETS];
+};
+
+static struct mailbox_stats_slot g_mailbox_stats[MAILBOX_STATS_SLOTS];
+// commands not counted because the table was full
+static volatile NVM_UINT64 g_mailbox_stats_dropped = 0;
+// serializes publishers so the temporary file isn't shared between threads
+static pthread_mutex_t g_mailbox_stats_publish_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Monotonic time in microseconds, for timing mailbox commands
+ */
+NVM_UINT64 get_monotonic_usec()
+{
+#ifdef __WINDOWS__
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER now;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&now);
+	// split so neither a frequency under 1 MHz nor the multiply overflows
+	NVM_UINT64 ticks = (NVM_UINT64)now.QuadPart;
+	NVM_UINT64 ticks_per_sec = (NVM_UINT64)frequency.QuadPart;
+	return (ticks / ticks_per_sec) * 1000000 + ((ticks % ticks_per_sec) * 1000000) / ticks_per_sec;
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (NVM_UINT64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+}
+
+/*
+ * The type is stored off by one so a key is never 0
+ */
+static NVM_UINT64 mailbox_stats_key(const enum mailbox_command_type type,
+		const NVM_UINT32 device_handle, const NVM_UINT8 opcode, const NVM_UINT8 sub_opcode)
+{
+	return ((NVM_UINT64)(type + 1) << 48) | ((NVM_UINT64)device_handle << 16) |
+			((NVM_UINT64)opcode << 8) | sub_opcode;
+}
+
+/*
+ * Find the slot of a key, claiming a free one if the key has none yet
+ * @return NULL if the table is full
+ */
+static struct mailbox_stats_slot *mailbox_stats_find_slot(const NVM_UINT64 key)
+{
+	struct mailbox_stats_slot *p_slot = NULL;
+	NVM_UINT32 start = (NVM_UINT32)((key * 0x9E3779B97F4A7C15ULL) >> 40) % MAILBOX_STATS_SLOTS;
+	for (NVM_UINT32 i = 0; i < MAILBOX_STATS_SLOTS && !p_slot; i++)
+	{
+		struct mailbox_stats_slot *p_candidate =
+				&g_mailbox_stats[(start + i) % MAILBOX_STATS_SLOTS];
+		NVM_UINT64 slot_key = p_candidate->key;
+		if (slot_key == 0)
+		{
+			// another thread may claim it first, for this key or another one
+			slot_key = __sync_val_compare_and_swap(&p_candidate->key, 0, key);
+			if (slot_key == 0)
+			{
+				slot_key = key;
+			}
+		}
+		if (slot_key == key)
+		{
+			p_slot = p_candidate;
+		}
+	}
+	return p_slot;
+}
+
+/*
+ * Index of the most significant bit set, value must not be 0
+ */
+static NVM_UINT32 mailbox_stats_log2(NVM_UINT64 value)
+{
+	NVM_UINT32 bit = 0;
+	while (value >>= 1)
+	{
+		bit++;
+	}
+	return bit;
+}
+
+static NVM_UINT32 mailbox_stats_bucket(const NVM_UINT64 latency_usec)
+{
+	NVM_UINT32 bucket = 0;
+	if (latency_usec < MAILBOX_STATS_LINEAR_BUCKETS)
+	{
+		bucket = (NVM_UINT32)latency_usec;
+	}
+	else
+	{
+		NVM_UINT32 magnitude = mailbox_stats_log2(latency_usec) - MAILBOX_STATS_SUB_BUCKET_BITS;
+		NVM_UINT32 sub_bucket = (latency_usec >> magnitude) -
+				(1 << MAILBOX_STATS_SUB_BUCKET_BITS);
+		bucket = MAILBOX_STATS_LINEAR_BUCKETS +
+				(magnitude << MAILBOX_STATS_SUB_BUCKET_BITS) + sub_bucket;
+		if (bucket >= NVM_MAILBOX_LATENCY_BUCKETS)
+		{
+			bucket = NVM_MAILBOX_LATENCY_BUCKETS - 1;
+		}
+	}
+	return bucket;
+}
+
+/*
+ * Count a completed mailbox command
+ */
+void mailbox_stats_record(const enum mailbox_command_type type, const NVM_UINT32 device_handle,
+		const NVM_UINT8 opcode, const NVM_UINT8 sub_opcode, const int rc,
+		const NVM_UINT64 bytes, const NVM_UINT64 latency_usec)
+{
+	struct mailbox_stats_slot *p_slot = mailbox_stats_find_slot(
+			mailbox_stats_key(type, device_handle, opcode, sub_opcode));
+	if (!p_slot)
+	{
+		if (__sync_add_and_fetch(&g_mailbox_stats_dropped, 1) == 1)
+		{
+			COMMON_LOG_WARN("The mailbox stats table is full, new commands are not counted");
+		}
+	}
+	else
+	{
+		__sync_add_and_fetch(&p_slot->count, 1);
+		__sync_add_and_fetch(&p_slot->bytes, bytes);
+		if (rc != NVM_SUCCESS)
+		{
+			__sync_add_and_fetch(&p_slot->errors, 1);
+		}
+		if (rc == NVM_ERR_DEVICEBUSY)
+		{
+			__sync_add_and_fetch(&p_slot->busy, 1);
+		}
+		__sync_add_and_fetch(&p_slot->total_latency_usec, latency_usec);
+		__sync_add_and_fetch(&p_slot->latency_histogram[mailbox_stats_bucket(latency_usec)], 1);
+
+		NVM_UINT64 max = p_slot->max_latency_usec;
+		while (latency_usec > max)
+		{
+			max = __sync_val_compare_and_swap(&p_slot->max_latency_usec, max, latency_usec);
+		}
+	}
+}
+
+/*
+ * Returns the number of firmware commands the calling process has mailbox statistics for
+ */
+int nvm_get_mailbox_stats_count()
+{
+	COMMON_LOG_ENTRY();
+	int count = 0;
+	for (int i = 0; i < MAILBOX_STATS_SLOTS; i++)
+	{
+		if (g_mailbox_stats[i].key != 0 && g_mailbox_stats[i].count > 0)
+		{
+			count++;
+		}
+	}
+	COMMON_LOG_EXIT_RETURN_I(count);
+	return count;
+}
+
+/*
+ * Retrieve the mailbox statistics of the firmware commands issued by the calling process
+ */
+int nvm_get_mailbox_stats(struct device_mailbox_stats *p_stats, const NVM_UINT32 count)
+{
+	COMMON_LOG_ENTRY();
+	int rc = 0;
+
+	if (p_stats == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_stats is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else
+	{
+		memset(p_stats, 0, sizeof (struct device_mailbox_stats) * count);
+		for (int i = 0; i < MAILBOX_STATS_SLOTS && rc >= 0; i++)
+		{
+			struct mailbox_stats_slot *p_slot = &g_mailbox_stats[i];
+			NVM_UINT64 key = p_slot->key;
+			if (key != 0 && p_slot->count > 0)
+			{
+				if ((NVM_UINT32)rc >= count)
+				{
+					COMMON_LOG_ERROR("The mailbox stats array is too small");
+					rc = NVM_ERR_ARRAYTOOSMALL;
+				}
+				else
+				{
+					struct device_mailbox_stats *p_entry = &p_stats[rc++];
+					p_entry->type = (enum mailbox_command_type)((key >> 48) - 1);
+					p_entry->device_handle = (NVM_UINT32)(key >> 16);
+					p_entry->opcode = (NVM_UINT8)(key >> 8);
+					p_entry->sub_opcode = (NVM_UINT8)key;
+					p_entry->count = p_slot->count;
+					p_entry->bytes = p_slot->bytes;
+					p_entry->errors = p_slot->errors;
+					p_entry->busy = p_slot->busy;
+					p_entry->total_latency_usec = p_slot->total_latency_usec;
+					p_entry->max_latency_usec = p_slot->max_latency_usec;
+					for (int j = 0; j < NVM_MAILBOX_LATENCY_BUCKETS; j++)
+					{
+						p_entry->latency_histogram[j] = p_slot->latency_histogram[j];
+					}
+				}
+			}
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Reset the mailbox statistics of the calling process to zero.
+ * The slots stay claimed so commands in flight keep counting into them.
+ */
+void nvm_reset_mailbox_stats()
+{
+	COMMON_LOG_ENTRY();
+	for (int i = 0; i < MAILBOX_STATS_SLOTS; i++)
+	{
+		struct mailbox_stats_slot *p_slot = &g_mailbox_stats[i];
+		__sync_lock_test_and_set(&p_slot->count, 0);
+		__sync_lock_test_and_set(&p_slot->bytes, 0);
+		__sync_lock_test_and_set(&p_slot->errors, 0);
+		__sync_lock_test_and_set(&p_slot->busy, 0);
+		__sync_lock_test_and_set(&p_slot->total_latency_usec, 0);
+		__sync_lock_test_and_set(&p_slot->max_latency_usec, 0);
+		for (int j = 0; j < NVM_MAILBOX_LATENCY_BUCKETS; j++)
+		{
+			__sync_lock_test_and_set(&p_slot->latency_histogram[j], 0);
+		}
+	}
+	__sync_lock_test_and_set(&g_mailbox_stats_dropped, 0);
+	COMMON_LOG_EXIT();
+}
+
+/*
+ * Get the smallest latency in microseconds counted by a mailbox latency histogram bucket
+ */
+NVM_UINT64 nvm_get_mailbox_latency_bucket_min(const NVM_UINT32 bucket)
+{
+	NVM_UINT64 min = bucket;
+	if (bucket >= MAILBOX_STATS_LINEAR_BUCKETS)
+	{
+		NVM_UINT32 magnitude = (bucket - MAILBOX_STATS_LINEAR_BUCKETS) >>
+				MAILBOX_STATS_SUB_BUCKET_BITS;
+		NVM_UINT32 sub_bucket = (bucket - MAILBOX_STATS_LINEAR_BUCKETS) &
+				((1 << MAILBOX_STATS_SUB_BUCKET_BITS) - 1);
+		min = ((NVM_UINT64)(1 << MAILBOX_STATS_SUB_BUCKET_BITS) + sub_bucket) << magnitude;
+	}
+	return min;
+}
+
+/*
+ * Get the largest latency in microseconds counted by a mailbox latency histogram bucket
+ */
+NVM_UINT64 nvm_get_mailbox_latency_bucket_max(const NVM_UINT32 bucket)
+{
+	NVM_UINT64 max = (NVM_UINT64)-1;
+	if (bucket < NVM_MAILBOX_LATENCY_BUCKETS - 1)
+	{
+		max = nvm_get_mailbox_latency_bucket_min(bucket + 1) - 1;
+	}
+	return max;
+}
+
+/*
+ * Estimate a latency percentile from the histogram of a mailbox stats entry
+ */
+NVM_UINT64 nvm_get_mailbox_latency_percentile(
+		const struct device_mailbox_stats *p_stats, const NVM_UINT8 percentile)
+{
+	NVM_UINT64 latency = 0;
+	if (p_stats && percentile > 0)
+	{
+		NVM_UINT64 total = 0;
+		for (int i = 0; i < NVM_MAILBOX_LATENCY_BUCKETS; i++)
+		{
+			total += p_stats->latency_histogram[i];
+		}
+
+		// the rank of the percentile, rounded up
+		NVM_UINT64 rank = (total * (percentile > 100 ? 100 : percentile) + 99) / 100;
+		NVM_UINT64 seen = 0;
+		for (int i = 0; i < NVM_MAILBOX_LATENCY_BUCKETS && total > 0; i++)
+		{
+			seen += p_stats->latency_histogram[i];
+			if (seen >= rank)
+			{
+				latency = nvm_get_mailbox_latency_bucket_max(i);
+				break;
+			}
+		}
+		if (latency > p_stats->max_latency_usec)
+		{
+			latency = p_stats->max_latency_usec;
+		}
+	}
+	return latency;
+}
+
+/*
+ * Build the path of the published stats file from the path of the config database
+ */
+static int get_mailbox_stats_file_path(COMMON_PATH path)
+{
+	int rc = NVM_SUCCESS;
+	if (get_lib_store_path(path) != COMMON_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to find the config database");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else
+	{
+		size_t path_len = s_strnlen(path, COMMON_PATH_LEN);
+		size_t name_len = strlen(CONFIG_FILE);
+		path[path_len >= name_len ? path_len - name_len : 0] = '\0';
+		s_strcat(path, COMMON_PATH_LEN, MAILBOX_STATS_FILE);
+	}
+	return rc;
+}
+
+/*
+ * Publish the mailbox statistics of the calling process for other processes to read
+ */
+int nvm_publish_mailbox_stats()
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	COMMON_PATH path;
+	COMMON_PATH tmp_path;
+	struct device_mailbox_stats *p_stats = NULL;
+
+	int count = nvm_get_mailbox_stats_count();
+	// commands may be counted in between, leave room for a few new entries
+	NVM_UINT32 size = (NVM_UINT32)count + 16;
+	if ((p_stats = calloc(size, sizeof (struct device_mailbox_stats))) == NULL)
+	{
+		COMMON_LOG_ERROR("Failed to allocate the mailbox stats");
+		rc = NVM_ERR_NOMEMORY;
+	}
+	else if ((count = nvm_get_mailbox_stats(p_stats, size)) < 0)
+	{
+		rc = count;
+	}
+	else if ((rc = get_mailbox_stats_file_path(path)) == NVM_SUCCESS)
+	{
+		struct mailbox_stats_file_header header;
+		memset(&header, 0, sizeof (header));
+		memmove(header.magic, MAILBOX_STATS_MAGIC, sizeof (header.magic));
+		header.version = MAILBOX_STATS_VERSION;
+		header.entry_size = sizeof (struct device_mailbox_stats);
+		header.entry_count = (NVM_UINT32)count;
+
+		s_strcpy(tmp_path, path, COMMON_PATH_LEN);
+		s_strcat(tmp_path, COMMON_PATH_LEN, MAILBOX_STATS_TMP_SUFFIX);
+
+		pthread_mutex_lock(&g_mailbox_stats_publish_lock);
+		// write next to the target and rename over it so readers never see a partial file
+		FILE *p_file = open_file(tmp_path, s_strnlen(tmp_path, COMMON_PATH_LEN), "wb");
+		if (p_file == NULL)
+		{
+			COMMON_LOG_ERROR_F("Failed to open the mailbox stats file %s", tmp_path);
+			rc = NVM_ERR_UNKNOWN;
+		}
+		else
+		{
+			size_t written = fwrite(&header, sizeof (header), 1, p_file);
+			if (header.entry_count > 0)
+			{
+				written += fwrite(p_stats, sizeof (struct device_mailbox_stats),
+						header.entry_count, p_file);
+			}
+			if (fclose(p_file) != 0 || written != 1 + header.entry_count)
+			{
+				COMMON_LOG_ERROR_F("Failed to write the mailbox stats file %s", tmp_path);
+				delete_file(tmp_path, s_strnlen(tmp_path, COMMON_PATH_LEN));
+				rc = NVM_ERR_UNKNOWN;
+			}
+#ifdef __WINDOWS__
+			else if (!MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING))
+#else
+			else if (rename(tmp_path, path) != 0)
+#endif
+			{
+				COMMON_LOG_ERROR_F("Failed to replace the mailbox stats file %s", path);
+				delete_file(tmp_path, s_strnlen(tmp_path, COMMON_PATH_LEN));
+				rc = NVM_ERR_UNKNOWN;
+			}
+		}
+		pthread_mutex_unlock(&g_mailbox_stats_publish_lock);
+	}
+	free(p_stats);
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Open the published stats file and read its header.
+ * @return NULL if nothing has been published or the file can't be used
+ */
+static FILE *open_published_mailbox_stats(struct mailbox_stats_file_header *p_header)
+{
+	FILE *p_file = NULL;
+	COMMON_PATH path;
+	if (get_mailbox_stats_file_path(path) == NVM_SUCCESS &&
+			file_exists(path, COMMON_PATH_LEN) &&
+			(p_file = open_file(path, s_strnlen(path, COMMON_PATH_LEN), "rb")) != NULL)
+	{
+		if (fread(p_header, sizeof (*p_header), 1, p_file) != 1 ||
+				memcmp(p_header->magic, MAILBOX_STATS_MAGIC, sizeof (p_header->magic)) != 0 ||
+				p_header->version != MAILBOX_STATS_VERSION ||
+				p_header->entry_size != sizeof (struct device_mailbox_stats))
+		{
+			COMMON_LOG_ERROR_F("The mailbox stats file %s is not valid", path);
+			fclose(p_file);
+			p_file = NULL;
+		}
+	}
+	return p_file;
+}
+
+/*
+ * Returns the number of firmware commands the monitor service has published mailbox statistics for
+ */
+int nvm_get_published_mailbox_stats_count()
+{
+	COMMON_LOG_ENTRY();
+	int count = 0;
+	struct mailbox_stats_file_header header;
+	FILE *p_file = open_published_mailbox_stats(&header);
+	if (p_file)
+	{
+		count = (int)header.entry_count;
+		fclose(p_file);
+	}
+	COMMON_LOG_EXIT_RETURN_I(count);
+	return count;
+}
+
+/*
+ * Retrieve the mailbox statistics last published by the monitor service
+ */
+int nvm_get_published_mailbox_stats(struct device_mailbox_stats *p_stats,
+		const NVM_UINT32 count)
+{
+	COMMON_LOG_ENTRY();
+	int rc = 0;
+	struct mailbox_stats_file_header header;
+	FILE *p_file = NULL;
+
+	if (p_stats == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_stats is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if ((p_file = open_published_mailbox_stats(&header)) != NULL)
+	{
+		memset(p_stats, 0, sizeof (struct device_mailbox_stats) * count);
+		if (header.entry_count > count)
+		{
+			COMMON_LOG_ERROR("The mailbox stats array is too small");
+			rc = NVM_ERR_ARRAYTOOSMALL;
+		}
+		else if (fread(p_stats, sizeof (struct device_mailbox_stats),
+				header.entry_count, p_file) != header.entry_count)
+		{
+			COMMON_LOG_ERROR("Failed to read the published mailbox stats");
+			rc = NVM_ERR_UNKNOWN;
+		}
+		else
+		{
+			rc = (int)header.entry_count;
+		}
+		fclose(p_file);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
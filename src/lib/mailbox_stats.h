@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file declares the counters kept for each firmware mailbox command.
+ * The adapters time every passthrough command and large payload transfer and
+ * record it here, the counters are read back through nvm_get_mailbox_stats.
+ */
+
+#ifndef MAILBOX_STATS_H_
+#define	MAILBOX_STATS_H_
+
+#include "nvm_management.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Monotonic time in microseconds, for timing mailbox commands
+ */
+NVM_UINT64 get_monotonic_usec();
+
+/*
+ * Count a completed mailbox command.  Lock free, safe to call from any thread.
+ */
+void mailbox_stats_record(const enum mailbox_command_type type, const NVM_UINT32 device_handle,
+		const NVM_UINT8 opcode, const NVM_UINT8 sub_opcode, const int rc,
+		const NVM_UINT64 bytes, const NVM_UINT64 latency_usec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MAILBOX_STATS_H_ */
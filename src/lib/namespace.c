@@ -53,6 +53,12 @@
 #include "system.h"
 #include "nvm_context.h"
 
+/*
+ * Upper limit on the threads used to create a batch of namespaces.
+ * Each thread works on whole interleave sets or DIMMs.
+ */
+#define	NAMESPACE_CREATE_MAX_THREADS	NVM_MAX_DEVICES_PER_SOCKET
+
 int validate_namespace_block_count(const NVM_GUID namespace_guid,
 		NVM_UINT64 *block_count, const NVM_BOOL allow_adjustment);
 
@@ -1209,6 +1215,114 @@ int nvm_adjust_modify_namespace_block_count(
 	return rc;
 }
 
+/*
+ * Find the highest N of the existing default namespace names (NvDimmVolN)
+ */
+int get_max_default_namespace_name_id()
+{
+	COMMON_LOG_ENTRY();
+	int max_unique_id = 0;
+
+	int namespace_count = nvm_get_namespace_count();
+	if (namespace_count > 0)
+	{
+		struct nvm_namespace_discovery nvm_namespaces[namespace_count];
+		get_namespaces(namespace_count, nvm_namespaces);
+		for (int ns = 0; ns < namespace_count; ns++)
+		{
+			// Determine ID only if it is a default namespace name
+			if (!s_strncmp(NVM_DEFAULT_NAMESPACE_NAME,
+					nvm_namespaces[ns].friendly_name,
+					s_strnlen(NVM_DEFAULT_NAMESPACE_NAME,
+							NVM_NAMESPACE_NAME_LEN)))
+			{
+				unsigned int id = 0;
+				s_strtoui(nvm_namespaces[ns].friendly_name,
+					s_strnlen(nvm_namespaces[ns].friendly_name,
+						NVM_NAMESPACE_NAME_LEN),
+					NULL,
+					&id);
+				if (id > max_unique_id)
+				{
+					max_unique_id = id;
+				}
+			}
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(max_unique_id);
+	return max_unique_id;
+}
+
+/*
+ * Fill in the driver settings for a validated namespace request.
+ * default_name_id is used to build the name if the caller didn't supply one.
+ */
+void get_nvm_namespace_create_settings(const struct namespace_create_settings *p_settings,
+		const NVM_UINT32 namespace_creation_id, const int default_name_id,
+		struct nvm_namespace_create_settings *p_nvm_settings)
+{
+	COMMON_LOG_ENTRY();
+
+	memset(p_nvm_settings, 0, sizeof (struct nvm_namespace_create_settings));
+	p_nvm_settings->type = p_settings->type;
+	if (p_nvm_settings->type == NAMESPACE_TYPE_APP_DIRECT)
+	{
+		p_nvm_settings->namespace_creation_id.interleave_setid
+			= namespace_creation_id;
+		COMMON_LOG_DEBUG_F("Creating App Direct namespace on interleave set %u",
+				namespace_creation_id);
+	}
+	else
+	{
+		p_nvm_settings->namespace_creation_id.device_handle.handle
+			= namespace_creation_id;
+		COMMON_LOG_DEBUG_F("Creating storage namespace on DIMM %u",
+				namespace_creation_id);
+	}
+	if (s_strnlen(p_settings->friendly_name, NAMESPACE_FRIENDLY_NAME_LEN) == 0)
+	{
+		// create a unique friendly name - NvDimmVolN.
+		char friendly_name[NVM_NAMESPACE_NAME_LEN];
+		char namespace_name[NVM_NAMESPACE_NAME_LEN];
+		s_strcpy(namespace_name, NVM_DEFAULT_NAMESPACE_NAME, NVM_NAMESPACE_NAME_LEN);
+		s_snprintf(friendly_name, NVM_NAMESPACE_NAME_LEN,
+				s_strcat(namespace_name, NVM_NAMESPACE_NAME_LEN, "%d"),
+						default_name_id);
+		s_strcpy(p_nvm_settings->friendly_name,
+				friendly_name, NVM_NAMESPACE_NAME_LEN);
+	}
+	else
+	{
+		s_strncpy(p_nvm_settings->friendly_name, NVM_NAMESPACE_NAME_LEN,
+				p_settings->friendly_name, NVM_NAMESPACE_NAME_LEN);
+	}
+	p_nvm_settings->enabled = p_settings->enabled;
+	p_nvm_settings->block_size = p_settings->block_size;
+	p_nvm_settings->block_count = p_settings->block_count;
+	p_nvm_settings->btt = p_settings->btt;
+
+	COMMON_LOG_EXIT();
+}
+
+/*
+ * Log an event indicating we successfully created a namespace
+ */
+void log_namespace_created_event(const NVM_GUID namespace_guid,
+		const char *friendly_name)
+{
+	NVM_EVENT_ARG ns_guid_arg;
+	guid_to_event_arg(namespace_guid, ns_guid_arg);
+	NVM_EVENT_ARG ns_name_arg;
+	s_strncpy(ns_name_arg, NVM_EVENT_ARG_LEN,
+			friendly_name, NVM_NAMESPACE_NAME_LEN);
+	log_mgmt_event(EVENT_SEVERITY_INFO,
+			EVENT_CODE_MGMT_NAMESPACE_CREATED,
+			namespace_guid,
+			0, // no action required
+			ns_name_arg, ns_guid_arg, NULL);
+}
+
 /*
  * Create a new namespace from the specified pool.
  */
@@ -1220,9 +1334,6 @@ int nvm_create_namespace(NVM_GUID *p_namespace_guid, const NVM_GUID pool_guid,
 	int rc = NVM_SUCCESS;
 	NVM_UINT32 namespace_creation_id; // the identifier used by the driver to create a namespace
 
-	struct nvm_capabilities nvm_caps;
-	memset(&nvm_caps, 0, sizeof (nvm_caps));
-
 	if (check_caller_permissions() != NVM_SUCCESS)
 	{
 		rc = NVM_ERR_INVALIDPERMISSIONS;
@@ -1257,105 +1368,270 @@ int nvm_create_namespace(NVM_GUID *p_namespace_guid, const NVM_GUID pool_guid,
 			if ((rc = validate_namespace_create_settings(&pool, p_settings, p_format,
 						&namespace_creation_id, allow_adjustment)) == NVM_SUCCESS)
 			{
+				int default_name_id = 0;
+				if (s_strnlen(p_settings->friendly_name, NAMESPACE_FRIENDLY_NAME_LEN) == 0)
+				{
+					default_name_id = get_max_default_namespace_name_id() + 1;
+				}
+
 				struct nvm_namespace_create_settings nvm_settings;
-				memset(&nvm_settings, 0, sizeof (nvm_settings));
+				get_nvm_namespace_create_settings(p_settings, namespace_creation_id,
+						default_name_id, &nvm_settings);
 
-				nvm_settings.type = p_settings->type;
-				if (nvm_settings.type == NAMESPACE_TYPE_APP_DIRECT)
+				rc = create_namespace(p_namespace_guid, &nvm_settings);
+				if (rc == NVM_SUCCESS)
 				{
-					nvm_settings.namespace_creation_id.interleave_setid
-						= namespace_creation_id;
-					COMMON_LOG_DEBUG_F("Creating App Direct namespace on interleave set %u",
-							namespace_creation_id);
+					// the context is no longer valid
+					invalidate_namespaces();
+
+					log_namespace_created_event(*p_namespace_guid, nvm_settings.friendly_name);
 				}
-				else
+			}
+		}
+		else
+		{
+			COMMON_LOG_ERROR_F("couldn't get pool, rc = %d", rc);
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * A validated namespace from a batch, waiting to be created by the driver
+ */
+struct namespace_create_job
+{
+	struct namespace_create_request *p_request;
+	struct nvm_namespace_create_settings nvm_settings;
+	NVM_UINT32 region; // index of the interleave set or DIMM the namespace is created on
+};
+
+/*
+ * The regions handled by one namespace creation thread
+ */
+struct namespace_create_worker
+{
+	struct namespace_create_job *p_jobs;
+	NVM_UINT32 job_count;
+	NVM_UINT32 first; // index of the first region handled by this thread
+	NVM_UINT32 stride; // number of threads
+};
+
+/*
+ * Thread body creating the namespaces of every stride'th region starting at first.
+ * Namespaces on the same region are created one at a time, in request order,
+ * because the driver hands out the idle namespace of a region to each creation.
+ */
+void *namespace_create_worker_thread(void *arg)
+{
+	struct namespace_create_worker *p_worker = (struct namespace_create_worker *)arg;
+	for (NVM_UINT32 i = 0; i < p_worker->job_count; i++)
+	{
+		struct namespace_create_job *p_job = &p_worker->p_jobs[i];
+		if ((p_job->region % p_worker->stride) == p_worker->first)
+		{
+			p_job->p_request->rc = create_namespace(&p_job->p_request->namespace_guid,
+					&p_job->nvm_settings);
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Find a pool in the snapshot taken for a batch of namespace requests
+ */
+struct pool *find_pool_in_snapshot(struct pool *p_pools, const int pool_count,
+		const NVM_GUID pool_guid)
+{
+	struct pool *p_pool = NULL;
+	for (int i = 0; i < pool_count && !p_pool; i++)
+	{
+		if (guid_cmp(p_pools[i].pool_guid, pool_guid))
+		{
+			p_pool = &p_pools[i];
+		}
+	}
+	return p_pool;
+}
+
+/*
+ * Take the capacity of a validated namespace out of the pool snapshot so the next
+ * requests in the batch are validated against what will be left.
+ */
+void reserve_namespace_in_snapshot(struct pool *p_pool,
+		const struct namespace_create_settings *p_settings,
+		const NVM_UINT32 namespace_creation_id)
+{
+	NVM_UINT64 capacity = p_settings->block_count * p_settings->block_size;
+	p_pool->free_capacity = (p_pool->free_capacity > capacity) ?
+			p_pool->free_capacity - capacity : 0;
+
+	if (p_settings->type == NAMESPACE_TYPE_APP_DIRECT)
+	{
+		// only one App Direct namespace per interleave set
+		for (int i = 0; i < p_pool->ilset_count; i++)
+		{
+			if (p_pool->ilsets[i].driver_id == namespace_creation_id)
+			{
+				p_pool->ilsets[i].available_size = 0;
+			}
+		}
+	}
+}
+
+/*
+ * Create several namespaces at once.
+ */
+int nvm_create_namespaces(struct namespace_create_request *p_requests,
+		const NVM_UINT32 count)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	if (check_caller_permissions() != NVM_SUCCESS)
+	{
+		rc = NVM_ERR_INVALIDPERMISSIONS;
+	}
+	else if ((rc = IS_NVM_FEATURE_LICENSED(create_namespace)) != NVM_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Creating a namespace is not supported.");
+	}
+	else if (p_requests == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_requests is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (count > 0)
+	{
+		// validate every request against a single snapshot of the pools
+		int pool_count = nvm_get_pool_count();
+		struct pool *p_pools = NULL;
+		if (pool_count < 0)
+		{
+			rc = pool_count;
+		}
+		else if (pool_count == 0)
+		{
+			COMMON_LOG_ERROR("No pools to create namespaces from");
+			rc = NVM_ERR_BADPOOL;
+		}
+		else if ((p_pools = calloc(pool_count, sizeof (struct pool))) == NULL)
+		{
+			COMMON_LOG_ERROR("Failed to allocate the pool snapshot");
+			rc = NVM_ERR_NOMEMORY;
+		}
+		else if ((pool_count = nvm_get_pools(p_pools, pool_count)) < 0)
+		{
+			rc = pool_count;
+		}
+
+		// count is caller supplied, keep the per-request state off the stack
+		struct namespace_create_job *jobs = NULL;
+		NVM_UINT32 *regions = NULL; // creation ID of each region with a job
+		if (rc == NVM_SUCCESS &&
+				((jobs = calloc(count, sizeof (struct namespace_create_job))) == NULL ||
+				(regions = calloc(count, sizeof (NVM_UINT32))) == NULL))
+		{
+			COMMON_LOG_ERROR("Failed to allocate the namespace create jobs");
+			rc = NVM_ERR_NOMEMORY;
+		}
+
+		if (rc == NVM_SUCCESS)
+		{
+			NVM_UINT32 job_count = 0;
+			NVM_UINT32 region_count = 0;
+			int next_default_name_id = get_max_default_namespace_name_id() + 1;
+
+			for (NVM_UINT32 i = 0; i < count; i++)
+			{
+				struct namespace_create_request *p_request = &p_requests[i];
+				memset(p_request->namespace_guid, 0, NVM_GUID_LEN);
+
+				NVM_UINT32 namespace_creation_id = 0;
+				struct pool *p_pool = find_pool_in_snapshot(p_pools, pool_count,
+						p_request->pool_guid);
+				if (!p_pool)
 				{
-					nvm_settings.namespace_creation_id.device_handle.handle
-						= namespace_creation_id;
-					COMMON_LOG_DEBUG_F("Creating storage namespace on DIMM %u",
-							namespace_creation_id);
+					COMMON_LOG_ERROR("Invalid parameter, pool doesn't exist");
+					p_request->rc = NVM_ERR_BADPOOL;
 				}
-				if (s_strnlen(p_settings->friendly_name, NAMESPACE_FRIENDLY_NAME_LEN) == 0)
+				else if ((p_request->rc = validate_namespace_create_settings(p_pool,
+						&p_request->settings,
+						p_request->format_valid ? &p_request->format : NULL,
+						&namespace_creation_id, p_request->allow_adjustment)) == NVM_SUCCESS)
 				{
-					char friendly_name[NVM_NAMESPACE_NAME_LEN];
-					int max_unique_id = 0;
-					int namespace_count = nvm_get_namespace_count();
-					if (namespace_count < 0)
+					reserve_namespace_in_snapshot(p_pool, &p_request->settings,
+							namespace_creation_id);
+
+					int default_name_id = 0;
+					if (s_strnlen(p_request->settings.friendly_name,
+							NAMESPACE_FRIENDLY_NAME_LEN) == 0)
 					{
-						namespace_count = 0;
+						default_name_id = next_default_name_id++;
 					}
 
-					if (namespace_count > 0)
+					// fails unless the worker gets to it
+					p_request->rc = NVM_ERR_UNKNOWN;
+					struct namespace_create_job *p_job = &jobs[job_count++];
+					p_job->p_request = p_request;
+					get_nvm_namespace_create_settings(&p_request->settings,
+							namespace_creation_id, default_name_id, &p_job->nvm_settings);
+
+					// App Direct and storage IDs are distinct regions even if equal
+					NVM_UINT32 region_id = (namespace_creation_id << 1) |
+							(p_request->settings.type == NAMESPACE_TYPE_STORAGE);
+					for (p_job->region = 0; p_job->region < region_count; p_job->region++)
 					{
-						// Figure out a unique ID for the default namespace name
-						// Find the max value of the ID currently present,
-						// and generate max_unique_id+1 as the ID
-						struct nvm_namespace_discovery nvm_namespaces[namespace_count];
-						get_namespaces(namespace_count, nvm_namespaces);
-						for (int ns = 0; ns < namespace_count; ns++)
+						if (regions[p_job->region] == region_id)
 						{
-							// Determine ID only if it is a default namespace name
-							if (!s_strncmp(NVM_DEFAULT_NAMESPACE_NAME,
-									nvm_namespaces[ns].friendly_name,
-									s_strnlen(NVM_DEFAULT_NAMESPACE_NAME,
-											NVM_NAMESPACE_NAME_LEN)))
-							{
-								unsigned int id = 0;
-								s_strtoui(nvm_namespaces[ns].friendly_name,
-									s_strnlen(nvm_namespaces[ns].friendly_name,
-										NVM_NAMESPACE_NAME_LEN),
-									NULL,
-									&id);
-								if (id > max_unique_id)
-								{
-									max_unique_id = id;
-								}
-							}
+							break;
 						}
 					}
-					// create a unique friendly name - NvDimmVolN.
-					char namespace_name[NVM_NAMESPACE_NAME_LEN];
-					s_strcpy(namespace_name, NVM_DEFAULT_NAMESPACE_NAME, NVM_NAMESPACE_NAME_LEN);
-					s_snprintf(friendly_name, NVM_NAMESPACE_NAME_LEN,
-							s_strcat(namespace_name, NVM_NAMESPACE_NAME_LEN, "%d"),
-									max_unique_id + 1);
-					s_strcpy(nvm_settings.friendly_name,
-							friendly_name, NVM_NAMESPACE_NAME_LEN);
+					if (p_job->region == region_count)
+					{
+						regions[region_count++] = region_id;
+					}
 				}
-				else
+			}
+
+			if (job_count > 0)
+			{
+				// create the namespaces region by region in parallel
+				NVM_UINT32 thread_count = region_count;
+				if (thread_count > NAMESPACE_CREATE_MAX_THREADS)
 				{
-					s_strncpy(nvm_settings.friendly_name, NVM_NAMESPACE_NAME_LEN,
-							p_settings->friendly_name, NVM_NAMESPACE_NAME_LEN);
+					thread_count = NAMESPACE_CREATE_MAX_THREADS;
 				}
-				nvm_settings.enabled = p_settings->enabled;
-				nvm_settings.block_size = p_settings->block_size;
-				nvm_settings.block_count = p_settings->block_count;
-				nvm_settings.btt = p_settings->btt;
 
-				rc = create_namespace(p_namespace_guid, &nvm_settings);
-				if (rc == NVM_SUCCESS)
+				struct namespace_create_worker workers[thread_count];
+				for (NVM_UINT32 t = 0; t < thread_count; t++)
 				{
-					// the context is no longer valid
-					invalidate_namespaces();
+					workers[t].p_jobs = jobs;
+					workers[t].job_count = job_count;
+					workers[t].first = t;
+					workers[t].stride = thread_count;
+				}
+				run_device_workers(namespace_create_worker_thread, workers,
+						sizeof (struct namespace_create_worker), thread_count);
 
-					// Log an event indicating we successfully created a namespace
-					NVM_EVENT_ARG ns_guid_arg;
-					guid_to_event_arg(*p_namespace_guid, ns_guid_arg);
-					NVM_EVENT_ARG ns_name_arg;
-					s_strncpy(ns_name_arg, NVM_EVENT_ARG_LEN,
-							nvm_settings.friendly_name, NVM_NAMESPACE_NAME_LEN);
-					log_mgmt_event(EVENT_SEVERITY_INFO,
-							EVENT_CODE_MGMT_NAMESPACE_CREATED,
-							*p_namespace_guid,
-							0, // no action required
-							ns_name_arg, ns_guid_arg, NULL);
+				// the context is no longer valid
+				invalidate_namespaces();
+
+				for (NVM_UINT32 i = 0; i < job_count; i++)
+				{
+					if (jobs[i].p_request->rc == NVM_SUCCESS)
+					{
+						log_namespace_created_event(jobs[i].p_request->namespace_guid,
+								jobs[i].nvm_settings.friendly_name);
+					}
 				}
 			}
 		}
-		else
-		{
-			COMMON_LOG_ERROR_F("couldn't get pool, rc = %d", rc);
-		}
+		free(regions);
+		free(jobs);
+		free(p_pools);
 	}
 
 	COMMON_LOG_EXIT_RETURN_I(rc);
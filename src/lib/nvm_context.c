@@ -27,6 +27,12 @@
 
 /*
  * This file contains the implementation of the library smart caching interface.
+ *
+ * The context is a versioned, copy-on-write snapshot. Readers take a reference to
+ * the current snapshot, holding the context lock only long enough to do so, and
+ * copy out of it unlocked. Writers copy the current snapshot, change the copy and
+ * publish it if no other writer published first, else they retry. The cached
+ * data blocks are immutable and shared between snapshots so copies stay cheap.
  */
 
 #include "nvm_context.h"
@@ -42,203 +48,325 @@ extern HANDLE g_context_lock;
 extern pthread_mutex_t g_context_lock;
 #endif
 
-// Current context pointer - one per process
+#define	CONTEXT_CHANGED	1 // another writer published a snapshot first
+
+/*
+ * A block of cached data shared by context snapshots.
+ * It is never modified once created and is freed with its last reference.
+ */
+struct nvm_context_data
+{
+	volatile int ref_count;
+	NVM_SIZE size;
+	NVM_UINT64 data[]; // 64 bit aligned for any structure copied in
+};
+
+/*
+ * The context of an NVM-DIMM
+ */
+struct nvm_device_context
+{
+	NVM_GUID guid;
+	struct nvm_context_data *p_device_discovery;
+	struct nvm_context_data *p_device_details;
+	struct nvm_context_data *p_pcd;
+};
+
+/*
+ * The context of an namespace
+ */
+struct nvm_namespace_context
+{
+	NVM_GUID guid;
+	struct nvm_context_data *p_namespace_discovery;
+	struct nvm_context_data *p_namespace_details;
+};
+
+/*
+ * Overall system context.
+ * A snapshot is never modified once it is published.
+ */
+struct nvm_context
+{
+	volatile int ref_count; // readers holding the snapshot, plus one while it is current
+	NVM_UINT64 version; // incremented each time a snapshot is published
+	struct nvm_context_data *p_capabilities;
+	int device_count;
+	struct nvm_device_context *p_devices;
+	int pool_count;
+	struct nvm_context_data *p_pools;
+	int namespace_count;
+	struct nvm_namespace_context *p_namespaces;
+};
+
+/*
+ * A change made to a copy of the current snapshot before it is published.
+ * It may be applied more than once if another writer publishes first.
+ */
+typedef int (*context_update)(struct nvm_context *p_new, const void *p_args);
+
+// Current context snapshot - one per process
 struct nvm_context *p_context = NULL;
 
+// Version of the last snapshot published, protected by the context lock
+NVM_UINT64 g_context_version = 0;
+
 /*
- * Initialize the context. This is a lazy context meaning
- * details are added as they are requested rather than up
- * front. This call should be pair with free_nvm_context.
+ * Helper function to create a shared data block holding a copy of the data
  */
-int nvm_create_context()
+struct nvm_context_data *create_context_data(const void *p_data, const NVM_SIZE size)
 {
-	COMMON_LOG_ENTRY();
-	// clean up existing
-	int rc = nvm_free_context();
-	if (rc == NVM_SUCCESS)
+	struct nvm_context_data *p_context_data =
+			malloc(sizeof (struct nvm_context_data) + size);
+	if (!p_context_data)
 	{
-		// lock
-		if (!mutex_lock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not obtain the context lock");
-			rc = NVM_ERR_UNKNOWN;
-		}
-		else
-		{
-			// create new pointer
-			p_context = calloc(1, sizeof (struct nvm_context));
-			if (!p_context)
-			{
-				COMMON_LOG_ERROR("Failed to allocate memory for the context.");
-				rc = NVM_ERR_NOMEMORY;
-			}
-			else
-			{
-				// initialize everything
-				p_context->p_capabilities = NULL;
-				p_context->device_count = -1;
-				p_context->p_devices = NULL;
-				p_context->pool_count = -1;
-				p_context->p_pools = NULL;
-				p_context->namespace_count = -1;
-				p_context->p_namespaces = NULL;
-			}
+		COMMON_LOG_ERROR("Failed to allocate memory for the context data.");
+	}
+	else
+	{
+		p_context_data->ref_count = 1;
+		p_context_data->size = size;
+		memmove(p_context_data->data, p_data, size);
+	}
+	return p_context_data;
+}
 
-			// unlock
-			if (!mutex_unlock(&g_context_lock))
-			{
-				COMMON_LOG_ERROR("Could not release the context lock.");
-				rc = NVM_ERR_UNKNOWN;
-			}
+void retain_context_data(struct nvm_context_data *p_context_data)
+{
+	if (p_context_data)
+	{
+		__sync_add_and_fetch(&p_context_data->ref_count, 1);
+	}
+}
+
+void release_context_data(struct nvm_context_data *p_context_data)
+{
+	if (p_context_data && __sync_sub_and_fetch(&p_context_data->ref_count, 1) == 0)
+	{
+		free(p_context_data);
+	}
+}
+
+/*
+ * Helper function to free the entire device list of a snapshot
+ */
+void free_device_list(struct nvm_context *p_snapshot)
+{
+	if (p_snapshot->p_devices)
+	{
+		for (int i = 0; i < p_snapshot->device_count; i++)
+		{
+			release_context_data(p_snapshot->p_devices[i].p_device_discovery);
+			release_context_data(p_snapshot->p_devices[i].p_device_details);
+			release_context_data(p_snapshot->p_devices[i].p_pcd);
 		}
+		free(p_snapshot->p_devices);
+		p_snapshot->p_devices = NULL;
 	}
-	COMMON_LOG_EXIT_RETURN_I(rc);
-	return rc;
+	p_snapshot->device_count = -1;
 }
 
 /*
- * Helper function to free the entire device list
- * NOTE: This function assumes the caller has obtained the lock
+ * Helper function to free the entire pool list of a snapshot
  */
-void free_device_list()
+void free_pool_list(struct nvm_context *p_snapshot)
 {
-	COMMON_LOG_ENTRY();
-	// clean up the device list
-	if (p_context && p_context->device_count > 0 && p_context->p_devices)
+	release_context_data(p_snapshot->p_pools);
+	p_snapshot->p_pools = NULL;
+	p_snapshot->pool_count = -1;
+}
+
+/*
+ * Helper function to free the entire namespace list of a snapshot
+ */
+void free_namespace_list(struct nvm_context *p_snapshot)
+{
+	if (p_snapshot->p_namespaces)
 	{
-		for (int i = 0; i < p_context->device_count; i++)
+		for (int i = 0; i < p_snapshot->namespace_count; i++)
 		{
-			if (p_context->p_devices[i].p_device_discovery)
-			{
-				free(p_context->p_devices[i].p_device_discovery);
-				p_context->p_devices[i].p_device_discovery = NULL;
-			}
-			if (p_context->p_devices[i].p_device_details)
-			{
-				free(p_context->p_devices[i].p_device_details);
-				p_context->p_devices[i].p_device_details = NULL;
-			}
-			if (p_context->p_devices[i].p_pcd)
-			{
-				free(p_context->p_devices[i].p_pcd);
-				p_context->p_devices[i].p_pcd = NULL;
-				p_context->p_devices[i].pcd_size = -1;
-			}
+			release_context_data(p_snapshot->p_namespaces[i].p_namespace_discovery);
+			release_context_data(p_snapshot->p_namespaces[i].p_namespace_details);
 		}
-		free(p_context->p_devices);
-		p_context->p_devices = NULL;
-		p_context->device_count = -1;
+		free(p_snapshot->p_namespaces);
+		p_snapshot->p_namespaces = NULL;
 	}
-	COMMON_LOG_EXIT();
+	p_snapshot->namespace_count = -1;
 }
 
 /*
- * Helper function to free the entire pool list
- * NOTE: This function assumes the caller has obtained the lock
+ * Helper function to create a snapshot with nothing cached
  */
-void free_pool_list()
+struct nvm_context *create_empty_context()
 {
-	COMMON_LOG_ENTRY();
-	// clean up the device list
-	if (p_context && p_context->pool_count > 0 && p_context->p_pools)
+	struct nvm_context *p_snapshot = calloc(1, sizeof (struct nvm_context));
+	if (!p_snapshot)
 	{
-		free(p_context->p_pools);
-		p_context->p_pools = NULL;
-		p_context->pool_count = -1;
+		COMMON_LOG_ERROR("Failed to allocate memory for the context.");
 	}
-	COMMON_LOG_EXIT();
+	else
+	{
+		p_snapshot->ref_count = 1;
+		p_snapshot->device_count = -1;
+		p_snapshot->pool_count = -1;
+		p_snapshot->namespace_count = -1;
+	}
+	return p_snapshot;
 }
 
 /*
- * Helper function to free the entire namespace list
- * NOTE: This function assumes the caller has obtained the lock
+ * Drop a reference to a snapshot, freeing it with its last reference
  */
-void free_namespace_list()
+void release_context(struct nvm_context *p_snapshot)
 {
-	COMMON_LOG_ENTRY();
-	// clean up the namespace list
-	if (p_context && p_context->namespace_count > 0 && p_context->p_namespaces)
+	if (p_snapshot && __sync_sub_and_fetch(&p_snapshot->ref_count, 1) == 0)
 	{
-		for (int i = 0; i < p_context->namespace_count; i++)
-		{
-			if (p_context->p_namespaces[i].p_namespace_discovery)
-			{
-				free(p_context->p_namespaces[i].p_namespace_discovery);
-				p_context->p_namespaces[i].p_namespace_discovery = NULL;
-			}
-			if (p_context->p_namespaces[i].p_namespace_details)
-			{
-				free(p_context->p_namespaces[i].p_namespace_details);
-				p_context->p_namespaces[i].p_namespace_details = NULL;
-			}
-		}
-		free(p_context->p_namespaces);
-		p_context->p_namespaces = NULL;
-		p_context->namespace_count = -1;
+		release_context_data(p_snapshot->p_capabilities);
+		free_device_list(p_snapshot);
+		free_pool_list(p_snapshot);
+		free_namespace_list(p_snapshot);
+		free(p_snapshot);
 	}
-	COMMON_LOG_EXIT();
 }
+
 /*
- * Clean up the resources allocated by nvm_create_context
+ * Take a reference to the current snapshot. NULL if there is no context.
+ * The caller must release it with release_context.
  */
-int nvm_free_context()
+struct nvm_context *acquire_context()
 {
-	COMMON_LOG_ENTRY();
-	int rc = NVM_SUCCESS;
+	struct nvm_context *p_snapshot = NULL;
 
 	// lock
 	if (!mutex_lock(&g_context_lock))
 	{
 		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
 	}
 	else
 	{
-		if (p_context)
+		p_snapshot = p_context;
+		if (p_snapshot)
 		{
-			// clean up capabilities
-			if (p_context->p_capabilities)
-			{
-				free(p_context->p_capabilities);
-				p_context->p_capabilities = NULL;
-			}
-
-			free_device_list();
-			free_pool_list();
-			free_namespace_list();
-
-			// clean up pointer
-			free(p_context);
-			p_context = NULL;
+			__sync_add_and_fetch(&p_snapshot->ref_count, 1);
 		}
 
 		// unlock
 		if (!mutex_unlock(&g_context_lock))
 		{
 			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
 		}
 	}
-	COMMON_LOG_EXIT_RETURN_I(rc);
-	return rc;
+	return p_snapshot;
 }
 
-int get_nvm_context_capabilities(struct nvm_capabilities *p_capabilities)
+/*
+ * Copy a snapshot so it can be changed. The cached data is shared with the original.
+ */
+struct nvm_context *copy_context(const struct nvm_context *p_snapshot)
+{
+	struct nvm_context *p_copy = create_empty_context();
+	if (p_copy)
+	{
+		p_copy->version = p_snapshot->version;
+
+		retain_context_data(p_snapshot->p_capabilities);
+		p_copy->p_capabilities = p_snapshot->p_capabilities;
+
+		retain_context_data(p_snapshot->p_pools);
+		p_copy->p_pools = p_snapshot->p_pools;
+		p_copy->pool_count = p_snapshot->pool_count;
+
+		if (p_snapshot->device_count > 0)
+		{
+			p_copy->p_devices = calloc(p_snapshot->device_count,
+					sizeof (struct nvm_device_context));
+			if (p_copy->p_devices)
+			{
+				memmove(p_copy->p_devices, p_snapshot->p_devices,
+						p_snapshot->device_count * sizeof (struct nvm_device_context));
+				for (int i = 0; i < p_snapshot->device_count; i++)
+				{
+					retain_context_data(p_copy->p_devices[i].p_device_discovery);
+					retain_context_data(p_copy->p_devices[i].p_device_details);
+					retain_context_data(p_copy->p_devices[i].p_pcd);
+				}
+			}
+		}
+		if (!p_copy->p_devices && p_snapshot->device_count > 0)
+		{
+			COMMON_LOG_ERROR("Failed to allocate memory for device context structure");
+			release_context(p_copy);
+			p_copy = NULL;
+		}
+		else
+		{
+			p_copy->device_count = p_snapshot->device_count;
+		}
+	}
+
+	if (p_copy)
+	{
+		if (p_snapshot->namespace_count > 0)
+		{
+			p_copy->p_namespaces = calloc(p_snapshot->namespace_count,
+					sizeof (struct nvm_namespace_context));
+			if (p_copy->p_namespaces)
+			{
+				memmove(p_copy->p_namespaces, p_snapshot->p_namespaces,
+						p_snapshot->namespace_count * sizeof (struct nvm_namespace_context));
+				for (int i = 0; i < p_snapshot->namespace_count; i++)
+				{
+					retain_context_data(p_copy->p_namespaces[i].p_namespace_discovery);
+					retain_context_data(p_copy->p_namespaces[i].p_namespace_details);
+				}
+			}
+		}
+		if (!p_copy->p_namespaces && p_snapshot->namespace_count > 0)
+		{
+			COMMON_LOG_ERROR("Failed to allocate memory for namespace context structure");
+			release_context(p_copy);
+			p_copy = NULL;
+		}
+		else
+		{
+			p_copy->namespace_count = p_snapshot->namespace_count;
+		}
+	}
+	return p_copy;
+}
+
+/*
+ * Make a changed copy of the base snapshot current, unless another writer changed
+ * the context since the base was taken.
+ * Takes over the caller's reference to the new snapshot.
+ */
+int publish_context(const struct nvm_context *p_base, struct nvm_context *p_new)
 {
-	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
+	struct nvm_context *p_old = NULL;
 
 	// lock
 	if (!mutex_lock(&g_context_lock))
 	{
 		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
 	}
 	else
 	{
-		if (p_context && p_context->p_capabilities)
+		if (!p_context)
+		{
+			COMMON_LOG_DEBUG("The context was freed before the change was published");
+			p_old = p_new;
+		}
+		else if (p_context->version != p_base->version)
 		{
-			memmove(p_capabilities, p_context->p_capabilities, sizeof (struct nvm_capabilities));
+			rc = CONTEXT_CHANGED;
+			p_old = p_new;
+		}
+		else
+		{
+			p_new->version = ++g_context_version;
+			p_old = p_context;
+			p_context = p_new;
 			rc = NVM_SUCCESS;
 		}
 
@@ -249,40 +377,105 @@ int get_nvm_context_capabilities(struct nvm_capabilities *p_capabilities)
 			rc = NVM_ERR_UNKNOWN;
 		}
 	}
-	COMMON_LOG_EXIT_RETURN_I(rc);
+
+	// free outside the lock
+	release_context(p_old);
 	return rc;
 }
 
-int set_nvm_context_capabilities(const struct nvm_capabilities *p_capabilities)
+/*
+ * Apply a change to the context by publishing a changed copy of the current snapshot
+ */
+int update_context(context_update update, const void *p_args)
 {
-	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
+	int retry = 1;
+	while (retry)
 	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
-	{
-		if (p_context)
+		retry = 0;
+		struct nvm_context *p_base = acquire_context();
+		if (p_base)
 		{
-			// clean up existing
-			if (p_context->p_capabilities)
+			struct nvm_context *p_new = copy_context(p_base);
+			if (!p_new)
+			{
+				rc = NVM_ERR_NOMEMORY;
+			}
+			else if ((rc = update(p_new, p_args)) != NVM_SUCCESS)
 			{
-				free(p_context->p_capabilities);
-				p_context->p_capabilities = NULL;
+				release_context(p_new);
 			}
-			// create new
-			p_context->p_capabilities = calloc(1, sizeof (struct nvm_capabilities));
-			if (p_context->p_capabilities)
+			else if ((rc = publish_context(p_base, p_new)) == CONTEXT_CHANGED)
 			{
-				memmove(p_context->p_capabilities, p_capabilities,
-						sizeof (struct nvm_capabilities));
-				rc = NVM_SUCCESS;
+				retry = 1;
 			}
+			release_context(p_base);
+		}
+	}
+	return rc;
+}
+
+/*
+ * Find a device in a snapshot, returns the index or -1 if not found
+ */
+int find_context_device(const struct nvm_context *p_snapshot, const NVM_GUID device_guid)
+{
+	int index = -1;
+	for (int i = 0; i < p_snapshot->device_count && index < 0; i++)
+	{
+		if (guid_cmp(device_guid, p_snapshot->p_devices[i].guid))
+		{
+			index = i;
 		}
+	}
+	return index;
+}
+
+/*
+ * Find a namespace in a snapshot, returns the index or -1 if not found
+ */
+int find_context_namespace(const struct nvm_context *p_snapshot, const NVM_GUID namespace_guid)
+{
+	int index = -1;
+	for (int i = 0; i < p_snapshot->namespace_count && index < 0; i++)
+	{
+		if (guid_cmp(namespace_guid, p_snapshot->p_namespaces[i].guid))
+		{
+			index = i;
+		}
+	}
+	return index;
+}
+
+/*
+ * Initialize the context. This is a lazy context meaning
+ * details are added as they are requested rather than up
+ * front. This call should be pair with free_nvm_context.
+ */
+int nvm_create_context()
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	struct nvm_context *p_new = create_empty_context();
+	if (!p_new)
+	{
+		rc = NVM_ERR_NOMEMORY;
+	}
+	// lock
+	else if (!mutex_lock(&g_context_lock))
+	{
+		COMMON_LOG_ERROR("Could not obtain the context lock");
+		release_context(p_new);
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else
+	{
+		// replace the existing context
+		struct nvm_context *p_old = p_context;
+		p_new->version = ++g_context_version;
+		p_context = p_new;
 
 		// unlock
 		if (!mutex_unlock(&g_context_lock))
@@ -290,16 +483,19 @@ int set_nvm_context_capabilities(const struct nvm_capabilities *p_capabilities)
 			COMMON_LOG_ERROR("Could not release the context lock.");
 			rc = NVM_ERR_UNKNOWN;
 		}
+		release_context(p_old);
 	}
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
 
-// devices
-int get_nvm_context_device_count()
+/*
+ * Clean up the resources allocated by nvm_create_context
+ */
+int nvm_free_context()
 {
 	COMMON_LOG_ENTRY();
-	int rc = NVM_ERR_UNKNOWN;
+	int rc = NVM_SUCCESS;
 
 	// lock
 	if (!mutex_lock(&g_context_lock))
@@ -309,10 +505,8 @@ int get_nvm_context_device_count()
 	}
 	else
 	{
-		if (p_context && p_context->device_count >= 0)
-		{
-			rc = p_context->device_count;
-		}
+		struct nvm_context *p_old = p_context;
+		p_context = NULL;
 
 		// unlock
 		if (!mutex_unlock(&g_context_lock))
@@ -320,34 +514,96 @@ int get_nvm_context_device_count()
 			COMMON_LOG_ERROR("Could not release the context lock.");
 			rc = NVM_ERR_UNKNOWN;
 		}
+
+		// readers still holding the snapshot keep it alive until they are done
+		release_context(p_old);
 	}
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
 
-int get_nvm_context_devices(struct device_discovery *p_devices, const int dev_count)
+int get_nvm_context_capabilities(struct nvm_capabilities *p_capabilities)
 {
 	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
+	struct nvm_context *p_snapshot = acquire_context();
+	if (p_snapshot)
 	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
+		if (p_snapshot->p_capabilities)
+		{
+			memmove(p_capabilities, p_snapshot->p_capabilities->data,
+					sizeof (struct nvm_capabilities));
+			rc = NVM_SUCCESS;
+		}
+		release_context(p_snapshot);
+	}
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+int update_context_capabilities(struct nvm_context *p_new, const void *p_args)
+{
+	int rc = NVM_SUCCESS;
+	struct nvm_context_data *p_capabilities =
+			create_context_data(p_args, sizeof (struct nvm_capabilities));
+	if (!p_capabilities)
+	{
+		rc = NVM_ERR_NOMEMORY;
 	}
 	else
 	{
-		if (p_context && p_context->device_count > 0 && p_context->p_devices)
+		release_context_data(p_new->p_capabilities);
+		p_new->p_capabilities = p_capabilities;
+	}
+	return rc;
+}
+
+int set_nvm_context_capabilities(const struct nvm_capabilities *p_capabilities)
+{
+	COMMON_LOG_ENTRY();
+	int rc = update_context(update_context_capabilities, p_capabilities);
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+// devices
+int get_nvm_context_device_count()
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_ERR_UNKNOWN;
+
+	struct nvm_context *p_snapshot = acquire_context();
+	if (p_snapshot)
+	{
+		if (p_snapshot->device_count >= 0)
+		{
+			rc = p_snapshot->device_count;
+		}
+		release_context(p_snapshot);
+	}
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+int get_nvm_context_devices(struct device_discovery *p_devices, const int dev_count)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_ERR_UNKNOWN;
+
+	struct nvm_context *p_snapshot = acquire_context();
+	if (p_snapshot)
+	{
+		if (p_snapshot->device_count > 0)
 		{
 			int copy_count = dev_count;
 			rc = copy_count;
-			if (dev_count > p_context->device_count)
+			if (dev_count > p_snapshot->device_count)
 			{
-				copy_count = p_context->device_count;
+				copy_count = p_snapshot->device_count;
 				rc = copy_count;
 			}
-			else if (dev_count < p_context->device_count)
+			else if (dev_count < p_snapshot->device_count)
 			{
 				rc = NVM_ERR_ARRAYTOOSMALL;
 			}
@@ -355,118 +611,95 @@ int get_nvm_context_devices(struct device_discovery *p_devices, const int dev_co
 
 			for (int i = 0; i < copy_count; i++)
 			{
-				if (p_context->p_devices[i].p_device_discovery)
-				{
-					memmove(&p_devices[i], p_context->p_devices[i].p_device_discovery,
-							sizeof (struct device_discovery));
-				}
-				else
-				{
-					// pointers are invalid, clear the device cache and quit
-					free_device_list();
-					rc = NVM_ERR_UNKNOWN;
-					break;
-				}
+				memmove(&p_devices[i], p_snapshot->p_devices[i].p_device_discovery->data,
+						sizeof (struct device_discovery));
 			}
 		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
-		}
+		release_context(p_snapshot);
 	}
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
 
-int set_nvm_context_devices(const struct device_discovery *p_devices, const int dev_count)
+/*
+ * Arguments to replace a list in the context
+ */
+struct context_list_args
 {
-	COMMON_LOG_ENTRY();
-	int rc = NVM_ERR_UNKNOWN;
+	const void *p_list;
+	int count;
+};
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
+int update_context_devices(struct nvm_context *p_new, const void *p_args)
+{
+	const struct context_list_args *p_list_args = p_args;
+	const struct device_discovery *p_devices = p_list_args->p_list;
+	int rc = NVM_SUCCESS;
+
+	// clean up existing
+	free_device_list(p_new);
+
+	// create new list
+	p_new->p_devices = calloc(p_list_args->count, sizeof (struct nvm_device_context));
+	if (!p_new->p_devices)
 	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
+		COMMON_LOG_ERROR("Failed to allocate memory for device context structure");
+		rc = NVM_ERR_NOMEMORY;
 	}
 	else
 	{
-		if (p_context)
+		p_new->device_count = p_list_args->count;
+		for (int i = 0; i < p_list_args->count; i++)
 		{
-			// clean up existing
-			free_device_list();
-
-			// create new list
-			p_context->p_devices = calloc(dev_count, sizeof (struct nvm_device_context));
-			if (!p_context->p_devices)
+			memmove(p_new->p_devices[i].guid, p_devices[i].guid, sizeof (NVM_GUID));
+			p_new->p_devices[i].p_device_discovery =
+					create_context_data(&p_devices[i], sizeof (struct device_discovery));
+			if (!p_new->p_devices[i].p_device_discovery)
 			{
-				COMMON_LOG_ERROR("Failed to allocate memory for device context structure");
 				rc = NVM_ERR_NOMEMORY;
+				break;
 			}
-			else
-			{
-				p_context->device_count = dev_count;
-				rc = NVM_SUCCESS;
-				for (int i = 0; i < dev_count; i++)
-				{
-					p_context->p_devices[i].p_device_details = NULL;
-					p_context->p_devices[i].p_pcd = NULL;
-					p_context->p_devices[i].pcd_size = -1;
-					p_context->p_devices[i].p_device_discovery =
-							calloc(1, sizeof (struct device_discovery));
-					if (!p_context->p_devices[i].p_device_discovery)
-					{
-						COMMON_LOG_ERROR("Failed to allocate memory for discovery structure");
-						rc = NVM_ERR_NOMEMORY;
-						break;
-					}
-					else
-					{
-						memmove(p_context->p_devices[i].guid,
-								p_devices[i].guid, sizeof (NVM_GUID));
-						memmove(p_context->p_devices[i].p_device_discovery,
-								&p_devices[i], sizeof (struct device_discovery));
-					}
-				}
-			}
-		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
 		}
 	}
+	return rc;
+}
+
+int set_nvm_context_devices(const struct device_discovery *p_devices, const int dev_count)
+{
+	COMMON_LOG_ENTRY();
+	struct context_list_args args;
+	args.p_list = p_devices;
+	args.count = dev_count;
+	int rc = update_context(update_context_devices, &args);
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
 
+int update_context_invalidate_devices(struct nvm_context *p_new, const void *p_args)
+{
+	free_device_list(p_new);
+	return NVM_SUCCESS;
+}
+
 /*
  * Clear the device list
  */
 void invalidate_devices()
 {
 	COMMON_LOG_ENTRY();
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-	}
-	else
-	{
-		free_device_list();
+	update_context(update_context_invalidate_devices, NULL);
+	COMMON_LOG_EXIT();
+}
 
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-		}
+int update_context_invalidate_device_pcd(struct nvm_context *p_new, const void *p_args)
+{
+	int index = find_context_device(p_new, p_args);
+	if (index >= 0)
+	{
+		release_context_data(p_new->p_devices[index].p_pcd);
+		p_new->p_devices[index].p_pcd = NULL;
 	}
-	COMMON_LOG_EXIT();
+	return NVM_SUCCESS;
 }
 
 /*
@@ -475,38 +708,7 @@ void invalidate_devices()
 void invalidate_device_pcd(const NVM_GUID device_guid)
 {
 	COMMON_LOG_ENTRY();
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-	}
-	else
-	{
-		if (p_context && p_context->device_count > 0 && p_context->p_devices)
-		{
-			for (int i = 0; i < p_context->device_count; i++)
-			{
-				if (guid_cmp(device_guid, p_context->p_devices[i].guid))
-				{
-					// found it
-					if (p_context->p_devices[i].p_pcd)
-					{
-						free(p_context->p_devices[i].p_pcd);
-						p_context->p_devices[i].p_pcd = NULL;
-						p_context->p_devices[i].pcd_size = -1;
-					}
-					break;
-				}
-			}
-		}
-
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-		}
-	}
+	update_context(update_context_invalidate_device_pcd, device_guid);
 	COMMON_LOG_EXIT();
 }
 
@@ -515,99 +717,66 @@ int get_nvm_context_device_details(const NVM_GUID device_guid, struct device_det
 	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
+	struct nvm_context *p_snapshot = acquire_context();
+	if (p_snapshot)
 	{
-		if (p_context && p_context->device_count > 0 && p_context->p_devices)
+		int index = find_context_device(p_snapshot, device_guid);
+		if (index >= 0 && p_snapshot->p_devices[index].p_device_details)
 		{
-			for (int i = 0; i < p_context->device_count; i++)
-			{
-				if (guid_cmp(device_guid, p_context->p_devices[i].guid))
-				{
-					// found it
-					if (p_context->p_devices[i].p_device_details)
-					{
-						memset(p_details, 0, sizeof (struct device_details));
-						memmove(p_details, p_context->p_devices[i].p_device_details,
-								sizeof (struct device_details));
-						rc = NVM_SUCCESS;
-					}
-					break;
-				}
-			}
-		}
-
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
+			memset(p_details, 0, sizeof (struct device_details));
+			memmove(p_details, p_snapshot->p_devices[index].p_device_details->data,
+					sizeof (struct device_details));
+			rc = NVM_SUCCESS;
 		}
+		release_context(p_snapshot);
 	}
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
 
-int set_nvm_context_device_details(const NVM_GUID device_guid,
-		const struct device_details *p_details)
+/*
+ * Arguments to replace the data cached for one device or namespace
+ */
+struct context_item_args
 {
-	COMMON_LOG_ENTRY();
+	const COMMON_UINT8 *p_guid;
+	const void *p_data;
+	NVM_SIZE size;
+};
+
+int update_context_device_details(struct nvm_context *p_new, const void *p_args)
+{
+	const struct context_item_args *p_item_args = p_args;
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
+	int index = find_context_device(p_new, p_item_args->p_guid);
+	if (index >= 0)
 	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
-	{
-		if (p_context && p_context->device_count > 0 && p_context->p_devices)
+		struct nvm_context_data *p_details =
+				create_context_data(p_item_args->p_data, p_item_args->size);
+		if (!p_details)
 		{
-			for (int i = 0; i < p_context->device_count; i++)
-			{
-				if (guid_cmp(device_guid, p_context->p_devices[i].guid))
-				{
-					// found it
-					// clear any existing details
-					if (p_context->p_devices[i].p_device_details)
-					{
-						free(p_context->p_devices[i].p_device_details);
-						p_context->p_devices[i].p_device_details = NULL;
-					}
-					// allocate new memory
-					p_context->p_devices[i].p_device_details =
-							calloc(1, sizeof (struct device_details));
-					if (!p_context->p_devices[i].p_device_details)
-					{
-						rc = NVM_ERR_NOMEMORY;
-						COMMON_LOG_ERROR("Failed to allocate memory for device details structure");
-					}
-					else
-					{
-						// success, do the copy
-						memmove(p_context->p_devices[i].p_device_details, p_details,
-								sizeof (struct device_details));
-						rc = NVM_SUCCESS;
-					}
-					break;
-				}
-			}
+			rc = NVM_ERR_NOMEMORY;
 		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
+		else
 		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
+			release_context_data(p_new->p_devices[index].p_device_details);
+			p_new->p_devices[index].p_device_details = p_details;
+			rc = NVM_SUCCESS;
 		}
 	}
+	return rc;
+}
+
+int set_nvm_context_device_details(const NVM_GUID device_guid,
+		const struct device_details *p_details)
+{
+	COMMON_LOG_ENTRY();
+	struct context_item_args args;
+	args.p_guid = device_guid;
+	args.p_data = p_details;
+	args.size = sizeof (struct device_details);
+	int rc = update_context(update_context_device_details, &args);
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
@@ -618,131 +787,81 @@ int get_nvm_context_device_pcd(const NVM_GUID device_guid,
 	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
+	struct nvm_context *p_snapshot = acquire_context();
+	if (p_snapshot)
 	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
-	{
-		if (p_context && p_context->device_count > 0 && p_context->p_devices)
+		int index = find_context_device(p_snapshot, device_guid);
+		if (index >= 0 && p_snapshot->p_devices[index].p_pcd)
 		{
-			for (int i = 0; i < p_context->device_count; i++)
-			{
-				if (guid_cmp(device_guid, p_context->p_devices[i].guid))
-				{
-					// found it
-					if (p_context->p_devices[i].pcd_size > 0 && p_context->p_devices[i].p_pcd)
-					{
-						// allocate memory for return
-						*pp_pcd = calloc(1, p_context->p_devices[i].pcd_size);
-						if (*pp_pcd == NULL)
-						{
-							COMMON_LOG_ERROR("Failed to allocate memory for the pcd structure");
-							rc = NVM_ERR_NOMEMORY;
-						}
-						else
-						{
-							memmove(*pp_pcd, p_context->p_devices[i].p_pcd,
-									p_context->p_devices[i].pcd_size);
-							*p_pcd_size = p_context->p_devices[i].pcd_size;
-							rc = NVM_SUCCESS;
-						}
-					}
-					break;
-				}
-			}
-		}
-
+			const struct nvm_context_data *p_pcd = p_snapshot->p_devices[index].p_pcd;
 
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
+			// allocate memory for return
+			*pp_pcd = calloc(1, p_pcd->size);
+			if (*pp_pcd == NULL)
+			{
+				COMMON_LOG_ERROR("Failed to allocate memory for the pcd structure");
+				rc = NVM_ERR_NOMEMORY;
+			}
+			else
+			{
+				memmove(*pp_pcd, p_pcd->data, p_pcd->size);
+				*p_pcd_size = p_pcd->size;
+				rc = NVM_SUCCESS;
+			}
 		}
+		release_context(p_snapshot);
 	}
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
 
-int set_nvm_context_device_pcd(const NVM_GUID device_guid,
-		const struct platform_config_data *p_pcd, const NVM_SIZE pcd_size)
+int update_context_device_pcd(struct nvm_context *p_new, const void *p_args)
 {
-	COMMON_LOG_ENTRY();
+	const struct context_item_args *p_item_args = p_args;
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
+	int index = find_context_device(p_new, p_item_args->p_guid);
+	if (index >= 0)
 	{
-		if (p_context && p_context->device_count > 0 && p_context->p_devices)
+		struct nvm_context_data *p_pcd =
+				create_context_data(p_item_args->p_data, p_item_args->size);
+		if (!p_pcd)
 		{
-			for (int i = 0; i < p_context->device_count; i++)
-			{
-				if (guid_cmp(device_guid, p_context->p_devices[i].guid))
-				{
-					// found it
-					// clear any existing pcd
-					if (p_context->p_devices[i].pcd_size > 0 && p_context->p_devices[i].p_pcd)
-					{
-						free(p_context->p_devices[i].p_pcd);
-						p_context->p_devices[i].p_pcd = NULL;
-						p_context->p_devices[i].pcd_size = -1;
-					}
-					// allocate new memory
-					p_context->p_devices[i].p_pcd = calloc(1, pcd_size);
-					if (!p_context->p_devices[i].p_pcd)
-					{
-						COMMON_LOG_ERROR("Failed to allocate memory for pcd structure");
-						rc = NVM_ERR_NOMEMORY;
-					}
-					else
-					{
-						// success, do the copy
-						p_context->p_devices[i].pcd_size = pcd_size;
-						memmove(p_context->p_devices[i].p_pcd, p_pcd, pcd_size);
-						rc = NVM_SUCCESS;
-					}
-					break;
-				}
-			}
+			rc = NVM_ERR_NOMEMORY;
 		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
+		else
 		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
+			release_context_data(p_new->p_devices[index].p_pcd);
+			p_new->p_devices[index].p_pcd = p_pcd;
+			rc = NVM_SUCCESS;
 		}
 	}
+	return rc;
+}
+
+int set_nvm_context_device_pcd(const NVM_GUID device_guid,
+		const struct platform_config_data *p_pcd, const NVM_SIZE pcd_size)
+{
+	COMMON_LOG_ENTRY();
+	struct context_item_args args;
+	args.p_guid = device_guid;
+	args.p_data = p_pcd;
+	args.size = pcd_size;
+	int rc = update_context(update_context_device_pcd, &args);
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
 
+int update_context_invalidate_pools(struct nvm_context *p_new, const void *p_args)
+{
+	free_pool_list(p_new);
+	return NVM_SUCCESS;
+}
+
 void invalidate_pools()
 {
 	COMMON_LOG_ENTRY();
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-	}
-	else
-	{
-		free_pool_list();
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-		}
-	}
+	update_context(update_context_invalidate_pools, NULL);
 	COMMON_LOG_EXIT();
 }
 
@@ -751,25 +870,14 @@ int get_nvm_context_pool_count()
 	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
+	struct nvm_context *p_snapshot = acquire_context();
+	if (p_snapshot)
 	{
-		if (p_context && p_context->pool_count >= 0)
-		{
-			rc = p_context->pool_count;
-		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
+		if (p_snapshot->pool_count >= 0)
 		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
+			rc = p_snapshot->pool_count;
 		}
+		release_context(p_snapshot);
 	}
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
@@ -780,82 +888,60 @@ int get_nvm_context_pools(struct pool *p_pools, const int pool_count)
 	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
+	struct nvm_context *p_snapshot = acquire_context();
+	if (p_snapshot)
 	{
-		if (p_context && p_context->pool_count > 0 && p_context->p_pools)
+		if (p_snapshot->pool_count > 0 && p_snapshot->p_pools)
 		{
 			int copy_count = pool_count;
 			rc = pool_count;
-			if (pool_count > p_context->pool_count)
+			if (pool_count > p_snapshot->pool_count)
 			{
-				copy_count = p_context->pool_count;
-				rc = p_context->pool_count;
+				copy_count = p_snapshot->pool_count;
+				rc = p_snapshot->pool_count;
 			}
-			else if (pool_count < p_context->pool_count)
+			else if (pool_count < p_snapshot->pool_count)
 			{
 				rc = NVM_ERR_ARRAYTOOSMALL;
 			}
 			memset(p_pools, 0, (copy_count * sizeof (struct pool)));
-			memmove(p_pools, p_context->p_pools, (copy_count * sizeof (struct pool)));
-		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
+			memmove(p_pools, p_snapshot->p_pools->data, (copy_count * sizeof (struct pool)));
 		}
+		release_context(p_snapshot);
 	}
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
 
-int set_nvm_context_pools(const struct pool *p_pools, const int pool_count)
+int update_context_pools(struct nvm_context *p_new, const void *p_args)
 {
-	COMMON_LOG_ENTRY();
-	int rc = NVM_ERR_UNKNOWN;
+	const struct context_list_args *p_list_args = p_args;
+	int rc = NVM_SUCCESS;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
+	struct nvm_context_data *p_pools = create_context_data(p_list_args->p_list,
+			p_list_args->count * sizeof (struct pool));
+	if (!p_pools)
 	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
+		COMMON_LOG_ERROR("Failed to allocate memory for pool list");
+		rc = NVM_ERR_NOMEMORY;
 	}
 	else
 	{
-		if (p_context)
-		{
-			// clean up existing
-			free_pool_list();
-
-			// create new list
-			p_context->p_pools = calloc(pool_count, sizeof (struct pool));
-			if (!p_context->p_pools)
-			{
-				COMMON_LOG_ERROR("Failed to allocate memory for pool list");
-				rc = NVM_ERR_NOMEMORY;
-			}
-			else
-			{
-				p_context->pool_count = pool_count;
-				memmove(p_context->p_pools, p_pools, pool_count * sizeof (struct pool));
-				rc = NVM_SUCCESS;
-			}
-		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
-		}
+		// clean up existing
+		free_pool_list(p_new);
+		p_new->p_pools = p_pools;
+		p_new->pool_count = p_list_args->count;
 	}
+	return rc;
+}
+
+int set_nvm_context_pools(const struct pool *p_pools, const int pool_count)
+{
+	COMMON_LOG_ENTRY();
+	struct context_list_args args;
+	args.p_list = p_pools;
+	args.count = pool_count;
+	int rc = update_context(update_context_pools, &args);
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 
@@ -866,58 +952,40 @@ int get_nvm_context_pool(const NVM_GUID pool_guid, struct pool *p_pool)
 	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
+	struct nvm_context *p_snapshot = acquire_context();
+	if (p_snapshot)
 	{
-		if (p_context && p_context->pool_count > 0 && p_context->p_pools)
+		if (p_snapshot->pool_count > 0 && p_snapshot->p_pools)
 		{
-			for (int i = 0; i < p_context->pool_count; i++)
+			const struct pool *p_pools = (const struct pool *)p_snapshot->p_pools->data;
+			for (int i = 0; i < p_snapshot->pool_count; i++)
 			{
-				if (guid_cmp(pool_guid, p_context->p_pools[i].pool_guid))
+				if (guid_cmp(pool_guid, p_pools[i].pool_guid))
 				{
 					// found it
 					memset(p_pool, 0, sizeof (struct pool));
-					memmove(p_pool, &p_context->p_pools[i],  sizeof (struct pool));
+					memmove(p_pool, &p_pools[i], sizeof (struct pool));
 					rc = NVM_SUCCESS;
 					break;
 				}
 			}
 		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
-		}
+		release_context(p_snapshot);
 	}
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
 
+int update_context_invalidate_namespaces(struct nvm_context *p_new, const void *p_args)
+{
+	free_namespace_list(p_new);
+	return NVM_SUCCESS;
+}
+
 void invalidate_namespaces()
 {
 	COMMON_LOG_ENTRY();
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-	}
-	else
-	{
-		free_namespace_list();
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-		}
-	}
+	update_context(update_context_invalidate_namespaces, NULL);
 	COMMON_LOG_EXIT();
 }
 
@@ -926,25 +994,14 @@ int get_nvm_context_namespace_count()
 	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
+	struct nvm_context *p_snapshot = acquire_context();
+	if (p_snapshot)
 	{
-		if (p_context && p_context->namespace_count >= 0)
-		{
-			rc = p_context->namespace_count;
-		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
+		if (p_snapshot->namespace_count >= 0)
 		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
+			rc = p_snapshot->namespace_count;
 		}
+		release_context(p_snapshot);
 	}
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
@@ -956,107 +1013,80 @@ int get_nvm_context_namespaces(struct namespace_discovery *p_namespaces,
 	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
+	struct nvm_context *p_snapshot = acquire_context();
+	if (p_snapshot)
 	{
-		if (p_context && p_context->namespace_count > 0 && p_context->p_namespaces)
+		if (p_snapshot->namespace_count > 0)
 		{
 			int copy_count = namespace_count;
 			rc = namespace_count;
-			if (namespace_count > p_context->namespace_count)
+			if (namespace_count > p_snapshot->namespace_count)
 			{
-				copy_count = p_context->namespace_count;
-				rc = p_context->namespace_count;
+				copy_count = p_snapshot->namespace_count;
+				rc = p_snapshot->namespace_count;
 			}
-			else if (namespace_count < p_context->namespace_count)
+			else if (namespace_count < p_snapshot->namespace_count)
 			{
 				rc = NVM_ERR_ARRAYTOOSMALL;
 			}
 
 			memset(p_namespaces, 0, (copy_count * sizeof (struct namespace_discovery)));
-			for (int i = 0; i < namespace_count; i++)
+			for (int i = 0; i < copy_count; i++)
 			{
-				memmove(&p_namespaces[i], p_context->p_namespaces[i].p_namespace_discovery,
+				memmove(&p_namespaces[i],
+						p_snapshot->p_namespaces[i].p_namespace_discovery->data,
 						(sizeof (struct namespace_discovery)));
 			}
 		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
-		}
+		release_context(p_snapshot);
 	}
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
 
-int set_nvm_context_namespaces(const struct namespace_discovery *p_namespaces,
-		const int namespace_count)
+int update_context_namespaces(struct nvm_context *p_new, const void *p_args)
 {
-	COMMON_LOG_ENTRY();
-	int rc = NVM_ERR_UNKNOWN;
+	const struct context_list_args *p_list_args = p_args;
+	const struct namespace_discovery *p_namespaces = p_list_args->p_list;
+	int rc = NVM_SUCCESS;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
+	// clean up existing
+	free_namespace_list(p_new);
+
+	// create new list
+	p_new->p_namespaces = calloc(p_list_args->count, sizeof (struct nvm_namespace_context));
+	if (!p_new->p_namespaces)
 	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
+		COMMON_LOG_ERROR("Failed to allocate memory for context structure");
+		rc = NVM_ERR_NOMEMORY;
 	}
 	else
 	{
-		if (p_context)
+		p_new->namespace_count = p_list_args->count;
+		for (int i = 0; i < p_list_args->count; i++)
 		{
-			// clean up existing
-			free_namespace_list();
-
-			// create new list
-			p_context->p_namespaces = calloc(namespace_count,
-					sizeof (struct nvm_namespace_context));
-			if (!p_context->p_namespaces)
+			memmove(p_new->p_namespaces[i].guid,
+					p_namespaces[i].namespace_guid, sizeof (NVM_GUID));
+			p_new->p_namespaces[i].p_namespace_discovery =
+					create_context_data(&p_namespaces[i], sizeof (struct namespace_discovery));
+			if (!p_new->p_namespaces[i].p_namespace_discovery)
 			{
-				COMMON_LOG_ERROR("Failed to allocate memory for context structure");
 				rc = NVM_ERR_NOMEMORY;
+				break;
 			}
-			else
-			{
-				p_context->namespace_count = namespace_count;
-				rc = NVM_SUCCESS;
-				for (int i = 0; i < namespace_count; i++)
-				{
-					p_context->p_namespaces[i].p_namespace_details = NULL;
-					p_context->p_namespaces[i].p_namespace_discovery =
-							calloc(1, sizeof (struct namespace_discovery));
-					if (!p_context->p_namespaces[i].p_namespace_discovery)
-					{
-						COMMON_LOG_ERROR("Failed to allocate memory for discovery structure");
-						rc = NVM_ERR_NOMEMORY;
-						break;
-					}
-					else
-					{
-						memmove(p_context->p_namespaces[i].guid,
-								p_namespaces[i].namespace_guid, sizeof (NVM_GUID));
-						memmove(p_context->p_namespaces[i].p_namespace_discovery,
-								&p_namespaces[i], sizeof (struct namespace_discovery));
-					}
-				}
-			}
-		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
-		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
 		}
 	}
+	return rc;
+}
+
+int set_nvm_context_namespaces(const struct namespace_discovery *p_namespaces,
+		const int namespace_count)
+{
+	COMMON_LOG_ENTRY();
+	struct context_list_args args;
+	args.p_list = p_namespaces;
+	args.count = namespace_count;
+	int rc = update_context(update_context_namespaces, &args);
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
@@ -1067,98 +1097,56 @@ int get_nvm_context_namespace_details(const NVM_GUID namespace_guid,
 	COMMON_LOG_ENTRY();
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
+	struct nvm_context *p_snapshot = acquire_context();
+	if (p_snapshot)
 	{
-		if (p_context && p_context->namespace_count > 0 && p_context->p_namespaces)
-		{
-			for (int i = 0; i < p_context->namespace_count; i++)
-			{
-				if (guid_cmp(namespace_guid, p_context->p_namespaces[i].guid))
-				{
-					// found it
-					if (p_context->p_namespaces[i].p_namespace_details)
-					{
-						memset(p_details, 0, sizeof (struct namespace_details));
-						memmove(p_details, p_context->p_namespaces[i].p_namespace_details,
-								sizeof (struct namespace_details));
-						rc = NVM_SUCCESS;
-					}
-					break;
-				}
-			}
-		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
+		int index = find_context_namespace(p_snapshot, namespace_guid);
+		if (index >= 0 && p_snapshot->p_namespaces[index].p_namespace_details)
 		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
+			memset(p_details, 0, sizeof (struct namespace_details));
+			memmove(p_details, p_snapshot->p_namespaces[index].p_namespace_details->data,
+					sizeof (struct namespace_details));
+			rc = NVM_SUCCESS;
 		}
+		release_context(p_snapshot);
 	}
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
 
-int set_nvm_context_namespace_details(const NVM_GUID namespace_guid,
-		const struct namespace_details *p_details)
+int update_context_namespace_details(struct nvm_context *p_new, const void *p_args)
 {
-	COMMON_LOG_ENTRY();
+	const struct context_item_args *p_item_args = p_args;
 	int rc = NVM_ERR_UNKNOWN;
 
-	// lock
-	if (!mutex_lock(&g_context_lock))
-	{
-		COMMON_LOG_ERROR("Could not obtain the context lock");
-		rc = NVM_ERR_UNKNOWN;
-	}
-	else
+	int index = find_context_namespace(p_new, p_item_args->p_guid);
+	if (index >= 0)
 	{
-		if (p_context && p_context->namespace_count > 0 && p_context->p_namespaces)
+		struct nvm_context_data *p_details =
+				create_context_data(p_item_args->p_data, p_item_args->size);
+		if (!p_details)
 		{
-			for (int i = 0; i < p_context->namespace_count; i++)
-			{
-				if (guid_cmp(namespace_guid, p_context->p_namespaces[i].guid))
-				{
-					// found it
-					// clear any existing details
-					if (p_context->p_namespaces[i].p_namespace_details)
-					{
-						free(p_context->p_namespaces[i].p_namespace_details);
-						p_context->p_namespaces[i].p_namespace_details = NULL;
-					}
-					// allocate new memory
-					p_context->p_namespaces[i].p_namespace_details =
-							calloc(1, sizeof (struct namespace_details));
-					if (!p_context->p_namespaces[i].p_namespace_details)
-					{
-						rc = NVM_ERR_NOMEMORY;
-						COMMON_LOG_ERROR("Failed to allocate memory for details structure");
-					}
-					else
-					{
-						// success, do the copy
-						memmove(p_context->p_namespaces[i].p_namespace_details, p_details,
-								sizeof (struct namespace_details));
-						rc = NVM_SUCCESS;
-					}
-					break;
-				}
-			}
+			rc = NVM_ERR_NOMEMORY;
 		}
-
-		// unlock
-		if (!mutex_unlock(&g_context_lock))
+		else
 		{
-			COMMON_LOG_ERROR("Could not release the context lock.");
-			rc = NVM_ERR_UNKNOWN;
+			release_context_data(p_new->p_namespaces[index].p_namespace_details);
+			p_new->p_namespaces[index].p_namespace_details = p_details;
+			rc = NVM_SUCCESS;
 		}
 	}
+	return rc;
+}
+
+int set_nvm_context_namespace_details(const NVM_GUID namespace_guid,
+		const struct namespace_details *p_details)
+{
+	COMMON_LOG_ENTRY();
+	struct context_item_args args;
+	args.p_guid = namespace_guid;
+	args.p_data = p_details;
+	args.size = sizeof (struct namespace_details);
+	int rc = update_context(update_context_namespace_details, &args);
 	COMMON_LOG_EXIT_RETURN_I(rc);
 	return rc;
 }
@@ -39,41 +39,7 @@ extern "C"
 {
 #endif
 
-/*
- * The context of an NVM-DIMM
- */
-struct nvm_device_context
-{
-	NVM_GUID guid;
-	struct device_discovery *p_device_discovery;
-	struct device_details *p_device_details;
-	NVM_SIZE pcd_size;
-	struct platform_config_data *p_pcd;
-};
-
-/*
- * The context of an namespace
- */
-struct nvm_namespace_context
-{
-	NVM_GUID guid;
-	struct namespace_discovery *p_namespace_discovery;
-	struct namespace_details *p_namespace_details;
-};
-
-/*
- * Overall system context
- */
-struct nvm_context
-{
-	struct nvm_capabilities *p_capabilities;
-	int device_count;
-	struct nvm_device_context *p_devices;
-	int pool_count;
-	struct pool *p_pools;
-	int namespace_count;
-	struct nvm_namespace_context *p_namespaces;
-};
+struct platform_config_data;
 
 /*
  * Initialize a new context
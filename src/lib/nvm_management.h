@@ -334,6 +334,18 @@ enum diagnostic_test
 	DIAG_TYPE_FW_CONSISTENCY = 4 // verifies all DIMMS have consistent FW and attributes
 };
 
+/*
+ * The individual checks performed by the quick health diagnostic
+ */
+enum quick_diagnostic_check
+{
+	QUICK_DIAGNOSTIC_CHECK_BSR = 0, // boot status register
+	QUICK_DIAGNOSTIC_CHECK_IDENTIFICATION = 1, // manufacturer, model, vendor and device ID
+	QUICK_DIAGNOSTIC_CHECK_HEALTH = 2, // SMART health, sensors and alarm thresholds
+	QUICK_DIAGNOSTIC_CHECK_POWER_LIMITATION = 3, // power limited by the platform
+	QUICK_DIAGNOSTIC_CHECK_MEDIA_ERRORS = 4 // media error log
+};
+
 /*
  * Diagnostic threshold type.
  */
@@ -378,7 +390,8 @@ enum diagnostic_threshold_type
 	DIAG_THRESHOLD_PCONFIG_BROKEN_ISET = 1llu << 36,
 	DIAG_THRESHOLD_PCONFIG_MAPPED_CAPACITY = 1llu << 37,
 	DIAG_THRESHOLD_SECURITY_ALL_NOTSUPPORTED = 1llu << 38,
-	DIAG_THRESHOLD_PCONFIG_BEST_PRACTICES = 1llu << 39
+	DIAG_THRESHOLD_PCONFIG_BEST_PRACTICES = 1llu << 39,
+	DIAG_THRESHOLD_FW_SITE_RULES = 1llu << 40
 };
 
 // The volatile memory mode currently selected by the BIOS.
@@ -645,6 +658,39 @@ struct device_performance
 	NVM_UINT64 block_writes; // Lifetime number of BW write requests the DIMM has services.
 };
 
+/*
+ * The kind of mailbox traffic a #device_mailbox_stats entry counts
+ */
+enum mailbox_command_type
+{
+	MAILBOX_COMMAND_PASSTHROUGH = 0, // A firmware passthrough command, end to end.
+	MAILBOX_COMMAND_LARGE_WRITE = 1, // Filling the large input mailbox of a command.
+	MAILBOX_COMMAND_LARGE_READ = 2 // Draining the large output mailbox of a command.
+};
+
+/*
+ * Mailbox statistics for one firmware command on one device.
+ * @remarks Counted by the library for the commands issued by the calling process,
+ * see #nvm_publish_mailbox_stats to share them with other processes.
+ * @remarks Latency bucket i holds commands that took between
+ * #nvm_get_mailbox_latency_bucket_min and #nvm_get_mailbox_latency_bucket_max
+ * microseconds, each bucket is within 25% of its lower bound.
+ */
+struct device_mailbox_stats
+{
+	NVM_UINT32 device_handle; // The device the commands were sent to.
+	enum mailbox_command_type type; // The kind of mailbox traffic counted.
+	NVM_UINT8 opcode; // The firmware command opcode.
+	NVM_UINT8 sub_opcode; // The firmware command sub-opcode.
+	NVM_UINT64 count; // Number of commands.
+	NVM_UINT64 bytes; // Payload bytes transferred.
+	NVM_UINT64 errors; // Number of commands that failed.
+	NVM_UINT64 busy; // Number of commands that failed because the device was busy.
+	NVM_UINT64 total_latency_usec; // Sum of the command latencies in microseconds.
+	NVM_UINT64 max_latency_usec; // Longest command latency in microseconds.
+	NVM_UINT32 latency_histogram[NVM_MAILBOX_LATENCY_BUCKETS]; // Commands by latency bucket.
+};
+
 /*
  * The threshold settings for a particular sensor
  */
@@ -934,6 +980,17 @@ struct config_goal
 	enum config_goal_status status; // Status for the config goal. Ignored for input.
 };
 
+/*
+ * A configuration goal for one AEP DIMM in a batch request.
+ */
+struct device_config_goal
+{
+	NVM_GUID device_guid; // The AEP DIMM to provision, filled in by the caller
+	struct config_goal goal; // The goal for the AEP DIMM, filled in by the caller
+	int rc; // The outcome of the request on this AEP DIMM
+	NVM_BOOL goal_applied; // Whether the goal is stored on the AEP DIMM on return
+};
+
 /*
  * Basic discovery information about a namespace.
  */
@@ -989,6 +1046,20 @@ struct namespace_create_settings
 	struct namespace_security_features security_features; // Security features
 };
 
+/*
+ * One namespace to create with #nvm_create_namespaces and the outcome of creating it.
+ */
+struct namespace_create_request
+{
+	NVM_GUID pool_guid; // The pool to create the namespace from.
+	struct namespace_create_settings settings; // The new namespace settings.
+	NVM_BOOL format_valid; // If format should be matched by the interleave set.
+	struct interleave_format format; // Interleave set format for App Direct namespaces.
+	NVM_BOOL allow_adjustment; // If block_count may be adjusted to meet alignment.
+	NVM_GUID namespace_guid; // The identifier of the new namespace.
+	int rc; // The return code of creating this namespace.
+};
+
 /*
  * Namespace size ranges. All sizes are in bytes.
  */
@@ -1135,6 +1206,18 @@ struct diagnostic
 	NVM_UINT32 overrides_len; // size of p_overrides array
 };
 
+/*
+ * The outcome of the quick health diagnostic on a single device.
+ */
+struct device_quick_diagnostic_result
+{
+	NVM_GUID device_guid; // The device to check, filled in by the caller
+	int rc; // The return code of the diagnostic on this device
+	NVM_UINT32 results; // The number of diagnostic results, as returned by nvm_run_diagnostic
+	// The number of failures found by each #quick_diagnostic_check
+	NVM_UINT32 check_failures[NVM_QUICK_DIAGNOSTIC_CHECK_COUNT];
+};
+
 /*
  * Describes the identity of a system's physical processor in a NUMA context
  */
@@ -1158,6 +1241,20 @@ struct job
 	enum nvm_job_type type;
 	NVM_GUID affected_element;
 	void *result;
+	char requester[NVM_JOB_REQUESTER_LEN]; // The user that started the job, if known.
+	time_t start_time; // When the job was started, 0 if unknown.
+	time_t last_update_time; // When the progress was last read from the device.
+	time_t end_time; // When the job was seen to complete, 0 if still running.
+	time_t estimated_completion_time; // Projected from the progress so far, 0 if unknown.
+};
+
+/*
+ * The outcome of erasing one device with #nvm_erase_devices.
+ */
+struct device_erase_result
+{
+	NVM_GUID device_guid; // The device that was erased.
+	int rc; // The return code of starting the erase on this device.
 };
 
 /*
@@ -1507,6 +1604,97 @@ extern NVM_API int nvm_get_device_details(const NVM_GUID device_guid,
 extern NVM_API int nvm_get_device_performance(const NVM_GUID device_guid,
 		struct device_performance *p_performance);
 
+/*
+ * Returns the number of firmware commands the calling process has mailbox statistics for.
+ * @remarks This method should be called before #nvm_get_mailbox_stats.
+ * @return Returns the number of #device_mailbox_stats entries.
+ */
+extern NVM_API int nvm_get_mailbox_stats_count();
+
+/*
+ * Retrieve the mailbox statistics of the firmware commands issued by the calling process,
+ * one entry per device, command and #mailbox_command_type.
+ * @param[in,out] p_stats
+ * 		An array of #device_mailbox_stats structures allocated by the caller.
+ * @param[in] count
+ * 		The size of the array.
+ * @remarks The counters are updated without locking, so an entry of a command
+ * 		in flight may be slightly inconsistent with itself.
+ * @return Returns the number of entries on success
+ * or one of the following @link #return_code return_codes: @endlink @n
+ * 		#NVM_ERR_INVALIDPARAMETER @n
+ * 		#NVM_ERR_ARRAYTOOSMALL
+ */
+extern NVM_API int nvm_get_mailbox_stats(struct device_mailbox_stats *p_stats,
+		const NVM_UINT32 count);
+
+/*
+ * Reset the mailbox statistics of the calling process to zero.
+ */
+extern NVM_API void nvm_reset_mailbox_stats();
+
+/*
+ * Publish the mailbox statistics of the calling process so other processes can read them
+ * with #nvm_get_published_mailbox_stats.  The monitor service publishes its statistics
+ * after every monitor pass.
+ * @remarks Replaces the statistics published before, by this or any other process.
+ * @return Returns one of the following @link #return_code return_codes: @endlink @n
+ * 		#NVM_SUCCESS @n
+ * 		#NVM_ERR_NOMEMORY @n
+ * 		#NVM_ERR_UNKNOWN
+ */
+extern NVM_API int nvm_publish_mailbox_stats();
+
+/*
+ * Returns the number of firmware commands with published mailbox statistics.
+ * @remarks This method should be called before #nvm_get_published_mailbox_stats.
+ * @return Returns the number of #device_mailbox_stats entries, 0 if none have been published.
+ */
+extern NVM_API int nvm_get_published_mailbox_stats_count();
+
+/*
+ * Retrieve the mailbox statistics last published with #nvm_publish_mailbox_stats,
+ * normally those of the monitor service.
+ * @param[in,out] p_stats
+ * 		An array of #device_mailbox_stats structures allocated by the caller.
+ * @param[in] count
+ * 		The size of the array.
+ * @return Returns the number of entries on success
+ * or one of the following @link #return_code return_codes: @endlink @n
+ * 		#NVM_ERR_INVALIDPARAMETER @n
+ * 		#NVM_ERR_ARRAYTOOSMALL @n
+ * 		#NVM_ERR_UNKNOWN
+ */
+extern NVM_API int nvm_get_published_mailbox_stats(struct device_mailbox_stats *p_stats,
+		const NVM_UINT32 count);
+
+/*
+ * Get the smallest latency in microseconds counted by a mailbox latency histogram bucket.
+ * @param[in] bucket
+ * 		The bucket, less than #NVM_MAILBOX_LATENCY_BUCKETS.
+ */
+extern NVM_API NVM_UINT64 nvm_get_mailbox_latency_bucket_min(const NVM_UINT32 bucket);
+
+/*
+ * Get the largest latency in microseconds counted by a mailbox latency histogram bucket.
+ * The last bucket also counts every longer latency.
+ * @param[in] bucket
+ * 		The bucket, less than #NVM_MAILBOX_LATENCY_BUCKETS.
+ */
+extern NVM_API NVM_UINT64 nvm_get_mailbox_latency_bucket_max(const NVM_UINT32 bucket);
+
+/*
+ * Estimate a latency percentile from the histogram of a #device_mailbox_stats entry.
+ * @param[in] p_stats
+ * 		The statistics to read.
+ * @param[in] percentile
+ * 		The percentile, 1 to 100.
+ * @return The upper bound in microseconds of the bucket holding the percentile,
+ * 		never more than the maximum latency seen. 0 if there are no commands.
+ */
+extern NVM_API NVM_UINT64 nvm_get_mailbox_latency_percentile(
+		const struct device_mailbox_stats *p_stats, const NVM_UINT8 percentile);
+
 /*
  * Retrieve the firmware image log information from the device specified.
  * @param[in] device_guid
@@ -1808,6 +1996,39 @@ extern NVM_API int nvm_unlock_device(const NVM_GUID device_guid,
 extern NVM_API int nvm_erase_device(const NVM_GUID device_guid, const enum erase_type type,
 		const NVM_PASSPHRASE passphrase, const NVM_SIZE passphrase_len);
 
+/*
+ * Erase every manageable device in the system at once.
+ * The erase is started on all devices in parallel and each one is tracked as a job
+ * that can be followed with #nvm_get_jobs.
+ * @param[in] type
+ * 		The type of erase to perform on each device.
+ * @param[in] passphrase
+ * 		The current passphrase, used by devices with security enabled.
+ * @param[in] passphrase_len
+ * 		String length of passphrase, should be <= #NVM_PASSPHRASE_LEN.
+ * @param[in,out] p_results
+ * 		An array of #device_erase_result structures allocated by the caller.
+ * 		One entry is filled in for each manageable device.
+ * @param[in] count
+ * 		The size of the array.
+ * @pre The caller has administrative privileges.
+ * @remarks To allocate the array of #device_erase_result structures,
+ * call #nvm_get_device_count before calling this method.
+ * @remarks A device that fails to start erasing does not stop the others.
+ * Check the rc of each result.
+ * @return Returns the number of results filled in on success
+ * or one of the following @link #return_code return_codes: @endlink @n
+ * 		#NVM_ERR_ARRAYTOOSMALL @n
+ * 		#NVM_ERR_INVALIDPARAMETER @n
+ * 		#NVM_ERR_INVALIDPERMISSIONS @n
+ * 		#NVM_ERR_NOTSUPPORTED @n
+ * 		#NVM_ERR_UNKNOWN @n
+ * 		#NVM_ERR_NOSIMULATOR (Simulated builds only)
+ */
+extern NVM_API int nvm_erase_devices(const enum erase_type type,
+		const NVM_PASSPHRASE passphrase, const NVM_SIZE passphrase_len,
+		struct device_erase_result *p_results, const NVM_UINT32 count);
+
 /*
  * monitor.c
  */
@@ -2124,6 +2345,45 @@ extern NVM_API int nvm_get_available_persistent_size_range(const NVM_GUID pool_g
 extern NVM_API int nvm_create_config_goal(const NVM_GUID device_guid,
 		struct config_goal *p_goal);
 
+/*
+ * Modify how the capacity of several AEP DIMMs is provisioned by the BIOS on the
+ * next reboot as a single operation.
+ * @param[in,out] p_goals
+ * 		An array of #device_config_goal structures allocated by the caller.
+ * 		The caller sets the device_guid and goal of each entry, the remaining
+ * 		fields are filled in with the outcome for that AEP DIMM.
+ * @param[in] count
+ * 		The number of elements in the array.
+ * @pre The caller has administrative privileges.
+ * @pre The specified AEP DIMMs are manageable by the host software.
+ * @pre Any existing namespaces created from capacity on the
+ * 		AEP DIMMs must be deleted first.
+ * @remarks Every goal is validated before any AEP DIMM is modified. If writing
+ * 		a goal fails, the platform configuration data of the AEP DIMMs already
+ * 		written is restored. The goal_applied field reports any AEP DIMM that
+ * 		could not be restored.
+ * @return Returns one of the following @link #return_code return_codes: @endlink @n
+ *		#NVM_SUCCESS @n
+ * 		#NVM_ERR_INVALIDPERMISSIONS @n
+ * 		#NVM_ERR_NOTSUPPORTED @n
+ * 		#NVM_ERR_NOMEMORY @n
+ * 		#NVM_ERR_BADDEVICE @n
+ * 		#NVM_ERR_INVALIDPARAMETER @n
+ * 		#NVM_ERR_NOTMANAGEABLE @n
+ * 		#NVM_ERR_NAMESPACESEXIST @n
+ * 		#NVM_ERR_DRIVERFAILED @n
+ * 		#NVM_ERR_DATATRANSFERERROR @n
+ * 		#NVM_ERR_DEVICEERROR @n
+ * 		#NVM_ERR_DEVICEBUSY @n
+ * 		#NVM_ERR_BADSIZE @n
+ * 		#NVM_ERR_BADDEVICECONFIG @n
+ * 		#NVM_ERR_UNKNOWN @n
+ * 		#NVM_ERR_NOSIMULATOR (Simulated builds only) @n
+ * 		The AEP DIMM that caused the failure is identified by the rc of its entry.
+ */
+extern NVM_API int nvm_create_config_goals(struct device_config_goal *p_goals,
+		const NVM_UINT32 count);
+
 /*
  * Retrieve the configuration goal from the specified AEP DIMM.
  * @param device_guid
@@ -2436,6 +2696,36 @@ extern NVM_API int nvm_create_namespace(NVM_GUID *p_namespace_guid, const NVM_GU
 		struct namespace_create_settings *p_settings,
 		const struct interleave_format *p_format, const NVM_BOOL allow_adjustment);
 
+/*
+ * Create several namespaces at once.
+ * All requests are validated against a single snapshot of the pools, with the capacity
+ * of each accepted request taken out of the snapshot before the next one is validated.
+ * The namespaces are then created in parallel, one interleave set or DIMM at a time.
+ * @param[in,out] p_requests
+ * 		An array of #namespace_create_request structures allocated by the caller.
+ * 		The caller fills in the pool, settings and format of each entry, the namespace
+ * 		identifier and return code are filled in with the outcome for that namespace.
+ * @param[in] count
+ * 		The number of elements in the array.
+ * @pre The caller has administrative privileges.
+ * @remarks Storage namespaces are only checked against the free capacity of the pool
+ * 		and of the DIMM before the batch, not against other storage namespaces in the
+ * 		batch placed on the same DIMM. If the DIMM runs out, creating that namespace fails.
+ * @return Returns one of the following @link #return_code return_codes: @endlink @n
+ * 		#NVM_SUCCESS @n
+ * 		#NVM_ERR_NOTSUPPORTED @n
+ * 		#NVM_ERR_NOMEMORY @n
+ * 		#NVM_ERR_INVALIDPERMISSIONS @n
+ * 		#NVM_ERR_INVALIDPARAMETER @n
+ * 		#NVM_ERR_BADPOOL @n
+ * 		#NVM_ERR_UNKNOWN @n
+ * 		#NVM_ERR_NOSIMULATOR (Simulated builds only) @n
+ * 		Errors on individual namespaces are reported in the rc of their request,
+ * 		using the return codes of #nvm_create_namespace.
+ */
+extern NVM_API int nvm_create_namespaces(struct namespace_create_request *p_requests,
+		const NVM_UINT32 count);
+
 /*
  * Change the friendly_name setting on the specified namespace.
  * @param[in] namespace_guid
@@ -2814,6 +3104,30 @@ extern NVM_API int nvm_clear_injected_device_error(const NVM_GUID device_guid,
 extern NVM_API int nvm_run_diagnostic(const NVM_GUID device_guid,
 		const struct diagnostic *p_diagnostic, NVM_UINT32 *p_results);
 
+/*
+ * Run the quick health diagnostic on several devices concurrently.
+ * All resulting events are stored in a single transaction.
+ * @param[in] p_diagnostic
+ * 		A pointer to a #diagnostic structure for a #DIAG_TYPE_QUICK test
+ * 		allocated by the caller.
+ * @param[in,out] p_results
+ * 		An array of #device_quick_diagnostic_result structures allocated by the caller.
+ * 		The caller sets the device_guid of each entry, the remaining fields are filled in
+ * 		with the outcome for that device.
+ * @param[in] count
+ * 		The number of elements in the array.
+ * @pre The caller has administrative privileges.
+ * @return Returns one of the following @link #return_code return_codes: @endlink @n
+ * 		#NVM_SUCCESS @n
+ * 		#NVM_ERR_NOTSUPPORTED @n
+ * 		#NVM_ERR_INVALIDPERMISSIONS @n
+ * 		#NVM_ERR_INVALIDPARAMETER @n
+ * 		#NVM_ERR_UNKNOWN @n
+ * 		Errors on individual devices are reported in the rc of their result.
+ */
+extern NVM_API int nvm_run_quick_diagnostics(const struct diagnostic *p_diagnostic,
+		struct device_quick_diagnostic_result *p_results, const NVM_UINT32 count);
+
 /*
  * logging.c
  */
@@ -2916,6 +3230,21 @@ extern NVM_API int nvm_get_job_count();
  */
 extern NVM_API int nvm_get_jobs(struct job *p_jobs, const NVM_UINT32 count);
 
+/*
+ * Refresh the progress of every tracked job from the devices.
+ * Jobs that are running on a device but were not started through this library
+ * are added to the job table, and jobs that have finished get an end time.
+ * @pre The caller must have administrative privileges.
+ * @remarks Intended to be called periodically by the monitor service so
+ * that #nvm_get_jobs has current progress without querying every device.
+ * @return Returns the number of running jobs on success
+ * or one of the following @link #return_code return_codes: @endlink @n
+ * 		#NVM_ERR_INVALIDPERMISSIONS @n
+ * 		#NVM_ERR_UNKNOWN @n
+ * 		#NVM_ERR_NOSIMULATOR (Simulated builds only)
+ */
+extern NVM_API int nvm_update_jobs();
+
 #if __ADD_MANUFACTURING__
 /*
  * A device pass-through command. Refer to the FW specification
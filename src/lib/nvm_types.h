@@ -61,6 +61,7 @@
 #define	NVM_EVENT_MSG_LEN	1024 // Length of event message string
 #define	NVM_EVENT_ARG_LEN	1024 // Length of event argument string
 #define	NVM_MAX_EVENT_ARGS	3 // Maximum number of event arguments
+#define	NVM_MAILBOX_LATENCY_BUCKETS	100 // Number of buckets in a mailbox latency histogram
 #define	NVM_FILTER_ON_TYPE	0x01 // Filter on event type
 #define	NVM_FILTER_ON_SEVERITY	0x02 // Filter on event severity
 #define	NVM_FILTER_ON_CODE	0x04 // Filter on code
@@ -92,10 +93,12 @@
 #define	NVM_MAX_BLOCK_SIZES	16 // maximum number of block sizes supported by the driver
 #define	NVM_MAX_TOPO_SIZE	96 // Maximum number of DIMMs possible for a given memory topology
 #define	NVM_THRESHOLD_STR_LEN	1024 // Max threshold string value len
+#define	NVM_QUICK_DIAGNOSTIC_CHECK_COUNT	5 // Number of checks in the quick health diagnostic
 #define	NVM_VOLATILE_POOL_SOCKET_ID	-1 // Volatile pools are system wide and not tied to a socket
 #define	NVM_MAX_CONFIG_LINE_LEN	512 // Maximum line size for config data in a dump file
 #define	NVM_DIE_SPARES_MAX	4 // Maximum number of spare dies
 #define	NVM_COMMIT_ID_LEN	41
+#define	NVM_JOB_REQUESTER_LEN	256 // Length of the job requester string
 
 /*
  * Macros for controlling what is exported by the library
@@ -45,6 +45,11 @@
 #include "nvm_context.h"
 #include "system.h"
 #include <os/os_adapter.h>
+#include "job.h"
+
+#define	ERASE_BUSY_RETRIES	5
+#define	ERASE_BUSY_RETRY_DELAY_MS	100 // grows with each retry
+#define	ERASE_MAX_THREADS	NVM_MAX_DEVICES_PER_SOCKET
 
 /*
  * Helper functions
@@ -444,6 +449,21 @@ int nvm_unlock_device(const NVM_GUID device_guid,
 
 }
 
+/*
+ * Determine if an erase command should be sent again and wait before it is.
+ * A busy device is given progressively longer to finish what it is doing.
+ */
+NVM_BOOL erase_busy_retry(const int rc, const int count)
+{
+	NVM_BOOL retry = 0;
+	if (rc == NVM_ERR_DEVICEBUSY && count < ERASE_BUSY_RETRIES)
+	{
+		nvm_sleep(ERASE_BUSY_RETRY_DELAY_MS * count);
+		retry = 1;
+	}
+	return retry;
+}
+
 /*
  * Helper method to make the overwrite erase call.
  */
@@ -475,16 +495,16 @@ int overwrite_dimm(NVM_BOOL quick, struct device_discovery *p_discovery)
 	cmd.input_payload_size = sizeof (input_payload);
 	cmd.input_payload = &input_payload;
 
-	// try to send the overwrite cimm command combo up to 5 times
+	// try to send the overwrite dimm command, backing off while the device is busy
 	int count = 0;
 	do
 	{
 		rc = ioctl_passthrough_cmd(&cmd);
-		s_memset(&input_payload, sizeof (input_payload));
 
 		count++;
 	}
-	while (rc == NVM_ERR_DEVICEBUSY && count < 5);
+	while (erase_busy_retry(rc, count));
+	s_memset(&input_payload, sizeof (input_payload));
 
 	// log event if it succeeded
 	if (rc == NVM_SUCCESS)
@@ -506,6 +526,8 @@ int overwrite_dimm(NVM_BOOL quick, struct device_discovery *p_discovery)
 				num_passes_str,
 				NULL,
 				DIAGNOSTIC_RESULT_UNKNOWN);
+
+		record_job_started(p_discovery->device_handle.handle, p_discovery->guid);
 	}
 
 	return rc;
@@ -517,7 +539,7 @@ int overwrite_dimm(NVM_BOOL quick, struct device_discovery *p_discovery)
 int crypto_scramble_dimm(struct device_discovery *p_discovery)
 {
 	int rc = NVM_ERR_UNKNOWN;
-	// try to send the crypto scramble erase command combo up to 5 times
+	// try to send the crypto scramble erase command, backing off while the device is busy
 	int count = 0;
 	do
 	{
@@ -530,7 +552,7 @@ int crypto_scramble_dimm(struct device_discovery *p_discovery)
 
 		count++;
 	}
-	while (rc == NVM_ERR_DEVICEBUSY && count < 5);
+	while (erase_busy_retry(rc, count));
 
 	// log event if it succeeded
 	if (rc == NVM_SUCCESS)
@@ -548,6 +570,8 @@ int crypto_scramble_dimm(struct device_discovery *p_discovery)
 				NULL,
 				NULL,
 				DIAGNOSTIC_RESULT_UNKNOWN);
+
+		record_job_started(p_discovery->device_handle.handle, p_discovery->guid);
 	}
 
 	return rc;
@@ -561,7 +585,7 @@ int secure_erase(const NVM_PASSPHRASE passphrase,
 		struct device_discovery *p_discovery)
 {
 	int rc = NVM_ERR_UNKNOWN;
-	// try to send the prepare/erase command combo up to 5 times
+	// try to send the prepare/erase command combo, backing off while the device is busy
 	int count = 0;
 	do
 	{
@@ -582,7 +606,7 @@ int secure_erase(const NVM_PASSPHRASE passphrase,
 
 		count++;
 	}
-	while (rc == NVM_ERR_DEVICEBUSY && count < 5);
+	while (erase_busy_retry(rc, count));
 
 	// log event if it succeeded
 	if (rc == NVM_SUCCESS)
@@ -605,6 +629,85 @@ int secure_erase(const NVM_PASSPHRASE passphrase,
 	return rc;
 }
 
+/*
+ * Start the requested type of erase on a device that is known to be manageable.
+ */
+int erase_device(struct device_discovery *p_discovery, const enum erase_type type,
+		const NVM_PASSPHRASE passphrase, const NVM_SIZE passphrase_len)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	switch (type)
+	{
+		case ERASE_TYPE_QUICK_OVERWRITE:
+			if (!p_discovery->security_capabilities.erase_overwrite_capable)
+			{
+				COMMON_LOG_ERROR("Invalid parameter. "
+						"Quick overwrite is not valid in the current security state");
+				rc = NVM_ERR_NOTSUPPORTED;
+			}
+			// verify device is in the right state to accept an overwrite
+			else if ((rc = overwrite_crypto_change_prepare(p_discovery)) == NVM_SUCCESS)
+			{
+				rc = overwrite_dimm(1, p_discovery);
+			}
+			break;
+		case ERASE_TYPE_MULTI_OVERWRITE:
+			if (!p_discovery->security_capabilities.erase_overwrite_capable)
+			{
+				COMMON_LOG_ERROR("Invalid parameter. "
+						"Multi overwrite is not valid in the current security state");
+				rc = NVM_ERR_NOTSUPPORTED;
+			}
+			// verify device is in the right state to accept an overwrite
+			else if ((rc = overwrite_crypto_change_prepare(p_discovery)) == NVM_SUCCESS)
+			{
+				rc = overwrite_dimm(0, p_discovery);
+			}
+			break;
+		case ERASE_TYPE_CRYPTO:
+			// if secure erase capable, choose that one first
+			if (p_discovery->security_capabilities.passphrase_capable)
+			{
+				// check passphrase length
+				if (passphrase_len > NVM_PASSPHRASE_LEN)
+				{
+					rc = NVM_ERR_BADPASSPHRASE;
+				}
+				// verify device is in the right state to accept a secure erase
+				else if ((rc =
+						security_change_prepare(p_discovery, passphrase, passphrase_len, 1))
+						== NVM_SUCCESS)
+				{
+					rc = secure_erase(passphrase, passphrase_len, p_discovery);
+				}
+			}
+			else if (p_discovery->security_capabilities.erase_crypto_capable)
+			{
+				// verify device is in the right state to accept a crypto scramble
+				if ((rc = overwrite_crypto_change_prepare(p_discovery)) == NVM_SUCCESS)
+				{
+					rc = crypto_scramble_dimm(p_discovery);
+				}
+			}
+			else
+			{
+				COMMON_LOG_ERROR("Invalid parameter. "
+						"Crypto scramble erase is not valid in the current security state");
+				rc = NVM_ERR_INVALIDPARAMETER;
+			}
+			break;
+		default:
+			COMMON_LOG_ERROR("Invalid erase type");
+			rc = NVM_ERR_INVALIDPARAMETER;
+			break;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
 /*
  * Erases the data on the device specified.
  */
@@ -631,85 +734,135 @@ int nvm_erase_device(const NVM_GUID device_guid, const enum erase_type type,
 	}
 	else if ((rc = exists_and_manageable(device_guid, &discovery, 1)) == NVM_SUCCESS)
 	{
-		switch (type)
+		rc = erase_device(&discovery, type, passphrase, passphrase_len);
+		// clear any device context - security state has likely changed
+		invalidate_devices();
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * The slice of devices erased by one thread
+ */
+struct erase_worker
+{
+	struct device_discovery *p_devices;
+	struct device_erase_result *p_results;
+	NVM_UINT32 count;
+	NVM_UINT32 first; // index of the first device erased by this thread
+	NVM_UINT32 stride; // number of threads
+	enum erase_type type;
+	const char *passphrase;
+	NVM_SIZE passphrase_len;
+};
+
+/*
+ * Thread body erasing every stride'th device starting at first
+ */
+void *erase_worker_thread(void *arg)
+{
+	struct erase_worker *p_worker = (struct erase_worker *)arg;
+	for (NVM_UINT32 i = p_worker->first; i < p_worker->count; i += p_worker->stride)
+	{
+		p_worker->p_results[i].rc = erase_device(&p_worker->p_devices[i],
+				p_worker->type, p_worker->passphrase, p_worker->passphrase_len);
+	}
+	return NULL;
+}
+
+/*
+ * Erases the data on every manageable device at once.
+ */
+int nvm_erase_devices(const enum erase_type type,
+		const NVM_PASSPHRASE passphrase, const NVM_SIZE passphrase_len,
+		struct device_erase_result *p_results, const NVM_UINT32 count)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	// check user has permission to make changes
+	if (check_caller_permissions() != COMMON_SUCCESS)
+	{
+		rc = NVM_ERR_INVALIDPERMISSIONS;
+	}
+	else if ((rc = IS_NVM_FEATURE_SUPPORTED(modify_device_security)) != NVM_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Modifying "NVM_DIMM_NAME" security is not supported.");
+	}
+	else if (p_results == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_results is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if ((rc = nvm_get_device_count()) > 0)
+	{
+		int device_count = rc;
+		struct device_discovery devices[device_count];
+		if ((rc = nvm_get_devices(devices, device_count)) > 0)
 		{
-			case ERASE_TYPE_QUICK_OVERWRITE:
-				if (!discovery.security_capabilities.erase_overwrite_capable)
+			// only manageable devices are erased
+			NVM_UINT32 manageable_count = 0;
+			for (int i = 0; i < rc; i++)
+			{
+				if (devices[i].manageability == MANAGEMENT_VALIDCONFIG)
 				{
-					COMMON_LOG_ERROR("Invalid parameter. "
-							"Quick overwrite is not valid in the current security state");
-					rc = NVM_ERR_NOTSUPPORTED;
+					memmove(&devices[manageable_count], &devices[i],
+							sizeof (struct device_discovery));
+					manageable_count++;
 				}
-				else
+			}
+
+			if (manageable_count > count)
+			{
+				COMMON_LOG_ERROR("Invalid parameter, "
+						"count is smaller than number of manageable devices");
+				rc = NVM_ERR_ARRAYTOOSMALL;
+			}
+			else if (manageable_count > 0)
+			{
+				memset(p_results, 0, sizeof (struct device_erase_result) * count);
+				for (NVM_UINT32 i = 0; i < manageable_count; i++)
 				{
-					// verify device is in the right state to accept an overwrite
-					if ((rc = overwrite_crypto_change_prepare(&discovery)) == NVM_SUCCESS)
-					{
-						rc = overwrite_dimm(1, &discovery);
-						// clear any device context - security state has likely changed
-						invalidate_devices();
-					}
+					memmove(p_results[i].device_guid, devices[i].guid, NVM_GUID_LEN);
+					// fails unless the worker gets to it
+					p_results[i].rc = NVM_ERR_UNKNOWN;
 				}
-				break;
-			case ERASE_TYPE_MULTI_OVERWRITE:
-				if (!discovery.security_capabilities.erase_overwrite_capable)
-				{
-					COMMON_LOG_ERROR("Invalid parameter. "
-							"Multi overwrite is not valid in the current security state");
-					rc = NVM_ERR_NOTSUPPORTED;
-				}
-				else
-				{
-					// verify device is in the right state to accept an overwrite
-					if ((rc = overwrite_crypto_change_prepare(&discovery)) == NVM_SUCCESS)
-					{
-						rc = overwrite_dimm(0, &discovery);
-						// clear any device context - security state has likely changed
-						invalidate_devices();
-					}
 
-				}
-				break;
-			case ERASE_TYPE_CRYPTO:
-				// if secure erase capable, choose that one first
-				if (discovery.security_capabilities.passphrase_capable)
-				{
-					// check passphrase length
-					if (passphrase_len > NVM_PASSPHRASE_LEN)
-					{
-						rc = NVM_ERR_BADPASSPHRASE;
-					}
-					// verify device is in the right state to accept a secure erase
-					else if ((rc =
-							security_change_prepare(&discovery, passphrase, passphrase_len, 1))
-							== NVM_SUCCESS)
-					{
-						rc = secure_erase(passphrase, passphrase_len, &discovery);
-						// clear any device context - security state has likely changed
-						invalidate_devices();
-					}
-				}
-				else if (discovery.security_capabilities.erase_crypto_capable)
+				NVM_UINT32 thread_count = manageable_count;
+				if (thread_count > ERASE_MAX_THREADS)
 				{
-					// verify device is in the right state to accept a crypto scramble
-					if ((rc = overwrite_crypto_change_prepare(&discovery)) == NVM_SUCCESS)
-					{
-						rc = crypto_scramble_dimm(&discovery);
-						// clear any device context - security state has likely changed
-						invalidate_devices();
-					}
+					thread_count = ERASE_MAX_THREADS;
 				}
-				else
+
+				struct erase_worker workers[thread_count];
+				for (NVM_UINT32 t = 0; t < thread_count; t++)
 				{
-					COMMON_LOG_ERROR("Invalid parameter. "
-							"Crypto scramble erase is not valid in the current security state");
-					rc = NVM_ERR_INVALIDPARAMETER;
+					workers[t].p_devices = devices;
+					workers[t].p_results = p_results;
+					workers[t].count = manageable_count;
+					workers[t].first = t;
+					workers[t].stride = thread_count;
+					workers[t].type = type;
+					workers[t].passphrase = passphrase;
+					workers[t].passphrase_len = passphrase_len;
 				}
-				break;
-			default:
-				COMMON_LOG_ERROR("Invalid erase type");
-				rc = NVM_ERR_INVALIDPARAMETER;
-				break;
+				run_device_workers(erase_worker_thread, workers,
+						sizeof (struct erase_worker), thread_count);
+
+				// clear any device context - security state has likely changed
+				invalidate_devices();
+				rc = manageable_count;
+			}
+			else
+			{
+				rc = 0;
+			}
+		}
+		else if (rc < 0)
+		{
+			COMMON_LOG_ERROR_F("Unable to get device discovery: rc = %d", rc);
 		}
 	}
 
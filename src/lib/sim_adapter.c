@@ -0,0 +1,577 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Implementation of the simulated device adapter interface for general operations.
+ */
+
+#include "device_adapter.h"
+#include "sim_adapter.h"
+#include "platform_capabilities.h"
+#include "utility.h"
+#include <persistence/logging.h>
+#include <string/s_str.h>
+#include <guid/guid.h>
+
+// The loaded simulator file - one per process
+PersistentStore *p_sim_store = NULL;
+
+/*
+ * Open the simulator file and load the firmware command behavior it describes
+ */
+int open_sim_store(const NVM_PATH simulator)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	// replace any simulator already loaded
+	close_sim_store();
+
+	PersistentStore *p_store = open_PersistentStore(simulator);
+	if (!p_store)
+	{
+		COMMON_LOG_ERROR_F("Failed to open the simulator file %s", simulator);
+		rc = NVM_ERR_BADFILE;
+	}
+	else if ((rc = load_sim_fw_behavior(p_store)) != NVM_SUCCESS)
+	{
+		free_PersistentStore(&p_store);
+	}
+	else
+	{
+		p_sim_store = p_store;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Close the simulator file
+ */
+int close_sim_store()
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	if (!p_sim_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else
+	{
+		unload_sim_fw_behavior();
+		free_PersistentStore(&p_sim_store);
+		p_sim_store = NULL;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Get the loaded simulator file, NULL if no simulator is loaded
+ */
+PersistentStore *get_sim_store()
+{
+	if (!p_sim_store)
+	{
+		COMMON_LOG_ERROR("No simulator is loaded");
+	}
+	return p_sim_store;
+}
+
+/*
+ * Get the dimm topology entry for a device handle from the simulator file
+ */
+int get_sim_dimm_topology(PersistentStore *p_store, const NVM_UINT32 device_handle,
+		struct db_dimm_topology *p_topology)
+{
+	int rc = NVM_SUCCESS;
+	if (db_get_dimm_topology_by_device_handle(p_store, device_handle, p_topology) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("Simulated "NVM_DIMM_NAME" %u does not exist", device_handle);
+		rc = NVM_ERR_BADDEVICE;
+	}
+	return rc;
+}
+
+/*
+ * Retrieve the vendor specific NVDIMM driver version.
+ */
+int get_vendor_driver_revision(NVM_VERSION version_str, const NVM_SIZE str_len)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	if (version_str == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, version buffer in NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (str_len == 0)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, version buffer length is 0");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else
+	{
+		// the simulator file may record the driver of the system it describes
+		struct db_sw_inventory inventory;
+		if (db_get_sw_inventorys(p_store, &inventory, 1) == 1 &&
+				s_strnlen(inventory.vendor_driver_rev, SW_INVENTORY_VENDOR_DRIVER_REV_LEN) > 0)
+		{
+			s_strncpy(version_str, str_len,
+					inventory.vendor_driver_rev, SW_INVENTORY_VENDOR_DRIVER_REV_LEN);
+		}
+		else
+		{
+			s_strcpy(version_str, "0.0.0.0", str_len);
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Get the capabilities of the host platform
+ */
+int get_platform_capabilities(struct bios_capabilities *p_capabilities,
+		const NVM_UINT32 cap_len)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	if (!p_capabilities)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_cabilities is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else
+	{
+		memset(p_capabilities, 0, cap_len);
+		rc = get_pcat_from_db(p_store, p_capabilities, cap_len);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Get the number of DIMMs in the system's memory topology
+ */
+int get_topology_count()
+{
+	COMMON_LOG_ENTRY();
+	int rc = 0; // returns the dimm count
+	PersistentStore *p_store = get_sim_store();
+
+	if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_dimm_topology_count(p_store, &rc) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to get the simulated "NVM_DIMM_NAME" count");
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Get the system's memory topology
+ */
+int get_topology(const NVM_UINT8 count, struct nvm_topology *p_dimm_topo)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	// check input parameters
+	if (count <= 0)
+	{
+		COMMON_LOG_ERROR_F("Invalid parameter, count = %d", count);
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if (p_dimm_topo == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, nvm_topology array is null");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else
+	{
+		int dimm_count = 0;
+		if (db_get_dimm_topology_count(p_store, &dimm_count) != DB_SUCCESS)
+		{
+			COMMON_LOG_ERROR("Failed to get the simulated "NVM_DIMM_NAME" count");
+			rc = NVM_ERR_DRIVERFAILED;
+		}
+		else if (dimm_count > count)
+		{
+			COMMON_LOG_ERROR("Invalid parameter, "
+					"count is smaller than number of "NVM_DIMM_NAME"s");
+			rc = NVM_ERR_ARRAYTOOSMALL;
+		}
+		else if (dimm_count > 0)
+		{
+			memset(p_dimm_topo, 0, count * sizeof (struct nvm_topology));
+
+			struct db_dimm_topology topologies[dimm_count];
+			dimm_count = db_get_dimm_topologys(p_store, topologies, dimm_count);
+			for (int i = 0; i < dimm_count; i++)
+			{
+				p_dimm_topo[i].device_handle.handle = topologies[i].device_handle;
+				p_dimm_topo[i].id = topologies[i].id;
+				p_dimm_topo[i].vendor_id = topologies[i].vendor_id;
+				p_dimm_topo[i].device_id = topologies[i].device_id;
+				p_dimm_topo[i].revision_id = topologies[i].revision_id;
+				p_dimm_topo[i].type = topologies[i].type;
+
+				// the interface format code is reported by identify dimm
+				struct db_identify_dimm identify_dimm;
+				if (db_get_identify_dimm_by_device_handle(p_store,
+						topologies[i].device_handle, &identify_dimm) == DB_SUCCESS)
+				{
+					p_dimm_topo[i].fmt_interface_code = identify_dimm.interface_format_code;
+				}
+			}
+		}
+
+		if (rc == NVM_SUCCESS)
+		{
+			rc = dimm_count;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Helper to convert SMBIOS details from the simulator file
+ */
+void db_dimm_details_to_nvm_details(const struct db_dimm_details *p_db_details,
+		struct nvm_details *p_details)
+{
+	memset(p_details, 0, sizeof (struct nvm_details));
+	p_details->id = p_db_details->id;
+	p_details->type = p_db_details->type;
+	p_details->type_detail_bits = p_db_details->type_detail;
+	p_details->form_factor = p_db_details->form_factor;
+	p_details->data_width = p_db_details->data_width;
+	p_details->total_width = p_db_details->total_width;
+	p_details->size = p_db_details->size;
+	p_details->speed = p_db_details->speed;
+	s_strncpy(p_details->part_number, NVM_PART_NUM_LEN,
+			p_db_details->part_number, DIMM_DETAILS_PART_NUMBER_LEN);
+	s_strncpy(p_details->device_locator, NVM_DEVICE_LOCATOR_LEN,
+			p_db_details->device_locator, DIMM_DETAILS_DEVICE_LOCATOR_LEN);
+	s_strncpy(p_details->bank_label, NVM_BANK_LABEL_LEN,
+			p_db_details->bank_label, DIMM_DETAILS_BANK_LABEL_LEN);
+	s_strncpy(p_details->manufacturer, NVM_MANUFACTURERSTR_LEN,
+			p_db_details->manufacturer, DIMM_DETAILS_MANUFACTURER_LEN);
+}
+
+/*
+ * Get the details of a specific dimm
+ */
+int get_dimm_details(NVM_NFIT_DEVICE_HANDLE device_handle, struct nvm_details *p_dimm_details)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	if (p_dimm_details == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_dimm_details is null");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else
+	{
+		// details are keyed by the SMBIOS handle of the dimm
+		struct db_dimm_topology topology;
+		struct db_dimm_details db_details;
+		if ((rc = get_sim_dimm_topology(p_store, device_handle.handle, &topology))
+				!= NVM_SUCCESS)
+		{
+			// already logged
+		}
+		else if (db_get_dimm_details_by_id(p_store, topology.id, &db_details) != DB_SUCCESS)
+		{
+			COMMON_LOG_ERROR_F("Failed to get the SMBIOS details for "NVM_DIMM_NAME" %u",
+					device_handle.handle);
+			rc = NVM_ERR_DRIVERFAILED;
+		}
+		else
+		{
+			db_dimm_details_to_nvm_details(&db_details, p_dimm_details);
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+int get_smbios_inventory_count()
+{
+	COMMON_LOG_ENTRY();
+	int rc = 0;
+	PersistentStore *p_store = get_sim_store();
+
+	if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_dimm_details_count(p_store, &rc) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to get the simulated SMBIOS memory device count");
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+int get_smbios_inventory(const NVM_UINT8 count, struct nvm_details *p_smbios_inventory)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	if (p_smbios_inventory == NULL)
+	{
+		COMMON_LOG_ERROR("nvm_details pointer was NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (count > 0)
+	{
+		memset(p_smbios_inventory, 0, sizeof (struct nvm_details) * count);
+
+		struct db_dimm_details db_details[count];
+		rc = db_get_dimm_detailss(p_store, db_details, count);
+		for (int i = 0; i < rc; i++)
+		{
+			db_dimm_details_to_nvm_details(&db_details[i], &p_smbios_inventory[i]);
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Return driver capabilities
+ */
+int get_driver_capabilities(struct nvm_driver_capabilities *p_capabilities)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	struct db_driver_capabilities db_capabilities;
+	struct db_driver_features db_features;
+	if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_driver_capabilitiess(p_store, &db_capabilities, 1) != 1 ||
+			db_get_driver_featuress(p_store, &db_features, 1) != 1)
+	{
+		COMMON_LOG_ERROR("The simulator does not describe the driver capabilities");
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+	else
+	{
+		memset(p_capabilities, 0, sizeof (struct nvm_driver_capabilities));
+		p_capabilities->min_namespace_size = db_capabilities.min_namespace_size;
+		p_capabilities->num_block_sizes = db_capabilities.num_block_sizes;
+		if (p_capabilities->num_block_sizes > MAX_NUMBER_OF_BLOCK_SIZES)
+		{
+			p_capabilities->num_block_sizes = MAX_NUMBER_OF_BLOCK_SIZES;
+		}
+		for (NVM_UINT32 i = 0; i < p_capabilities->num_block_sizes; i++)
+		{
+			p_capabilities->block_sizes[i] = db_capabilities.block_sizes[i];
+		}
+
+		struct driver_feature_flags *p_features = &p_capabilities->features;
+		p_features->get_platform_capabilities = db_features.get_platform_capabilities;
+		p_features->get_topology = db_features.get_topology;
+		p_features->get_interleave = db_features.get_interleave;
+		p_features->get_dimm_detail = db_features.get_dimm_detail;
+		p_features->get_namespaces = db_features.get_namespaces;
+		p_features->get_namespace_detail = db_features.get_namespace_detail;
+		p_features->get_address_scrub_data = db_features.get_address_scrub_data;
+		p_features->get_platform_config_data = db_features.get_platform_config_data;
+		p_features->get_boot_status = db_features.get_boot_status;
+		p_features->get_power_data = db_features.get_power_data;
+		p_features->get_security_state = db_features.get_security_state;
+		p_features->get_log_page = db_features.get_log_page;
+		p_features->get_features = db_features.get_features;
+		p_features->set_features = db_features.set_features;
+		p_features->create_namespace = db_features.create_namespace;
+		p_features->rename_namespace = db_features.rename_namespace;
+		p_features->grow_namespace = db_features.grow_namespace;
+		p_features->shrink_namespace = db_features.shrink_namespace;
+		p_features->delete_namespace = db_features.delete_namespace;
+		p_features->enable_namespace = db_features.enable_namespace;
+		p_features->disable_namespace = db_features.disable_namespace;
+		p_features->set_security_state = db_features.set_security_state;
+		p_features->enable_logging = db_features.enable_logging;
+		p_features->run_diagnostic = db_features.run_diagnostic;
+		p_features->set_platform_config = db_features.set_platform_config;
+		p_features->passthrough = db_features.passthrough;
+		p_features->start_address_scrub = db_features.start_address_scrub;
+		p_features->app_direct_mode = db_features.app_direct_mode;
+		p_features->storage_mode = db_features.storage_mode;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Determine if power is limited
+ * Return error code or whether or not power is limited
+ */
+int get_dimm_power_limited(NVM_UINT16 socket_id)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	struct db_socket socket;
+	if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_socket_by_socket_id(p_store, socket_id, &socket) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("Simulated socket %hu does not exist", socket_id);
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+	else
+	{
+		rc = socket.rapl_limited ? 1 : 0;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+int get_test_result_count(enum driver_diagnostic diagnostic)
+{
+	COMMON_LOG_ENTRY();
+	int rc = 0;
+	PersistentStore *p_store = get_sim_store();
+
+	if (diagnostic != DRIVER_DIAGNOSTIC_PM_METADATA_CHECK)
+	{
+		rc = NVM_ERR_NOTSUPPORTED;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_driver_metadata_check_diag_result_count(p_store, &rc) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to get the simulated metadata check result count");
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+int run_test(enum driver_diagnostic diagnostic, const NVM_UINT32 count,
+		struct health_event results[])
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	if (diagnostic != DRIVER_DIAGNOSTIC_PM_METADATA_CHECK)
+	{
+		rc = NVM_ERR_NOTSUPPORTED;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (count > 0)
+	{
+		memset(results, 0, count * sizeof (struct health_event));
+
+		struct db_driver_metadata_check_diag_result db_results[count];
+		rc = db_get_driver_metadata_check_diag_results(p_store, db_results, count);
+		for (int i = 0; i < rc; i++)
+		{
+			results[i].event_type = db_results[i].result_type;
+			if (results[i].event_type == HEALTH_EVENT_TYPE_NAMESPACE)
+			{
+				results[i].health.namespace_event.health_flag = db_results[i].health_flag;
+				str_to_guid(db_results[i].ns_guid,
+						results[i].health.namespace_event.namespace_guid);
+			}
+			else
+			{
+				results[i].health.label_area_event.health_flag = db_results[i].health_flag;
+				results[i].health.label_area_event.device_handle =
+						db_results[i].device_handle;
+			}
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file declares common definitions and helper functions used throughout the
+ * simulated device adapter.
+ *
+ * The simulated system is described by a simulator file, a database with the same
+ * schema as the library's own. The DIMMs, namespaces and interleave sets are read
+ * from its tables and any change made through the adapter is written back to them,
+ * so the state of the simulated DIMMs persists in the file.
+ */
+
+#ifndef SIM_ADAPTER_H_
+#define	SIM_ADAPTER_H_
+
+#include "device_adapter.h"
+#include <persistence/schema.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Simulator file config keys.
+ * These are read from the config table of the simulator file, not the library's.
+ */
+//! Per command latency, a comma separated list of <opcode>[.<sub_opcode>]=<milliseconds>
+#define	SIM_KEY_FW_LATENCY	"SIM_FW_LATENCY"
+//! Injected faults, a comma separated list of <opcode>[.<sub_opcode>]=<mailbox status>[/<every n>]
+#define	SIM_KEY_FW_FAULTS	"SIM_FW_FAULTS"
+//! Firmware trace file whose recorded responses are served before the simulated ones
+#define	SIM_KEY_FW_REPLAY	"SIM_FW_REPLAY"
+//! 1 to reproduce the latency recorded in the firmware trace file
+#define	SIM_KEY_FW_REPLAY_TIMING	"SIM_FW_REPLAY_TIMING"
+//! Security passphrase of a simulated DIMM, by device handle
+#define	SIM_KEY_PASSPHRASE	"SIM_PASSPHRASE_%u"
+
+/*
+ * Open the simulator file and load the firmware command behavior it describes
+ */
+int open_sim_store(const NVM_PATH simulator);
+
+/*
+ * Close the simulator file
+ */
+int close_sim_store();
+
+/*
+ * Get the loaded simulator file, NULL if no simulator is loaded
+ */
+PersistentStore *get_sim_store();
+
+/*
+ * Parse the firmware command latency and fault rules and load the firmware trace
+ * from the simulator file
+ */
+int load_sim_fw_behavior(PersistentStore *p_store);
+
+/*
+ * Release the firmware command behavior loaded from the simulator file
+ */
+void unload_sim_fw_behavior();
+
+/*
+ * Get the dimm topology entry for a device handle from the simulator file
+ */
+int get_sim_dimm_topology(PersistentStore *p_store, const NVM_UINT32 device_handle,
+		struct db_dimm_topology *p_topology);
+
+/*
+ * Get a simulated interleave set by its index from the current config
+ */
+int get_sim_interleave_set(PersistentStore *p_store, const NVM_UINT32 index_id,
+		struct nvm_interleave_set *p_set);
+
+/*
+ * Get the storage capacity of a simulated dimm
+ */
+int get_sim_storage_capacity(PersistentStore *p_store, const NVM_UINT32 device_handle,
+		struct nvm_storage_capacities *p_capacity);
+
+/*
+ * Get the capacity used by the simulated namespaces on an interleave set
+ * (app direct) or a dimm (storage)
+ */
+NVM_UINT64 get_sim_namespace_capacity(PersistentStore *p_store,
+		const enum namespace_type type, const NVM_UINT32 creation_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_ADAPTER_H_ */
@@ -0,0 +1,489 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file contains the implementation of the simulated device adapter interface for
+ * namespaces.  Namespaces live in the namespace table of the simulator file.
+ */
+
+#include "device_adapter.h"
+#include "sim_adapter.h"
+#include "utility.h"
+#include <persistence/logging.h>
+#include <string/s_str.h>
+#include <guid/guid.h>
+
+/*
+ * Get the identifier a namespace was created on
+ */
+static NVM_UINT32 get_sim_namespace_creation_id(const struct db_namespace *p_namespace)
+{
+	return (p_namespace->type == NAMESPACE_TYPE_STORAGE) ?
+			p_namespace->device_handle : p_namespace->interleave_set_index;
+}
+
+/*
+ * Get the capacity used by the simulated namespaces on an interleave set
+ * (app direct) or a dimm (storage)
+ */
+NVM_UINT64 get_sim_namespace_capacity(PersistentStore *p_store,
+		const enum namespace_type type, const NVM_UINT32 creation_id)
+{
+	NVM_UINT64 capacity = 0;
+
+	int ns_count = 0;
+	if (db_get_namespace_count(p_store, &ns_count) == DB_SUCCESS && ns_count > 0)
+	{
+		struct db_namespace namespaces[ns_count];
+		ns_count = db_get_namespaces(p_store, namespaces, ns_count);
+		for (int i = 0; i < ns_count; i++)
+		{
+			if (namespaces[i].type == type &&
+					get_sim_namespace_creation_id(&namespaces[i]) == creation_id)
+			{
+				capacity += adjust_namespace_size(namespaces[i].block_size,
+						namespaces[i].block_count);
+			}
+		}
+	}
+
+	return capacity;
+}
+
+/*
+ * Get the simulated namespace for a guid
+ */
+static int get_sim_namespace(PersistentStore *p_store, const NVM_GUID namespace_guid,
+		struct db_namespace *p_namespace)
+{
+	int rc = NVM_SUCCESS;
+
+	NVM_GUID_STR guid_str;
+	guid_to_str(namespace_guid, guid_str);
+	if (db_get_namespace_by_namespace_guid(p_store, guid_str, p_namespace) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("Simulated namespace %s does not exist", guid_str);
+		rc = NVM_ERR_BADNAMESPACE;
+	}
+	return rc;
+}
+
+/*
+ * Write a changed namespace back to the simulator file
+ */
+static int update_sim_namespace(PersistentStore *p_store, struct db_namespace *p_namespace)
+{
+	int rc = NVM_SUCCESS;
+	if (db_update_namespace_by_namespace_guid(p_store,
+			p_namespace->namespace_guid, p_namespace) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("Failed to update simulated namespace %s",
+				p_namespace->namespace_guid);
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+	return rc;
+}
+
+/*
+ * Get the number of existing namespaces
+ */
+int get_namespace_count()
+{
+	COMMON_LOG_ENTRY();
+	int rc = 0;
+	PersistentStore *p_store = get_sim_store();
+
+	if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_namespace_count(p_store, &rc) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to get the simulated namespace count");
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Get the discovery information for a given number of namespaces
+ */
+int get_namespaces(const NVM_UINT32 count,
+		struct nvm_namespace_discovery *p_namespaces)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	int ns_count = 0;
+	if (p_namespaces == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_namespaces is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_namespace_count(p_store, &ns_count) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to get the simulated namespace count");
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+	else if (ns_count > count)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, count is smaller than number of namespaces");
+		rc = NVM_ERR_ARRAYTOOSMALL;
+	}
+	else if (ns_count > 0)
+	{
+		memset(p_namespaces, 0, count * sizeof (struct nvm_namespace_discovery));
+
+		struct db_namespace namespaces[ns_count];
+		ns_count = db_get_namespaces(p_store, namespaces, ns_count);
+		for (int i = 0; i < ns_count; i++)
+		{
+			str_to_guid(namespaces[i].namespace_guid, p_namespaces[i].namespace_guid);
+			s_strncpy(p_namespaces[i].friendly_name, NVM_NAMESPACE_NAME_LEN,
+					namespaces[i].friendly_name, NAMESPACE_FRIENDLY_NAME_LEN);
+		}
+		rc = ns_count;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Get the details for a specific namespace
+ */
+int get_namespace_details(
+		const NVM_GUID namespace_guid,
+		struct nvm_namespace_details *p_details)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	struct db_namespace ns;
+	if (namespace_guid == NULL)
+	{
+		COMMON_LOG_ERROR("namespace guid cannot be NULL.");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (p_details == NULL)
+	{
+		COMMON_LOG_ERROR("nvm_namespace_details is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if ((rc = get_sim_namespace(p_store, namespace_guid, &ns)) == NVM_SUCCESS)
+	{
+		memset(p_details, 0, sizeof (struct nvm_namespace_details));
+		memmove(p_details->discovery.namespace_guid, namespace_guid, NVM_GUID_LEN);
+		s_strncpy(p_details->discovery.friendly_name, NVM_NAMESPACE_NAME_LEN,
+				ns.friendly_name, NAMESPACE_FRIENDLY_NAME_LEN);
+		p_details->block_size = ns.block_size;
+		p_details->block_count = ns.block_count;
+		p_details->type = ns.type;
+		p_details->health = ns.health;
+		p_details->enabled = ns.enabled;
+		p_details->btt = ns.btt;
+		if (ns.type == NAMESPACE_TYPE_STORAGE)
+		{
+			p_details->namespace_creation_id.device_handle.handle = ns.device_handle;
+		}
+		else
+		{
+			p_details->namespace_creation_id.interleave_setid = ns.interleave_set_index;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Get the capacity still available where a namespace would be created
+ */
+static int get_sim_available_capacity(PersistentStore *p_store,
+		const enum namespace_type type, const NVM_UINT32 creation_id,
+		NVM_UINT64 *p_available)
+{
+	int rc = NVM_SUCCESS;
+	if (type == NAMESPACE_TYPE_APP_DIRECT)
+	{
+		struct nvm_interleave_set set;
+		if ((rc = get_sim_interleave_set(p_store, creation_id, &set)) == NVM_SUCCESS)
+		{
+			*p_available = set.available_size;
+		}
+	}
+	else if (type == NAMESPACE_TYPE_STORAGE)
+	{
+		struct nvm_storage_capacities capacity;
+		if ((rc = get_sim_storage_capacity(p_store, creation_id, &capacity)) == NVM_SUCCESS)
+		{
+			*p_available = capacity.free_storage_capacity;
+		}
+	}
+	else
+	{
+		COMMON_LOG_ERROR("Cannot create unknown namespace type");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	return rc;
+}
+
+/*
+ * Create a new namespace
+ */
+int create_namespace(
+		NVM_GUID *p_namespace_guid,
+		const struct nvm_namespace_create_settings *p_settings)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	if (p_settings == NULL)
+	{
+		COMMON_LOG_ERROR("namespace create settings structure cannot be NULL.");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if (p_namespace_guid == NULL)
+	{
+		COMMON_LOG_ERROR("namespace GUID pointer cannot be NULL.");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else
+	{
+		struct db_namespace ns;
+		memset(&ns, 0, sizeof (ns));
+		ns.type = p_settings->type;
+		if (ns.type == NAMESPACE_TYPE_STORAGE)
+		{
+			ns.device_handle = p_settings->namespace_creation_id.device_handle.handle;
+			ns.block_size = p_settings->block_size;
+		}
+		else
+		{
+			ns.interleave_set_index = p_settings->namespace_creation_id.interleave_setid;
+			ns.block_size = 1;
+		}
+		ns.block_count = calculateBlockCount(
+				adjust_namespace_size(p_settings->block_size, p_settings->block_count),
+				ns.block_size);
+
+		NVM_UINT64 available = 0;
+		if ((rc = get_sim_available_capacity(p_store, p_settings->type,
+				get_sim_namespace_creation_id(&ns), &available)) != NVM_SUCCESS)
+		{
+			// already logged
+		}
+		else if (adjust_namespace_size(ns.block_size, ns.block_count) > available)
+		{
+			COMMON_LOG_ERROR("Not enough capacity to create the simulated namespace");
+			rc = NVM_ERR_BADSIZE;
+		}
+		else
+		{
+			NVM_GUID namespace_guid;
+			generate_guid(namespace_guid);
+			guid_to_str(namespace_guid, ns.namespace_guid);
+			s_strncpy(ns.friendly_name, NAMESPACE_FRIENDLY_NAME_LEN,
+					p_settings->friendly_name, NVM_NAMESPACE_NAME_LEN);
+			ns.btt = p_settings->btt;
+			ns.enabled = p_settings->enabled;
+			ns.health = NAMESPACE_HEALTH_NORMAL;
+
+			if (db_add_namespace(p_store, &ns) != DB_SUCCESS)
+			{
+				COMMON_LOG_ERROR("Failed to add the simulated namespace");
+				rc = NVM_ERR_DRIVERFAILED;
+			}
+			else
+			{
+				memmove(p_namespace_guid, namespace_guid, NVM_GUID_LEN);
+			}
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Delete an existing namespace
+ */
+int delete_namespace(const NVM_GUID namespace_guid)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	struct db_namespace ns;
+	if (namespace_guid == NULL)
+	{
+		COMMON_LOG_ERROR("namespace guid cannot be NULL.");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if ((rc = get_sim_namespace(p_store, namespace_guid, &ns)) == NVM_SUCCESS &&
+			db_delete_namespace_by_namespace_guid(p_store, ns.namespace_guid) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("Failed to delete simulated namespace %s", ns.namespace_guid);
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Modify an existing namespace name
+ */
+int modify_namespace_name(
+		const NVM_GUID namespace_guid,
+		const NVM_NAMESPACE_NAME name)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	struct db_namespace ns;
+	if (namespace_guid == NULL)
+	{
+		COMMON_LOG_ERROR("namespace guid cannot be NULL.");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if ((rc = get_sim_namespace(p_store, namespace_guid, &ns)) == NVM_SUCCESS)
+	{
+		s_strncpy(ns.friendly_name, NAMESPACE_FRIENDLY_NAME_LEN,
+				name, NVM_NAMESPACE_NAME_LEN);
+		rc = update_sim_namespace(p_store, &ns);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Modify an existing namespace size
+ */
+int modify_namespace_block_count(
+		const NVM_GUID namespace_guid,
+		const NVM_UINT64 block_count)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	struct db_namespace ns;
+	if (namespace_guid == NULL)
+	{
+		COMMON_LOG_ERROR("namespace guid cannot be NULL.");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if ((rc = get_sim_namespace(p_store, namespace_guid, &ns)) == NVM_SUCCESS)
+	{
+		NVM_UINT64 old_size = adjust_namespace_size(ns.block_size, ns.block_count);
+		NVM_UINT64 new_size = adjust_namespace_size(ns.block_size, block_count);
+		NVM_UINT64 available = 0;
+
+		// only growing needs more capacity
+		if (new_size > old_size &&
+				(rc = get_sim_available_capacity(p_store, ns.type,
+						get_sim_namespace_creation_id(&ns), &available)) == NVM_SUCCESS &&
+				(new_size - old_size) > available)
+		{
+			COMMON_LOG_ERROR("Not enough capacity to grow the simulated namespace");
+			rc = NVM_ERR_BADSIZE;
+		}
+
+		if (rc == NVM_SUCCESS)
+		{
+			ns.block_count = block_count;
+			rc = update_sim_namespace(p_store, &ns);
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Modify an existing namespace enable
+ */
+int modify_namespace_enabled(
+		const NVM_GUID namespace_guid,
+		const enum namespace_enable_state enabled)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	struct db_namespace ns;
+	if (namespace_guid == NULL)
+	{
+		COMMON_LOG_ERROR("namespace guid cannot be NULL.");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if ((rc = get_sim_namespace(p_store, namespace_guid, &ns)) == NVM_SUCCESS)
+	{
+		ns.enabled = enabled;
+		rc = update_sim_namespace(p_store, &ns);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
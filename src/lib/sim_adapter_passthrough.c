@@ -0,0 +1,1183 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file contains the implementation of the simulated device adapter interface for
+ * firmware passthrough commands.  Each command is answered from, and persists changes to,
+ * the simulator file.  The simulator file may also add a per command latency and inject
+ * mailbox failures to exercise the library's error handling, or name a firmware trace
+ * whose recorded responses are replayed in place of the simulated ones.
+ */
+
+#include "device_adapter.h"
+#include "sim_adapter.h"
+#include "fw_trace.h"
+#include "mailbox_stats.h"
+#include "platform_config_data.h"
+#include "platform_config_data_db.h"
+#include "utility.h"
+#include <fw_header.h>
+#include <persistence/logging.h>
+#include <os/os_adapter.h>
+#include <string/s_str.h>
+#include <string/revision.h>
+#include <pthread.h>
+#include <time.h>
+
+#define	SIM_MAX_FW_RULES	64
+#define	SIM_ANY_SUB_OPCODE	-1
+
+/*
+ * A latency or fault rule for a firmware command
+ */
+struct sim_fw_rule
+{
+	int opcode;
+	int sub_opcode; // SIM_ANY_SUB_OPCODE to match every sub-opcode
+	NVM_UINT32 value; // milliseconds for a latency rule, mailbox status for a fault rule
+	NVM_UINT32 every; // a fault rule fires on every nth matching command
+	NVM_UINT32 calls; // matching commands seen so far
+};
+
+static struct sim_fw_rule g_sim_latency_rules[SIM_MAX_FW_RULES];
+static int g_sim_latency_rule_count = 0;
+static struct sim_fw_rule g_sim_fault_rules[SIM_MAX_FW_RULES];
+static int g_sim_fault_rule_count = 0;
+static struct fw_trace *g_p_sim_fw_replay = NULL;
+static NVM_BOOL g_sim_fw_replay_timing = 0;
+
+// serializes the read-modify-write of the simulated DIMM state
+static pthread_mutex_t g_sim_fw_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Parse a comma separated list of <opcode>[.<sub_opcode>]=<value>[/<every n>] rules
+ */
+static int parse_sim_fw_rules(const char *rules, struct sim_fw_rule *p_rules)
+{
+	int count = 0;
+	size_t rules_len = s_strnlen(rules, CONFIG_VALUE_LEN);
+	const char *p_cur = rules;
+	while (p_cur != NULL && count >= 0 && (size_t)(p_cur - rules) < rules_len)
+	{
+		struct sim_fw_rule rule;
+		memset(&rule, 0, sizeof (rule));
+		rule.sub_opcode = SIM_ANY_SUB_OPCODE;
+		rule.every = 1;
+
+		unsigned int num = 0;
+		const char *p_end = NULL;
+		if (s_strtoui(p_cur, rules_len - (p_cur - rules), &p_end, &num) == 0)
+		{
+			// nothing but separators left
+			break;
+		}
+		rule.opcode = num;
+
+		if (p_end != NULL && *p_end == '.' &&
+				s_strtoui(p_end, rules_len - (p_end - rules), &p_end, &num) > 0)
+		{
+			rule.sub_opcode = num;
+		}
+
+		if (p_end == NULL || *p_end != '=' ||
+				s_strtoui(p_end, rules_len - (p_end - rules), &p_end, &num) == 0)
+		{
+			COMMON_LOG_ERROR_F("Invalid simulator firmware rule list '%s'", rules);
+			count = NVM_ERR_BADFILE;
+			break;
+		}
+		rule.value = num;
+
+		if (p_end != NULL && *p_end == '/' &&
+				s_strtoui(p_end, rules_len - (p_end - rules), &p_end, &num) > 0 && num > 0)
+		{
+			rule.every = num;
+		}
+
+		if (count >= SIM_MAX_FW_RULES)
+		{
+			COMMON_LOG_ERROR_F("Too many simulator firmware rules, max is %d",
+					SIM_MAX_FW_RULES);
+			count = NVM_ERR_BADFILE;
+			break;
+		}
+		p_rules[count++] = rule;
+		p_cur = p_end;
+	}
+
+	return count;
+}
+
+/*
+ * Parse the firmware command latency and fault rules and load the firmware trace
+ * from the simulator file
+ */
+int load_sim_fw_behavior(PersistentStore *p_store)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	struct sim_fw_rule latency_rules[SIM_MAX_FW_RULES];
+	struct sim_fw_rule fault_rules[SIM_MAX_FW_RULES];
+	int latency_count = 0;
+	int fault_count = 0;
+	struct fw_trace *p_replay = NULL;
+	NVM_BOOL replay_timing = 0;
+
+	struct db_config config;
+	if (db_get_config_by_key(p_store, SIM_KEY_FW_LATENCY, &config) == DB_SUCCESS &&
+			(latency_count = parse_sim_fw_rules(config.value, latency_rules)) < 0)
+	{
+		rc = latency_count;
+	}
+	else if (db_get_config_by_key(p_store, SIM_KEY_FW_FAULTS, &config) == DB_SUCCESS &&
+			(fault_count = parse_sim_fw_rules(config.value, fault_rules)) < 0)
+	{
+		rc = fault_count;
+	}
+	else if (db_get_config_by_key(p_store, SIM_KEY_FW_REPLAY, &config) == DB_SUCCESS &&
+			s_strnlen(config.value, CONFIG_VALUE_LEN) > 0 &&
+			(rc = fw_trace_load(config.value, &p_replay)) != NVM_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("Failed to load the simulator firmware trace %s", config.value);
+	}
+	else
+	{
+		if (db_get_config_by_key(p_store, SIM_KEY_FW_REPLAY_TIMING, &config) == DB_SUCCESS)
+		{
+			replay_timing = (config.value[0] == '1');
+		}
+
+		pthread_mutex_lock(&g_sim_fw_lock);
+		memmove(g_sim_latency_rules, latency_rules, sizeof (g_sim_latency_rules));
+		g_sim_latency_rule_count = latency_count;
+		memmove(g_sim_fault_rules, fault_rules, sizeof (g_sim_fault_rules));
+		g_sim_fault_rule_count = fault_count;
+		fw_trace_free(g_p_sim_fw_replay);
+		g_p_sim_fw_replay = p_replay;
+		g_sim_fw_replay_timing = replay_timing;
+		pthread_mutex_unlock(&g_sim_fw_lock);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Release the firmware command behavior loaded from the simulator file
+ */
+void unload_sim_fw_behavior()
+{
+	pthread_mutex_lock(&g_sim_fw_lock);
+	g_sim_latency_rule_count = 0;
+	g_sim_fault_rule_count = 0;
+	fw_trace_free(g_p_sim_fw_replay);
+	g_p_sim_fw_replay = NULL;
+	g_sim_fw_replay_timing = 0;
+	pthread_mutex_unlock(&g_sim_fw_lock);
+}
+
+/*
+ * Find the first rule that applies to a firmware command
+ */
+static struct sim_fw_rule *find_sim_fw_rule(struct sim_fw_rule *p_rules, const int rule_count,
+		const struct fw_cmd *p_cmd)
+{
+	struct sim_fw_rule *p_rule = NULL;
+	for (int i = 0; i < rule_count && !p_rule; i++)
+	{
+		if (p_rules[i].opcode == p_cmd->opcode &&
+				(p_rules[i].sub_opcode == SIM_ANY_SUB_OPCODE ||
+				p_rules[i].sub_opcode == p_cmd->sub_opcode))
+		{
+			p_rule = &p_rules[i];
+		}
+	}
+	return p_rule;
+}
+
+/*
+ * Convert a simulated mailbox status to the error the driver would have reported
+ */
+static int sim_mb_status_to_nvm_lib_err(const unsigned char status)
+{
+	return dsm_err_to_nvm_lib_err(
+			DSM_VENDOR_ERR_NON_SPECIFIC | (status << DSM_MAILBOX_ERROR_SHIFT));
+}
+
+/*
+ * Copy a small payload to the command output, truncated to what the caller asked for
+ */
+static void sim_set_output(struct fw_cmd *p_cmd, const void *p_payload, const size_t size)
+{
+	if (p_cmd->output_payload)
+	{
+		memset(p_cmd->output_payload, 0, p_cmd->output_payload_size);
+		memmove(p_cmd->output_payload, p_payload,
+				(size < p_cmd->output_payload_size) ? size : p_cmd->output_payload_size);
+	}
+}
+
+/*
+ * Copy the command input into a small payload, the input must be large enough to fill it
+ */
+static unsigned char sim_get_input(const struct fw_cmd *p_cmd, void *p_payload,
+		const size_t size)
+{
+	unsigned char status = MB_SUCCESS;
+	memset(p_payload, 0, size);
+	if (!p_cmd->input_payload || p_cmd->input_payload_size < size)
+	{
+		COMMON_LOG_ERROR_F("Simulated command 0x%x.0x%x input payload is too small",
+				p_cmd->opcode, p_cmd->sub_opcode);
+		status = MB_INVALID_CMD_PARAM;
+	}
+	else
+	{
+		memmove(p_payload, p_cmd->input_payload, size);
+	}
+	return status;
+}
+
+static unsigned char sim_identify_dimm(PersistentStore *p_store, struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+	struct db_identify_dimm db_identify;
+	if (db_get_identify_dimm_by_device_handle(p_store, p_cmd->device_handle, &db_identify)
+			!= DB_SUCCESS)
+	{
+		status = MB_UNSUPPORTED_CMD;
+	}
+	else
+	{
+		struct pt_payload_identify_dimm identify;
+		memset(&identify, 0, sizeof (identify));
+		identify.vendor_id = db_identify.vendor_id;
+		identify.device_id = db_identify.device_id;
+		identify.revision_id = db_identify.revision_id;
+		identify.ifc = db_identify.interface_format_code;
+		convert_fw_version_str_to_array(db_identify.fw_revision,
+				IDENTIFY_DIMM_FW_REVISION_LEN, identify.fwr);
+		identify.api_ver = db_identify.fw_api_version;
+		identify.fswr = db_identify.fw_sw_mask;
+		identify.nbw = db_identify.block_windows;
+		identify.nwfa = db_identify.write_flush_addresses;
+		identify.wfas = db_identify.write_flush_address_start;
+		identify.obmcr = db_identify.block_control_region_offset;
+		identify.rc = db_identify.raw_cap / MULTIPLES_TO_BYTES(1);
+		identify.mf[0] = db_identify.manufacturer & 0xFF;
+		identify.mf[1] = (db_identify.manufacturer >> 8) & 0xFF;
+		identify.sn[0] = db_identify.serial_num & 0xFF;
+		identify.sn[1] = (db_identify.serial_num >> 8) & 0xFF;
+		identify.sn[2] = (db_identify.serial_num >> 16) & 0xFF;
+		identify.sn[3] = (db_identify.serial_num >> 24) & 0xFF;
+		s_strncpy(identify.mn, DEV_MODELNUM_LEN,
+				db_identify.model_num, IDENTIFY_DIMM_MODEL_NUM_LEN);
+		identify.dimm_sku = db_identify.dimm_sku;
+		sim_set_output(p_cmd, &identify, sizeof (identify));
+	}
+	return status;
+}
+
+static unsigned char sim_get_security_info(PersistentStore *p_store, struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+	if (p_cmd->sub_opcode == SUBOP_GET_SEC_STATE)
+	{
+		struct pt_payload_get_security_state security;
+		memset(&security, 0, sizeof (security));
+
+		struct db_dimm_security_info db_security;
+		if (db_get_dimm_security_info_by_device_handle(p_store,
+				p_cmd->device_handle, &db_security) != DB_SUCCESS)
+		{
+			security.security_status = SEC_NOT_SUPPORTED;
+		}
+		else
+		{
+			security.security_status = db_security.security_state;
+		}
+		sim_set_output(p_cmd, &security, sizeof (security));
+	}
+	else if (p_cmd->sub_opcode == SUBOP_GET_SAN_STATE)
+	{
+		struct pt_payload_sanitize_dimm_status sanitize;
+		memset(&sanitize, 0, sizeof (sanitize));
+
+		struct db_dimm_sanitize_info db_sanitize;
+		if (db_get_dimm_sanitize_info_by_device_handle(p_store,
+				p_cmd->device_handle, &db_sanitize) == DB_SUCCESS)
+		{
+			sanitize.state = db_sanitize.sanitize_state;
+			sanitize.progress = db_sanitize.sanitize_progress;
+		}
+		sim_set_output(p_cmd, &sanitize, sizeof (sanitize));
+	}
+	else
+	{
+		status = MB_UNSUPPORTED_CMD;
+	}
+	return status;
+}
+
+/*
+ * Check a passphrase against the one stored for the simulated dimm
+ */
+static unsigned char sim_check_passphrase(PersistentStore *p_store,
+		const NVM_UINT32 device_handle, const char *passphrase)
+{
+	unsigned char status = MB_SUCCESS;
+
+	char key[CONFIG_KEY_LEN];
+	s_snprintf(key, CONFIG_KEY_LEN, SIM_KEY_PASSPHRASE, device_handle);
+	struct db_config config;
+	memset(&config, 0, sizeof (config));
+	db_get_config_by_key(p_store, key, &config);
+
+	if (s_strncmp(config.value, passphrase, DEV_PASSPHRASE_LEN) != 0)
+	{
+		status = MB_INVALID_CREDENTIAL;
+	}
+	return status;
+}
+
+/*
+ * Store the passphrase of a simulated dimm, an empty passphrase removes it
+ */
+static unsigned char sim_set_passphrase(PersistentStore *p_store,
+		const NVM_UINT32 device_handle, const char *passphrase)
+{
+	unsigned char status = MB_SUCCESS;
+
+	struct db_config config;
+	memset(&config, 0, sizeof (config));
+	s_snprintf(config.key, CONFIG_KEY_LEN, SIM_KEY_PASSPHRASE, device_handle);
+	s_strncpy(config.value, CONFIG_VALUE_LEN, passphrase, DEV_PASSPHRASE_LEN);
+
+	db_delete_config_by_key(p_store, config.key);
+	if (s_strnlen(config.value, CONFIG_VALUE_LEN) > 0 &&
+			db_add_config(p_store, &config) != DB_SUCCESS)
+	{
+		status = MB_INTERNAL_DEV_ERR;
+	}
+	return status;
+}
+
+/*
+ * Sanitize completes immediately on a simulated dimm
+ */
+static unsigned char sim_sanitize(PersistentStore *p_store, const NVM_UINT32 device_handle)
+{
+	unsigned char status = MB_SUCCESS;
+
+	struct db_dimm_sanitize_info db_sanitize;
+	memset(&db_sanitize, 0, sizeof (db_sanitize));
+	db_sanitize.device_handle = device_handle;
+	db_sanitize.sanitize_state = SAN_COMPLETED;
+	db_sanitize.sanitize_progress = 100;
+	if (db_upsert_dimm_sanitize_info(p_store, &db_sanitize) != DB_SUCCESS)
+	{
+		status = MB_INTERNAL_DEV_ERR;
+	}
+	return status;
+}
+
+static unsigned char sim_set_security_info(PersistentStore *p_store, struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+
+	struct db_dimm_security_info db_security;
+	struct pt_payload_set_passphrase input;
+	memset(&input, 0, sizeof (input));
+	if (db_get_dimm_security_info_by_device_handle(p_store,
+			p_cmd->device_handle, &db_security) != DB_SUCCESS ||
+			(db_security.security_state & SEC_NOT_SUPPORTED))
+	{
+		status = MB_UNSUPPORTED_CMD;
+	}
+	// every command but freeze lock is rejected until reset
+	else if ((db_security.security_state & SEC_FROZEN) &&
+			p_cmd->sub_opcode != SUBOP_SEC_FREEZE_LOCK)
+	{
+		status = MB_INVALID_SECURITY_STATE;
+	}
+	else
+	{
+		int state = db_security.security_state;
+		switch (p_cmd->sub_opcode)
+		{
+			case SUBOP_SET_PASS:
+				if ((status = sim_get_input(p_cmd, &input, sizeof (input))) != MB_SUCCESS)
+				{
+					// bad input
+				}
+				else if (state & SEC_LOCKED)
+				{
+					status = MB_INVALID_SECURITY_STATE;
+				}
+				else if ((state & SEC_ENABLED) &&
+						(status = sim_check_passphrase(p_store, p_cmd->device_handle,
+								input.passphrase_current)) != MB_SUCCESS)
+				{
+					// wrong passphrase
+				}
+				else if ((status = sim_set_passphrase(p_store, p_cmd->device_handle,
+						input.passphrase_new)) == MB_SUCCESS)
+				{
+					state |= SEC_ENABLED;
+				}
+				break;
+
+			case SUBOP_DISABLE_PASS:
+			case SUBOP_UNLOCK_UNIT:
+			case SUBOP_SEC_ERASE_UNIT:
+				// all start with the current passphrase
+				if ((status = sim_get_input(p_cmd, &input, DEV_PASSPHRASE_LEN)) != MB_SUCCESS)
+				{
+					// bad input
+				}
+				else if (!(state & SEC_ENABLED) && p_cmd->sub_opcode != SUBOP_SEC_ERASE_UNIT)
+				{
+					status = MB_INVALID_SECURITY_STATE;
+				}
+				else if ((state & SEC_ENABLED) &&
+						(status = sim_check_passphrase(p_store, p_cmd->device_handle,
+								input.passphrase_current)) != MB_SUCCESS)
+				{
+					// wrong passphrase
+				}
+				else if (p_cmd->sub_opcode == SUBOP_DISABLE_PASS)
+				{
+					if (state & SEC_LOCKED)
+					{
+						status = MB_INVALID_SECURITY_STATE;
+					}
+					else if ((status = sim_set_passphrase(p_store, p_cmd->device_handle, ""))
+							== MB_SUCCESS)
+					{
+						state &= ~SEC_ENABLED;
+					}
+				}
+				else if (p_cmd->sub_opcode == SUBOP_UNLOCK_UNIT)
+				{
+					if (!(state & SEC_LOCKED))
+					{
+						status = MB_INVALID_SECURITY_STATE;
+					}
+					else
+					{
+						state &= ~SEC_LOCKED;
+					}
+				}
+				break;
+
+			case SUBOP_SEC_FREEZE_LOCK:
+				state |= SEC_FROZEN;
+				break;
+
+			case SUBOP_OVERWRITE_DIMM:
+			case SUBOP_CRYPTO_SCRAMBLE:
+				if (state & SEC_LOCKED)
+				{
+					status = MB_INVALID_SECURITY_STATE;
+				}
+				else
+				{
+					status = sim_sanitize(p_store, p_cmd->device_handle);
+				}
+				break;
+
+			case SUBOP_SANITIZE_FREEZE_LOCK:
+			case SUBOP_SANITIZE_ANTIFREEZE_LOCK:
+				break;
+
+			default:
+				status = MB_UNSUPPORTED_CMD;
+				break;
+		}
+
+		if (status == MB_SUCCESS && state != db_security.security_state)
+		{
+			db_security.security_state = state;
+			if (db_update_dimm_security_info_by_device_handle(p_store,
+					p_cmd->device_handle, &db_security) != DB_SUCCESS)
+			{
+				status = MB_INTERNAL_DEV_ERR;
+			}
+		}
+	}
+
+	s_memset(&input, sizeof (input));
+	return status;
+}
+
+static unsigned char sim_get_features(PersistentStore *p_store, struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+	switch (p_cmd->sub_opcode)
+	{
+		case SUBOP_ALARM_THRESHOLDS:
+		{
+			struct db_dimm_alarm_thresholds db_thresholds;
+			if (db_get_dimm_alarm_thresholds_by_device_handle(p_store,
+					p_cmd->device_handle, &db_thresholds) != DB_SUCCESS)
+			{
+				status = MB_UNSUPPORTED_CMD;
+			}
+			else
+			{
+				struct pt_payload_alarm_thresholds thresholds;
+				memset(&thresholds, 0, sizeof (thresholds));
+				thresholds.enable = db_thresholds.enable;
+				thresholds.spare = db_thresholds.spare;
+				thresholds.media_temperature = db_thresholds.media_temperature;
+				thresholds.controller_temperature = db_thresholds.controller_temperature;
+				sim_set_output(p_cmd, &thresholds, sizeof (thresholds));
+			}
+			break;
+		}
+		case SUBOP_POLICY_POW_MGMT:
+		{
+			struct db_dimm_power_management db_power;
+			if (db_get_dimm_power_management_by_device_handle(p_store,
+					p_cmd->device_handle, &db_power) != DB_SUCCESS)
+			{
+				status = MB_UNSUPPORTED_CMD;
+			}
+			else
+			{
+				struct pt_payload_power_mgmt_policy power;
+				memset(&power, 0, sizeof (power));
+				power.enabled = db_power.enable;
+				power.tdp = db_power.tdp_power_limit;
+				power.peak_power_budget = db_power.peak_power_budget;
+				power.average_power_budget = db_power.avg_power_budget;
+				sim_set_output(p_cmd, &power, sizeof (power));
+			}
+			break;
+		}
+		case SUBOP_POLICY_DIE_SPARING:
+		{
+			struct db_dimm_die_sparing db_sparing;
+			if (db_get_dimm_die_sparing_by_device_handle(p_store,
+					p_cmd->device_handle, &db_sparing) != DB_SUCCESS)
+			{
+				status = MB_UNSUPPORTED_CMD;
+			}
+			else
+			{
+				struct pt_get_die_spare_policy sparing;
+				memset(&sparing, 0, sizeof (sparing));
+				sparing.enable = db_sparing.enable;
+				sparing.aggressiveness = db_sparing.aggressiveness;
+				for (int i = 0; i < DIMM_DIE_SPARING_SUPPORTED_BY_RANK_COUNT; i++)
+				{
+					if (db_sparing.supported_by_rank[i])
+					{
+						sparing.supported |= (1 << i);
+					}
+				}
+				sim_set_output(p_cmd, &sparing, sizeof (sparing));
+			}
+			break;
+		}
+		case SUBOP_OPT_CONFIG_DATA_POLICY:
+		{
+			struct db_dimm_optional_config_data db_config_data;
+			if (db_get_dimm_optional_config_data_by_device_handle(p_store,
+					p_cmd->device_handle, &db_config_data) != DB_SUCCESS)
+			{
+				status = MB_UNSUPPORTED_CMD;
+			}
+			else
+			{
+				struct pt_payload_config_data_policy config_data;
+				memset(&config_data, 0, sizeof (config_data));
+				config_data.first_fast_refresh = db_config_data.first_fast_refresh_enable;
+				sim_set_output(p_cmd, &config_data, sizeof (config_data));
+			}
+			break;
+		}
+		default:
+			status = MB_UNSUPPORTED_CMD;
+			break;
+	}
+	return status;
+}
+
+static unsigned char sim_set_features(PersistentStore *p_store, struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+	enum db_return_codes db_rc = DB_SUCCESS;
+	switch (p_cmd->sub_opcode)
+	{
+		case SUBOP_ALARM_THRESHOLDS:
+		{
+			struct pt_payload_alarm_thresholds thresholds;
+			if ((status = sim_get_input(p_cmd, &thresholds, sizeof (thresholds)))
+					== MB_SUCCESS)
+			{
+				struct db_dimm_alarm_thresholds db_thresholds;
+				memset(&db_thresholds, 0, sizeof (db_thresholds));
+				db_thresholds.device_handle = p_cmd->device_handle;
+				db_thresholds.enable = thresholds.enable;
+				db_thresholds.spare = thresholds.spare;
+				db_thresholds.media_temperature = thresholds.media_temperature;
+				db_thresholds.controller_temperature = thresholds.controller_temperature;
+				db_rc = db_upsert_dimm_alarm_thresholds(p_store, &db_thresholds);
+			}
+			break;
+		}
+		case SUBOP_POLICY_POW_MGMT:
+		{
+			struct pt_payload_power_mgmt_policy power;
+			if ((status = sim_get_input(p_cmd, &power, sizeof (power))) == MB_SUCCESS)
+			{
+				struct db_dimm_power_management db_power;
+				memset(&db_power, 0, sizeof (db_power));
+				db_power.device_handle = p_cmd->device_handle;
+				db_power.enable = power.enabled;
+				db_power.tdp_power_limit = power.tdp;
+				db_power.peak_power_budget = power.peak_power_budget;
+				db_power.avg_power_budget = power.average_power_budget;
+				db_rc = db_upsert_dimm_power_management(p_store, &db_power);
+			}
+			break;
+		}
+		case SUBOP_POLICY_DIE_SPARING:
+		{
+			struct pt_set_die_spare_policy sparing;
+			struct db_dimm_die_sparing db_sparing;
+			if ((status = sim_get_input(p_cmd, &sparing, sizeof (sparing))) != MB_SUCCESS)
+			{
+				// bad input
+			}
+			else if (db_get_dimm_die_sparing_by_device_handle(p_store,
+					p_cmd->device_handle, &db_sparing) != DB_SUCCESS)
+			{
+				status = MB_UNSUPPORTED_CMD;
+			}
+			else
+			{
+				// the supported ranks are a property of the dimm
+				db_sparing.enable = sparing.enable;
+				db_sparing.aggressiveness = sparing.aggressiveness;
+				db_rc = db_update_dimm_die_sparing_by_device_handle(p_store,
+						p_cmd->device_handle, &db_sparing);
+			}
+			break;
+		}
+		case SUBOP_OPT_CONFIG_DATA_POLICY:
+		{
+			struct pt_payload_config_data_policy config_data;
+			if ((status = sim_get_input(p_cmd, &config_data, sizeof (config_data)))
+					== MB_SUCCESS)
+			{
+				struct db_dimm_optional_config_data db_config_data;
+				memset(&db_config_data, 0, sizeof (db_config_data));
+				db_config_data.device_handle = p_cmd->device_handle;
+				db_config_data.first_fast_refresh_enable = config_data.first_fast_refresh;
+				db_rc = db_upsert_dimm_optional_config_data(p_store, &db_config_data);
+			}
+			break;
+		}
+		default:
+			status = MB_UNSUPPORTED_CMD;
+			break;
+	}
+
+	if (db_rc != DB_SUCCESS)
+	{
+		status = MB_INTERNAL_DEV_ERR;
+	}
+	return status;
+}
+
+/*
+ * Read the platform config data of a simulated dimm
+ */
+static unsigned char sim_get_platform_config_data(PersistentStore *p_store,
+		struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+
+	struct pt_payload_get_platform_cfg_data input;
+	if ((status = sim_get_input(p_cmd, &input, sizeof (input))) == MB_SUCCESS)
+	{
+		// the whole partition reads back as zeros past the end of the config data
+		NVM_UINT8 *p_partition = calloc(1, DEV_PLT_CFG_PART_SIZE);
+		if (!p_partition)
+		{
+			status = MB_INTERNAL_DEV_ERR;
+		}
+		else
+		{
+			int size = get_dimm_platform_config_size_from_db(p_store, p_cmd->device_handle);
+			if (size > DEV_PLT_CFG_PART_SIZE)
+			{
+				status = MB_INTERNAL_DEV_ERR;
+			}
+			else if (size > 0 && get_dimm_platform_config_data_from_db(p_store,
+					p_cmd->device_handle, (struct platform_config_data *)p_partition,
+					size) != NVM_SUCCESS)
+			{
+				status = MB_INTERNAL_DEV_ERR;
+			}
+			else if (input.options == DEV_PLT_CFG_OPT_LARGE_DATA)
+			{
+				if (!p_cmd->large_output_payload)
+				{
+					status = MB_INVALID_CMD_PARAM;
+				}
+				else
+				{
+					memmove(p_cmd->large_output_payload, p_partition,
+							(p_cmd->large_output_payload_size < DEV_PLT_CFG_PART_SIZE) ?
+							p_cmd->large_output_payload_size : DEV_PLT_CFG_PART_SIZE);
+				}
+			}
+			else if (input.options == DEV_PLT_CFG_OPT_SMALL_DATA)
+			{
+				if (input.offset > (DEV_PLT_CFG_PART_SIZE - DEV_SMALL_PAYLOAD_SIZE))
+				{
+					status = MB_INVALID_CMD_PARAM;
+				}
+				else
+				{
+					sim_set_output(p_cmd, p_partition + input.offset, DEV_SMALL_PAYLOAD_SIZE);
+				}
+			}
+			else
+			{
+				status = MB_UNSUPPORTED_CMD;
+			}
+			free(p_partition);
+		}
+	}
+	return status;
+}
+
+/*
+ * Replace the platform config data of a simulated dimm
+ */
+static unsigned char sim_set_platform_config_data(PersistentStore *p_store,
+		struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+
+	// only the partition and payload type are needed for a large payload write
+	struct pt_payload_set_platform_cfg_data input;
+	memset(&input, 0, sizeof (input));
+	if ((status = sim_get_input(p_cmd, &input, 2)) != MB_SUCCESS)
+	{
+		// bad input
+	}
+	// small payload writes leave the config data half written between calls
+	else if (input.payload_type != DEV_PLT_CFG_LARGE_PAY)
+	{
+		status = MB_UNSUPPORTED_CMD;
+	}
+	else if (!p_cmd->large_input_payload ||
+			p_cmd->large_input_payload_size < sizeof (struct platform_config_data))
+	{
+		status = MB_INVALID_CMD_PARAM;
+	}
+	else if (update_dimm_platform_config_in_db(p_store, p_cmd->device_handle,
+			(struct platform_config_data *)p_cmd->large_input_payload) != NVM_SUCCESS)
+	{
+		status = MB_INVALID_CMD_PARAM;
+	}
+	return status;
+}
+
+static unsigned char sim_get_admin_features(PersistentStore *p_store, struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+	switch (p_cmd->sub_opcode)
+	{
+		case SUBOP_SYSTEM_TIME:
+		{
+			struct pt_payload_system_time system_time;
+			memset(&system_time, 0, sizeof (system_time));
+			system_time.time = time(NULL);
+			sim_set_output(p_cmd, &system_time, sizeof (system_time));
+			break;
+		}
+		case SUBOP_PLATFORM_DATA_INFO:
+			status = sim_get_platform_config_data(p_store, p_cmd);
+			break;
+		case SUBOP_DIMM_PARTITION_INFO:
+		{
+			struct db_dimm_partition db_partition;
+			if (db_get_dimm_partition_by_device_handle(p_store,
+					p_cmd->device_handle, &db_partition) != DB_SUCCESS)
+			{
+				status = MB_UNSUPPORTED_CMD;
+			}
+			else
+			{
+				struct pt_payload_get_dimm_partition_info partition;
+				memset(&partition, 0, sizeof (partition));
+				partition.volatile_capacity = db_partition.volatile_capacity;
+				partition.start_volatile = db_partition.volatile_start;
+				partition.pmem_capacity = db_partition.pmem_capacity;
+				partition.start_pmem = db_partition.pm_start;
+				partition.raw_capacity = db_partition.raw_capacity;
+				sim_set_output(p_cmd, &partition, sizeof (partition));
+			}
+			break;
+		}
+		default:
+			status = MB_UNSUPPORTED_CMD;
+			break;
+	}
+	return status;
+}
+
+static unsigned char sim_set_admin_features(PersistentStore *p_store, struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+	switch (p_cmd->sub_opcode)
+	{
+		case SUBOP_SYSTEM_TIME:
+			// the simulated dimms always use the host clock
+			break;
+		case SUBOP_PLATFORM_DATA_INFO:
+			status = sim_set_platform_config_data(p_store, p_cmd);
+			break;
+		default:
+			status = MB_UNSUPPORTED_CMD;
+			break;
+	}
+	return status;
+}
+
+static unsigned char sim_get_log(PersistentStore *p_store, struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+	switch (p_cmd->sub_opcode)
+	{
+		case SUBOP_SMART_HEALTH:
+		{
+			struct db_dimm_smart db_smart;
+			if (db_get_dimm_smart_by_device_handle(p_store,
+					p_cmd->device_handle, &db_smart) != DB_SUCCESS)
+			{
+				status = MB_UNSUPPORTED_CMD;
+			}
+			else
+			{
+				struct pt_payload_smart_health smart;
+				memset(&smart, 0, sizeof (smart));
+				smart.validation_flags.flags = db_smart.validation_flags;
+				smart.health_status = db_smart.health_status;
+				smart.spare = db_smart.spare;
+				smart.percentage_used = db_smart.percentage_used;
+				smart.alarm_trips = db_smart.alarm_trips;
+				smart.media_temperature = db_smart.media_temperature;
+				smart.controller_temperature = db_smart.controller_temperature;
+				smart.lss = db_smart.lss;
+				smart.vendor_specific_data_size = db_smart.vendor_specific_data_size;
+				smart.vendor_data.power_cycles = db_smart.power_cycles;
+				smart.vendor_data.power_on_seconds = db_smart.power_on_seconds;
+				smart.vendor_data.uptime = db_smart.uptime;
+				smart.vendor_data.unsafe_shutdowns = db_smart.unsafe_shutdowns;
+				smart.vendor_data.lss_details = db_smart.lss_details;
+				smart.vendor_data.last_shutdown_time = db_smart.last_shutdown_time;
+				sim_set_output(p_cmd, &smart, sizeof (smart));
+			}
+			break;
+		}
+		case SUBOP_FW_IMAGE_INFO:
+		{
+			struct db_dimm_fw_image db_image;
+			if (db_get_dimm_fw_image_by_device_handle(p_store,
+					p_cmd->device_handle, &db_image) != DB_SUCCESS)
+			{
+				status = MB_UNSUPPORTED_CMD;
+			}
+			else
+			{
+				struct pt_payload_fw_image_info image;
+				memset(&image, 0, sizeof (image));
+				convert_fw_version_str_to_array(db_image.fw_rev,
+						DIMM_FW_IMAGE_FW_REV_LEN, image.fw_rev);
+				image.fw_type = db_image.fw_type;
+				image.staged_fw_status = db_image.staged_fw_status;
+				convert_fw_version_str_to_array(db_image.staged_fw_rev,
+						DIMM_FW_IMAGE_STAGED_FW_REV_LEN, image.staged_fw_rev);
+				image.staged_fw_type = db_image.staged_fw_type;
+				memmove(image.commit_id, db_image.commit_id, DEV_FW_COMMIT_ID_LEN);
+				sim_set_output(p_cmd, &image, sizeof (image));
+			}
+			break;
+		}
+		default:
+			status = MB_UNSUPPORTED_CMD;
+			break;
+	}
+	return status;
+}
+
+/*
+ * Stage a firmware image on a simulated dimm, or activate the staged one
+ */
+static unsigned char sim_update_fw(PersistentStore *p_store, struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+
+	struct db_dimm_fw_image db_image;
+	if (db_get_dimm_fw_image_by_device_handle(p_store,
+			p_cmd->device_handle, &db_image) != DB_SUCCESS)
+	{
+		status = MB_UNSUPPORTED_CMD;
+	}
+	else if (p_cmd->sub_opcode == SUBOP_UPDATE_FW)
+	{
+		fwImageHeader *p_header = (fwImageHeader *)p_cmd->large_input_payload;
+		if (!p_header || p_cmd->large_input_payload_size < sizeof (fwImageHeader))
+		{
+			status = MB_INVALID_CMD_PARAM;
+		}
+		else if (p_header->moduleType != FW_HEADER_MODULETYPE ||
+				p_header->moduleVendor != FW_HEADER_MODULEVENDOR)
+		{
+			status = MB_SECURITY_CHK_FAIL;
+		}
+		else
+		{
+			build_revision(db_image.staged_fw_rev, DIMM_FW_IMAGE_STAGED_FW_REV_LEN,
+					p_header->imageVersion.majorVer.version,
+					p_header->imageVersion.minorVer.version,
+					p_header->imageVersion.hotfixVer.version,
+					p_header->imageVersion.buildVer.build);
+			db_image.staged_fw_type = db_image.fw_type;
+			db_image.staged_fw_status = 1;
+		}
+	}
+	else if (p_cmd->sub_opcode == SUBOP_EXECUTE_FW)
+	{
+		struct db_identify_dimm db_identify;
+		if (!db_image.staged_fw_status)
+		{
+			status = MB_NO_NEW_FW;
+		}
+		else
+		{
+			s_strncpy(db_image.fw_rev, DIMM_FW_IMAGE_FW_REV_LEN,
+					db_image.staged_fw_rev, DIMM_FW_IMAGE_STAGED_FW_REV_LEN);
+			db_image.fw_type = db_image.staged_fw_type;
+			db_image.staged_fw_status = 0;
+
+			// identify dimm reports the running firmware too
+			if (db_get_identify_dimm_by_device_handle(p_store,
+					p_cmd->device_handle, &db_identify) == DB_SUCCESS)
+			{
+				s_strncpy(db_identify.fw_revision, IDENTIFY_DIMM_FW_REVISION_LEN,
+						db_image.fw_rev, DIMM_FW_IMAGE_FW_REV_LEN);
+				if (db_update_identify_dimm_by_device_handle(p_store,
+						p_cmd->device_handle, &db_identify) != DB_SUCCESS)
+				{
+					status = MB_INTERNAL_DEV_ERR;
+				}
+			}
+		}
+	}
+	else
+	{
+		status = MB_UNSUPPORTED_CMD;
+	}
+
+	if (status == MB_SUCCESS && db_update_dimm_fw_image_by_device_handle(p_store,
+			p_cmd->device_handle, &db_image) != DB_SUCCESS)
+	{
+		status = MB_INTERNAL_DEV_ERR;
+	}
+	return status;
+}
+
+static unsigned char sim_bios_emulated_command(PersistentStore *p_store,
+		struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+
+	struct db_boot_status_register db_bsr;
+	if (p_cmd->sub_opcode != SUBOP_GET_BOOT_STATUS ||
+			db_get_boot_status_register_by_device_handle(p_store,
+					p_cmd->device_handle, &db_bsr) != DB_SUCCESS)
+	{
+		status = MB_UNSUPPORTED_CMD;
+	}
+	else
+	{
+		unsigned long long bsr = db_bsr.bsr;
+		sim_set_output(p_cmd, &bsr, sizeof (bsr));
+	}
+	return status;
+}
+
+/*
+ * Answer a firmware command from the simulator file
+ */
+static unsigned char sim_fw_cmd(PersistentStore *p_store, struct fw_cmd *p_cmd)
+{
+	unsigned char status = MB_SUCCESS;
+	switch (p_cmd->opcode)
+	{
+		case PT_IDENTIFY_DIMM:
+			status = sim_identify_dimm(p_store, p_cmd);
+			break;
+		case PT_GET_SEC_INFO:
+			status = sim_get_security_info(p_store, p_cmd);
+			break;
+		case PT_SET_SEC_INFO:
+			status = sim_set_security_info(p_store, p_cmd);
+			break;
+		case PT_GET_FEATURES:
+			status = sim_get_features(p_store, p_cmd);
+			break;
+		case PT_SET_FEATURES:
+			status = sim_set_features(p_store, p_cmd);
+			break;
+		case PT_GET_ADMIN_FEATURES:
+			status = sim_get_admin_features(p_store, p_cmd);
+			break;
+		case PT_SET_ADMIN_FEATURES:
+			status = sim_set_admin_features(p_store, p_cmd);
+			break;
+		case PT_GET_LOG:
+			status = sim_get_log(p_store, p_cmd);
+			break;
+		case PT_UPDATE_FW:
+			status = sim_update_fw(p_store, p_cmd);
+			break;
+		case BIOS_EMULATED_COMMAND:
+			status = sim_bios_emulated_command(p_store, p_cmd);
+			break;
+		default:
+			status = MB_UNSUPPORTED_CMD;
+			break;
+	}
+	return status;
+}
+
+/*
+ * Execute a passthrough IOCTL against a simulated dimm
+ */
+int ioctl_passthrough_cmd(struct fw_cmd *p_cmd)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+	NVM_UINT64 start_usec = get_monotonic_usec();
+
+	struct db_dimm_topology topology;
+	// check input parameters
+	if (p_cmd == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, cmd struct is null");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if ((p_cmd->input_payload_size > 0 && p_cmd->input_payload == NULL) ||
+			(p_cmd->input_payload != NULL && p_cmd->input_payload_size == 0) ||
+			(p_cmd->output_payload_size > 0 && p_cmd->output_payload == NULL) ||
+			(p_cmd->output_payload != NULL && p_cmd->output_payload_size == 0) ||
+			(p_cmd->large_input_payload_size > 0 && p_cmd->large_input_payload == NULL) ||
+			(p_cmd->large_input_payload != NULL && p_cmd->large_input_payload_size == 0) ||
+			(p_cmd->large_output_payload_size > 0 && p_cmd->large_output_payload == NULL) ||
+			(p_cmd->large_output_payload != NULL && p_cmd->large_output_payload_size == 0))
+	{
+		COMMON_LOG_ERROR("Invalid input or output payloads specified");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if ((rc = get_sim_dimm_topology(p_store, p_cmd->device_handle, &topology))
+			== NVM_SUCCESS)
+	{
+		// the rules don't change after the simulator is loaded
+		struct sim_fw_rule *p_latency = find_sim_fw_rule(g_sim_latency_rules,
+				g_sim_latency_rule_count, p_cmd);
+		if (p_latency && p_latency->value > 0)
+		{
+			nvm_sleep(p_latency->value);
+		}
+
+		pthread_mutex_lock(&g_sim_fw_lock);
+		unsigned char status = MB_SUCCESS;
+		NVM_BOOL replayed = 0;
+		NVM_UINT32 replay_latency_usec = 0;
+		struct sim_fw_rule *p_fault = find_sim_fw_rule(g_sim_fault_rules,
+				g_sim_fault_rule_count, p_cmd);
+		if (p_fault && (++p_fault->calls % p_fault->every) == 0)
+		{
+			COMMON_LOG_DEBUG_F("Injecting mailbox status %u for command 0x%x.0x%x",
+					p_fault->value, p_cmd->opcode, p_cmd->sub_opcode);
+			status = p_fault->value;
+		}
+		else if (fw_trace_replay(g_p_sim_fw_replay, p_cmd, &rc, &replay_latency_usec))
+		{
+			replayed = 1;
+			if (!g_sim_fw_replay_timing)
+			{
+				replay_latency_usec = 0;
+			}
+		}
+		else
+		{
+			status = sim_fw_cmd(p_store, p_cmd);
+		}
+		pthread_mutex_unlock(&g_sim_fw_lock);
+
+		if (replayed)
+		{
+			if (replay_latency_usec >= 1000)
+			{
+				nvm_sleep(replay_latency_usec / 1000);
+			}
+		}
+		else if (status != MB_SUCCESS)
+		{
+			rc = sim_mb_status_to_nvm_lib_err(status);
+		}
+	}
+
+	if (p_cmd)
+	{
+		mailbox_stats_record(MAILBOX_COMMAND_PASSTHROUGH, p_cmd->device_handle,
+				p_cmd->opcode, p_cmd->sub_opcode, rc,
+				(NVM_UINT64)p_cmd->input_payload_size + p_cmd->output_payload_size +
+				p_cmd->large_input_payload_size + p_cmd->large_output_payload_size,
+				get_monotonic_usec() - start_usec);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file contains the implementation of the simulated device adapter interface for
+ * interleave sets and storage capacities.
+ */
+
+#include "device_adapter.h"
+#include "sim_adapter.h"
+#include "platform_config_data.h"
+#include "pool_utilities.h"
+#include "device_fw.h"
+#include "utility.h"
+#include <persistence/logging.h>
+
+/*
+ * Get a simulated interleave set by its index from the current config
+ */
+int get_sim_interleave_set(PersistentStore *p_store, const NVM_UINT32 index_id,
+		struct nvm_interleave_set *p_set)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	memset(p_set, 0, sizeof (struct nvm_interleave_set));
+
+	int info_count = 0;
+	if (db_get_interleave_set_dimm_info_count_by_dimm_interleave_set_index_id(p_store,
+			index_id, &info_count) != DB_SUCCESS || info_count == 0)
+	{
+		COMMON_LOG_ERROR_F("Simulated interleave set %u has no "NVM_DIMM_NAME"s", index_id);
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+	else
+	{
+		struct db_interleave_set_dimm_info infos[info_count];
+		struct db_dimm_interleave_set db_set;
+		memset(&db_set, 0, sizeof (db_set));
+		db_get_interleave_set_dimm_infos_by_dimm_interleave_set_index_id(p_store,
+				index_id, infos, info_count);
+
+		for (int i = 0; i < info_count && rc == NVM_SUCCESS; i++)
+		{
+			// the input and output tables of the PCD share the index space
+			if (infos[i].config_table_type != TABLE_TYPE_CURRENT_CONFIG)
+			{
+				continue;
+			}
+			if (p_set->dimm_count >= NVM_MAX_DEVICES_PER_SOCKET)
+			{
+				COMMON_LOG_ERROR_F("Simulated interleave set %u has too many "
+						NVM_DIMM_NAME"s", index_id);
+				rc = NVM_ERR_DRIVERFAILED;
+				break;
+			}
+			p_set->dimms[p_set->dimm_count].handle = infos[i].device_handle;
+			p_set->size += infos[i].size;
+			p_set->dimm_count++;
+		}
+
+		if (rc == NVM_SUCCESS && p_set->dimm_count == 0)
+		{
+			COMMON_LOG_ERROR_F("Simulated interleave set %u is not in the current config",
+					index_id);
+			rc = NVM_ERR_DRIVERFAILED;
+		}
+		else if (rc == NVM_SUCCESS)
+		{
+			// the format is the same on each dimm in the set
+			int set_count = 0;
+			if (db_get_dimm_interleave_set_count_by_dimm_topology_device_handle(p_store,
+					p_set->dimms[0].handle, &set_count) == DB_SUCCESS && set_count > 0)
+			{
+				struct db_dimm_interleave_set db_sets[set_count];
+				db_get_dimm_interleave_sets_by_dimm_topology_device_handle(p_store,
+						p_set->dimms[0].handle, db_sets, set_count);
+				for (int i = 0; i < set_count; i++)
+				{
+					if (db_sets[i].index_id == index_id &&
+							db_sets[i].config_table_type == TABLE_TYPE_CURRENT_CONFIG)
+					{
+						db_set = db_sets[i];
+						break;
+					}
+				}
+			}
+
+			p_set->set_index = index_id;
+			p_set->driver_id = index_id;
+			p_set->socket_id = p_set->dimms[0].parts.socket_id;
+			p_set->mirrored = db_set.mirror_enable ? 1 : 0;
+			interleave_format_to_struct(db_set.interleave_format, &p_set->settings);
+			if (p_set->mirrored)
+			{
+				// mirrored sets use twice the raw capacity
+				p_set->size /= 2llu;
+			}
+
+			NVM_UINT64 used = get_sim_namespace_capacity(p_store,
+					NAMESPACE_TYPE_APP_DIRECT, index_id);
+			p_set->available_size = (used < p_set->size) ? (p_set->size - used) : 0;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Get the unique indexes of the interleave sets in the current config
+ */
+static int get_sim_interleave_set_indexes(PersistentStore *p_store,
+		NVM_UINT32 *p_indexes, const int index_count)
+{
+	int rc = 0;
+
+	int row_count = 0;
+	if (db_get_dimm_interleave_set_count(p_store, &row_count) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to get the simulated interleave set count");
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+	else if (row_count > 0)
+	{
+		// one row per dimm in each interleave set
+		struct db_dimm_interleave_set rows[row_count];
+		row_count = db_get_dimm_interleave_sets(p_store, rows, row_count);
+		for (int i = 0; i < row_count && rc >= 0; i++)
+		{
+			if (rows[i].config_table_type != TABLE_TYPE_CURRENT_CONFIG)
+			{
+				continue;
+			}
+
+			NVM_BOOL found = 0;
+			for (int j = 0; j < rc && !found; j++)
+			{
+				found = (p_indexes[j] == rows[i].index_id);
+			}
+			if (!found)
+			{
+				if (rc >= index_count)
+				{
+					rc = NVM_ERR_ARRAYTOOSMALL;
+				}
+				else
+				{
+					p_indexes[rc++] = rows[i].index_id;
+				}
+			}
+		}
+	}
+
+	return rc;
+}
+
+/*
+ * Fetch the interleave set count.
+ */
+int get_interleave_set_count()
+{
+	COMMON_LOG_ENTRY();
+	int rc = 0;
+	PersistentStore *p_store = get_sim_store();
+
+	int row_count = 0;
+	if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_dimm_interleave_set_count(p_store, &row_count) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to get the simulated interleave set count");
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+	else if (row_count > 0)
+	{
+		NVM_UINT32 indexes[row_count];
+		rc = get_sim_interleave_set_indexes(p_store, indexes, row_count);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Fetch the list of interleave sets.
+ */
+int get_interleave_sets(const NVM_UINT32 count, struct nvm_interleave_set *p_interleaves)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	if (p_interleaves == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, interleave set array is null");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (count > 0)
+	{
+		memset(p_interleaves, 0, count * sizeof (struct nvm_interleave_set));
+
+		NVM_UINT32 indexes[count];
+		if ((rc = get_sim_interleave_set_indexes(p_store, indexes, count)) > 0)
+		{
+			int set_count = rc;
+			for (int i = 0; i < set_count; i++)
+			{
+				if ((rc = get_sim_interleave_set(p_store, indexes[i], &p_interleaves[i]))
+						!= NVM_SUCCESS)
+				{
+					break;
+				}
+			}
+
+			if (rc == NVM_SUCCESS)
+			{
+				rc = set_count;
+			}
+		}
+		else if (rc == NVM_ERR_ARRAYTOOSMALL)
+		{
+			COMMON_LOG_ERROR_F(
+					"count %u is smaller than number of simulated interleave sets", count);
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Get the storage capacity of a simulated dimm
+ */
+int get_sim_storage_capacity(PersistentStore *p_store, const NVM_UINT32 device_handle,
+		struct nvm_storage_capacities *p_capacity)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	memset(p_capacity, 0, sizeof (struct nvm_storage_capacities));
+	p_capacity->device_handle.handle = device_handle;
+
+	struct db_dimm_partition partition;
+	if (db_get_dimm_partition_by_device_handle(p_store, device_handle, &partition)
+			!= DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("Simulated "NVM_DIMM_NAME" %u has no partition info",
+				device_handle);
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+	else
+	{
+		p_capacity->total_storage_capacity = MULTIPLES_TO_BYTES(partition.pmem_capacity);
+
+		NVM_UINT64 mirrored_capacity = 0;
+		NVM_UINT64 ilset_capacity = 0;
+		if ((rc = get_dimm_ilset_capacity(p_capacity->device_handle,
+				&mirrored_capacity, &ilset_capacity)) == NVM_SUCCESS)
+		{
+			ilset_capacity += mirrored_capacity;
+			if (p_capacity->total_storage_capacity > ilset_capacity)
+			{
+				p_capacity->storage_only_capacity =
+						p_capacity->total_storage_capacity - ilset_capacity;
+			}
+		}
+
+		NVM_UINT64 used = get_sim_namespace_capacity(p_store,
+				NAMESPACE_TYPE_STORAGE, device_handle);
+		p_capacity->free_storage_capacity = (used < p_capacity->total_storage_capacity) ?
+				(p_capacity->total_storage_capacity - used) : 0;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Retrieve the storage capacity for each DIMM
+ */
+int get_dimm_storage_capacities(const NVM_UINT32 count,
+		struct nvm_storage_capacities *p_capacities)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	int dimm_count = 0;
+	if (p_capacities == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_capacities is null");
+		rc = NVM_ERR_UNKNOWN;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_dimm_topology_count(p_store, &dimm_count) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to get the simulated "NVM_DIMM_NAME" count");
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+	else if (dimm_count > count)
+	{
+		COMMON_LOG_ERROR_F("Too many DIMMs (expected count = %u)", count);
+		rc = NVM_ERR_DRIVERFAILED;
+	}
+	else if (dimm_count > 0)
+	{
+		memset(p_capacities, 0, count * sizeof (struct nvm_storage_capacities));
+
+		struct db_dimm_topology topologies[dimm_count];
+		dimm_count = db_get_dimm_topologys(p_store, topologies, dimm_count);
+		for (int i = 0; i < dimm_count; i++)
+		{
+			if ((rc = get_sim_storage_capacity(p_store, topologies[i].device_handle,
+					&p_capacities[i])) != NVM_SUCCESS)
+			{
+				break;
+			}
+		}
+
+		if (rc == NVM_SUCCESS)
+		{
+			rc = dimm_count;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
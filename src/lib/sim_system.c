@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file implements the internal interface for system level functionality in
+ * the simulated adapter.  The host and sockets are described by the simulator file.
+ */
+
+#include "system.h"
+#include "sim_adapter.h"
+#include <persistence/logging.h>
+#include <os/os_adapter.h>
+#include <file_ops/file_ops_adapter.h>
+#include <string/s_str.h>
+
+/*
+ * Load a simulator file.
+ */
+int add_simulator(const NVM_PATH simulator, const NVM_SIZE simulator_len)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+
+	if (simulator == NULL || s_strnlen(simulator, simulator_len) == 0)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, simulator path is empty");
+		rc = NVM_ERR_BADFILE;
+	}
+	else if (!file_exists(simulator, simulator_len))
+	{
+		COMMON_LOG_ERROR_F("Simulator file %s does not exist", simulator);
+		rc = NVM_ERR_BADFILE;
+	}
+	else
+	{
+		rc = open_sim_store(simulator);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Remove a simulator file.
+ */
+int remove_simulator()
+{
+	COMMON_LOG_ENTRY();
+
+	int rc = close_sim_store();
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Retrieve basic information about the host server the simulator describes.
+ * Falls back to the real host when the simulator file has no host entry.
+ */
+int get_host(struct host *p_host)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	struct db_host host;
+	if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_hosts(p_store, &host, 1) == 1)
+	{
+		s_strncpy(p_host->name, NVM_COMPUTERNAME_LEN, host.name, HOST_NAME_LEN);
+		p_host->os_type = host.os_type;
+		s_strncpy(p_host->os_name, NVM_OSNAME_LEN, host.os_name, HOST_OS_NAME_LEN);
+		s_strncpy(p_host->os_version, NVM_OSVERSION_LEN,
+				host.os_version, HOST_OS_VERSION_LEN);
+	}
+	else
+	{
+		if (get_host_name(p_host->name, NVM_COMPUTERNAME_LEN) != COMMON_SUCCESS)
+		{
+			COMMON_LOG_ERROR("Failed to retrieve the host name.");
+			rc = NVM_ERR_UNKNOWN;
+		}
+
+		p_host->os_type = OS_TYPE_LINUX;
+
+		if (get_os_name(p_host->os_name, NVM_OSNAME_LEN) != COMMON_SUCCESS)
+		{
+			COMMON_LOG_ERROR("Failed to retrieve the OS name.");
+			rc = NVM_ERR_UNKNOWN;
+		}
+
+		if (get_os_version(p_host->os_version, NVM_OSVERSION_LEN) != COMMON_SUCCESS)
+		{
+			COMMON_LOG_ERROR("Failed to retrieve the OS version.");
+			rc = NVM_ERR_UNKNOWN;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * The simulator does not touch the hardware so any caller may use it.
+ */
+int check_caller_permissions()
+{
+	return COMMON_SUCCESS;
+}
+
+/*
+ * Helper to convert a socket from the simulator file
+ */
+void db_socket_to_socket(const struct db_socket *p_db_socket, struct socket *p_socket)
+{
+	memset(p_socket, 0, sizeof (struct socket));
+	p_socket->id = p_db_socket->socket_id;
+	p_socket->type = p_db_socket->type;
+	p_socket->model = p_db_socket->model;
+	p_socket->brand = p_db_socket->brand;
+	p_socket->family = p_db_socket->family;
+	p_socket->stepping = p_db_socket->stepping;
+	s_strncpy(p_socket->manufacturer, NVM_SOCKET_MANUFACTURER_LEN,
+			p_db_socket->manufacturer, SOCKET_MANUFACTURER_LEN);
+	p_socket->logical_processor_count = p_db_socket->logical_processor_count;
+}
+
+/*
+ * Retrieves the number of sockets the simulator describes.
+ */
+int get_socket_count()
+{
+	COMMON_LOG_ENTRY();
+	int rc = 0;
+	PersistentStore *p_store = get_sim_store();
+
+	if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_socket_count(p_store, &rc) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR("Failed to get the simulated socket count");
+		rc = NVM_ERR_UNKNOWN;
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Retrieves the sockets the simulator describes.
+ */
+int get_sockets(struct socket *p_sockets, NVM_UINT16 count)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	if (p_sockets == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_sockets is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else
+	{
+		int socket_count = 0;
+		if (db_get_socket_count(p_store, &socket_count) != DB_SUCCESS)
+		{
+			COMMON_LOG_ERROR("Failed to get the simulated socket count");
+			rc = NVM_ERR_UNKNOWN;
+		}
+		else if (socket_count > count)
+		{
+			COMMON_LOG_ERROR("Invalid parameter, count is smaller than number of sockets");
+			rc = NVM_ERR_ARRAYTOOSMALL;
+		}
+		else if (socket_count > 0)
+		{
+			struct db_socket db_sockets[socket_count];
+			socket_count = db_get_sockets(p_store, db_sockets, socket_count);
+			for (int i = 0; i < socket_count; i++)
+			{
+				db_socket_to_socket(&db_sockets[i], &p_sockets[i]);
+			}
+		}
+
+		if (rc == NVM_SUCCESS)
+		{
+			rc = socket_count;
+		}
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * Retrieves a specific simulated socket.
+ */
+int get_socket(NVM_UINT16 socket_id, struct socket *p_socket)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_SUCCESS;
+	PersistentStore *p_store = get_sim_store();
+
+	struct db_socket db_socket;
+	if (p_socket == NULL)
+	{
+		COMMON_LOG_ERROR("Invalid parameter, p_socket is NULL");
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!p_store)
+	{
+		rc = NVM_ERR_NOSIMULATOR;
+	}
+	else if (db_get_socket_by_socket_id(p_store, socket_id, &db_socket) != DB_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("Simulated socket %hu does not exist", socket_id);
+		rc = NVM_ERR_BADSOCKET;
+	}
+	else
+	{
+		db_socket_to_socket(&db_socket, p_socket);
+	}
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
+
+/*
+ * The simulator file does not carry a raw SMBIOS table.
+ */
+int get_smbios_table_alloc(NVM_UINT8 **pp_smbios_table, size_t *p_allocated_size)
+{
+	COMMON_LOG_ENTRY();
+	int rc = NVM_ERR_NOTSUPPORTED;
+
+	COMMON_LOG_EXIT_RETURN_I(rc);
+	return rc;
+}
@@ -1005,13 +1005,6 @@ enum label_area_health_result convert_label_health_result(LABEL_AREA_HEALTH_EVEN
 	return result;
 }
 
-
-int get_job_count()
-{
-	int rc = NVM_ERR_NOTSUPPORTED;
-	return rc;
-}
-
 /*
  * Send an IOCTL payload to the driver
  */
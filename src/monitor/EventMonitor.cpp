@@ -36,6 +36,7 @@
 #include <persistence/config_settings.h>
 #include <algorithm>
 #include "EventMonitor.h"
+#include "MetricsExporter.h"
 #include <persistence/event.h>
 #include <string/s_str.h>
 #include <LogEnterExit.h>
@@ -72,7 +73,16 @@
 				NULL, \
 				DIAGNOSTIC_RESULT_UNKNOWN)
 
-monitor::EventMonitor::EventMonitor() : NvmMonitorBase("EVENT"), m_nsMgmtCallbackId(-1)
+/*
+ * Namespaces are normally only discovered and re-queried when a DIMM health state or
+ * uncorrectable error count changes. Driver-reported conditions (e.g. label corruption)
+ * and namespaces created or deleted outside this library don't show up in the DIMMs,
+ * so every so many passes the namespaces are discovered and queried anyway.
+ */
+#define	NAMESPACE_HEALTH_RECHECK_PASSES	10
+
+monitor::EventMonitor::EventMonitor() : NvmMonitorBase("EVENT"), m_nsMgmtCallbackId(-1),
+		m_namespaceHealthStale(true), m_namespacePassCount(0)
 {
 	if (!get_lib_store())
 	{
@@ -131,6 +141,10 @@ void monitor::EventMonitor::startOfDay()
 	// Update the saved topology state
 	saveCurrentTopologyState(devMap);
 
+	// The stored dimm and namespace state is only read once, monitor() keeps it up to date
+	loadDimmStates();
+	loadNamespaceStates();
+
 	// On start-up look for deleted namespaces and auto-acknowledge action required events
 	acknowledgeDeletedNamespaces();
 
@@ -203,6 +217,8 @@ void monitor::EventMonitor::monitorDimmStatus(const std::string &guidStr,
 	}
 	else
 	{
+		MetricsExporter::getExporter().setDimmHealth(guidStr, status.health);
+
 		// first pass, just store current values
 		if (firstState)
 		{
@@ -513,6 +529,8 @@ void monitor::EventMonitor::monitorDimmSensors(const std::string &guidStr,
 	}
 	else
 	{
+		MetricsExporter::getExporter().setDimmSensors(guidStr, sensors);
+
 		// first pass, just store current values
 		if (firstState)
 		{
@@ -605,111 +623,216 @@ void monitor::EventMonitor::monitorNamespaces(PersistentStore *pStore)
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 	if (pStore)
 	{
-		// get namespaces
-		int nsCount = nvm_get_namespace_count();
-		if (nsCount < 0)
+		if (++m_namespacePassCount >= NAMESPACE_HEALTH_RECHECK_PASSES)
+		{
+			m_namespaceHealthStale = true;
+		}
+
+		// nothing the DIMMs report points at a namespace change, skip the discovery
+		int nsCount = 0;
+		if (m_namespaceHealthStale && (nsCount = nvm_get_namespace_count()) < 0)
 		{
 			COMMON_LOG_ERROR_F("nvm_get_namespace_count failed with error %d", nsCount);
 		}
-		else if (nsCount > 0)
+		else if (m_namespaceHealthStale)
 		{
-			struct namespace_discovery namespaces[nsCount];
-			memset(namespaces, 0, sizeof (struct namespace_discovery) * nsCount);
-			nsCount = nvm_get_namespaces(namespaces, nsCount);
-			if (nsCount < 0)
-			{
-				COMMON_LOG_ERROR_F("nvm_get_namespaces failed with error %d", nsCount);
-			}
-			else if (nsCount > 0)
+			NamespaceSet currentNamespaces;
+			if (nsCount > 0)
 			{
+				// sized by the driver, so keep it off the stack
+				std::vector<struct namespace_discovery> namespaces(nsCount);
+				nsCount = nvm_get_namespaces(&namespaces[0], nsCount);
+				if (nsCount < 0)
+				{
+					COMMON_LOG_ERROR_F("nvm_get_namespaces failed with error %d", nsCount);
+				}
+
 				// for each namespace
 				for (int i = 0; i < nsCount; i++)
 				{
-					struct namespace_details details;
-					memset(&details, 0, sizeof (details));
 					NVM_GUID_STR guidStr;
 					guid_to_str(namespaces[i].namespace_guid, guidStr);
-					int rc = nvm_get_namespace_details(namespaces[i].namespace_guid, &details);
-					if (rc != NVM_SUCCESS)
-					{
-						COMMON_LOG_ERROR_F("nvm_get_namespace_details for namespace %s failed with error %d",
-								guidStr, rc);
-					}
-					else
-					{
-						// get the stored state for this namespace
-						bool storedStateChanged = false;
+					currentNamespaces.insert(guidStr);
 
-						struct db_namespace_state storedState;
-						memset(&storedState, 0, sizeof (storedState));
-						if (db_get_namespace_state_by_namespace_guid(pStore,
-								guidStr, &storedState) != DB_SUCCESS)
-						{
-							// initial state, just store current state
-							s_strcpy(storedState.namespace_guid, guidStr,
-									NAMESPACE_STATE_NAMESPACE_GUID_LEN);
-							storedState.health_state = details.health;
-							storedStateChanged = true;
-						}
-						// log health transition event
-						else if (details.health != storedState.health_state)
-						{
-							enum event_severity severity = EVENT_SEVERITY_INFO;
-							bool actionRequired = false;
-							// namespace is failed
-							if (details.health == NAMESPACE_HEALTH_CRITICAL ||
-								details.health == NAMESPACE_HEALTH_BROKENMIRROR)
-							{
-								severity = EVENT_SEVERITY_CRITICAL;
-								actionRequired = true;
-							}
-							// namespace is not failed
-							else
-							{
-								// auto-acknowledge any old namespace health failed events
-								acknowledgeEvent(EVENT_CODE_HEALTH_NAMESPACE_HEALTH_STATE_CHANGED,
-										namespaces[i].namespace_guid);
-							}
+					bool firstState = (m_namespaceStates.find(guidStr) == m_namespaceStates.end());
+					monitorNamespaceHealth(namespaces[i].namespace_guid, guidStr, firstState);
+				}
+			}
 
-							std::string oldState = namespaceHealthToStr(
-									(enum namespace_health)storedState.health_state);
-							std::string newState = namespaceHealthToStr(details.health);
-							store_event_by_parts(
-									EVENT_TYPE_HEALTH,
-									severity,
-									EVENT_CODE_HEALTH_NAMESPACE_HEALTH_STATE_CHANGED,
-									namespaces[i].namespace_guid,
-									actionRequired,
-									guidStr,
-									oldState.c_str(),
-									newState.c_str(),
-									DIAGNOSTIC_RESULT_UNKNOWN);
-
-							storedStateChanged = true;
-							storedState.health_state = details.health;
-							if (db_delete_namespace_state_by_namespace_guid(pStore,
-									guidStr) != DB_SUCCESS)
-							{
-								COMMON_LOG_ERROR_F(
-									"Failed to clean up the stored health state for namespace %s",
-									guidStr);
-							}
-						}
+			// don't treat a failure to get namespaces as all of them being deleted
+			if (nsCount >= 0)
+			{
+				removeDeletedNamespaces(currentNamespaces);
+				m_namespaceHealthStale = false;
+				m_namespacePassCount = 0;
+			}
 
-						if (storedStateChanged)
-						{
-							if (db_add_namespace_state(pStore, &storedState) != DB_SUCCESS)
-							{
-								COMMON_LOG_ERROR_F(
-									"Failed to update the stored health state for namespace %s",
-									guidStr);
-							}
-						}
-					} // end nvm_get_namespace_details
-				} // end for each namespace
-			} // end nvm_get_namespaces
-		} // end nvm_get_namespace_count
-	} // end get peristent store
+			saveNamespaceStates(pStore);
+		}
+	}
+}
+
+void monitor::EventMonitor::monitorNamespaceHealth(const NVM_GUID nsGuid,
+		const std::string &guidStr, bool firstState)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	struct namespace_details details;
+	memset(&details, 0, sizeof (details));
+	int rc = nvm_get_namespace_details(nsGuid, &details);
+	if (rc != NVM_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("nvm_get_namespace_details for namespace %s failed with error %d",
+				guidStr.c_str(), rc);
+	}
+	else if (firstState)
+	{
+		// initial state, just store current state
+		struct db_namespace_state storedState;
+		memset(&storedState, 0, sizeof (storedState));
+		s_strcpy(storedState.namespace_guid, guidStr.c_str(),
+				NAMESPACE_STATE_NAMESPACE_GUID_LEN);
+		storedState.health_state = details.health;
+		m_namespaceStates[guidStr] = storedState;
+		m_dirtyNamespaceStates.insert(guidStr);
+		m_deletedNamespaceStates.erase(guidStr);
+	}
+	else
+	{
+		struct db_namespace_state &storedState = m_namespaceStates[guidStr];
+
+		// log health transition event
+		if (details.health != storedState.health_state)
+		{
+			enum event_severity severity = EVENT_SEVERITY_INFO;
+			bool actionRequired = false;
+			// namespace is failed
+			if (details.health == NAMESPACE_HEALTH_CRITICAL ||
+				details.health == NAMESPACE_HEALTH_BROKENMIRROR)
+			{
+				severity = EVENT_SEVERITY_CRITICAL;
+				actionRequired = true;
+			}
+			// namespace is not failed
+			else
+			{
+				// auto-acknowledge any old namespace health failed events
+				acknowledgeEvent(EVENT_CODE_HEALTH_NAMESPACE_HEALTH_STATE_CHANGED, nsGuid);
+			}
+
+			std::string oldState = namespaceHealthToStr(
+					(enum namespace_health)storedState.health_state);
+			std::string newState = namespaceHealthToStr(details.health);
+			store_event_by_parts(
+					EVENT_TYPE_HEALTH,
+					severity,
+					EVENT_CODE_HEALTH_NAMESPACE_HEALTH_STATE_CHANGED,
+					nsGuid,
+					actionRequired,
+					guidStr.c_str(),
+					oldState.c_str(),
+					newState.c_str(),
+					DIAGNOSTIC_RESULT_UNKNOWN);
+
+			storedState.health_state = details.health;
+			m_dirtyNamespaceStates.insert(guidStr);
+		}
+	}
+}
+
+void monitor::EventMonitor::removeDeletedNamespaces(const NamespaceSet &currentNamespaces)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	NamespaceStateMap::iterator iter = m_namespaceStates.begin();
+	while (iter != m_namespaceStates.end())
+	{
+		if (currentNamespaces.find(iter->first) == currentNamespaces.end())
+		{
+			// namespace is gone, its health events no longer need action
+			NVM_GUID guid;
+			str_to_guid(iter->first.c_str(), guid);
+			acknowledgeEvent(EVENT_CODE_HEALTH_NAMESPACE_HEALTH_STATE_CHANGED, guid);
+
+			m_dirtyNamespaceStates.erase(iter->first);
+			m_deletedNamespaceStates.insert(iter->first);
+			m_namespaceStates.erase(iter++);
+		}
+		else
+		{
+			iter++;
+		}
+	}
+}
+
+void monitor::EventMonitor::loadNamespaceStates()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	m_namespaceStates.clear();
+	m_dirtyNamespaceStates.clear();
+	m_deletedNamespaceStates.clear();
+	m_namespaceHealthStale = true;
+
+	PersistentStore *pStore = get_lib_store();
+	int stateCount = 0;
+	if (pStore && db_get_namespace_state_count(pStore, &stateCount) == DB_SUCCESS &&
+			stateCount > 0)
+	{
+		// sized by the table, so keep it off the stack
+		std::vector<struct db_namespace_state> nsStates(stateCount);
+		stateCount = db_get_namespace_states(pStore, &nsStates[0], stateCount);
+		for (int i = 0; i < stateCount; i++)
+		{
+			m_namespaceStates[nsStates[i].namespace_guid] = nsStates[i];
+		}
+	}
+}
+
+void monitor::EventMonitor::saveNamespaceStates(PersistentStore *pStore)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	if (!m_dirtyNamespaceStates.empty() || !m_deletedNamespaceStates.empty())
+	{
+		bool saved = true;
+		db_begin_transaction(pStore);
+		for (NamespaceSet::const_iterator iter = m_deletedNamespaceStates.begin();
+				saved && iter != m_deletedNamespaceStates.end(); iter++)
+		{
+			if (db_delete_namespace_state_by_namespace_guid(pStore,
+					iter->c_str()) != DB_SUCCESS)
+			{
+				COMMON_LOG_ERROR_F(
+					"Failed to clean up the stored health state for namespace %s",
+					iter->c_str());
+				saved = false;
+			}
+		}
+		for (NamespaceSet::const_iterator iter = m_dirtyNamespaceStates.begin();
+				saved && iter != m_dirtyNamespaceStates.end(); iter++)
+		{
+			if (db_upsert_namespace_state(pStore, &m_namespaceStates[*iter]) != DB_SUCCESS)
+			{
+				COMMON_LOG_ERROR_F(
+					"Failed to update the stored health state for namespace %s",
+					iter->c_str());
+				saved = false;
+			}
+		}
+
+		// on failure keep the changes pending so the next pass retries them
+		if (saved)
+		{
+			db_end_transaction(pStore);
+			m_dirtyNamespaceStates.clear();
+			m_deletedNamespaceStates.clear();
+		}
+		else
+		{
+			db_rollback_transaction(pStore);
+		}
+	}
 }
 
 void monitor::EventMonitor::monitor()
@@ -735,20 +858,26 @@ void monitor::EventMonitor::monitor()
 			{
 				bool storedStateChanged = false;
 				bool firstState = false;
+				NVM_UINT32 handle = discovery.device_handle.handle;
+				MetricsExporter::getExporter().setDimmHandle(guidStr, handle);
 
-				// get stored device state
-				struct db_dimm_state storedState;
-				memset(&storedState, 0, sizeof (storedState));
-				if (db_get_dimm_state_by_device_handle(pStore,
-						discovery.device_handle.handle, &storedState) != DB_SUCCESS)
+				// get last known device state
+				DimmStateMap::iterator stateIter = m_dimmStates.find(handle);
+				if (stateIter == m_dimmStates.end())
 				{
 					// initial state, just store current
 					firstState = true;
-					COMMON_LOG_INFO_F("Failed to retrieve the stored health state of dimm %u",
-							discovery.device_handle.handle);
-					storedState.device_handle = discovery.device_handle.handle;
+					COMMON_LOG_INFO_F("No stored health state for dimm %u", handle);
+					struct db_dimm_state initialState;
+					memset(&initialState, 0, sizeof (initialState));
+					initialState.device_handle = handle;
+					stateIter = m_dimmStates.insert(
+							std::make_pair(handle, initialState)).first;
 					storedStateChanged = true;
 				}
+				struct db_dimm_state &storedState = stateIter->second;
+				int lastHealthState = storedState.health_state;
+				NVM_UINT64 lastUncorrectable = storedState.mediaerrors_uncorrectable;
 
 				// check for dimm health state transition
 				monitorDimmStatus(guidStr, discovery, storedState,
@@ -758,25 +887,23 @@ void monitor::EventMonitor::monitor()
 				monitorDimmSensors(guidStr, discovery, storedState,
 						storedStateChanged, firstState);
 
-				// update stored dimm state
+				// namespace health follows the health and media errors of the underlying dimms
+				if (firstState || storedState.health_state != lastHealthState ||
+						storedState.mediaerrors_uncorrectable != lastUncorrectable)
+				{
+					m_namespaceHealthStale = true;
+				}
+
 				if (storedStateChanged)
 				{
-					// clear existing dimm state
-					if (!firstState)
-					{
-						db_delete_dimm_state_by_device_handle(pStore,
-								discovery.device_handle.handle);
-					}
-					// add current state
-					if (db_add_dimm_state(pStore, &storedState) != DB_SUCCESS)
-					{
-						COMMON_LOG_ERROR_F("Failed to store the health state of dimm %u",
-								discovery.device_handle.handle);
-					}
+					m_dirtyDimmStates.insert(handle);
 				}
 			}
 		}
 
+		// update stored dimm state for the dimms that changed
+		saveDimmStates(pStore);
+
 		// Monitor namespace health transitions
 		monitorNamespaces(pStore);
 
@@ -788,7 +915,7 @@ void monitor::EventMonitor::monitor()
 }
 
 bool monitor::EventMonitor::namespaceDeleted(const NVM_GUID nsGuid,
-		const std::vector<std::string> &nsGuids)
+		const NamespaceSet &nsGuids)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 	bool deleted = false;
@@ -796,7 +923,7 @@ bool monitor::EventMonitor::namespaceDeleted(const NVM_GUID nsGuid,
 	// look for the guid in the list
 	NVM_GUID_STR guidStr;
 	guid_to_str(nsGuid, guidStr);
-	if (std::find(nsGuids.begin(), nsGuids.end(), guidStr) == nsGuids.end())
+	if (nsGuids.find(guidStr) == nsGuids.end())
 	{
 		// if not found, then deleted
 		deleted = true;
@@ -836,7 +963,7 @@ void monitor::EventMonitor::acknowledgeDeletedNamespaces()
 		}
 		else if (eventCount > 0)
 		{
-			std::vector<std::string> nsGuids;
+			NamespaceSet nsGuids;
 			bool ackAll = false;
 			// get namespace list
 			int nsCount = nvm_get_namespace_count();
@@ -850,8 +977,8 @@ void monitor::EventMonitor::acknowledgeDeletedNamespaces()
 			}
 			else // at least one namespace
 			{
-				struct namespace_discovery namespaces[nsCount];
-				nsCount = nvm_get_namespaces(namespaces, nsCount);
+				std::vector<struct namespace_discovery> namespaces(nsCount);
+				nsCount = nvm_get_namespaces(&namespaces[0], nsCount);
 				if (nsCount < 0) // error retrieving namespace list
 				{
 					COMMON_LOG_ERROR_F("nvm_get_namespaces failed with error %d", nsCount);
@@ -866,7 +993,7 @@ void monitor::EventMonitor::acknowledgeDeletedNamespaces()
 					{
 						NVM_GUID_STR guidStr;
 						guid_to_str(namespaces[i].namespace_guid, guidStr);
-						nsGuids.push_back(guidStr);
+						nsGuids.insert(guidStr);
 					}
 				}
 			}
@@ -1221,59 +1348,82 @@ void monitor::EventMonitor::saveCurrentTopologyState(const DeviceMap &devices)
 	PersistentStore *pStore = get_lib_store();
 	if (pStore)
 	{
-		// Only keep the latest topology
-		if (db_delete_all_topology_states(pStore) != DB_SUCCESS)
+		int valid = 0;
+		get_config_value_int(SQL_KEY_TOPOLOGY_STATE_VALID, &valid);
+
+		db_begin_transaction(pStore);
+
+		// Without a valid stored topology there is nothing to diff against
+		if (!valid && db_delete_all_topology_states(pStore) != DB_SUCCESS)
 		{
 			COMMON_LOG_ERROR("couldn't delete old topology_state");
 			saved = false;
 		}
-		else
+
+		// Remove DIMMs that are gone or have moved to another handle
+		for (DeviceMap::const_iterator iter = devices.begin();
+				saved && iter != devices.end(); iter++)
 		{
-			// Preserve topology state in config DB
-			for (DeviceMap::const_iterator iter = devices.begin();
-					iter != devices.end(); iter++)
+			const struct deviceInfo &device = iter->second;
+			if (device.stored && (!device.discovered ||
+					device.discovery.device_handle.handle != device.storedState.device_handle))
 			{
-				const std::string &guidStr = iter->first;
-				const struct deviceInfo &device = iter->second;
+				if (db_delete_topology_state_by_device_handle(pStore,
+						device.storedState.device_handle) != DB_SUCCESS)
+				{
+					COMMON_LOG_ERROR_F("couldn't delete topology_state for DIMM %s",
+							iter->first.c_str());
+					saved = false;
+				}
+			}
+		}
 
-				// only store current devices
-				if (device.discovered)
+		// Preserve topology state in config DB, only writing what changed
+		for (DeviceMap::const_iterator iter = devices.begin();
+				saved && iter != devices.end(); iter++)
+		{
+			const std::string &guidStr = iter->first;
+			const struct deviceInfo &device = iter->second;
+
+			// only store current devices
+			if (device.discovered)
+			{
+				struct db_topology_state topoState;
+				memset(&topoState, 0, sizeof(topoState));
+				s_strcpy(topoState.guid, guidStr.c_str(), NVM_GUIDSTR_LEN);
+				topoState.device_handle = device.discovery.device_handle.handle;
+				topoState.manufacturer = MANUFACTURER_TO_UINT(device.discovery.manufacturer);
+				topoState.serial_num = SERIAL_NUMBER_TO_UINT(device.discovery.serial_number);
+				memmove(topoState.model_num, device.discovery.model_number, NVM_MODEL_LEN);
+
+				topoState.current_config_status = device.status.config_status;
+				topoState.config_goal_status = CONFIG_GOAL_STATUS_UNKNOWN;
+
+				struct config_goal goal;
+				memset(&goal, 0, sizeof (goal));
+				int rc = nvm_get_config_goal(device.discovery.guid, &goal);
+				if (rc == NVM_SUCCESS)
 				{
-					struct db_topology_state topoState;
-					memset(&topoState, 0, sizeof(topoState));
-					s_strcpy(topoState.guid, guidStr.c_str(), NVM_GUIDSTR_LEN);
-					topoState.device_handle = device.discovery.device_handle.handle;
-					topoState.manufacturer = MANUFACTURER_TO_UINT(device.discovery.manufacturer);
-					topoState.serial_num = SERIAL_NUMBER_TO_UINT(device.discovery.serial_number);
-					memmove(topoState.model_num, device.discovery.model_number, NVM_MODEL_LEN);
-
-					topoState.current_config_status = device.status.config_status;
-					topoState.config_goal_status = CONFIG_GOAL_STATUS_UNKNOWN;
-
-					struct config_goal goal;
-					memset(&goal, 0, sizeof (goal));
-					int rc = nvm_get_config_goal(device.discovery.guid, &goal);
-					if (rc == NVM_SUCCESS)
-					{
-						topoState.config_goal_status = goal.status;
-					}
-					else if (rc == NVM_ERR_NOTFOUND)
-					{
-						COMMON_LOG_DEBUG_F("No goal for DIMM %s", guidStr.c_str());
-					}
-					else
-					{
-						COMMON_LOG_ERROR_F("Error fetching config goalfor DIMM %s: %d",
-						                   guidStr.c_str(),
-						                   rc);
-					}
+					topoState.config_goal_status = goal.status;
+				}
+				else if (rc == NVM_ERR_NOTFOUND)
+				{
+					COMMON_LOG_DEBUG_F("No goal for DIMM %s", guidStr.c_str());
+				}
+				else
+				{
+					COMMON_LOG_ERROR_F("Error fetching config goalfor DIMM %s: %d",
+					                   guidStr.c_str(),
+					                   rc);
+				}
 
-					if (db_add_topology_state(pStore, &topoState) != DB_SUCCESS)
+				if (!device.stored || topologyStateChanged(device.storedState, topoState))
+				{
+					if (db_upsert_topology_state(pStore, &topoState) != DB_SUCCESS)
 					{
 						COMMON_LOG_ERROR_F("couldn't add topology_state for DIMM %s",
 								topoState.guid);
 						saved = false;
-						break;
 					}
 				}
 			}
@@ -1282,8 +1432,77 @@ void monitor::EventMonitor::saveCurrentTopologyState(const DeviceMap &devices)
 		// everything succeeded
 		if (saved)
 		{
+			db_end_transaction(pStore);
 			add_config_value(SQL_KEY_TOPOLOGY_STATE_VALID, "1");
 		}
+		else
+		{
+			db_rollback_transaction(pStore);
+		}
+	}
+}
+
+bool monitor::EventMonitor::topologyStateChanged(const struct db_topology_state &stored,
+		const struct db_topology_state &current) const
+{
+	return stored.device_handle != current.device_handle ||
+			stored.manufacturer != current.manufacturer ||
+			stored.serial_num != current.serial_num ||
+			strncmp(stored.model_num, current.model_num, NVM_MODEL_LEN) != 0 ||
+			stored.current_config_status != current.current_config_status ||
+			stored.config_goal_status != current.config_goal_status;
+}
+
+void monitor::EventMonitor::loadDimmStates()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	m_dimmStates.clear();
+	m_dirtyDimmStates.clear();
+
+	PersistentStore *pStore = get_lib_store();
+	int stateCount = 0;
+	if (pStore && db_get_dimm_state_count(pStore, &stateCount) == DB_SUCCESS &&
+			stateCount > 0)
+	{
+		// sized by the table, so keep it off the stack
+		std::vector<struct db_dimm_state> dimmStates(stateCount);
+		stateCount = db_get_dimm_states(pStore, &dimmStates[0], stateCount);
+		for (int i = 0; i < stateCount; i++)
+		{
+			m_dimmStates[dimmStates[i].device_handle] = dimmStates[i];
+		}
+	}
+}
+
+void monitor::EventMonitor::saveDimmStates(PersistentStore *pStore)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	if (!m_dirtyDimmStates.empty())
+	{
+		bool saved = true;
+		db_begin_transaction(pStore);
+		for (std::set<NVM_UINT32>::const_iterator iter = m_dirtyDimmStates.begin();
+				saved && iter != m_dirtyDimmStates.end(); iter++)
+		{
+			if (db_upsert_dimm_state(pStore, &m_dimmStates[*iter]) != DB_SUCCESS)
+			{
+				COMMON_LOG_ERROR_F("Failed to store the health state of dimm %u", *iter);
+				saved = false;
+			}
+		}
+
+		// on failure keep the dimms dirty so the next pass retries them
+		if (saved)
+		{
+			db_end_transaction(pStore);
+			m_dirtyDimmStates.clear();
+		}
+		else
+		{
+			db_rollback_transaction(pStore);
+		}
 	}
 }
 
@@ -35,6 +35,7 @@
 #include <persistence/schema.h>
 #include <string>
 #include <map>
+#include <set>
 #include <vector>
 
 #ifndef _MONITOR_EVENTMONITOR_H_
@@ -58,6 +59,15 @@ namespace monitor
 	//!< Map with a GUID string key and deviceInfo Struct
 	typedef std::map<std::string, struct deviceInfo> DeviceMap;
 
+	//!< Map with a device handle key and the last known dimm_state
+	typedef std::map<NVM_UINT32, struct db_dimm_state> DimmStateMap;
+
+	//!< Map with a namespace GUID string key and the last known namespace_state
+	typedef std::map<std::string, struct db_namespace_state> NamespaceStateMap;
+
+	//!< Set of namespace GUID strings
+	typedef std::set<std::string> NamespaceSet;
+
 	/*!
 	 * @brief Process to monitor conditions on the system and generate events for important
 	 * changes.
@@ -139,6 +149,24 @@ namespace monitor
 		 */
 		void saveCurrentTopologyState(const DeviceMap &devices);
 
+		/*
+		 * Helper to determine if the stored topology of a DIMM no longer matches the current one
+		 */
+		bool topologyStateChanged(const struct db_topology_state &stored,
+				const struct db_topology_state &current) const;
+
+		/*
+		 * Load the stored dimm_state of all DIMMs into memory. Only done on start-up,
+		 * after that the in-memory copy is authoritative.
+		 */
+		void loadDimmStates();
+
+		/*
+		 * Persist the dimm_state of the DIMMs that changed since the last save
+		 * in a single transaction.
+		 */
+		void saveDimmStates(PersistentStore *pStore);
+
 		/*
 		 * Monitor dimm health status transitions
 		 */
@@ -209,10 +237,32 @@ namespace monitor
 		std::string namespaceHealthToStr(enum namespace_health health);
 
 		/*
-		 * Monitor Namespace health events
+		 * Monitor Namespace health events. The namespaces are only discovered and
+		 * queried when their stored health may be stale.
 		 */
 		void monitorNamespaces(PersistentStore *p_Store);
 
+		/*
+		 * Check a single namespace for a health transition
+		 */
+		void monitorNamespaceHealth(const NVM_GUID nsGuid, const std::string &guidStr,
+				bool firstState);
+
+		/*
+		 * Forget namespaces that no longer exist and auto-acknowledge their events
+		 */
+		void removeDeletedNamespaces(const NamespaceSet &currentNamespaces);
+
+		/*
+		 * Load the stored namespace_state of all namespaces into memory on start-up.
+		 */
+		void loadNamespaceStates();
+
+		/*
+		 * Persist namespace_state changes since the last save in a single transaction.
+		 */
+		void saveNamespaceStates(PersistentStore *pStore);
+
 		/*
 		 * Build a map of guids to discovery information for all NVM-DIMM in the system
 		 */
@@ -232,7 +282,7 @@ namespace monitor
 		 * Helper to determine if a namespace has been deleted
 		 */
 		bool namespaceDeleted(const NVM_GUID nsGuid,
-				const std::vector<std::string> &nsGuids);
+				const NamespaceSet &nsGuids);
 
 		/*
 		 * On start-up log an event for mixed SKUs.
@@ -241,6 +291,25 @@ namespace monitor
 
 		// callback identifer for delete namespace events
 		int m_nsMgmtCallbackId;
+
+		// last known dimm_state of each DIMM, by device handle
+		DimmStateMap m_dimmStates;
+
+		// device handles whose dimm_state has not been written to the DB yet
+		std::set<NVM_UINT32> m_dirtyDimmStates;
+
+		// last known namespace_state of each namespace, by namespace GUID
+		NamespaceStateMap m_namespaceStates;
+
+		// namespaces whose namespace_state has not been written to/removed from the DB yet
+		NamespaceSet m_dirtyNamespaceStates;
+		NamespaceSet m_deletedNamespaceStates;
+
+		// discover and query the namespaces on the next pass
+		bool m_namespaceHealthStale;
+
+		// passes since the health of every known namespace was last queried
+		int m_namespacePassCount;
 	};
 }
 #endif /* _MONITOR_EVENTMONITOR_H_ */
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file contains the implementation of the job monitoring class
+ * of the NvmMonitor service which periodically refreshes the progress
+ * of long running jobs, such as sanitize, on each NVM-DIMM in the system.
+ */
+
+#include "JobMonitor.h"
+#include <LogEnterExit.h>
+#include <persistence/logging.h>
+#include <nvm_context.h>
+
+monitor::JobMonitor::JobMonitor()
+	: NvmMonitorBase(JOB_MONITOR_NAME)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+}
+
+monitor::JobMonitor::~JobMonitor()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+}
+
+/*
+ * Thread callback on monitor interval timer
+ */
+void monitor::JobMonitor::monitor()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	// clear any existing context
+	nvm_create_context();
+
+	int rc = nvm_update_jobs();
+	if (rc < 0)
+	{
+		COMMON_LOG_ERROR_F("Failed to update the job progress, rc = %d", rc);
+	}
+
+	nvm_free_context();
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file contains the definition of the job monitoring class
+ * of the NvmMonitor service which periodically refreshes the progress
+ * of long running jobs, such as sanitize, on each NVM-DIMM in the system.
+ */
+
+#include "NvmMonitorBase.h"
+#include <nvm_management.h>
+
+#ifndef _MONITOR_JOBMONITOR_H_
+#define _MONITOR_JOBMONITOR_H_
+
+
+namespace monitor
+{
+	static const std::string JOB_MONITOR_NAME = "JOB";
+
+	/*
+	 * Monitor class to periodically refresh the progress and completion of
+	 * the long running jobs on each manageable NVM-DIMM in the system.
+	 */
+	class JobMonitor : public NvmMonitorBase
+	{
+		public:
+			JobMonitor();
+			virtual ~JobMonitor();
+			virtual void monitor();
+	};
+}
+
+#endif /* _MONITOR_JOBMONITOR_H_ */
@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file contains the implementation of the metrics exporter of the NvmMonitor
+ * service which publishes the latest values gathered by the monitors in the
+ * Prometheus text exposition format.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sstream>
+#include "MetricsExporter.h"
+#include <LogEnterExit.h>
+#include <os/os_adapter.h>
+#include <string/s_str.h>
+#include <persistence/config_settings.h>
+#include <persistence/lib_persistence.h>
+#include <persistence/logging.h>
+
+#ifdef __WINDOWS__
+#include <Windows.h>
+
+HANDLE g_metrics_lock;
+#else
+pthread_mutex_t g_metrics_lock;
+#endif
+
+namespace monitor
+{
+	static const std::string METRICS_PREFIX = "ixpdimm_";
+	static const std::string METRICS_TMP_SUFFIX = ".tmp";
+
+	// Prometheus label value for each sensor, indexed by enum sensor_type
+	static const char *SENSOR_LABELS[NVM_MAX_DEVICE_SENSORS] =
+	{
+		"media_temperature",
+		"spare_capacity",
+		"wear_level",
+		"power_cycles",
+		"power_on_time",
+		"up_time",
+		"unsafe_shutdowns",
+		"fw_error_log_count",
+		"power_limited",
+		"media_errors_uncorrectable",
+		"media_errors_corrected",
+		"media_errors_erasure_coded",
+		"write_count_maximum",
+		"write_count_average",
+		"media_errors_host",
+		"media_errors_non_host",
+		"controller_temperature"
+	};
+
+	/*
+	 * Write the HELP and TYPE lines describing a metric family
+	 */
+	static void writeMetricHeader(std::ostringstream &out, const std::string &name,
+			const std::string &type, const std::string &help)
+	{
+		out << "# HELP " << METRICS_PREFIX << name << " " << help << "\n";
+		out << "# TYPE " << METRICS_PREFIX << name << " " << type << "\n";
+	}
+
+	/*
+	 * Format a millisecond count as seconds without going through floating point
+	 */
+	static std::string msecToSeconds(unsigned long long msec)
+	{
+		char seconds[32];
+		s_snprintf(seconds, sizeof (seconds), "%llu.%03llu", msec / 1000, msec % 1000);
+		return std::string(seconds);
+	}
+}
+
+monitor::MetricsExporter &monitor::MetricsExporter::getExporter()
+{
+	static MetricsExporter exporter;
+	return exporter;
+}
+
+monitor::MetricsExporter::MetricsExporter()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	// exporter is per process so no need to be cross-process safe
+	mutex_init((OS_MUTEX*)&g_metrics_lock, NULL);
+
+	char value[CONFIG_VALUE_LEN];
+	if (get_config_value(SQL_KEY_METRICS_EXPORT_FILE, value) == COMMON_SUCCESS)
+	{
+		m_filePath = value;
+	}
+	if (get_config_value(SQL_KEY_METRICS_EXPORT_SOCKET, value) == COMMON_SUCCESS)
+	{
+		m_socketPath = value;
+	}
+}
+
+monitor::MetricsExporter::~MetricsExporter()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	mutex_delete((OS_MUTEX*)&g_metrics_lock, NULL);
+}
+
+bool monitor::MetricsExporter::isEnabled() const
+{
+	return !m_filePath.empty() || !m_socketPath.empty();
+}
+
+std::string const & monitor::MetricsExporter::getFilePath() const
+{
+	return m_filePath;
+}
+
+std::string const & monitor::MetricsExporter::getSocketPath() const
+{
+	return m_socketPath;
+}
+
+/*
+ * Get the stored metrics of a DIMM, adding an empty entry the first time it is seen.
+ * Caller must hold the metrics lock.
+ */
+monitor::MetricsExporter::DimmMetrics &monitor::MetricsExporter::getDimm(
+		const std::string &guidStr)
+{
+	DimmMetricsMap::iterator iter = m_dimms.find(guidStr);
+	if (iter == m_dimms.end())
+	{
+		DimmMetrics dimm;
+		memset(&dimm, 0, sizeof (dimm));
+		iter = m_dimms.insert(std::make_pair(guidStr, dimm)).first;
+	}
+	return iter->second;
+}
+
+void monitor::MetricsExporter::setDimmHandle(const std::string &guidStr, NVM_UINT32 handle)
+{
+	if (isEnabled())
+	{
+		mutex_lock(&g_metrics_lock);
+		DimmMetrics &dimm = getDimm(guidStr);
+		dimm.hasHandle = true;
+		dimm.handle = handle;
+		mutex_unlock(&g_metrics_lock);
+	}
+}
+
+void monitor::MetricsExporter::setDimmHealth(const std::string &guidStr,
+		enum device_health health)
+{
+	if (isEnabled())
+	{
+		mutex_lock(&g_metrics_lock);
+		DimmMetrics &dimm = getDimm(guidStr);
+		dimm.hasHealth = true;
+		dimm.health = health;
+		mutex_unlock(&g_metrics_lock);
+	}
+}
+
+void monitor::MetricsExporter::setDimmSensors(const std::string &guidStr,
+		const struct sensor sensors[NVM_MAX_DEVICE_SENSORS])
+{
+	if (isEnabled())
+	{
+		mutex_lock(&g_metrics_lock);
+		DimmMetrics &dimm = getDimm(guidStr);
+		dimm.hasSensors = true;
+		memmove(dimm.sensors, sensors, sizeof (dimm.sensors));
+		mutex_unlock(&g_metrics_lock);
+	}
+}
+
+void monitor::MetricsExporter::setDimmPerformance(const std::string &guidStr,
+		const struct device_performance &performance)
+{
+	if (isEnabled())
+	{
+		mutex_lock(&g_metrics_lock);
+		DimmMetrics &dimm = getDimm(guidStr);
+		dimm.hasPerformance = true;
+		dimm.performance = performance;
+		mutex_unlock(&g_metrics_lock);
+	}
+}
+
+void monitor::MetricsExporter::setMonitorPass(const std::string &monitorName,
+		unsigned long long durationMsec, unsigned long long endTimeMsec)
+{
+	if (isEnabled())
+	{
+		mutex_lock(&g_metrics_lock);
+		MonitorMetricsMap::iterator iter = m_monitors.find(monitorName);
+		if (iter == m_monitors.end())
+		{
+			MonitorMetrics metrics;
+			memset(&metrics, 0, sizeof (metrics));
+			iter = m_monitors.insert(std::make_pair(monitorName, metrics)).first;
+		}
+		iter->second.passes++;
+		iter->second.lastDurationMsec = durationMsec;
+		iter->second.totalDurationMsec += durationMsec;
+		iter->second.lastPassTimeMsec = endTimeMsec;
+		mutex_unlock(&g_metrics_lock);
+	}
+}
+
+std::string monitor::MetricsExporter::render()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	std::ostringstream out;
+
+	mutex_lock(&g_metrics_lock);
+
+	writeMetricHeader(out, "dimm_info", "gauge",
+			"Device handle of each monitored DIMM.");
+	for (DimmMetricsMap::const_iterator iter = m_dimms.begin();
+			iter != m_dimms.end(); iter++)
+	{
+		if (iter->second.hasHandle)
+		{
+			out << METRICS_PREFIX << "dimm_info{dimm_guid=\"" << iter->first
+					<< "\",dimm_handle=\"" << iter->second.handle << "\"} 1\n";
+		}
+	}
+
+	writeMetricHeader(out, "health_state", "gauge",
+			"Overall DIMM health (0=unknown, 5=normal, 15=noncritical, 25=critical, 30=fatal).");
+	for (DimmMetricsMap::const_iterator iter = m_dimms.begin();
+			iter != m_dimms.end(); iter++)
+	{
+		if (iter->second.hasHealth)
+		{
+			out << METRICS_PREFIX << "health_state{dimm_guid=\"" << iter->first
+					<< "\"} " << (int)iter->second.health << "\n";
+		}
+	}
+
+	writeMetricHeader(out, "sensor_reading", "gauge",
+			"Current reading of each DIMM health sensor.");
+	for (DimmMetricsMap::const_iterator iter = m_dimms.begin();
+			iter != m_dimms.end(); iter++)
+	{
+		if (iter->second.hasSensors)
+		{
+			for (int s = 0; s < NVM_MAX_DEVICE_SENSORS; s++)
+			{
+				out << METRICS_PREFIX << "sensor_reading{dimm_guid=\"" << iter->first
+						<< "\",sensor=\"" << SENSOR_LABELS[s] << "\"} "
+						<< iter->second.sensors[s].reading << "\n";
+			}
+		}
+	}
+
+	writeMetricHeader(out, "sensor_state", "gauge",
+			"Current state of each DIMM health sensor (0=unknown, 1=normal, 2=critical).");
+	for (DimmMetricsMap::const_iterator iter = m_dimms.begin();
+			iter != m_dimms.end(); iter++)
+	{
+		if (iter->second.hasSensors)
+		{
+			for (int s = 0; s < NVM_MAX_DEVICE_SENSORS; s++)
+			{
+				out << METRICS_PREFIX << "sensor_state{dimm_guid=\"" << iter->first
+						<< "\",sensor=\"" << SENSOR_LABELS[s] << "\"} "
+						<< (int)iter->second.sensors[s].current_state << "\n";
+			}
+		}
+	}
+
+	struct
+	{
+		const char *name;
+		const char *help;
+		NVM_UINT64 device_performance::*field;
+	} counters[] =
+	{
+		{"bytes_read_total", "Total bytes of data read from the DIMM.",
+				&device_performance::bytes_read},
+		{"bytes_written_total", "Total bytes of data written to the DIMM.",
+				&device_performance::bytes_written},
+		{"host_reads_total", "Lifetime number of read requests the DIMM serviced.",
+				&device_performance::host_reads},
+		{"host_writes_total", "Lifetime number of write requests the DIMM serviced.",
+				&device_performance::host_writes},
+		{"block_reads_total", "Lifetime number of block window read requests the DIMM serviced.",
+				&device_performance::block_reads},
+		{"block_writes_total", "Lifetime number of block window write requests the DIMM serviced.",
+				&device_performance::block_writes}
+	};
+	for (size_t c = 0; c < sizeof (counters) / sizeof (counters[0]); c++)
+	{
+		writeMetricHeader(out, counters[c].name, "counter", counters[c].help);
+		for (DimmMetricsMap::const_iterator iter = m_dimms.begin();
+				iter != m_dimms.end(); iter++)
+		{
+			if (iter->second.hasPerformance)
+			{
+				out << METRICS_PREFIX << counters[c].name << "{dimm_guid=\"" << iter->first
+						<< "\"} " << iter->second.performance.*counters[c].field << "\n";
+			}
+		}
+	}
+
+	writeMetricHeader(out, "performance_timestamp_seconds", "gauge",
+			"Time the DIMM performance counters were last read.");
+	for (DimmMetricsMap::const_iterator iter = m_dimms.begin();
+			iter != m_dimms.end(); iter++)
+	{
+		if (iter->second.hasPerformance)
+		{
+			out << METRICS_PREFIX << "performance_timestamp_seconds{dimm_guid=\""
+					<< iter->first << "\"} "
+					<< (unsigned long long)iter->second.performance.time << "\n";
+		}
+	}
+
+	writeMetricHeader(out, "monitor_passes_total", "counter",
+			"Number of completed passes of each monitor.");
+	for (MonitorMetricsMap::const_iterator iter = m_monitors.begin();
+			iter != m_monitors.end(); iter++)
+	{
+		out << METRICS_PREFIX << "monitor_passes_total{monitor=\"" << iter->first
+				<< "\"} " << iter->second.passes << "\n";
+	}
+
+	writeMetricHeader(out, "monitor_last_duration_seconds", "gauge",
+			"Duration of the most recent pass of each monitor.");
+	for (MonitorMetricsMap::const_iterator iter = m_monitors.begin();
+			iter != m_monitors.end(); iter++)
+	{
+		out << METRICS_PREFIX << "monitor_last_duration_seconds{monitor=\"" << iter->first
+				<< "\"} " << msecToSeconds(iter->second.lastDurationMsec) << "\n";
+	}
+
+	writeMetricHeader(out, "monitor_duration_seconds_total", "counter",
+			"Total time spent in passes of each monitor.");
+	for (MonitorMetricsMap::const_iterator iter = m_monitors.begin();
+			iter != m_monitors.end(); iter++)
+	{
+		out << METRICS_PREFIX << "monitor_duration_seconds_total{monitor=\"" << iter->first
+				<< "\"} " << msecToSeconds(iter->second.totalDurationMsec) << "\n";
+	}
+
+	writeMetricHeader(out, "monitor_last_pass_timestamp_seconds", "gauge",
+			"Time the most recent pass of each monitor completed.");
+	for (MonitorMetricsMap::const_iterator iter = m_monitors.begin();
+			iter != m_monitors.end(); iter++)
+	{
+		out << METRICS_PREFIX << "monitor_last_pass_timestamp_seconds{monitor=\""
+				<< iter->first << "\"} " << msecToSeconds(iter->second.lastPassTimeMsec) << "\n";
+	}
+
+	mutex_unlock(&g_metrics_lock);
+
+	return out.str();
+}
+
+void monitor::MetricsExporter::writeFile()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	if (!m_filePath.empty())
+	{
+		// serialize writers so the temporary file isn't shared between monitor threads
+		mutex_lock(&g_metrics_lock);
+
+		std::string metrics = render();
+
+		// write next to the target and rename over it so readers never see a partial file
+		std::string tmpPath = m_filePath + METRICS_TMP_SUFFIX;
+		FILE *pFile = fopen(tmpPath.c_str(), "w");
+		if (!pFile)
+		{
+			COMMON_LOG_ERROR_F("Failed to open metrics file %s", tmpPath.c_str());
+		}
+		else
+		{
+			size_t written = fwrite(metrics.c_str(), 1, metrics.size(), pFile);
+			int closeRc = fclose(pFile);
+			if (written != metrics.size() || closeRc != 0)
+			{
+				COMMON_LOG_ERROR_F("Failed to write metrics file %s", tmpPath.c_str());
+				remove(tmpPath.c_str());
+			}
+#ifdef __WINDOWS__
+			else if (!MoveFileExA(tmpPath.c_str(), m_filePath.c_str(), MOVEFILE_REPLACE_EXISTING))
+#else
+			else if (rename(tmpPath.c_str(), m_filePath.c_str()) != 0)
+#endif
+			{
+				COMMON_LOG_ERROR_F("Failed to replace metrics file %s", m_filePath.c_str());
+				remove(tmpPath.c_str());
+			}
+		}
+
+		mutex_unlock(&g_metrics_lock);
+	}
+}
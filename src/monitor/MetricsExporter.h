@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file contains the definition of the metrics exporter of the NvmMonitor
+ * service which publishes the latest values gathered by the monitors in the
+ * Prometheus text exposition format.
+ */
+
+#include <map>
+#include <string>
+#include <nvm_management.h>
+
+#ifndef _MONITOR_METRICSEXPORTER_H_
+#define _MONITOR_METRICSEXPORTER_H_
+
+namespace monitor
+{
+	/*
+	 * Holds the most recent per-DIMM values read by the monitors and the
+	 * timing of each monitor pass. The monitors push what they have already
+	 * retrieved so exporting never issues any additional firmware commands.
+	 */
+	class MetricsExporter
+	{
+		public:
+			/*
+			 * Get the process wide exporter. Call once before starting the
+			 * monitor threads.
+			 */
+			static MetricsExporter &getExporter();
+
+			/*
+			 * True if a metrics file or socket is configured
+			 */
+			bool isEnabled() const;
+
+			std::string const & getFilePath() const;
+			std::string const & getSocketPath() const;
+
+			void setDimmHandle(const std::string &guidStr, NVM_UINT32 handle);
+			void setDimmHealth(const std::string &guidStr, enum device_health health);
+			void setDimmSensors(const std::string &guidStr,
+					const struct sensor sensors[NVM_MAX_DEVICE_SENSORS]);
+			void setDimmPerformance(const std::string &guidStr,
+					const struct device_performance &performance);
+
+			/*
+			 * Record the duration and completion time of a monitor pass
+			 */
+			void setMonitorPass(const std::string &monitorName,
+					unsigned long long durationMsec, unsigned long long endTimeMsec);
+
+			/*
+			 * Format the current metrics in the Prometheus text format
+			 */
+			std::string render();
+
+			/*
+			 * Atomically replace the configured metrics file with the current metrics.
+			 * Does nothing if no file is configured.
+			 */
+			void writeFile();
+
+		private:
+			MetricsExporter();
+			~MetricsExporter();
+
+			// no copies of the singleton
+			MetricsExporter(const MetricsExporter &);
+			MetricsExporter &operator=(const MetricsExporter &);
+
+			struct DimmMetrics
+			{
+				bool hasHandle;
+				NVM_UINT32 handle;
+				bool hasHealth;
+				enum device_health health;
+				bool hasSensors;
+				struct sensor sensors[NVM_MAX_DEVICE_SENSORS];
+				bool hasPerformance;
+				struct device_performance performance;
+			};
+
+			struct MonitorMetrics
+			{
+				unsigned long long passes;
+				unsigned long long lastDurationMsec;
+				unsigned long long totalDurationMsec;
+				unsigned long long lastPassTimeMsec;
+			};
+
+			typedef std::map<std::string, DimmMetrics> DimmMetricsMap;
+			typedef std::map<std::string, MonitorMetrics> MonitorMetricsMap;
+
+			DimmMetrics &getDimm(const std::string &guidStr);
+
+			DimmMetricsMap m_dimms;
+			MonitorMetricsMap m_monitors;
+			std::string m_filePath;
+			std::string m_socketPath;
+	};
+}
+
+#endif /* _MONITOR_METRICSEXPORTER_H_ */
@@ -31,10 +31,18 @@
 
 
 #include <string>
+#ifdef __WINDOWS__
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
 #include <LogEnterExit.h>
+#include <time/time_utilities.h>
 #include "NvmMonitorBase.h"
+#include "MetricsExporter.h"
 #include "PerformanceMonitor.h"
 #include "EventMonitor.h"
+#include "JobMonitor.h"
 
 /*
  * Constructor
@@ -73,6 +81,9 @@ void monitor::NvmMonitorBase::getMonitors(std::vector<monitor::NvmMonitorBase *>
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
+	// create the exporter before any monitor thread can use it
+	MetricsExporter::getExporter();
+
 	EventMonitor *event = new EventMonitor();
 	if (event && event->isEnabled())
 	{
@@ -92,6 +103,49 @@ void monitor::NvmMonitorBase::getMonitors(std::vector<monitor::NvmMonitorBase *>
 	{
 		delete performance;
 	}
+
+	JobMonitor *job = new JobMonitor();
+	if (job && job->isEnabled())
+	{
+		monitors.push_back(job);
+	}
+	else
+	{
+		delete job;
+	}
+}
+
+/*
+ * Milliseconds from a monotonic clock, for timing monitor passes
+ */
+static unsigned long long getMonotonicMsec()
+{
+#ifdef __WINDOWS__
+	return (unsigned long long)GetTickCount64();
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((unsigned long long)now.tv_sec * 1000) + (now.tv_nsec / 1000000);
+#endif
+}
+
+void monitor::NvmMonitorBase::runMonitor()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	unsigned long long startTime = getMonotonicMsec();
+	monitor();
+	unsigned long long duration = getMonotonicMsec() - startTime;
+
+	unsigned long long endTime = 0;
+	get_current_time_msec(&endTime);
+
+	MetricsExporter &exporter = MetricsExporter::getExporter();
+	exporter.setMonitorPass(m_name, duration, endTime);
+	exporter.writeFile();
+
+	// the CLI reads the mailbox stats of this process from the published copy
+	nvm_publish_mailbox_stats();
 }
 
 /*
@@ -68,6 +68,12 @@ namespace monitor
 		virtual void monitor() = 0;
 		virtual void cleanup() {}
 
+		/*
+		 * Run a single monitor pass and publish its timing and results
+		 * through the metrics exporter
+		 */
+		void runMonitor();
+
 		std::string const & getName() const;
 
 		size_t getIntervalSeconds() const;
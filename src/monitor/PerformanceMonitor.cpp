@@ -33,6 +33,7 @@
 
 #include <string.h>
 #include "PerformanceMonitor.h"
+#include "MetricsExporter.h"
 #include <LogEnterExit.h>
 #include <guid/guid.h>
 #include <string/s_str.h>
@@ -93,10 +94,15 @@ void monitor::PerformanceMonitor::monitor()
 			COMMON_LOG_ERROR_F(
 				"Failed to retrieve the performance data for "NVM_DIMM_NAME" %s", dimmGuidStr.c_str());
 		}
-		// store it in the db
-		else if (storeDimmPerformanceData(dimmGuidStr, devPerformance))
+		else
 		{
-			performanceDataAdded = true;
+			MetricsExporter::getExporter().setDimmPerformance(dimmGuidStr, devPerformance);
+
+			// store it in the db
+			if (storeDimmPerformanceData(dimmGuidStr, devPerformance))
+			{
+				performanceDataAdded = true;
+			}
 		}
 	}
 
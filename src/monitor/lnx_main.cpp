@@ -35,19 +35,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <string.h>
 #include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/select.h>
 
 #include<pthread.h>
 #include <time.h>
 #include<signal.h>
 
 #include "NvmMonitorBase.h"
+#include "MetricsExporter.h"
 
 #define PID_FILE_NAME "/var/run/ixpdimm-monitor.pid"
 
 int setupDaemon();
 void signalHandler(int sigNum);
 void *worker(void *arg);
+int openMetricsSocket(const std::string &path);
+void *metricsServer(void *arg);
 
 // flag set when a signal is received to exit the service
 bool keepRunning = true;
@@ -81,6 +88,20 @@ int main(int argc, char **argv)
 			pthread_create(threads + t, NULL, &worker, (void *) (monitors[t]));
 		}
 
+		// optionally serve the latest metrics on a local socket
+		const std::string &socketPath =
+				monitor::MetricsExporter::getExporter().getSocketPath();
+		int metricsFd = -1;
+		pthread_t metricsThread;
+		if (!socketPath.empty())
+		{
+			metricsFd = openMetricsSocket(socketPath);
+			if (metricsFd >= 0)
+			{
+				pthread_create(&metricsThread, NULL, &metricsServer, (void *)&metricsFd);
+			}
+		}
+
 		while (keepRunning)
 		{
 			// Keep the process running until signaled to close
@@ -94,6 +115,13 @@ int main(int argc, char **argv)
 			pthread_join(threads[t], (void **)&i);
 		}
 
+		if (metricsFd >= 0)
+		{
+			pthread_join(metricsThread, NULL);
+			close(metricsFd);
+			unlink(socketPath.c_str());
+		}
+
 		// clean up
 		monitor::NvmMonitorBase::deleteMonitors(monitors);
 	}
@@ -140,7 +168,7 @@ void *worker(void *arg)
 
 		while (!timeToQuit(callback->getIntervalSeconds()))
 		{
-			callback->monitor();
+			callback->runMonitor();
 		}
 
 		callback->cleanup();
@@ -148,6 +176,76 @@ void *worker(void *arg)
 	return NULL;
 }
 
+/*
+ * Create a listening Unix domain socket at the given path
+ */
+int openMetricsSocket(const std::string &path)
+{
+	int fd = -1;
+
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof (addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() < sizeof (addr.sun_path))
+	{
+		memmove(addr.sun_path, path.c_str(), path.size());
+
+		// remove a socket left behind by a previous instance
+		unlink(path.c_str());
+
+		fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd >= 0 &&
+			(bind(fd, (struct sockaddr *)&addr, sizeof (addr)) != 0 ||
+			chmod(path.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP) != 0 ||
+			listen(fd, 8) != 0))
+		{
+			close(fd);
+			fd = -1;
+		}
+	}
+
+	return fd;
+}
+
+/*
+ * Metrics socket thread. Each connection is sent the current metrics and closed.
+ */
+void *metricsServer(void *arg)
+{
+	int fd = *(int *)arg;
+	while (keepRunning)
+	{
+		// wake up periodically to check if it's time to quit
+		fd_set readFds;
+		FD_ZERO(&readFds);
+		FD_SET(fd, &readFds);
+		struct timeval timeout;
+		timeout.tv_sec = 1;
+		timeout.tv_usec = 0;
+		if (select(fd + 1, &readFds, NULL, NULL, &timeout) > 0)
+		{
+			int client = accept(fd, NULL, NULL);
+			if (client >= 0)
+			{
+				std::string metrics = monitor::MetricsExporter::getExporter().render();
+				size_t offset = 0;
+				while (offset < metrics.size())
+				{
+					ssize_t sent = send(client, metrics.c_str() + offset,
+							metrics.size() - offset, MSG_NOSIGNAL);
+					if (sent <= 0)
+					{
+						break;
+					}
+					offset += sent;
+				}
+				close(client);
+			}
+		}
+	}
+	return NULL;
+}
+
 /*
  * Writes the PID to a given file
  */
@@ -247,7 +247,7 @@ DWORD WINAPI WorkerThread(LPVOID arg)
 		//  Wait for the service stop signal until it's time to run the monitor callback
 		while (WaitForSingleObject(g_serviceStopEvent, milliseconds) != WAIT_OBJECT_0)
 		{
-			pMonitor->monitor();
+			pMonitor->runMonitor();
 		}
 		pMonitor->cleanup();
 	}
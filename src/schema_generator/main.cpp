@@ -84,6 +84,9 @@ int main(int arg_count, char **args)
 	event.addAttribute("arg2").isText(1024);
 	event.addAttribute("arg3").isText(1024);
 	event.addAttribute("diag_result").isInt32().isUnsigned();
+	event.addIndex("time");
+	event.addIndex("guid").thenBy("time");
+	event.addIndex("type").thenBy("guid");
 	entities.push_back(event);
 
 	/*
@@ -696,6 +699,19 @@ int main(int arg_count, char **args)
 	boot_status_register.addAttribute("bsr").isInt64().isUnsigned();
 	entities.push_back(boot_status_register);
 
+	// Long running jobs (sanitize) started through the native API
+	Entity job("job", "Long running jobs started and tracked by the native API.");
+	job.addAttribute("device_handle").isInt32().isUnsigned().isPk();
+	job.addAttribute("device_guid").isText(37);
+	job.addAttribute("type").isInt32().isUnsigned();
+	job.addAttribute("status").isInt32().isUnsigned();
+	job.addAttribute("percent_complete").isInt32().isUnsigned();
+	job.addAttribute("requester").isText(256);
+	job.addAttribute("start_time").isInt64().isUnsigned();
+	job.addAttribute("last_update_time").isInt64().isUnsigned();
+	job.addAttribute("end_time").isInt64().isUnsigned();
+	entities.push_back(job);
+
 	if (arg_count == 3) // allows caller to pass where the templates are and where to put the files
 	{
 		CrudSchemaGenerator::Generate(entities, args[1], args[2]);
@@ -324,6 +324,11 @@ static std::string JOBSTATE_KEY = "JobState";
 static std::string PERCENTCOMPLETE_KEY = "PercentComplete";
 static std::string DELETEONCOMPLETION_KEY = "DeleteOnCompletion";
 static std::string TIMEBEFOREREMOVAL_KEY = "TimeBeforeRemoval";
+static std::string OWNER_KEY = "Owner";
+static std::string STARTTIME_KEY = "StartTime";
+static std::string ELAPSEDTIME_KEY = "ElapsedTime";
+static std::string TIMEOFLASTSTATECHANGE_KEY = "TimeOfLastStateChange";
+static std::string ESTIMATEDCOMPLETIONTIME_KEY = "EstimatedCompletionTime";
 static std::string NVM_JOB_TYPE_SANITIZE_NAME = "Sanitize Job";
 static std::string NVM_STATUS_OK = "OK";
 static std::string JOBTABLENAME = "JobTable";
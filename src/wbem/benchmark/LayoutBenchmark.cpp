@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Times the memory allocation layout engine against generated topologies.
+ * No hardware is touched: the allocator talks to a TopologyNvmApi.
+ *
+ * Usage: layout_benchmark [iterations]
+ */
+
+#include <logic/MemoryAllocator.h>
+#include <logic/TopologyNvmApi.h>
+#include <logic/MemoryAllocationUtil.h>
+#include <common_types.h>
+#include <libintelnvm-cim/Exception.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <time.h>
+#include <vector>
+
+#define	DEFAULT_ITERATIONS	1000
+
+static const NVM_UINT16 SOCKET_COUNTS[] = {1, 2, 4, 8};
+static const NVM_UINT16 DIMMS_PER_SOCKET_COUNTS[] = {1, 2, 3, 4, 6};
+static const NVM_UINT64 DIMM_CAPACITIES_GIB[] = {128, 256, 512};
+
+// every allocation made while a layout is timed is counted
+static unsigned long long g_allocationCount = 0;
+
+void *operator new(size_t size) throw (std::bad_alloc)
+{
+	g_allocationCount++;
+	void *p = malloc(size ? size : 1);
+	if (!p)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void *p) throw ()
+{
+	free(p);
+}
+
+struct Topology
+{
+	struct nvm_capabilities capabilities;
+	std::vector<struct device_discovery> devices;
+	NVM_UINT16 socketCount;
+};
+
+static void generateCapabilities(struct nvm_capabilities &capabilities)
+{
+	memset(&capabilities, 0, sizeof (capabilities));
+	capabilities.nvm_features.modify_device_capacity = 1;
+	capabilities.nvm_features.memory_mode = 1;
+	capabilities.nvm_features.app_direct_mode = 1;
+	capabilities.nvm_features.storage_mode = 1;
+	capabilities.sku_capabilities.memory_sku = 1;
+	capabilities.sku_capabilities.app_direct_sku = 1;
+	capabilities.sku_capabilities.storage_sku = 1;
+
+	struct platform_capabilities &platform = capabilities.platform_capabilities;
+	platform.current_volatile_mode = VOLATILE_MODE_AUTO;
+	platform.storage_mode_supported = 1;
+	platform.memory_mode.supported = 1;
+	platform.app_direct_mode.supported = 1;
+
+	const enum interleave_ways ways[] =
+	{
+		INTERLEAVE_WAYS_1, INTERLEAVE_WAYS_2, INTERLEAVE_WAYS_3,
+		INTERLEAVE_WAYS_4, INTERLEAVE_WAYS_6
+	};
+	for (size_t i = 0; i < sizeof (ways) / sizeof (ways[0]); i++)
+	{
+		struct interleave_format &format = platform.app_direct_mode.interleave_formats[i];
+		format.ways = ways[i];
+		format.imc = INTERLEAVE_SIZE_4KB;
+		format.channel = INTERLEAVE_SIZE_256B;
+		format.recommended = 1;
+		platform.app_direct_mode.interleave_formats_count++;
+	}
+}
+
+/*
+ * Sockets are populated identically, filling one slot per channel. Capacities
+ * vary by slot so the layouts aren't all symmetrical.
+ */
+static void generateTopology(const NVM_UINT16 socketCount, const NVM_UINT16 dimmsPerSocket,
+		Topology &topology)
+{
+	generateCapabilities(topology.capabilities);
+	topology.devices.clear();
+	topology.socketCount = socketCount;
+
+	const size_t capacityCount = sizeof (DIMM_CAPACITIES_GIB) / sizeof (DIMM_CAPACITIES_GIB[0]);
+	for (NVM_UINT16 socket = 0; socket < socketCount; socket++)
+	{
+		for (NVM_UINT16 slot = 0; slot < dimmsPerSocket; slot++)
+		{
+			struct device_discovery device;
+			memset(&device, 0, sizeof (device));
+			device.socket_id = socket;
+			device.memory_controller_id = slot % wbem::logic::IMCS_PER_SOCKET;
+			device.channel_id = slot / wbem::logic::IMCS_PER_SOCKET;
+			device.device_handle.parts.socket_id = device.socket_id;
+			device.device_handle.parts.memory_controller_id = device.memory_controller_id;
+			device.device_handle.parts.mem_channel_id = device.channel_id;
+			device.capacity = DIMM_CAPACITIES_GIB[slot % capacityCount] * BYTES_PER_GB;
+			device.manageability = MANAGEMENT_VALIDCONFIG;
+			device.lock_state = LOCK_STATE_DISABLED;
+			device.guid[0] = (unsigned char)socket;
+			device.guid[1] = (unsigned char)slot;
+			topology.devices.push_back(device);
+		}
+	}
+}
+
+static unsigned long long getTimeNsec()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+/*
+ * Half of the capacity in Memory Mode, the rest interleaved App Direct
+ */
+static struct wbem::logic::MemoryAllocationRequest getRequest(const Topology &topology)
+{
+	struct wbem::logic::MemoryAllocationRequest request;
+	NVM_UINT64 totalGiB = 0;
+	for (std::vector<struct device_discovery>::const_iterator iter = topology.devices.begin();
+			iter != topology.devices.end(); iter++)
+	{
+		request.dimms.push_back(wbem::logic::MemoryAllocationUtil::deviceDiscoveryToDimm(*iter));
+		totalGiB += iter->capacity / BYTES_PER_GB;
+	}
+	request.memoryCapacity = totalGiB / 2;
+
+	struct wbem::logic::AppDirectExtent appDirect;
+	appDirect.capacity = wbem::logic::REQUEST_REMAINING_CAPACITY;
+	request.appDirectExtents.push_back(appDirect);
+
+	return request;
+}
+
+static void runBenchmark(const Topology &topology, const NVM_UINT16 dimmsPerSocket,
+		const int iterations)
+{
+	wbem::logic::TopologyNvmApi api(topology.capabilities, topology.devices,
+			topology.socketCount);
+	wbem::logic::MemoryAllocator allocator(topology.capabilities, topology.devices,
+			std::vector<struct pool>(), topology.socketCount, &api);
+	struct wbem::logic::MemoryAllocationRequest request = getRequest(topology);
+
+	std::vector<unsigned long long> times;
+	times.reserve(iterations);
+	unsigned long long allocations = 0;
+	int failures = 0;
+	for (int i = 0; i < iterations; i++)
+	{
+		unsigned long long startAllocations = g_allocationCount;
+		unsigned long long start = getTimeNsec();
+		try
+		{
+			wbem::logic::MemoryAllocationLayout layout = allocator.layout(request);
+		}
+		catch (wbem::framework::Exception &)
+		{
+			failures++;
+		}
+		times.push_back(getTimeNsec() - start);
+		allocations += g_allocationCount - startAllocations;
+	}
+
+	std::sort(times.begin(), times.end());
+	printf("%7u %12u %10.1f %10.1f %14llu %9d\n",
+			topology.socketCount, dimmsPerSocket,
+			times[times.size() / 2] / 1000.0,
+			times[(times.size() * 99) / 100] / 1000.0,
+			allocations / iterations,
+			failures);
+}
+
+int main(int argc, char *argv[])
+{
+	int iterations = DEFAULT_ITERATIONS;
+	if (argc > 1)
+	{
+		iterations = atoi(argv[1]);
+	}
+	if (iterations <= 0)
+	{
+		fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	printf("%7s %12s %10s %10s %14s %9s\n",
+			"Sockets", "DIMMs/Socket", "p50 (us)", "p99 (us)", "Allocs/Layout", "Failures");
+	for (size_t s = 0; s < sizeof (SOCKET_COUNTS) / sizeof (SOCKET_COUNTS[0]); s++)
+	{
+		for (size_t d = 0; d < sizeof (DIMMS_PER_SOCKET_COUNTS) / sizeof (DIMMS_PER_SOCKET_COUNTS[0]); d++)
+		{
+			Topology topology;
+			generateTopology(SOCKET_COUNTS[s], DIMMS_PER_SOCKET_COUNTS[d], topology);
+			runBenchmark(topology, DIMMS_PER_SOCKET_COUNTS[d], iterations);
+		}
+	}
+
+	return 0;
+}
@@ -43,6 +43,7 @@
 #include <exception/NvmExceptionLibError.h>
 #include <NvmStrings.h>
 #include "ErasureCapabilitiesFactory.h"
+#include <lib_interface/NvmApi.h>
 
 
 wbem::erasure::ErasureServiceFactory::ErasureServiceFactory()
@@ -302,9 +303,41 @@ void wbem::erasure::ErasureServiceFactory::eraseDevice(std::string password,
 		enum wbem::erasure::eraseType eraseType)
 throw (framework::Exception)
 {
-	std::vector<std::string> devices = m_GetManageableDeviceGuids();
-	for (size_t i = 0; i < devices.size(); i++)
+	std::vector<struct device_erase_result> results = eraseAllDevices(password, eraseType);
+	for (size_t i = 0; i < results.size(); i++)
 	{
-		eraseDevice(devices[i], password, eraseType);
+		if (results[i].rc != NVM_SUCCESS)
+		{
+			throw exception::NvmExceptionLibError(results[i].rc);
+		}
+	}
+}
+
+std::vector<struct device_erase_result> wbem::erasure::ErasureServiceFactory::eraseAllDevices(
+		std::string password, enum wbem::erasure::eraseType eraseType)
+throw (framework::Exception)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	lib_interface::NvmApi *pApi = lib_interface::NvmApi::getApi();
+	std::vector<struct device_erase_result> results;
+
+	int rc = pApi->getDeviceCount();
+	if (rc < 0)
+	{
+		throw exception::NvmExceptionLibError(rc);
 	}
+	else if (rc > 0)
+	{
+		results.resize(rc);
+		rc = pApi->eraseDevices((enum erase_type)eraseType, password.c_str(), password.length(),
+				&results.front(), results.size());
+		if (rc < 0)
+		{
+			throw exception::NvmExceptionLibError(rc);
+		}
+		results.resize(rc);
+	}
+
+	return results;
 }
@@ -133,6 +133,17 @@ class NVM_API ErasureServiceFactory : public framework_interface::NvmInstanceFac
 				enum wbem::erasure::eraseType eraseType)
 				throw (framework::Exception);
 
+		/*!
+		 * Secure erase all manageable devices on system at once
+		 * @param password
+		 * 		Password to the devices
+		 * @return
+		 * 		The outcome of starting the erase on each device
+		 */
+		std::vector<struct device_erase_result> eraseAllDevices(std::string password,
+				enum wbem::erasure::eraseType eraseType)
+				throw (framework::Exception);
+
 		/*!
 		 * API indirection
 		 * @param device_guid
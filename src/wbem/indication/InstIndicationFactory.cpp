@@ -38,9 +38,18 @@
 #include <physical_asset/NVDIMMFactory.h>
 #include <LogEnterExit.h>
 #include <support/NVDIMMSensorFactory.h>
+#include <persistence/config_settings.h>
+#include <persistence/lib_persistence.h>
+#include <guid/guid.h>
 
 #include "InstIndicationFactory.h"
 
+std::map<wbem::indication::sensor_key_t, enum sensor_status>
+	wbem::indication::InstIndicationFactory::m_sensorStates;
+std::map<wbem::indication::sensor_key_t, std::pair<time_t, enum sensor_status> >
+	wbem::indication::InstIndicationFactory::m_lastSensorIndications;
+int wbem::indication::InstIndicationFactory::m_coalesceWindow = -1;
+
 wbem::framework::Instance *wbem::indication::InstIndicationFactory::createIndication(
 		struct event *pEvent)
 throw(framework::Exception)
@@ -190,6 +199,8 @@ wbem::framework::Instance *wbem::indication::InstIndicationFactory::createDevice
 	nvdimmFactory.createPathFromGuid(pEvent->guid, path);
 	framework::Instance *pSourceInstance  = NULL;
 	std::string className;
+	// InstCreation carries the created instance, like namespace creation does. A DIMM
+	// is only added on a topology change, so this isn't read on a frequent path.
 	if (isDeviceCreation(pEvent))
 	{
 		physical_asset::NVDIMMFactory dimmFactory;
@@ -201,6 +212,7 @@ wbem::framework::Instance *wbem::indication::InstIndicationFactory::createDevice
 	{
 		className = INSTDELETION_CLASSNAME;
 		pSourceInstance = new framework::Instance(path);
+		clearSensorStates(pEvent->args[0]);
 	}
 
 	if (pSourceInstance)
@@ -257,28 +269,69 @@ wbem::framework::Instance *wbem::indication::InstIndicationFactory::createSensor
 		event *pEvent)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
-	wbem::support::NVDIMMSensorFactory factory;
 	framework::Instance *pResult = NULL;
 
 	std::string dimmGuid(pEvent->args[0]);
 	enum sensor_type sensorType;
 	if (canGetEventSensorType(pEvent, &sensorType))
 	{
-		// need sensor path to get sensor instances for the indication
-		framework::ObjectPath sensorPath = factory.getSensorPath(
-				sensorType, server::getHostName(), dimmGuid);
-		framework::attribute_names_t attributes;
-		attributes.push_back(CURRENTSTATE_KEY);
-		framework::Instance *pSourceInstance = factory.getInstance(sensorPath, attributes);
-		framework::Instance *pPreviousInstance = factory.getInstance(sensorPath, attributes);
-		changeCurrentStateToPrevious(pPreviousInstance);
-
-		framework::STR_LIST changedProps;
-		changedProps.push_back(CURRENTSTATE_KEY);
+		sensor_key_t sensorKey(dimmGuid, (int)sensorType);
+
+		// the state before the event is the last state seen for the sensor
+		std::map<sensor_key_t, enum sensor_status>::iterator previous =
+				m_sensorStates.find(sensorKey);
+		bool previousKnown = (previous != m_sensorStates.end());
+		enum sensor_status previousState = previousKnown ? previous->second : SENSOR_UNKNOWN;
+
+		// the state after the event comes from the event itself when it can
+		enum sensor_status currentState = SENSOR_UNKNOWN;
+		bool coalesced = false;
+		if (canGetEventSensorState(pEvent, &currentState))
+		{
+			coalesced = isCoalesced(sensorKey, pEvent->time, currentState);
+		}
+		// otherwise, e.g. for new media errors or an unsafe shutdown, the sensor is only
+		// read when the event isn't merged into the last indication of the known state
+		else if (previousKnown && isCoalesced(sensorKey, pEvent->time, previousState))
+		{
+			currentState = previousState;
+			coalesced = true;
+		}
+		else
+		{
+			if (!readSensorState(dimmGuid, sensorType, &currentState))
+			{
+				currentState = previousState;
+			}
+			coalesced = isCoalesced(sensorKey, pEvent->time, currentState);
+		}
+		m_sensorStates[sensorKey] = currentState;
 
+		if (!previousKnown)
+		{
+			previousState = guessPreviousState(currentState);
+		}
 
-		pResult = createIndicationInstance(INSTMODIFICATION_CLASSNAME, (COMMON_UINT64)pEvent->time,
-				&sensorPath, pSourceInstance, pPreviousInstance, &changedProps);
+		if (!coalesced)
+		{
+			m_lastSensorIndications[sensorKey] = std::make_pair(pEvent->time, currentState);
+
+			// need sensor path to get sensor instances for the indication
+			framework::ObjectPath sensorPath = support::NVDIMMSensorFactory::getSensorPath(
+					sensorType, server::getHostName(), dimmGuid);
+			framework::Instance *pSourceInstance = createSensorInstance(sensorPath, currentState);
+			framework::Instance *pPreviousInstance =
+					createSensorInstance(sensorPath, previousState);
+
+			framework::STR_LIST changedProps;
+			changedProps.push_back(CURRENTSTATE_KEY);
+
+			pResult = createIndicationInstance(INSTMODIFICATION_CLASSNAME,
+					(COMMON_UINT64)pEvent->time,
+					&sensorPath, pSourceInstance, pPreviousInstance, &changedProps);
+			delete pSourceInstance;
+			delete pPreviousInstance;
+		}
 	}
 
 	return pResult;
@@ -350,20 +403,121 @@ bool wbem::indication::InstIndicationFactory::canGetEventSensorType(const struct
 	return eventCodeIsSensor;
 }
 
-void wbem::indication::InstIndicationFactory::changeCurrentStateToPrevious(
-		framework::Instance* pPreviousInstance)
+bool wbem::indication::InstIndicationFactory::canGetEventSensorState(const struct event *pEvent,
+		enum sensor_status *pSensorState)
 {
-	std::string normalState = support::NVDIMMSensorFactory::getSensorStateStr(SENSOR_NORMAL);
-	std::string criticalState = support::NVDIMMSensorFactory::getSensorStateStr(SENSOR_CRITICAL);
+	bool eventCodeHasState = true;
+	enum sensor_status sensorState = SENSOR_UNKNOWN;
+	switch(pEvent->code)
+	{
+	case EVENT_CODE_HEALTH_LOW_SPARE_CAPACITY:
+	case EVENT_CODE_HEALTH_MEDIA_TEMPERATURE_OVER_THRESHOLD:
+	case EVENT_CODE_HEALTH_CONTROLLER_TEMPERATURE_OVER_THRESHOLD:
+	case EVENT_CODE_HEALTH_HIGH_WEARLEVEL:
+		sensorState = SENSOR_CRITICAL;
+		break;
+	case EVENT_CODE_HEALTH_MEDIA_TEMPERATURE_UNDER_THRESHOLD:
+	case EVENT_CODE_HEALTH_CONTROLLER_TEMPERATURE_UNDER_THRESHOLD:
+		sensorState = SENSOR_NORMAL;
+		break;
+	default:
+		eventCodeHasState = false;
+		break;
+	}
+
+	if (pSensorState != NULL)
+	{
+		*pSensorState = sensorState;
+	}
 
-	framework::Attribute currentStateAttribute;
-	pPreviousInstance->getAttribute(CURRENTSTATE_KEY, currentStateAttribute);
-	std::string currentState = currentStateAttribute.stringValue();
+	return eventCodeHasState;
+}
 
+bool wbem::indication::InstIndicationFactory::readSensorState(const std::string &dimmGuid,
+		const enum sensor_type sensorType, enum sensor_status *pSensorState)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	NVM_GUID guid;
+	str_to_guid(dimmGuid.c_str(), guid);
+	struct sensor sensor;
+	int rc = nvm_get_sensor(guid, sensorType, &sensor);
+	if (rc != NVM_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("Failed to read sensor %d of DIMM %s, rc = %d",
+				(int)sensorType, dimmGuid.c_str(), rc);
+	}
+	else
+	{
+		*pSensorState = sensor.current_state;
+	}
+	return rc == NVM_SUCCESS;
+}
+
+void wbem::indication::InstIndicationFactory::clearSensorStates(const std::string &dimmGuid)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	// keys are ordered by DIMM GUID first so all sensors of the DIMM are adjacent
+	sensor_key_t firstKey(dimmGuid, 0);
+	std::map<sensor_key_t, enum sensor_status>::iterator state =
+			m_sensorStates.lower_bound(firstKey);
+	while (state != m_sensorStates.end() && state->first.first == dimmGuid)
+	{
+		m_sensorStates.erase(state++);
+	}
+	std::map<sensor_key_t, std::pair<time_t, enum sensor_status> >::iterator lastIndication =
+			m_lastSensorIndications.lower_bound(firstKey);
+	while (lastIndication != m_lastSensorIndications.end() &&
+			lastIndication->first.first == dimmGuid)
+	{
+		m_lastSensorIndications.erase(lastIndication++);
+	}
+}
+
+bool wbem::indication::InstIndicationFactory::isCoalesced(const sensor_key_t &sensorKey,
+		const time_t eventTime, const enum sensor_status state)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	bool coalesced = false;
+
+	// read once, the window doesn't change while the provider is loaded
+	if (m_coalesceWindow < 0 &&
+			get_config_value_int(SQL_KEY_INDICATION_COALESCE_SECONDS, &m_coalesceWindow)
+				!= COMMON_SUCCESS)
+	{
+		m_coalesceWindow = 0;
+	}
+	int window = m_coalesceWindow;
+
+	std::map<sensor_key_t, std::pair<time_t, enum sensor_status> >::iterator lastIndication =
+			m_lastSensorIndications.find(sensorKey);
+	if (window > 0 && lastIndication != m_lastSensorIndications.end() &&
+			lastIndication->second.second == state &&
+			eventTime >= lastIndication->second.first &&
+			eventTime - lastIndication->second.first < window)
+	{
+		COMMON_LOG_DEBUG_F("Merging indication for sensor %d of DIMM %s into the last one",
+				sensorKey.second, sensorKey.first.c_str());
+		coalesced = true;
+	}
+
+	return coalesced;
+}
+
+wbem::framework::Instance *wbem::indication::InstIndicationFactory::createSensorInstance(
+		framework::ObjectPath &sensorPath, const enum sensor_status state)
+{
+	framework::Instance *pInstance = new framework::Instance(sensorPath);
+	pInstance->setAttribute(CURRENTSTATE_KEY,
+			framework::Attribute(support::NVDIMMSensorFactory::getSensorStateStr(state), false));
+	return pInstance;
+}
+
+enum sensor_status wbem::indication::InstIndicationFactory::guessPreviousState(
+		const enum sensor_status currentState)
+{
 	// don't actually know previous state, but because Sensor can really only be in normal
 	// or critical states, going to make an educated guess.
-	std::string prevState = currentState == normalState ? criticalState : normalState;
-
-	pPreviousInstance->setAttribute(CURRENTSTATE_KEY,
-			framework::Attribute(prevState, false));
+	return currentState == SENSOR_NORMAL ? SENSOR_CRITICAL : SENSOR_NORMAL;
 }
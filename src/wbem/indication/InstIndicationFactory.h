@@ -37,6 +37,8 @@
 #define _WBEM_INDICATION_INSTINDICATION_FACTORY_H_
 
 #include "NvmIndicationFactory.h"
+#include <map>
+#include <utility>
 #include <libintelnvm-cim/ObjectPath.h>
 #include <libintelnvm-cim/Types.h>
 #include <NvmStrings.h>
@@ -65,6 +67,11 @@ static const std::string SOURCEINSTANCE = SOURCEINSTANCE_KEY;
 #endif
 
 
+/*!
+ * Identifies a sensor on a DIMM by DIMM GUID and sensor type
+ */
+typedef std::pair<std::string, int> sensor_key_t;
+
 class NVM_API InstIndicationFactory : public NvmIndicationFactory
 {
 public:
@@ -117,6 +124,34 @@ private:
 	 * Returns true if the event code is not related to a sensor.
 	 */
 	bool canGetEventSensorType(const struct event *pEvent, enum sensor_type *pSensorType);
+
+	/*!
+	 * Get the sensor state reported by the event.
+	 * Returns false if the event code doesn't imply a state, e.g. new media errors.
+	 */
+	bool canGetEventSensorState(const struct event *pEvent, enum sensor_status *pSensorState);
+
+	/*!
+	 * Read the current state of one sensor of a DIMM.
+	 * Returns false if the sensor couldn't be read.
+	 */
+	bool readSensorState(const std::string &dimmGuid, const enum sensor_type sensorType,
+			enum sensor_status *pSensorState);
+
+	/*!
+	 * Forget the sensor states of a DIMM that is no longer present
+	 */
+	void clearSensorStates(const std::string &dimmGuid);
+
+	/*!
+	 * Check if a sensor indication repeats the state of the last indication sent for the
+	 * same sensor within the coalescing window, in which case it is merged into that one.
+	 * A change of state implied by the event is never merged. The caller records the
+	 * indications it sends. The window is read from the config once per process.
+	 */
+	bool isCoalesced(const sensor_key_t &sensorKey, const time_t eventTime,
+			const enum sensor_status state);
+
 	/*!
 	 * Construct an Instance of an InstModification/InstCreation/InstDeletion indication
 	 */
@@ -143,8 +178,23 @@ private:
 	 */
 	framework::Instance *createSensorIndication(event *pEvent);
 
-	void changeCurrentStateToPrevious(framework::Instance *pPreviousInstance);
+	/*!
+	 * Construct a sensor Instance carrying only its current state
+	 */
+	framework::Instance *createSensorInstance(framework::ObjectPath &sensorPath,
+			const enum sensor_status state);
 
+	/*!
+	 * Guess the state of a sensor before the event when it was never seen before
+	 */
+	enum sensor_status guessPreviousState(const enum sensor_status currentState);
+
+	// Indications are created on the single event polling thread, and a factory
+	// is created per event, so the last known state is kept across instances.
+	static std::map<sensor_key_t, enum sensor_status> m_sensorStates;
+	static std::map<sensor_key_t, std::pair<time_t, enum sensor_status> > m_lastSensorIndications;
+	// coalescing window in seconds, -1 until read from the config
+	static int m_coalesceWindow;
 };
 
 };
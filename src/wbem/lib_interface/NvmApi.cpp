@@ -85,7 +85,11 @@ NvmApi::NvmApi()
 
 NvmApi::~NvmApi()
 {
-	m_pSingleton = NULL;
+	// subclasses standing in for the library must not release the singleton
+	if (m_pSingleton == this)
+	{
+		m_pSingleton = NULL;
+	}
 }
 
 NvmApi* NvmApi::getApi()
@@ -247,6 +251,13 @@ int NvmApi::eraseDevice(const NVM_GUID deviceGuid, const erase_type type, const
 	return nvm_erase_device(deviceGuid, type, passphrase, passphraseLen);
 }
 
+int NvmApi::eraseDevices(const erase_type type, const NVM_PASSPHRASE passphrase,
+				const NVM_SIZE passphraseLen, struct device_erase_result *pResults,
+				const NVM_UINT32 count)
+{
+	return nvm_erase_devices(type, passphrase, passphraseLen, pResults, count);
+}
+
 int NvmApi::getJobCount()
 {
 	return nvm_get_job_count();
@@ -283,6 +294,11 @@ int NvmApi::createConfigGoal(const NVM_GUID deviceGuid, struct config_goal *pGoa
 	return nvm_create_config_goal(deviceGuid, pGoal);
 }
 
+int NvmApi::createConfigGoals(struct device_config_goal *pGoals, const NVM_UINT32 count)
+{
+	return nvm_create_config_goals(pGoals, count);
+}
+
 int NvmApi::getConfigGoal(const NVM_GUID deviceGuid, struct config_goal *pGoal)
 {
 	return nvm_get_config_goal(deviceGuid, pGoal);
@@ -332,6 +348,12 @@ int NvmApi::createNamespace(NVM_GUID *pNamespaceGuid, const NVM_GUID poolGuid,
 	return nvm_create_namespace(pNamespaceGuid, poolGuid, pSettings, pFormat, allowAdjustment);
 }
 
+int NvmApi::createNamespaces(struct namespace_create_request *pRequests,
+		const NVM_UINT32 count)
+{
+	return nvm_create_namespaces(pRequests, count);
+}
+
 int NvmApi::modifyNamespaceName(const NVM_GUID namespaceGuid, const NVM_NAMESPACE_NAME name)
 {
 	return nvm_modify_namespace_name(namespaceGuid, name);
@@ -190,6 +190,13 @@ class NVM_API NvmApi
 		virtual int eraseDevice(const NVM_GUID deviceGuid, const erase_type type, const NVM_PASSPHRASE passphrase,
 				const NVM_SIZE passphraseLen);
 
+		/*
+		 * Erase persistent data on every manageable NVM-DIMM at once
+		 */
+		virtual int eraseDevices(const erase_type type, const NVM_PASSPHRASE passphrase,
+				const NVM_SIZE passphraseLen, struct device_erase_result *pResults,
+				const NVM_UINT32 count);
+
 		/*
 		 * Return the number of currently running jobs
 		 */
@@ -227,6 +234,11 @@ class NVM_API NvmApi
 		 */
 		virtual int createConfigGoal(const NVM_GUID deviceGuid, struct config_goal *pGoal);
 
+		/*
+		 * Create the config goals on several NVM-DIMMs, undoing all of them on failure
+		 */
+		virtual int createConfigGoals(struct device_config_goal *pGoals, const NVM_UINT32 count);
+
 		/*
 		 * Retrieve the configuration goal from the specified NVM-DIMM
 		 */
@@ -276,6 +288,12 @@ class NVM_API NvmApi
 				struct namespace_create_settings *pSettings, const struct interleave_format *pFormat,
 				const NVM_BOOL allowAdjustment);
 
+		/*
+		 * Create several namespaces, validated against one pool snapshot
+		 */
+		virtual int createNamespaces(struct namespace_create_request *pRequests,
+				const NVM_UINT32 count);
+
 		/*
 		 * Change the friendly name of a specified namespace
 		 */
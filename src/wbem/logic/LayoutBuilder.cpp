@@ -66,7 +66,16 @@ wbem::logic::MemoryAllocationLayout wbem::logic::LayoutBuilder::build(
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
-	populateAllLayoutStepsForRequest(request);
+	return build(request, LayoutConstraints());
+}
+
+wbem::logic::MemoryAllocationLayout wbem::logic::LayoutBuilder::build(
+		const MemoryAllocationRequest& request,
+		const LayoutConstraints &constraints)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	populateAllLayoutStepsForRequest(request, constraints);
 
 	MemoryAllocationLayout layout;
 	initLayoutGoals(request, layout);
@@ -87,13 +96,14 @@ wbem::logic::MemoryAllocationLayout wbem::logic::LayoutBuilder::build(
 	return layout;
 }
 
-void wbem::logic::LayoutBuilder::populateAllLayoutStepsForRequest(const MemoryAllocationRequest& request)
+void wbem::logic::LayoutBuilder::populateAllLayoutStepsForRequest(const MemoryAllocationRequest& request,
+		const LayoutConstraints &constraints)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
 	deleteLayoutSteps();
 	populateWarningGeneratingLayoutSteps();
-	populateOrderedLayoutStepsForRequest(request);
+	populateOrderedLayoutStepsForRequest(request, constraints);
 }
 
 void wbem::logic::LayoutBuilder::populateWarningGeneratingLayoutSteps()
@@ -108,12 +118,13 @@ void wbem::logic::LayoutBuilder::populateWarningGeneratingLayoutSteps()
 }
 
 void wbem::logic::LayoutBuilder::populateOrderedLayoutStepsForRequest(
-		const MemoryAllocationRequest& request)
+		const MemoryAllocationRequest& request,
+		const LayoutConstraints &constraints)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
 	// Reserve a DIMM before we get started laying out other capacity
-	m_layoutSteps.push_back(new LayoutStepReserveDimm());
+	m_layoutSteps.push_back(new LayoutStepReserveDimm(constraints.reserveDimmGuid));
 
 	// Any capacity marked REMAINING must go last (but before storage)
 	LayoutStep *pRemainingStep = NULL;
@@ -130,7 +141,8 @@ void wbem::logic::LayoutBuilder::populateOrderedLayoutStepsForRequest(
 
 	for (size_t i = 0; i < request.appDirectExtents.size(); i++)
 	{
-		LayoutStep *pAppDirect = new LayoutStepAppDirect(m_systemCapabilities, (int)i, m_pLibApi);
+		LayoutStep *pAppDirect = new LayoutStepAppDirect(m_systemCapabilities, (int)i, m_pLibApi,
+				constraints.maxInterleaveWaysBySocket);
 		if (pAppDirect->isRemainingStep(request))
 		{
 			pRemainingStep = pAppDirect;
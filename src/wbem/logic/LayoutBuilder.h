@@ -50,13 +50,17 @@ class NVM_API LayoutBuilder
 		virtual ~LayoutBuilder();
 
 		MemoryAllocationLayout build(const MemoryAllocationRequest &request);
+		MemoryAllocationLayout build(const MemoryAllocationRequest &request,
+				const LayoutConstraints &constraints);
 
 	protected:
 		void initLayoutGoals(const MemoryAllocationRequest &request, MemoryAllocationLayout &layout);
 
-		void populateAllLayoutStepsForRequest(const MemoryAllocationRequest& request);
+		void populateAllLayoutStepsForRequest(const MemoryAllocationRequest& request,
+				const LayoutConstraints &constraints);
 		void populateWarningGeneratingLayoutSteps();
-		void populateOrderedLayoutStepsForRequest(const MemoryAllocationRequest& request);
+		void populateOrderedLayoutStepsForRequest(const MemoryAllocationRequest& request,
+				const LayoutConstraints &constraints);
 		void deleteLayoutSteps();
 
 		std::vector<LayoutStep *> m_layoutSteps;
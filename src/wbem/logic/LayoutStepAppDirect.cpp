@@ -41,8 +41,10 @@
 wbem::logic::LayoutStepAppDirect::LayoutStepAppDirect(
 		const struct nvm_capabilities &cap,
 		const int appDirectExtentIndex,
-		lib_interface::NvmApi *pApi)
-	: m_systemCap(cap), m_adExtentIndex(appDirectExtentIndex), m_pLibApi(pApi)
+		lib_interface::NvmApi *pApi,
+		const std::map<NVM_UINT16, size_t> &maxInterleaveWaysBySocket)
+	: m_systemCap(cap), m_adExtentIndex(appDirectExtentIndex), m_pLibApi(pApi),
+	  m_pAllocationUtil(NULL), m_maxInterleaveWaysBySocket(maxInterleaveWaysBySocket)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
@@ -50,11 +52,16 @@ wbem::logic::LayoutStepAppDirect::LayoutStepAppDirect(
 	{
 		m_pLibApi = lib_interface::NvmApi::getApi();
 	}
+
+	// shared by every interleave set so the system's set IDs are only read once
+	m_pAllocationUtil = new MemoryAllocationUtil(m_pLibApi);
 }
 
 wbem::logic::LayoutStepAppDirect::~LayoutStepAppDirect()
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	delete m_pAllocationUtil;
 }
 
 bool wbem::logic::LayoutStepAppDirect::isRemainingStep(const MemoryAllocationRequest &request)
@@ -76,13 +83,28 @@ void wbem::logic::LayoutStepAppDirect::execute(const MemoryAllocationRequest& re
 
 	if (request.appDirectExtents.size() > m_adExtentIndex)
 	{
+		bool byOne = request.appDirectExtents[m_adExtentIndex].byOne;
+
+		// group the DIMMs once, they don't change between passes
 		std::vector<Dimm> dimmsToLayout;
+		std::map<NVM_UINT16, std::vector<Dimm> > dimmsBySocket;
+		if (byOne)
+		{
+			dimmsToLayout.reserve(request.dimms.size());
+		}
 		for (std::vector<Dimm>::const_iterator dimmIter = request.dimms.begin();
 				dimmIter != request.dimms.end(); dimmIter++)
 		{
 			if (layout.reserveDimmGuid != dimmIter->guid)
 			{
-				dimmsToLayout.push_back(*dimmIter);
+				if (byOne)
+				{
+					dimmsToLayout.push_back(*dimmIter);
+				}
+				else
+				{
+					dimmsBySocket[dimmIter->socket].push_back(*dimmIter);
+				}
 				m_dimmExistingSets[dimmIter->guid] =
 						layout.goals[dimmIter->guid].app_direct_count;
 			}
@@ -97,13 +119,13 @@ void wbem::logic::LayoutStepAppDirect::execute(const MemoryAllocationRequest& re
 			{
 				try
 				{
-					if (request.appDirectExtents[m_adExtentIndex].byOne)
+					if (byOne)
 					{
 						bytesRemaining = layoutByOneAd(bytesRemaining, dimmsToLayout, request, layout);
 					}
 					else
 					{
-						bytesRemaining = layoutInterleavedAd(bytesRemaining, dimmsToLayout, request, layout);
+						bytesRemaining = layoutInterleavedAd(bytesRemaining, dimmsBySocket, request, layout);
 					}
 				}
 				catch (exception::NvmExceptionBadRequestSize &e)
@@ -136,11 +158,11 @@ NVM_UINT64 wbem::logic::LayoutStepAppDirect::layoutByOneAd(
 			dimmsIncluded);
 
 
+	std::vector<Dimm> byOneDimmList(1);
 	for (std::vector<Dimm>::const_iterator dimmIter = dimmsIncluded.begin();
 			dimmIter != dimmsIncluded.end(); dimmIter++)
 	{
-		std::vector<Dimm> byOneDimmList;
-		byOneDimmList.push_back(*dimmIter);
+		byOneDimmList[0] = *dimmIter;
 		bytesAllocated += layoutInterleaveSet(bytesPerDimm, byOneDimmList, request, layout);
 	}
 
@@ -154,30 +176,26 @@ NVM_UINT64 wbem::logic::LayoutStepAppDirect::layoutByOneAd(
 
 NVM_UINT64 wbem::logic::LayoutStepAppDirect::layoutInterleavedAd(
 		const NVM_UINT64 &bytesToAllocate,
-		const std::vector<wbem::logic::Dimm> &dimms,
+		const std::map<NVM_UINT16, std::vector<Dimm> > &sockets,
 		const MemoryAllocationRequest& request,
 		MemoryAllocationLayout& layout)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
 	NVM_UINT64 bytesAllocated = 0;
-	// create a map of socket to dimm lists
-	std::map<NVM_UINT16, std::vector<Dimm> >sockets;
-	for (std::vector<Dimm>::const_iterator dimmIter = dimms.begin();
-						dimmIter != dimms.end(); dimmIter++)
-	{
-		sockets[dimmIter->socket].push_back(*dimmIter);
-	}
-	NVM_UINT64 dimmCount = removeEmptySockets(sockets, bytesToAllocate, request, layout);
+	std::vector<NVM_UINT16> socketsWithCapacity;
+	NVM_UINT64 dimmCount = getSocketsWithCapacity(sockets, bytesToAllocate, layout,
+			socketsWithCapacity);
 
-	if (sockets.size() && dimmCount > 0)
+	if (socketsWithCapacity.size() && dimmCount > 0)
 	{
 		NVM_UINT64 bytesPerDimm = bytesToAllocate / dimmCount;
-		for (std::map<NVM_UINT16, std::vector<Dimm> >::iterator socketIter = sockets.begin();
-			socketIter != sockets.end(); socketIter++)
+		for (std::vector<NVM_UINT16>::const_iterator socketIter = socketsWithCapacity.begin();
+			socketIter != socketsWithCapacity.end(); socketIter++)
 		{
-			NVM_UINT64 bytesPerSocket = bytesPerDimm * socketIter->second.size();
-			bytesAllocated += layoutInterleavedAdAcrossSocket(bytesPerSocket, socketIter->second, request, layout);
+			const std::vector<Dimm> &socketDimms = sockets.find(*socketIter)->second;
+			NVM_UINT64 bytesPerSocket = bytesPerDimm * socketDimms.size();
+			bytesAllocated += layoutInterleavedAdAcrossSocket(bytesPerSocket, socketDimms, request, layout);
 		}
 	}
 
@@ -232,66 +250,57 @@ NVM_UINT64 wbem::logic::LayoutStepAppDirect::layoutInterleaveSet(
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
 	NVM_UINT64 bytesAllocated = 0;
-	MemoryAllocationUtil util(m_pLibApi);
-	NVM_UINT16 setId = util.getNextAvailableInterleaveSetId(layout);
-	enum interleave_ways way = getInterleaveWay(dimms.size());
-	enum interleave_size channelSize = getInterleaveChannelSize(request, dimms.size());
-	enum interleave_size imcSize = getInterleaveImcSize(request, dimms.size());
+	NVM_UINT16 setId = m_pAllocationUtil->getNextAvailableInterleaveSetId(layout);
+
+	// every DIMM in the set gets the same settings
+	struct app_direct_attributes settings;
+	memset(&settings, 0, sizeof (settings));
+	settings.interleave.ways = getInterleaveWay(dimms.size());
+	settings.interleave.channel = getInterleaveChannelSize(request, dimms.size());
+	settings.interleave.imc = getInterleaveImcSize(request, dimms.size());
+	for (size_t i = 0; i < dimms.size(); i++)
+	{
+		str_to_guid(dimms[i].guid.c_str(), settings.dimms[i]);
+	}
+
 	for (std::vector<Dimm>::const_iterator dimmIter = dimms.begin();
 					dimmIter != dimms.end(); dimmIter++)
 	{
-		struct app_direct_attributes settings;
-		memset(&settings, 0, sizeof (settings));
-		settings.interleave.ways = way;
-		settings.interleave.channel = channelSize;
-		settings.interleave.imc = imcSize;
-		for (size_t i = 0; i < dimms.size(); i++)
-		{
-			str_to_guid(dimms[i].guid.c_str(), settings.dimms[i]);
-		}
 		addInterleaveSetToGoal(dimmIter->guid, layout.goals[dimmIter->guid], bytesPerDimm, setId, settings);
 		bytesAllocated += bytesPerDimm;
 	}
 	return bytesAllocated;
 }
 
-NVM_UINT64 wbem::logic::LayoutStepAppDirect::removeEmptySockets(
-		std::map<NVM_UINT16, std::vector<Dimm> > &sockets,
+NVM_UINT64 wbem::logic::LayoutStepAppDirect::getSocketsWithCapacity(
+		const std::map<NVM_UINT16, std::vector<Dimm> > &sockets,
 		const NVM_UINT64 &bytesToAllocate,
-		const MemoryAllocationRequest& request,
-		MemoryAllocationLayout& layout)
+		MemoryAllocationLayout& layout,
+		std::vector<NVM_UINT16> &socketsWithCapacity)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
 	NVM_UINT64 dimmCount = 0;
-	std::vector<NVM_UINT16> emptySockets;
-	for (std::map<NVM_UINT16, std::vector<Dimm> >::iterator socketIter = sockets.begin();
+	std::vector<Dimm> dimmsIncluded;
+	for (std::map<NVM_UINT16, std::vector<Dimm> >::const_iterator socketIter = sockets.begin();
 		socketIter != sockets.end(); socketIter++)
 	{
 		try
 		{
-			std::vector<Dimm> dimmsIncluded;
+			dimmsIncluded.clear();
 			NVM_UINT64 bytesPerDimm = getLargestPerDimmSymmetricalBytes(
 					socketIter->second, layout.goals, bytesToAllocate, dimmsIncluded);
-			if (bytesPerDimm == 0)
-			{
-				emptySockets.push_back(socketIter->first);
-			}
-			else
+			if (bytesPerDimm > 0)
 			{
+				socketsWithCapacity.push_back(socketIter->first);
 				dimmCount += dimmsIncluded.size();
 			}
 		}
 		catch (exception::NvmExceptionBadRequestSize &)
 		{
-			emptySockets.push_back(socketIter->first);
+			// no capacity left on this socket
 		}
 	}
-	for (std::vector<NVM_UINT16>::const_iterator eraseIter = emptySockets.begin();
-			eraseIter != emptySockets.end(); eraseIter++)
-	{
-		sockets.erase(*eraseIter);
-	}
 
 	return dimmCount;
 }
@@ -483,6 +492,24 @@ bool wbem::logic::LayoutStepAppDirect::dimmPopulationMatchesInterleaveSet(
 	return match;
 }
 
+bool wbem::logic::LayoutStepAppDirect::interleaveSetIsAllowed(const int &interleaveSet,
+		const NVM_UINT16 socket)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	std::map<NVM_UINT16, size_t>::const_iterator maxWays = m_maxInterleaveWaysBySocket.find(socket);
+	size_t ways = 0;
+	for (int i = 0; i < DIMMS_PER_SOCKET; i++)
+	{
+		if (DIMM_POPULATED(interleaveSet, i))
+		{
+			ways++;
+		}
+	}
+
+	return (maxWays == m_maxInterleaveWaysBySocket.end() || ways <= maxWays->second);
+}
+
 std::vector<wbem::logic::Dimm> wbem::logic::LayoutStepAppDirect::getDimmsMatchingInterleaveSet(
 		const int &interleaveSet,
 		const std::vector<wbem::logic::Dimm> &requestedDimms)
@@ -513,11 +540,14 @@ NVM_UINT64 wbem::logic::LayoutStepAppDirect::getBestInterleaveBytesPerDimm(
 
 	NVM_UINT64 bytesPerDimm = 0;
 	int dimmPopulationMap = getDimmPopulationMap(requestedDimms, goals);
+	// the requested dimms are all on one socket
+	NVM_UINT16 socket = requestedDimms.empty() ? 0 : requestedDimms.front().socket;
 
 	size_t setCount = (sizeof (INTERLEAVE_SETS) / sizeof (int));
 	for (size_t i = 0; i < setCount; i++)
 	{
-		if (dimmPopulationMatchesInterleaveSet(dimmPopulationMap, INTERLEAVE_SETS[i]))
+		if (interleaveSetIsAllowed(INTERLEAVE_SETS[i], socket) &&
+				dimmPopulationMatchesInterleaveSet(dimmPopulationMap, INTERLEAVE_SETS[i]))
 		{
 			std::vector<Dimm> dimms = getDimmsMatchingInterleaveSet(INTERLEAVE_SETS[i], requestedDimms);
 			if (canMapInterleavedCapacity(dimms, goals, request))
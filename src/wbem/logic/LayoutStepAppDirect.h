@@ -35,6 +35,7 @@
 #include "LayoutStep.h"
 #include <nvm_types.h>
 #include <lib_interface/NvmApi.h>
+#include "MemoryAllocationUtil.h"
 
 namespace wbem
 {
@@ -46,7 +47,9 @@ class NVM_API LayoutStepAppDirect: public LayoutStep
 	public:
 		LayoutStepAppDirect(const struct nvm_capabilities &cap,
 				const int appDirectExtentIndex = 0,
-				lib_interface::NvmApi *pApi = NULL);
+				lib_interface::NvmApi *pApi = NULL,
+				const std::map<NVM_UINT16, size_t> &maxInterleaveWaysBySocket =
+						std::map<NVM_UINT16, size_t>());
 		virtual ~LayoutStepAppDirect();
 
 		virtual void execute(const MemoryAllocationRequest &request,
@@ -66,7 +69,7 @@ class NVM_API LayoutStepAppDirect: public LayoutStep
 				MemoryAllocationLayout &layout);
 		NVM_UINT64 layoutInterleavedAd(
 				const NVM_UINT64 &bytesToAllocate,
-				const std::vector<Dimm> &dimms,
+				const std::map<NVM_UINT16, std::vector<Dimm> > &sockets,
 				const MemoryAllocationRequest &request,
 				MemoryAllocationLayout &layout);
 		NVM_UINT64 layoutInterleavedAdAcrossSocket(
@@ -110,12 +113,14 @@ class NVM_API LayoutStepAppDirect: public LayoutStep
 		int getDimmPopulationMap(const std::vector<Dimm> &requestedDimms,
 						std::map<std::string, struct config_goal> &goals);
 		bool dimmPopulationMatchesInterleaveSet(const int &dimmMap, const int &interleaveSet);
+		bool interleaveSetIsAllowed(const int &interleaveSet, const NVM_UINT16 socket);
 		std::vector<Dimm> getDimmsMatchingInterleaveSet(const int &interleaveSet,
 				const std::vector<Dimm> &requestedDimms);
-		NVM_UINT64 removeEmptySockets(std::map<NVM_UINT16, std::vector<Dimm> > &sockets,
+		NVM_UINT64 getSocketsWithCapacity(
+				const std::map<NVM_UINT16, std::vector<Dimm> > &sockets,
 				const NVM_UINT64 &bytesToAllocate,
-				const MemoryAllocationRequest& request,
-				MemoryAllocationLayout& layout);
+				MemoryAllocationLayout& layout,
+				std::vector<NVM_UINT16> &socketsWithCapacity);
 		std::vector<Dimm> getDimmsWithCapacity(const std::vector<Dimm> &dimms,
 				MemoryAllocationLayout& layout);
 		std::vector<Dimm> getRemainingDimms(const std::vector<Dimm> &dimms,
@@ -124,6 +129,8 @@ class NVM_API LayoutStepAppDirect: public LayoutStep
 		struct nvm_capabilities m_systemCap;
 		unsigned int m_adExtentIndex;
 		lib_interface::NvmApi *m_pLibApi;
+		MemoryAllocationUtil *m_pAllocationUtil;
+		std::map<NVM_UINT16, size_t> m_maxInterleaveWaysBySocket; // no entry for no limit
 		std::map<std::string, int> m_dimmExistingSets; // dimm GUID to App Direct count map
 };
 
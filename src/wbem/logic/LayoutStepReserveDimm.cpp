@@ -34,7 +34,8 @@
 #include <LogEnterExit.h>
 #include <exception/NvmExceptionBadRequest.h>
 
-wbem::logic::LayoutStepReserveDimm::LayoutStepReserveDimm()
+wbem::logic::LayoutStepReserveDimm::LayoutStepReserveDimm(const std::string &reserveDimmGuid)
+	: m_reserveDimmGuid(reserveDimmGuid)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 }
@@ -59,6 +60,10 @@ void wbem::logic::LayoutStepReserveDimm::execute(const MemoryAllocationRequest&
 		{
 			setReserveDimmForStorage(request.dimms[0], layout);
 		}
+		else if (requestedDimmIsSelectedAsReserve(request, layout))
+		{
+			// reserve dimm was chosen by the caller
+		}
 		else
 		{
 			std::map<NVM_UINT16, std::vector<Dimm> > socketDimmListMap;
@@ -188,6 +193,30 @@ bool wbem::logic::LayoutStepReserveDimm::oddlySizedDimmIsSelectedAsReserve(
 	return found;
 }
 
+bool wbem::logic::LayoutStepReserveDimm::requestedDimmIsSelectedAsReserve(
+		const MemoryAllocationRequest &request,
+		MemoryAllocationLayout& layout)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	bool found = false;
+	if (!m_reserveDimmGuid.empty())
+	{
+		for (std::vector<struct Dimm>::const_iterator dimmIter = request.dimms.begin();
+				dimmIter != request.dimms.end(); dimmIter++)
+		{
+			if (dimmIter->guid == m_reserveDimmGuid)
+			{
+				found = true;
+				setReserveDimmForStorage(*dimmIter, layout);
+				break;
+			}
+		}
+	}
+
+	return found;
+}
+
 void wbem::logic::LayoutStepReserveDimm::setReserveDimmForStorage(struct Dimm reserveDimm,
 		MemoryAllocationLayout& layout)
 {
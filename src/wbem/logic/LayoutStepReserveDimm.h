@@ -42,7 +42,7 @@ namespace logic
 class NVM_API LayoutStepReserveDimm : public LayoutStep
 {
 	public:
-		LayoutStepReserveDimm();
+		LayoutStepReserveDimm(const std::string &reserveDimmGuid = "");
 		virtual ~LayoutStepReserveDimm();
 
 		virtual void execute(const MemoryAllocationRequest &request,
@@ -63,6 +63,12 @@ class NVM_API LayoutStepReserveDimm : public LayoutStep
 		bool oddlySizedDimmIsSelectedAsReserve(
 				const std::map<NVM_UINT16, std::vector<Dimm> > &socketDimmListMap,
 				MemoryAllocationLayout& layout);
+
+		bool requestedDimmIsSelectedAsReserve(
+				const MemoryAllocationRequest &request,
+				MemoryAllocationLayout& layout);
+
+		std::string m_reserveDimmGuid; // forced choice of reserve dimm, if not empty
 };
 
 } /* namespace logic */
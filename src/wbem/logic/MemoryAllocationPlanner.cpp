@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Lays out memory allocation requests against a synthetic topology read from
+ * a file, for capacity planning without touching the hardware.
+ */
+
+#include "MemoryAllocationPlanner.h"
+#include "MemoryAllocator.h"
+#include "MemoryAllocationUtil.h"
+#include "TopologyNvmApi.h"
+#include <LogEnterExit.h>
+#include <common_types.h>
+#include <libintelnvm-cim/ExceptionBadParameter.h>
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <cstdlib>
+#include <cstring>
+
+wbem::logic::MemoryAllocationPlanner::MemoryAllocationPlanner() :
+		m_devices(), m_socketCount(0)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	clearTopology();
+}
+
+wbem::logic::MemoryAllocationPlanner::~MemoryAllocationPlanner()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+}
+
+void wbem::logic::MemoryAllocationPlanner::clearTopology()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	memset(&m_capabilities, 0, sizeof (m_capabilities));
+	m_capabilities.nvm_features.modify_device_capacity = 1;
+	m_capabilities.platform_capabilities.current_volatile_mode = VOLATILE_MODE_AUTO;
+	setModeSupported("MemoryMode", true);
+	setModeSupported("AppDirect", true);
+	setModeSupported("Storage", true);
+
+	m_devices.clear();
+	m_socketCount = 0;
+}
+
+void wbem::logic::MemoryAllocationPlanner::loadTopology(const std::string &path)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	std::ifstream topologyFile(path.c_str());
+	if (!topologyFile.is_open())
+	{
+		COMMON_LOG_ERROR_F("Failed to open topology file %s", path.c_str());
+		throw framework::ExceptionBadParameter(path.c_str());
+	}
+
+	clearTopology();
+
+	std::string line;
+	size_t lineNumber = 0;
+	while (std::getline(topologyFile, line))
+	{
+		lineNumber++;
+		parseLine(line, lineNumber);
+	}
+
+	if (m_devices.empty())
+	{
+		COMMON_LOG_ERROR_F("Topology file %s has no DIMMs", path.c_str());
+		throw framework::ExceptionBadParameter(path.c_str());
+	}
+
+	if (m_capabilities.platform_capabilities.app_direct_mode.interleave_formats_count == 0)
+	{
+		setDefaultInterleaveFormats();
+	}
+}
+
+void wbem::logic::MemoryAllocationPlanner::parseLine(const std::string &line,
+		const size_t lineNumber)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	size_t start = line.find_first_not_of(" \t\r");
+	if (start == std::string::npos || line[start] == '#')
+	{
+		return;
+	}
+
+	size_t separator = line.find('=', start);
+	if (separator == std::string::npos)
+	{
+		throwBadLine(lineNumber);
+	}
+
+	std::string key = line.substr(start, separator - start);
+	key = key.substr(0, key.find_last_not_of(" \t") + 1);
+	std::vector<std::string> values = splitValues(line.substr(separator + 1));
+	if (values.empty())
+	{
+		throwBadLine(lineNumber);
+	}
+
+	if (key == "Dimm")
+	{
+		addDimm(values, lineNumber);
+	}
+	else if (key == "InterleaveFormat")
+	{
+		addInterleaveFormat(values, lineNumber);
+	}
+	else if (key == "MemoryMode" || key == "AppDirect" || key == "Storage")
+	{
+		setModeSupported(key, stringToNumber(values[0], lineNumber) != 0);
+	}
+	else if (key == "Sockets")
+	{
+		m_socketCount = (NVM_UINT16)stringToNumber(values[0], lineNumber);
+	}
+	else
+	{
+		throwBadLine(lineNumber);
+	}
+}
+
+void wbem::logic::MemoryAllocationPlanner::addDimm(const std::vector<std::string> &values,
+		const size_t lineNumber)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	if (values.size() < 4 || values.size() > 5 ||
+			(values.size() == 5 && values[4] != "Locked"))
+	{
+		throwBadLine(lineNumber);
+	}
+
+	struct device_discovery device;
+	memset(&device, 0, sizeof (device));
+
+	device.socket_id = (NVM_UINT16)stringToNumber(values[0], lineNumber);
+	device.memory_controller_id = (NVM_UINT16)stringToNumber(values[1], lineNumber);
+	device.channel_id = (NVM_UINT16)stringToNumber(values[2], lineNumber);
+	device.capacity = stringToNumber(values[3], lineNumber) * BYTES_PER_GB;
+	if (device.capacity == 0)
+	{
+		throwBadLine(lineNumber);
+	}
+
+	device.device_handle.parts.socket_id = device.socket_id;
+	device.device_handle.parts.memory_controller_id = device.memory_controller_id;
+	device.device_handle.parts.mem_channel_id = device.channel_id;
+	device.manageability = MANAGEMENT_VALIDCONFIG;
+	device.lock_state = values.size() == 5 ? LOCK_STATE_LOCKED : LOCK_STATE_DISABLED;
+
+	// deterministic so plans for the same file can be compared
+	NVM_UINT16 index = (NVM_UINT16)m_devices.size();
+	device.guid[0] = (unsigned char)device.socket_id;
+	device.guid[1] = (unsigned char)device.memory_controller_id;
+	device.guid[2] = (unsigned char)device.channel_id;
+	device.guid[NVM_GUID_LEN - 2] = (unsigned char)(index >> 8);
+	device.guid[NVM_GUID_LEN - 1] = (unsigned char)(index & 0xFF);
+
+	m_devices.push_back(device);
+}
+
+void wbem::logic::MemoryAllocationPlanner::addInterleaveFormat(
+		const std::vector<std::string> &values, const size_t lineNumber)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	struct memory_capabilities &appDirect =
+			m_capabilities.platform_capabilities.app_direct_mode;
+	if (values.size() < 3 || values.size() > 4 ||
+			(values.size() == 4 && values[3] != "Recommended") ||
+			appDirect.interleave_formats_count >= NVM_INTERLEAVE_FORMATS)
+	{
+		throwBadLine(lineNumber);
+	}
+
+	struct interleave_format &format =
+			appDirect.interleave_formats[appDirect.interleave_formats_count];
+	format.ways = (enum interleave_ways)stringToNumber(values[0], lineNumber);
+	format.imc = stringToInterleaveSize(values[1], lineNumber);
+	format.channel = stringToInterleaveSize(values[2], lineNumber);
+	format.recommended = values.size() == 4;
+	appDirect.interleave_formats_count++;
+}
+
+void wbem::logic::MemoryAllocationPlanner::setDefaultInterleaveFormats()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	const enum interleave_ways defaultWays[] =
+	{
+		INTERLEAVE_WAYS_1, INTERLEAVE_WAYS_2, INTERLEAVE_WAYS_3,
+		INTERLEAVE_WAYS_4, INTERLEAVE_WAYS_6
+	};
+	const size_t defaultWaysCount = sizeof (defaultWays) / sizeof (defaultWays[0]);
+
+	struct memory_capabilities &appDirect =
+			m_capabilities.platform_capabilities.app_direct_mode;
+	for (size_t i = 0; i < defaultWaysCount && i < NVM_INTERLEAVE_FORMATS; i++)
+	{
+		struct interleave_format &format = appDirect.interleave_formats[i];
+		format.ways = defaultWays[i];
+		format.imc = INTERLEAVE_SIZE_4KB;
+		format.channel = INTERLEAVE_SIZE_256B;
+		format.recommended = 1;
+		appDirect.interleave_formats_count++;
+	}
+}
+
+void wbem::logic::MemoryAllocationPlanner::setModeSupported(const std::string &mode,
+		const bool supported)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	NVM_BOOL value = supported ? 1 : 0;
+	if (mode == "MemoryMode")
+	{
+		m_capabilities.nvm_features.memory_mode = value;
+		m_capabilities.platform_capabilities.memory_mode.supported = value;
+		m_capabilities.sku_capabilities.memory_sku = value;
+	}
+	else if (mode == "AppDirect")
+	{
+		m_capabilities.nvm_features.app_direct_mode = value;
+		m_capabilities.platform_capabilities.app_direct_mode.supported = value;
+		m_capabilities.sku_capabilities.app_direct_sku = value;
+	}
+	else if (mode == "Storage")
+	{
+		m_capabilities.nvm_features.storage_mode = value;
+		m_capabilities.platform_capabilities.storage_mode_supported = value;
+		m_capabilities.sku_capabilities.storage_sku = value;
+	}
+}
+
+std::vector<wbem::logic::Dimm> wbem::logic::MemoryAllocationPlanner::getDimms() const
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	std::vector<Dimm> dimms;
+	for (std::vector<struct device_discovery>::const_iterator iter = m_devices.begin();
+			iter != m_devices.end(); iter++)
+	{
+		dimms.push_back(MemoryAllocationUtil::deviceDiscoveryToDimm(*iter));
+	}
+
+	return dimms;
+}
+
+std::vector<struct device_discovery> wbem::logic::MemoryAllocationPlanner::getDevices() const
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_devices;
+}
+
+NVM_UINT16 wbem::logic::MemoryAllocationPlanner::getSocketCount() const
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	NVM_UINT16 socketCount = m_socketCount;
+	if (socketCount == 0)
+	{
+		std::set<NVM_UINT16> sockets;
+		for (std::vector<struct device_discovery>::const_iterator iter = m_devices.begin();
+				iter != m_devices.end(); iter++)
+		{
+			sockets.insert(iter->socket_id);
+		}
+		socketCount = (NVM_UINT16)sockets.size();
+	}
+
+	return socketCount;
+}
+
+wbem::logic::MemoryAllocationLayout wbem::logic::MemoryAllocationPlanner::plan(
+		const struct MemoryAllocationRequest &request)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	NVM_UINT16 socketCount = getSocketCount();
+	TopologyNvmApi api(m_capabilities, m_devices, socketCount);
+	MemoryAllocator allocator(m_capabilities, m_devices, std::vector<struct pool>(),
+			socketCount, &api);
+
+	return allocator.layout(request);
+}
+
+std::vector<std::string> wbem::logic::MemoryAllocationPlanner::splitValues(
+		const std::string &value)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	std::vector<std::string> values;
+	std::stringstream stream(value);
+	std::string token;
+	while (std::getline(stream, token, ','))
+	{
+		size_t first = token.find_first_not_of(" \t\r");
+		if (first == std::string::npos)
+		{
+			values.push_back("");
+		}
+		else
+		{
+			size_t last = token.find_last_not_of(" \t\r");
+			values.push_back(token.substr(first, last - first + 1));
+		}
+	}
+
+	return values;
+}
+
+NVM_UINT64 wbem::logic::MemoryAllocationPlanner::stringToNumber(const std::string &value,
+		const size_t lineNumber)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	char *pEnd = NULL;
+	NVM_UINT64 number = strtoull(value.c_str(), &pEnd, 10);
+	if (value.empty() || value[0] == '-' || *pEnd != '\0')
+	{
+		throwBadLine(lineNumber);
+	}
+
+	return number;
+}
+
+enum interleave_size wbem::logic::MemoryAllocationPlanner::stringToInterleaveSize(
+		const std::string &value, const size_t lineNumber)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	enum interleave_size size = INTERLEAVE_SIZE_64B;
+	if (value == "64B")
+	{
+		size = INTERLEAVE_SIZE_64B;
+	}
+	else if (value == "128B")
+	{
+		size = INTERLEAVE_SIZE_128B;
+	}
+	else if (value == "256B")
+	{
+		size = INTERLEAVE_SIZE_256B;
+	}
+	else if (value == "4KB")
+	{
+		size = INTERLEAVE_SIZE_4KB;
+	}
+	else if (value == "1GB")
+	{
+		size = INTERLEAVE_SIZE_1GB;
+	}
+	else
+	{
+		throwBadLine(lineNumber);
+	}
+
+	return size;
+}
+
+void wbem::logic::MemoryAllocationPlanner::throwBadLine(const size_t lineNumber)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	std::stringstream line;
+	line << "topology line " << lineNumber;
+	COMMON_LOG_ERROR_F("Invalid %s", line.str().c_str());
+	throw framework::ExceptionBadParameter(line.str().c_str());
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Lays out memory allocation requests against a synthetic topology read from
+ * a file, for capacity planning without touching the hardware.
+ *
+ * The topology file holds one key=value setting per line. Lines starting with
+ * '#' are comments.
+ *	Dimm=<socket>,<memory controller>,<channel>,<capacity GiB>[,Locked]
+ *	InterleaveFormat=<ways>,<imc size>,<channel size>[,Recommended]
+ *	MemoryMode|AppDirect|Storage=<0|1>
+ *	Sockets=<count>
+ * Interleave sizes are one of 64B, 128B, 256B, 4KB or 1GB.
+ */
+
+#ifndef _WBEM_LOGIC_MEMORYALLOCATIONPLANNER_H_
+#define _WBEM_LOGIC_MEMORYALLOCATIONPLANNER_H_
+
+#include <string>
+#include <vector>
+#include <nvm_management.h>
+#include "MemoryAllocationTypes.h"
+
+namespace wbem
+{
+namespace logic
+{
+
+class NVM_API MemoryAllocationPlanner
+{
+	public:
+		MemoryAllocationPlanner();
+		virtual ~MemoryAllocationPlanner();
+
+		/*
+		 * Replace the current topology with the one described in the file.
+		 * Throws ExceptionBadParameter if the file can't be read or is malformed.
+		 */
+		void loadTopology(const std::string &path);
+
+		std::vector<Dimm> getDimms() const;
+		std::vector<struct device_discovery> getDevices() const;
+		NVM_UINT16 getSocketCount() const;
+
+		/*
+		 * Run the request rules, layout steps and post-layout checks against
+		 * the topology. Nothing is written to the hardware.
+		 */
+		MemoryAllocationLayout plan(const struct MemoryAllocationRequest &request);
+
+	protected:
+		void clearTopology();
+		void parseLine(const std::string &line, const size_t lineNumber);
+		void addDimm(const std::vector<std::string> &values, const size_t lineNumber);
+		void addInterleaveFormat(const std::vector<std::string> &values,
+				const size_t lineNumber);
+		void setModeSupported(const std::string &mode, const bool supported);
+		void setDefaultInterleaveFormats();
+
+		static std::vector<std::string> splitValues(const std::string &value);
+		static NVM_UINT64 stringToNumber(const std::string &value, const size_t lineNumber);
+		static enum interleave_size stringToInterleaveSize(const std::string &value,
+				const size_t lineNumber);
+		static void throwBadLine(const size_t lineNumber);
+
+		struct nvm_capabilities m_capabilities;
+		std::vector<struct device_discovery> m_devices;
+		NVM_UINT16 m_socketCount; // 0 to count the sockets populated with DIMMs
+};
+
+} /* namespace logic */
+} /* namespace wbem */
+
+#endif /* _WBEM_LOGIC_MEMORYALLOCATIONPLANNER_H_ */
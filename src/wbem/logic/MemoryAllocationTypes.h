@@ -121,16 +121,43 @@ struct AppDirectExtent
 struct MemoryAllocationRequest
 {
 	MemoryAllocationRequest() :
-		memoryCapacity(0), appDirectExtents(), storageRemaining(false), reserveDimm(false), dimms() {}
+		memoryCapacity(0), appDirectExtents(), storageRemaining(false), reserveDimm(false),
+		searchLayouts(false), dimms() {}
 
 	NVM_UINT64 memoryCapacity; // total in GiB
 	std::vector<struct AppDirectExtent> appDirectExtents;
 	bool storageRemaining;
 	bool reserveDimm;
+	bool searchLayouts; // try alternative layouts and keep the best valid one
 
 	std::vector<Dimm> dimms;
 };
 
+/*
+ * Choices the layout steps would otherwise make greedily. Used to build
+ * alternative layouts when searching for the best one.
+ */
+struct LayoutConstraints
+{
+	LayoutConstraints() : reserveDimmGuid(""), maxInterleaveWaysBySocket() {}
+
+	std::string reserveDimmGuid; // empty to let the layout step choose
+	// widest App Direct interleave set allowed on each socket, no entry for no limit
+	std::map<NVM_UINT16, size_t> maxInterleaveWaysBySocket;
+};
+
+/*
+ * How well a layout satisfies a request, used to rank alternative layouts.
+ */
+struct LayoutScore
+{
+	LayoutScore() : deviation(0), narrowestInterleaveWays(0), extentCount(0) {}
+
+	NVM_UINT64 deviation; // GiB difference between requested and laid out capacity
+	size_t narrowestInterleaveWays; // of any App Direct interleave set, 0 if none
+	size_t extentCount; // App Direct interleave sets summed over all DIMMs
+};
+
 enum LayoutWarningCode
 {
 	LAYOUT_WARNING_APP_DIRECT_NOT_SUPPORTED_BY_DRIVER,
@@ -155,6 +182,9 @@ struct MemoryAllocationLayout
 	std::vector<enum LayoutWarningCode> warnings;
 };
 
+// the string is a DIMM GUID, the value is the library return code for its goal
+typedef std::map<std::string, int> MemoryAllocationResults;
+
 } /* namespace logic */
 } /* namespace wbem */
 
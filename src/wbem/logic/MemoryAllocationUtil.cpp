@@ -26,19 +26,19 @@
  */
 
 #include "MemoryAllocationUtil.h"
-#include <physical_asset/NVDIMMFactory.h>
 #include <guid/guid.h>
 #include <exception/NvmExceptionLibError.h>
 #include <LogEnterExit.h>
 
-wbem::logic::MemoryAllocationUtil::MemoryAllocationUtil() : m_pApi(NULL)
+wbem::logic::MemoryAllocationUtil::MemoryAllocationUtil() :
+		m_pApi(NULL), m_systemSetIdKnown(false), m_lastSystemSetId(0)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 	m_pApi = lib_interface::NvmApi::getApi();
 }
 
 wbem::logic::MemoryAllocationUtil::MemoryAllocationUtil(lib_interface::NvmApi* pApi) :
-		m_pApi(pApi)
+		m_pApi(pApi), m_systemSetIdKnown(false), m_lastSystemSetId(0)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 }
@@ -53,9 +53,15 @@ NVM_UINT16 wbem::logic::MemoryAllocationUtil::getNextAvailableInterleaveSetId(
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
-	NVM_UINT16 maxId = 0;
-	getLastInterleaveSetIdFromCurrentConfig(maxId);
-	getLastInterleaveSetIdFromConfigGoals(maxId);
+	if (!m_systemSetIdKnown)
+	{
+		m_lastSystemSetId = 0;
+		getLastInterleaveSetIdFromCurrentConfig(m_lastSystemSetId);
+		getLastInterleaveSetIdFromConfigGoals(m_lastSystemSetId);
+		m_systemSetIdKnown = true;
+	}
+
+	NVM_UINT16 maxId = m_lastSystemSetId;
 	getLastInterleaveSetIdFromLayout(layout, maxId);
 
 	return maxId + 1;
@@ -86,10 +92,13 @@ void wbem::logic::MemoryAllocationUtil::getLastInterleaveSetIdFromConfigGoals(NV
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
-	std::vector<std::string> guids = physical_asset::NVDIMMFactory::getManageableDeviceGuids();
-	for (NVM_UINT32 i = 0; i < guids.size(); i++)
+	std::vector<struct device_discovery> devices;
+	m_pApi->getManageableDimms(devices);
+	for (NVM_UINT32 i = 0; i < devices.size(); i++)
 	{
-		NVM_UINT32 maxDimmInterleaveIndex = getDimmInterleaveInfoMaxSetIndex(guids[i]);
+		NVM_GUID_STR guidStr;
+		guid_to_str(devices[i].guid, guidStr);
+		NVM_UINT32 maxDimmInterleaveIndex = getDimmInterleaveInfoMaxSetIndex(guidStr);
 		if (maxDimmInterleaveIndex > maxId)
 		{
 			maxId = maxDimmInterleaveIndex;
@@ -44,12 +44,18 @@ class NVM_API MemoryAllocationUtil
 		MemoryAllocationUtil(lib_interface::NvmApi *pApi);
 		virtual ~MemoryAllocationUtil();
 
+		/*
+		 * The set IDs already used by the system are looked up once and
+		 * reused for every later call on this object.
+		 */
 		virtual NVM_UINT16 getNextAvailableInterleaveSetId(const MemoryAllocationLayout &layout);
 
 		static Dimm deviceDiscoveryToDimm(const struct device_discovery &deviceDiscovery);
 
 	protected:
 		lib_interface::NvmApi *m_pApi;
+		bool m_systemSetIdKnown;
+		NVM_UINT16 m_lastSystemSetId; // largest set ID in the current config and goals
 
 		void getLastInterleaveSetIdFromCurrentConfig(NVM_UINT16 &maxId);
 		void getLastInterleaveSetIdFromConfigGoals(NVM_UINT16 &maxId);
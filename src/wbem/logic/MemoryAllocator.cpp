@@ -56,6 +56,10 @@
 #include "PostLayoutRequestDeviationCheck.h"
 #include <exception/NvmExceptionBadRequest.h>
 #include "RuleMemoryModeCapacityNotSupported.h"
+#include <set>
+
+// narrower caps to try on each socket, the default layout has no cap (x6)
+static const size_t LAYOUT_SEARCH_INTERLEAVE_WAYS[] = {4, 3, 2, 1};
 
 wbem::logic::MemoryAllocator::MemoryAllocator(const struct nvm_capabilities &systemCapabilities,
 		const std::vector<struct device_discovery> &manageableDevices,
@@ -129,14 +133,194 @@ wbem::logic::MemoryAllocationLayout wbem::logic::MemoryAllocator::layout(
 
 	validateRequest(request);
 
-	LayoutBuilder builder(m_systemCapabilities);
-	wbem::logic::MemoryAllocationLayout layout = builder.build(request);
+	wbem::logic::MemoryAllocationLayout layout;
+	if (request.searchLayouts)
+	{
+		layout = searchLayouts(request);
+	}
+	else
+	{
+		LayoutBuilder builder(m_systemCapabilities, m_pLibApi);
+		layout = builder.build(request);
 
-	validateLayout(request, layout);
+		validateLayout(request, layout);
+	}
 
 	return layout;
 }
 
+/*
+ * Search for the valid layout closest to the request. Each choice the layout steps
+ * would make greedily is varied on its own while the others keep their best value
+ * so far: first the reserve dimm, then the widest interleave set on each socket in
+ * turn. That builds at most 1 + dimms + 4 * sockets layouts instead of one for every
+ * combination.
+ */
+wbem::logic::MemoryAllocationLayout wbem::logic::MemoryAllocator::searchLayouts(
+		const struct MemoryAllocationRequest& request)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	LayoutBuilder builder(m_systemCapabilities, m_pLibApi);
+	MemoryAllocationLayout bestLayout;
+	LayoutScore bestScore;
+	LayoutConstraints bestConstraints;
+
+	// ties go to the earlier candidate, the first one is the default layout
+	bool found = tryLayoutCandidate(builder, request, bestConstraints,
+			false, bestLayout, bestScore);
+
+	if (request.reserveDimm)
+	{
+		for (std::vector<Dimm>::const_iterator dimmIter = request.dimms.begin();
+				dimmIter != request.dimms.end(); dimmIter++)
+		{
+			LayoutConstraints candidate = bestConstraints;
+			candidate.reserveDimmGuid = dimmIter->guid;
+			if (tryLayoutCandidate(builder, request, candidate, found, bestLayout, bestScore))
+			{
+				bestConstraints = candidate;
+				found = true;
+			}
+		}
+	}
+
+	std::set<NVM_UINT16> sockets;
+	for (std::vector<Dimm>::const_iterator dimmIter = request.dimms.begin();
+			dimmIter != request.dimms.end(); dimmIter++)
+	{
+		sockets.insert(dimmIter->socket);
+	}
+
+	size_t waysCount = sizeof (LAYOUT_SEARCH_INTERLEAVE_WAYS) / sizeof (size_t);
+	for (std::set<NVM_UINT16>::const_iterator socketIter = sockets.begin();
+			socketIter != sockets.end(); socketIter++)
+	{
+		LayoutConstraints socketConstraints = bestConstraints;
+		for (size_t i = 0; i < waysCount; i++)
+		{
+			LayoutConstraints candidate = socketConstraints;
+			candidate.maxInterleaveWaysBySocket[*socketIter] = LAYOUT_SEARCH_INTERLEAVE_WAYS[i];
+			if (tryLayoutCandidate(builder, request, candidate, found, bestLayout, bestScore))
+			{
+				bestConstraints = candidate;
+				found = true;
+			}
+		}
+	}
+
+	if (!found)
+	{
+		// report why the default layout failed
+		bestLayout = builder.build(request);
+		validateLayout(request, bestLayout);
+	}
+
+	return bestLayout;
+}
+
+/*
+ * Build the layout for the constraints and keep it if it is valid and better
+ * than the best layout so far.
+ */
+bool wbem::logic::MemoryAllocator::tryLayoutCandidate(LayoutBuilder &builder,
+		const struct MemoryAllocationRequest& request,
+		const LayoutConstraints &constraints,
+		const bool haveBest,
+		MemoryAllocationLayout &bestLayout,
+		LayoutScore &bestScore)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	bool kept = false;
+	try
+	{
+		MemoryAllocationLayout layout = builder.build(request, constraints);
+		validateLayout(request, layout);
+
+		LayoutScore score = scoreLayout(request, layout);
+		if (!haveBest || layoutScoreIsBetter(score, bestScore))
+		{
+			bestLayout = layout;
+			bestScore = score;
+			kept = true;
+		}
+	}
+	catch (framework::Exception &)
+	{
+		// candidate can't satisfy the request
+	}
+
+	return kept;
+}
+
+wbem::logic::LayoutScore wbem::logic::MemoryAllocator::scoreLayout(
+		const struct MemoryAllocationRequest& request,
+		const MemoryAllocationLayout &layout)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	LayoutScore score;
+
+	// capacity marked REMAINING has nothing to deviate from
+	if (request.memoryCapacity != REQUEST_REMAINING_CAPACITY)
+	{
+		score.deviation += (layout.memoryCapacity > request.memoryCapacity) ?
+				layout.memoryCapacity - request.memoryCapacity :
+				request.memoryCapacity - layout.memoryCapacity;
+	}
+	for (size_t i = 0; i < request.appDirectExtents.size(); i++)
+	{
+		NVM_UINT64 requested = request.appDirectExtents[i].capacity;
+		NVM_UINT64 laidOut = (i < layout.appDirectCapacities.size()) ?
+				layout.appDirectCapacities[i] : 0;
+		if (requested != REQUEST_REMAINING_CAPACITY)
+		{
+			score.deviation += (laidOut > requested) ? laidOut - requested : requested - laidOut;
+		}
+	}
+
+	for (std::map<std::string, struct config_goal>::const_iterator goalIter = layout.goals.begin();
+			goalIter != layout.goals.end(); goalIter++)
+	{
+		const struct config_goal &goal = goalIter->second;
+		score.extentCount += goal.app_direct_count;
+		for (NVM_UINT16 i = 0; i < goal.app_direct_count; i++)
+		{
+			size_t ways = (i == 0) ? goal.app_direct_1_settings.interleave.ways :
+					goal.app_direct_2_settings.interleave.ways;
+			if (score.narrowestInterleaveWays == 0 || ways < score.narrowestInterleaveWays)
+			{
+				score.narrowestInterleaveWays = ways;
+			}
+		}
+	}
+
+	return score;
+}
+
+bool wbem::logic::MemoryAllocator::layoutScoreIsBetter(const LayoutScore &score,
+		const LayoutScore &bestScore)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	bool better = false;
+	if (score.deviation != bestScore.deviation)
+	{
+		better = score.deviation < bestScore.deviation;
+	}
+	else if (score.narrowestInterleaveWays != bestScore.narrowestInterleaveWays)
+	{
+		better = score.narrowestInterleaveWays > bestScore.narrowestInterleaveWays;
+	}
+	else
+	{
+		better = score.extentCount < bestScore.extentCount;
+	}
+
+	return better;
+}
+
 void wbem::logic::MemoryAllocator::populateRequestRules()
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
@@ -152,10 +336,10 @@ void wbem::logic::MemoryAllocator::populateRequestRules()
 	m_requestRules.push_back(new RuleAppDirectNotSupported(m_systemCapabilities));
 	m_requestRules.push_back(new RuleMirroredAppDirectNotSupported);
 	m_requestRules.push_back(new RuleStorageCapacityNotSupported(m_systemCapabilities));
-	m_requestRules.push_back(new RuleDimmHasConfigGoal);
-	m_requestRules.push_back(new RuleNamespacesExist(m_systemCapabilities));
+	m_requestRules.push_back(new RuleDimmHasConfigGoal(m_pLibApi));
+	m_requestRules.push_back(new RuleNamespacesExist(m_systemCapabilities, m_pLibApi));
 	m_requestRules.push_back(new RuleRejectLockedDimms(m_manageableDevices));
-	m_requestRules.push_back(new RulePartialSocketConfigured(m_manageableDevices));
+	m_requestRules.push_back(new RulePartialSocketConfigured(m_manageableDevices, m_pLibApi));
 }
 
 void wbem::logic::MemoryAllocator::populatePostLayoutChecks()
@@ -218,27 +402,57 @@ void wbem::logic::MemoryAllocator::deleteLayoutRules()
 void wbem::logic::MemoryAllocator::allocate(struct MemoryAllocationLayout &layout)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
-	bool atLeastOneRequestSucceeded = false;
 
+	MemoryAllocationResults results;
+	allocate(layout, results);
+}
+
+void wbem::logic::MemoryAllocator::allocate(struct MemoryAllocationLayout &layout,
+		MemoryAllocationResults &results)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	results.clear();
+	if (layout.goals.empty())
+	{
+		return;
+	}
+
+	std::vector<struct device_config_goal> goals(layout.goals.size());
+	size_t goalIdx = 0;
 	for (std::map<std::string, struct config_goal>::iterator goalIter = layout.goals.begin();
-			goalIter != layout.goals.end(); goalIter++)
+			goalIter != layout.goals.end(); goalIter++, goalIdx++)
 	{
-		NVM_GUID guid;
-		str_to_guid((*goalIter).first.c_str(), guid);
-		int rc = m_pLibApi->createConfigGoal(guid, &((*goalIter).second));
-		if (rc != NVM_SUCCESS)
+		str_to_guid((*goalIter).first.c_str(), goals[goalIdx].device_guid);
+		goals[goalIdx].goal = (*goalIter).second;
+	}
+
+	// the library validates every goal first and restores the DIMMs already written on failure
+	int rc = m_pLibApi->createConfigGoals(&goals[0], goals.size());
+
+	bool goalLeftOnDimm = false;
+	goalIdx = 0;
+	for (std::map<std::string, struct config_goal>::iterator goalIter = layout.goals.begin();
+			goalIter != layout.goals.end(); goalIter++, goalIdx++)
+	{
+		results[(*goalIter).first] = goals[goalIdx].rc;
+		if (goals[goalIdx].goal_applied)
 		{
-			COMMON_LOG_ERROR_F("creating config goal failed with rc = %d", rc);
-			if (atLeastOneRequestSucceeded)
-			{
-				throw exception::NvmExceptionPartialResultsCouldNotBeUndone();
-			}
-			else
-			{
-				throw exception::NvmExceptionLibError(rc);
-			}
+			goalLeftOnDimm = true;
+		}
+	}
+
+	if (rc != NVM_SUCCESS)
+	{
+		COMMON_LOG_ERROR_F("creating config goals failed with rc = %d", rc);
+		if (goalLeftOnDimm)
+		{
+			throw exception::NvmExceptionPartialResultsCouldNotBeUndone();
+		}
+		else
+		{
+			throw exception::NvmExceptionLibError(rc);
 		}
-		atLeastOneRequestSucceeded = true;
 	}
 }
 
@@ -45,6 +45,8 @@ namespace wbem
 namespace logic
 {
 
+class LayoutBuilder;
+
 class NVM_API MemoryAllocator
 {
 	public:
@@ -65,9 +67,25 @@ class NVM_API MemoryAllocator
 		MemoryAllocationLayout layout(const struct MemoryAllocationRequest &request);
 		void allocate(struct MemoryAllocationLayout &layout);
 
+		/*
+		 * Apply every goal in the layout or none of them. The outcome on each
+		 * DIMM is returned in results, even when an exception is thrown.
+		 */
+		void allocate(struct MemoryAllocationLayout &layout, MemoryAllocationResults &results);
+
 		static NVM_UINT64 getTotalCapacitiesOfRequestedDimmsinB(const MemoryAllocationRequest& request);
 
 	protected:
+		MemoryAllocationLayout searchLayouts(const struct MemoryAllocationRequest &request);
+		bool tryLayoutCandidate(LayoutBuilder &builder,
+				const struct MemoryAllocationRequest &request,
+				const LayoutConstraints &constraints,
+				const bool haveBest,
+				MemoryAllocationLayout &bestLayout,
+				LayoutScore &bestScore);
+		LayoutScore scoreLayout(const struct MemoryAllocationRequest &request,
+				const MemoryAllocationLayout &layout);
+		bool layoutScoreIsBetter(const LayoutScore &score, const LayoutScore &bestScore);
 		void validateLayout(
 				const struct MemoryAllocationRequest &request,
 				const MemoryAllocationLayout layout);
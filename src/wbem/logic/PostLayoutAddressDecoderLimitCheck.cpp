@@ -46,6 +46,14 @@ wbem::logic::PostLayoutAddressDecoderLimitCheck::PostLayoutAddressDecoderLimitCh
 		m_numSystemSockets(numSystemSockets)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	for (std::vector<struct device_discovery>::const_iterator iter = m_devices.begin();
+			iter != m_devices.end(); iter++)
+	{
+		NVM_GUID_STR guidStr;
+		guid_to_str(iter->guid, guidStr);
+		m_dimmSockets[guidStr] = iter->socket_id;
+	}
 }
 
 wbem::logic::PostLayoutAddressDecoderLimitCheck::~PostLayoutAddressDecoderLimitCheck()
@@ -53,19 +61,16 @@ wbem::logic::PostLayoutAddressDecoderLimitCheck::~PostLayoutAddressDecoderLimitC
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 }
 
-NVM_UINT16 wbem::logic::PostLayoutAddressDecoderLimitCheck::getSocketIdForDimm(NVM_GUID &guid)
+NVM_UINT16 wbem::logic::PostLayoutAddressDecoderLimitCheck::getSocketIdForDimm(
+		const std::string &dimmGuid)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
 	NVM_UINT16 socketId = 0;
-	for (std::vector<struct device_discovery>::const_iterator iter = m_devices.begin();
-			iter != m_devices.end(); iter++)
+	std::map<std::string, NVM_UINT16>::const_iterator iter = m_dimmSockets.find(dimmGuid);
+	if (iter != m_dimmSockets.end())
 	{
-		if (guid_cmp(iter->guid, guid))
-		{
-			socketId = iter->socket_id;
-			break;
-		}
+		socketId = iter->second;
 	}
 
 	return socketId;
@@ -80,9 +85,7 @@ std::list<NVM_UINT16> wbem::logic::PostLayoutAddressDecoderLimitCheck::getListOf
 	for (std::map<std::string, struct config_goal>::const_iterator iter = layout.goals.begin();
 			iter != layout.goals.end(); iter++)
 	{
-		NVM_GUID guid;
-		str_to_guid((*iter).first.c_str(), guid);
-		NVM_UINT16 socketId = getSocketIdForDimm(guid);
+		NVM_UINT16 socketId = getSocketIdForDimm(iter->first);
 		socketList.push_back(socketId);
 	}
 
@@ -100,9 +103,7 @@ std::vector<struct config_goal> wbem::logic::PostLayoutAddressDecoderLimitCheck:
 	for (std::map<std::string, struct config_goal>::const_iterator iter = layout.goals.begin();
 			iter != layout.goals.end(); iter++)
 	{
-		NVM_GUID guid;
-		str_to_guid((*iter).first.c_str(), guid);
-		NVM_UINT16 dimmSocketId = getSocketIdForDimm(guid);
+		NVM_UINT16 dimmSocketId = getSocketIdForDimm(iter->first);
 
 		if (dimmSocketId == socketId)
 		{
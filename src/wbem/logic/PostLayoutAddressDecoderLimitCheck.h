@@ -36,6 +36,8 @@
 #include <nvm_types.h>
 #include <vector>
 #include <list>
+#include <map>
+#include <string>
 
 static const NVM_UINT16 criticalNumberOfSockets = 8;
 static const NVM_UINT16 criticalNumberOfIlsetsOnSocket = 7;
@@ -60,7 +62,7 @@ class NVM_API PostLayoutAddressDecoderLimitCheck: public PostLayoutCheck
 		/*
 		 * For a given dimm, get the socketId
 		 */
-		NVM_UINT16 getSocketIdForDimm(NVM_GUID &guid);
+		NVM_UINT16 getSocketIdForDimm(const std::string &dimmGuid);
 
 		/*
 		 * Get a list of all the sockets involved in the layout
@@ -90,6 +92,7 @@ class NVM_API PostLayoutAddressDecoderLimitCheck: public PostLayoutCheck
 				const struct interleave_set &interleave);
 
 		std::vector<struct device_discovery> m_devices;
+		std::map<std::string, NVM_UINT16> m_dimmSockets; // dimm GUID to socket ID map
 		std::vector<struct pool> m_pools;
 		NVM_UINT16 m_numSystemSockets;
 };
@@ -36,9 +36,15 @@
 #include <lib_interface/NvmApi.h>
 #include <exception/NvmExceptionLibError.h>
 
-wbem::logic::RuleDimmHasConfigGoal::RuleDimmHasConfigGoal()
+wbem::logic::RuleDimmHasConfigGoal::RuleDimmHasConfigGoal(lib_interface::NvmApi *pApi) :
+		m_pLibApi(pApi)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	if (!m_pLibApi)
+	{
+		m_pLibApi = lib_interface::NvmApi::getApi();
+	}
 }
 
 wbem::logic::RuleDimmHasConfigGoal::~RuleDimmHasConfigGoal()
@@ -50,8 +56,6 @@ void wbem::logic::RuleDimmHasConfigGoal::verify(const MemoryAllocationRequest &r
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
-	wbem::lib_interface::NvmApi *pApi = wbem::lib_interface::NvmApi::getApi();
-
 	for (std::vector<struct Dimm>::const_iterator dimmIter = request.dimms.begin();
 				dimmIter != request.dimms.end(); dimmIter++)
 	{
@@ -59,7 +63,7 @@ void wbem::logic::RuleDimmHasConfigGoal::verify(const MemoryAllocationRequest &r
 		str_to_guid((*dimmIter).guid.c_str(), guid);
 
 		struct config_goal goal;
-		int rc = pApi->getConfigGoal(guid, &goal);
+		int rc = m_pLibApi->getConfigGoal(guid, &goal);
 
 		if (rc == NVM_SUCCESS)
 		{
@@ -34,6 +34,7 @@
 
 #include "RequestRule.h"
 #include <nvm_types.h>
+#include <lib_interface/NvmApi.h>
 
 namespace wbem
 {
@@ -43,9 +44,12 @@ namespace logic
 class NVM_API RuleDimmHasConfigGoal: public RequestRule
 {
 	public:
-		RuleDimmHasConfigGoal();
+		RuleDimmHasConfigGoal(lib_interface::NvmApi *pApi = NULL);
 		virtual ~RuleDimmHasConfigGoal();
 		virtual void verify(const MemoryAllocationRequest &request);
+
+	protected:
+		lib_interface::NvmApi *m_pLibApi;
 };
 
 } /* namespace logic */
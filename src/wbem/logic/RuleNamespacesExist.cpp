@@ -38,10 +38,16 @@
 #include <lib_interface/NvmApi.h>
 
 wbem::logic::RuleNamespacesExist::RuleNamespacesExist(
-		const struct nvm_capabilities &systemCapabilities) :
-		m_systemCapabilities(systemCapabilities)
+		const struct nvm_capabilities &systemCapabilities,
+		lib_interface::NvmApi *pApi) :
+		m_systemCapabilities(systemCapabilities), m_pLibApi(pApi)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	if (!m_pLibApi)
+	{
+		m_pLibApi = lib_interface::NvmApi::getApi();
+	}
 }
 
 wbem::logic::RuleNamespacesExist::~RuleNamespacesExist()
@@ -53,15 +59,13 @@ void wbem::logic::RuleNamespacesExist::verify(const MemoryAllocationRequest &req
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
-	lib_interface::NvmApi *pApi = lib_interface::NvmApi::getApi();
-
 	// check each dimm in the request to every namespace
 	for (std::vector<struct Dimm>::const_iterator dimmIter = request.dimms.begin();
 			dimmIter != request.dimms.end(); dimmIter++)
 	{
 		NVM_GUID dimmGuid;
 		str_to_guid(dimmIter->guid.c_str(), dimmGuid);
-		int nsCount = pApi->getDeviceNamespaceCount(dimmGuid, NAMESPACE_TYPE_UNKNOWN);
+		int nsCount = m_pLibApi->getDeviceNamespaceCount(dimmGuid, NAMESPACE_TYPE_UNKNOWN);
 		if (nsCount < 0) // error
 		{
 			// If retrieving NS' is not supported, allow Memory goal creation on MemoryMode SKU
@@ -34,6 +34,7 @@
 
 #include "RequestRule.h"
 #include <nvm_types.h>
+#include <lib_interface/NvmApi.h>
 
 namespace wbem
 {
@@ -43,12 +44,14 @@ namespace logic
 class NVM_API RuleNamespacesExist : public RequestRule
 {
 	public:
-		RuleNamespacesExist(const struct nvm_capabilities &systemCapabilities);
+		RuleNamespacesExist(const struct nvm_capabilities &systemCapabilities,
+				lib_interface::NvmApi *pApi = NULL);
 		virtual ~RuleNamespacesExist();
 		virtual void verify(const MemoryAllocationRequest &request);
 
 	protected:
 		struct nvm_capabilities m_systemCapabilities;
+		lib_interface::NvmApi *m_pLibApi;
 };
 
 } /* namespace logic */
@@ -36,13 +36,18 @@
 #include <guid/guid.h>
 #include <nvm_management.h>
 #include <lib_interface/NvmApi.h>
-#include <mem_config/MemoryConfigurationServiceFactory.h>
 
 wbem::logic::RulePartialSocketConfigured::RulePartialSocketConfigured(
-		const std::vector<struct device_discovery> manageableDevices) :
-		m_manageableDimms(manageableDevices)
+		const std::vector<struct device_discovery> manageableDevices,
+		lib_interface::NvmApi *pApi) :
+		m_manageableDimms(manageableDevices), m_pLibApi(pApi)
 {
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	if (!m_pLibApi)
+	{
+		m_pLibApi = lib_interface::NvmApi::getApi();
+	}
 }
 
 wbem::logic::RulePartialSocketConfigured::~RulePartialSocketConfigured()
@@ -108,11 +113,9 @@ bool wbem::logic::RulePartialSocketConfigured::deviceIsNew(NVM_GUID guid)
 	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
 
 	bool deviceIsNew = false;
-	lib_interface::NvmApi *pApi = lib_interface::NvmApi::getApi();
-
 	struct device_status status;
 	memset(&status, 0, sizeof (struct device_status));
-	int rc = pApi->getDeviceStatus(guid, &status);
+	int rc = m_pLibApi->getDeviceStatus(guid, &status);
 	if (rc != NVM_SUCCESS)
 	{
 		COMMON_LOG_ERROR_F("Failed to retrieve device status rc = ", rc);
@@ -34,6 +34,7 @@
 
 #include "RequestRule.h"
 #include <nvm_types.h>
+#include <lib_interface/NvmApi.h>
 #include <set>
 #include <vector>
 #include <list>
@@ -45,7 +46,8 @@ namespace logic
 class NVM_API RulePartialSocketConfigured : public RequestRule
 {
 	public:
-		RulePartialSocketConfigured(const std::vector<struct device_discovery> manageableDevices);
+		RulePartialSocketConfigured(const std::vector<struct device_discovery> manageableDevices,
+				lib_interface::NvmApi *pApi = NULL);
 		virtual ~RulePartialSocketConfigured();
 		virtual void verify(const MemoryAllocationRequest &request);
 
@@ -59,6 +61,7 @@ class NVM_API RulePartialSocketConfigured : public RequestRule
 		void validateRequestForSocket(const std::vector<Dimm> &requestDimms, NVM_UINT16 socketId);
 
 		std::vector<struct device_discovery> m_manageableDimms;
+		lib_interface::NvmApi *m_pLibApi;
 };
 
 } /* namespace logic */
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Answers the NvmApi queries made by the memory allocation logic from a
+ * synthetic topology instead of the hardware.
+ */
+
+#include "TopologyNvmApi.h"
+#include <LogEnterExit.h>
+#include <guid/guid.h>
+#include <exception/NvmExceptionLibError.h>
+
+wbem::logic::TopologyNvmApi::TopologyNvmApi(const struct nvm_capabilities &capabilities,
+		const std::vector<struct device_discovery> &devices,
+		const NVM_UINT16 socketCount) :
+		m_capabilities(capabilities), m_devices(devices), m_socketCount(socketCount)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+}
+
+wbem::logic::TopologyNvmApi::~TopologyNvmApi()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+}
+
+bool wbem::logic::TopologyNvmApi::deviceExists(const NVM_GUID deviceGuid) const
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	bool exists = false;
+	for (std::vector<struct device_discovery>::const_iterator iter = m_devices.begin();
+			iter != m_devices.end(); iter++)
+	{
+		if (guid_cmp(iter->guid, deviceGuid))
+		{
+			exists = true;
+			break;
+		}
+	}
+
+	return exists;
+}
+
+int wbem::logic::TopologyNvmApi::getSocketCount()
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+	return m_socketCount;
+}
+
+int wbem::logic::TopologyNvmApi::getNvmCapabilities(struct nvm_capabilities *pCapabilities)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	int rc = NVM_SUCCESS;
+	if (pCapabilities == NULL)
+	{
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else
+	{
+		*pCapabilities = m_capabilities;
+	}
+	return rc;
+}
+
+int wbem::logic::TopologyNvmApi::getDeviceStatus(const NVM_GUID deviceGuid,
+		struct device_status *pStatus)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	int rc = NVM_SUCCESS;
+	if (pStatus == NULL)
+	{
+		rc = NVM_ERR_INVALIDPARAMETER;
+	}
+	else if (!deviceExists(deviceGuid))
+	{
+		rc = NVM_ERR_BADDEVICE;
+	}
+	else
+	{
+		// every synthetic DIMM is unconfigured
+		memset(pStatus, 0, sizeof (struct device_status));
+		pStatus->is_new = 1;
+	}
+	return rc;
+}
+
+int wbem::logic::TopologyNvmApi::createConfigGoal(const NVM_GUID deviceGuid,
+		struct config_goal *pGoal)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	// a plan never changes anything
+	return NVM_ERR_NOTSUPPORTED;
+}
+
+int wbem::logic::TopologyNvmApi::createConfigGoals(struct device_config_goal *pGoals,
+		const NVM_UINT32 count)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	// a plan never changes anything
+	return NVM_ERR_NOTSUPPORTED;
+}
+
+int wbem::logic::TopologyNvmApi::getConfigGoal(const NVM_GUID deviceGuid,
+		struct config_goal *pGoal)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	return deviceExists(deviceGuid) ? NVM_ERR_NOTFOUND : NVM_ERR_BADDEVICE;
+}
+
+int wbem::logic::TopologyNvmApi::getDeviceNamespaceCount(const NVM_GUID deviceGuid,
+		const enum namespace_type type)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	return deviceExists(deviceGuid) ? 0 : NVM_ERR_BADDEVICE;
+}
+
+void wbem::logic::TopologyNvmApi::getConfigGoalForDimm(const std::string &dimmGuid,
+		struct config_goal &goal) const
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	throw exception::NvmExceptionLibError(NVM_ERR_NOTFOUND);
+}
+
+void wbem::logic::TopologyNvmApi::getPools(std::vector<struct pool> &pools) const
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	// no capacity is provisioned yet
+	pools.clear();
+}
+
+void wbem::logic::TopologyNvmApi::getDevices(std::vector<struct device_discovery> &devices) const
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	devices = m_devices;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Answers the NvmApi queries made by the memory allocation logic from a
+ * synthetic topology instead of the hardware.
+ */
+
+#ifndef _WBEM_LOGIC_TOPOLOGYNVMAPI_H_
+#define _WBEM_LOGIC_TOPOLOGYNVMAPI_H_
+
+#include <lib_interface/NvmApi.h>
+#include <vector>
+
+namespace wbem
+{
+namespace logic
+{
+
+class NVM_API TopologyNvmApi : public lib_interface::NvmApi
+{
+	public:
+		TopologyNvmApi(const struct nvm_capabilities &capabilities,
+				const std::vector<struct device_discovery> &devices,
+				const NVM_UINT16 socketCount);
+		virtual ~TopologyNvmApi();
+
+		virtual int getSocketCount();
+		virtual int getNvmCapabilities(struct nvm_capabilities *pCapabilities);
+		virtual int getDeviceStatus(const NVM_GUID deviceGuid, struct device_status *pStatus);
+		virtual int createConfigGoal(const NVM_GUID deviceGuid, struct config_goal *pGoal);
+		virtual int createConfigGoals(struct device_config_goal *pGoals, const NVM_UINT32 count);
+		virtual int getConfigGoal(const NVM_GUID deviceGuid, struct config_goal *pGoal);
+		virtual int getDeviceNamespaceCount(const NVM_GUID deviceGuid,
+				const enum namespace_type type);
+		virtual void getConfigGoalForDimm(const std::string &dimmGuid,
+				struct config_goal &goal) const;
+		virtual void getPools(std::vector<struct pool> &pools) const;
+		virtual void getDevices(std::vector<struct device_discovery> &devices) const;
+
+	protected:
+		bool deviceExists(const NVM_GUID deviceGuid) const;
+
+		struct nvm_capabilities m_capabilities;
+		std::vector<struct device_discovery> m_devices;
+		NVM_UINT16 m_socketCount;
+};
+
+} /* namespace logic */
+} /* namespace wbem */
+
+#endif /* _WBEM_LOGIC_TOPOLOGYNVMAPI_H_ */
@@ -87,6 +87,12 @@ class NVM_API MemoryConfigurationFactory  : public framework_interface::NvmInsta
 		wbem::framework::instances_t *getInstancesFromLayout(const wbem::logic::MemoryAllocationLayout &layout,
 				framework::attribute_names_t &attributes);
 
+		/*
+		 * Return the Storage Mode capacity for the given dimm for the goal config
+		 */
+		static NVM_UINT64 getDimmStorageCapacityFromGoal
+			(const struct device_discovery *pDiscovery, const struct config_goal &goal);
+
 	private:
 		/*
 		 * Return true if the given dimm is in at least one pool
@@ -131,12 +137,6 @@ class NVM_API MemoryConfigurationFactory  : public framework_interface::NvmInsta
 				(const NVM_GUID guid, const std::vector<struct pool> &pools)
 						throw (framework::Exception);
 
-		/*
-		 * Return the Storage Mode capacity for the given dimm for the goal config
-		 */
-		static NVM_UINT64 getDimmStorageCapacityFromGoal
-			(const struct device_discovery *pDiscovery, const struct config_goal &goal);
-
 		/*
 		 * finish populating the goal instance
 		 */
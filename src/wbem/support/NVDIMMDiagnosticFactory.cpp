@@ -49,6 +49,7 @@ wbem::support::NVDIMMDiagnosticFactory::NVDIMMDiagnosticFactory()
 	throw (wbem::framework::Exception)
 {
 	m_RunDiagProvider = nvm_run_diagnostic;
+	m_RunQuickDiagsProvider = nvm_run_quick_diagnostics;
 }
 
 wbem::support::NVDIMMDiagnosticFactory::~NVDIMMDiagnosticFactory()
@@ -259,6 +260,35 @@ void wbem::support::NVDIMMDiagnosticFactory::RunDiagnosticService(NVM_GUID devic
 	}
 }
 
+std::vector<struct device_quick_diagnostic_result>
+	wbem::support::NVDIMMDiagnosticFactory::RunQuickDiagnosticService(
+		const std::vector<std::string> &deviceGuids,
+		framework::UINT16_LIST ignoreList)
+	throw (framework::Exception)
+{
+	LogEnterExit logging(__FUNCTION__, __FILE__, __LINE__);
+
+	struct diagnostic diags = getDiagnosticStructure(NVDIMMDIAGNOSTIC_TEST_QUICK, ignoreList);
+
+	std::vector<struct device_quick_diagnostic_result> results(deviceGuids.size());
+	for (size_t i = 0; i < deviceGuids.size(); i++)
+	{
+		memset(&results[i], 0, sizeof (struct device_quick_diagnostic_result));
+		str_to_guid(deviceGuids[i].c_str(), results[i].device_guid);
+	}
+
+	if (!results.empty())
+	{
+		int rc = m_RunQuickDiagsProvider(&diags, &results[0], results.size());
+		if (rc != NVM_SUCCESS)
+		{
+			throw exception::NvmExceptionLibError(rc);
+		}
+	}
+
+	return results;
+}
+
 bool wbem::support::NVDIMMDiagnosticFactory::testTypeValid(std::string testType)
 {
 	bool rc = true;
@@ -426,6 +456,9 @@ struct diagnostic wbem::support::NVDIMMDiagnosticFactory::getDiagnosticStructure
 			case SET_IGNORE_DEBUGLOG:
 				diags.excludes |= (NVM_UINT64)DIAG_THRESHOLD_FW_DEBUGLOG;
 				break;
+			case SET_IGNORE_SITE_RULES:
+				diags.excludes |= (NVM_UINT64)DIAG_THRESHOLD_FW_SITE_RULES;
+				break;
 			default:
 				COMMON_LOG_ERROR_F("Settings Ignore value %d is invalid for test %s",
 						ignoreList[i], NVDIMMDIAGNOSTIC_TEST_SETTING.c_str());
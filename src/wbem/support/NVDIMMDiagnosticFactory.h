@@ -35,6 +35,7 @@
 #define	_WBEM_SUPPORT_NVDIMMDIAGNOSTIC_FACTORY_H_
 
 #include <string>
+#include <vector>
 #include <server/BaseServerFactory.h>
 #include <nvm_management.h>
 #include <framework_interface/NvmInstanceFactory.h>
@@ -129,7 +130,8 @@ namespace support
 		SET_IGNORE_POW_MGMT_POLICIES,
 		SET_IGNORE_DIE_SPARING_POLICIES,
 		SET_IGNORE_TIME,
-		SET_IGNORE_DEBUGLOG
+		SET_IGNORE_DEBUGLOG,
+		SET_IGNORE_SITE_RULES
 	};
 
 	static const NVM_UINT32 NVDIMMDIAGNOSTIC_ERR_NOT_SUPPORTED = 1;
@@ -188,6 +190,13 @@ class NVM_API NVDIMMDiagnosticFactory : public framework_interface::NvmInstanceF
 				const struct diagnostic *p_diagnostic,
 				NVM_UINT32 *p_results);
 
+		/*!
+		 * Provider for extern int nvm_run_quick_diagnostics
+		 */
+		int (*m_RunQuickDiagsProvider)(const struct diagnostic *p_diagnostic,
+				struct device_quick_diagnostic_result *p_results,
+				const NVM_UINT32 count);
+
 		/*!
 		 * Helper method to verify test type is valid.
 		 * @param testType test type in question
@@ -208,6 +217,18 @@ class NVM_API NVDIMMDiagnosticFactory : public framework_interface::NvmInstanceF
 				std::string testType)
 			throw (framework::Exception);
 
+		/*!
+		 * Run the quick diagnostic on several NVM-DIMMs concurrently
+		 * @param deviceGuids The NVM-DIMMs against which to run the diagnostic
+		 * @param ignoreList Health checks to skip
+		 * @throw Exception if unable to run the diagnostic at all
+		 * @return The outcome for each NVM-DIMM, in the same order as deviceGuids
+		 */
+		std::vector<struct device_quick_diagnostic_result> RunQuickDiagnosticService(
+				const std::vector<std::string> &deviceGuids,
+				framework::UINT16_LIST ignoreList)
+			throw (framework::Exception);
+
 		wbem::framework::UINT32 executeMethod(
 				wbem::framework::UINT32 &wbem_return,
 				const std::string method,
@@ -65,6 +65,11 @@ void wbem::support::SanitizeJobFactory::populateAttributeList(
 	attributes.push_back(PERCENTCOMPLETE_KEY);
 	attributes.push_back(DELETEONCOMPLETION_KEY);
 	attributes.push_back(TIMEBEFOREREMOVAL_KEY);
+	attributes.push_back(OWNER_KEY);
+	attributes.push_back(STARTTIME_KEY);
+	attributes.push_back(ELAPSEDTIME_KEY);
+	attributes.push_back(TIMEOFLASTSTATECHANGE_KEY);
+	attributes.push_back(ESTIMATEDCOMPLETIONTIME_KEY);
 }
 
 wbem::framework::instance_names_t* wbem::support::SanitizeJobFactory::getInstanceNames()
@@ -211,7 +216,7 @@ wbem::framework::Instance* wbem::support::SanitizeJobFactory::getInstance(wbem::
 			{
 				jobState = "Unknown";
 			}
-			else if (jobs[foundIndex].status == NVM_JOB_STATUS_UNKNOWN)
+			else if (jobs[foundIndex].status == NVM_JOB_STATUS_NOT_STARTED)
 			{
 				jobState = "Not started";
 			}
@@ -251,6 +256,53 @@ wbem::framework::Instance* wbem::support::SanitizeJobFactory::getInstance(wbem::
 							wbem::framework::DATETIME_SUBTYPE_INTERVAL, false);
 			pInstance->setAttribute(TIMEBEFOREREMOVAL_KEY, timeAttr, attributes);
 		}
+
+		// Owner - the user that started the job, empty if started outside of the library
+		if (containsAttribute(OWNER_KEY, attributes))
+		{
+			framework::Attribute a(std::string(jobs[foundIndex].requester), false);
+			pInstance->setAttribute(OWNER_KEY, a, attributes);
+		}
+
+		// StartTime - when the job was started, 0 if unknown
+		if (containsAttribute(STARTTIME_KEY, attributes))
+		{
+			framework::Attribute timeAttr((unsigned long long)jobs[foundIndex].start_time,
+					wbem::framework::DATETIME_SUBTYPE_DATETIME, false);
+			pInstance->setAttribute(STARTTIME_KEY, timeAttr, attributes);
+		}
+
+		// ElapsedTime - from the start until completion or the last progress update
+		if (containsAttribute(ELAPSEDTIME_KEY, attributes))
+		{
+			unsigned long long elapsed = 0;
+			time_t until = jobs[foundIndex].end_time ?
+					jobs[foundIndex].end_time : jobs[foundIndex].last_update_time;
+			if (jobs[foundIndex].start_time && until > jobs[foundIndex].start_time)
+			{
+				elapsed = (unsigned long long)(until - jobs[foundIndex].start_time);
+			}
+			framework::Attribute timeAttr(elapsed,
+					wbem::framework::DATETIME_SUBTYPE_INTERVAL, false);
+			pInstance->setAttribute(ELAPSEDTIME_KEY, timeAttr, attributes);
+		}
+
+		// TimeOfLastStateChange - when the progress was last read from the device
+		if (containsAttribute(TIMEOFLASTSTATECHANGE_KEY, attributes))
+		{
+			framework::Attribute timeAttr((unsigned long long)jobs[foundIndex].last_update_time,
+					wbem::framework::DATETIME_SUBTYPE_DATETIME, false);
+			pInstance->setAttribute(TIMEOFLASTSTATECHANGE_KEY, timeAttr, attributes);
+		}
+
+		// EstimatedCompletionTime - projected from the progress so far, 0 if unknown
+		if (containsAttribute(ESTIMATEDCOMPLETIONTIME_KEY, attributes))
+		{
+			framework::Attribute timeAttr(
+					(unsigned long long)jobs[foundIndex].estimated_completion_time,
+					wbem::framework::DATETIME_SUBTYPE_DATETIME, false);
+			pInstance->setAttribute(ESTIMATEDCOMPLETIONTIME_KEY, timeAttr, attributes);
+		}
 	}
 	catch (framework::Exception &) // clean up and re-throw
 	{
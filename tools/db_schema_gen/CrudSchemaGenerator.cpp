@@ -117,6 +117,77 @@ void CrudSchemaGenerator::fillAttributeDictionary(ctemplate::TemplateDictionary*
 	}
 }
 
+void CrudSchemaGenerator::fillIndexDictionary(ctemplate::TemplateDictionary* pDictionary,
+		Entity &entity, Index &index)
+{
+	std::vector<std::string> columns = index.getColumns();
+	std::vector<Attribute> attributes = entity.getAttributes();
+	std::string functionSuffix = "";
+	std::string orderBy = "";
+
+	for (size_t i = 0; i < columns.size(); i++)
+	{
+		std::vector<Attribute>::iterator att = attributes.begin();
+		while (att != attributes.end() && att->getName() != columns[i])
+		{
+			att++;
+		}
+		if (att == attributes.end())
+		{
+			std::cout << "Warning: index column " << entity.getName() << "." << columns[i]
+				<< " is not an attribute" << std::endl;
+			continue;
+		}
+
+		ctemplate::TemplateDictionary *condDict = pDictionary->AddSectionDictionary("INDEX_CONDITION");
+		(*condDict)["COND_NAME"] = att->getName();
+		(*condDict)["COND_TYPE"] = att->getSqlType();
+		(*condDict)["COND_C_TYPE"] = att->getCType();
+
+		// the last integer column of an index is queried as a range, everything else by value
+		if (i == columns.size() - 1 && !att->getIsText())
+		{
+			(*condDict).ShowSection("RANGE");
+			(*pDictionary).ShowSection("INDEX_RANGE");
+			(*pDictionary)["RANGE_ATTRIBUTE_NAME"] = att->getName();
+			orderBy = "ORDER BY " + att->getName() + " DESC, rowid DESC";
+			functionSuffix = "_range";
+		}
+		else
+		{
+			(*condDict).ShowSection("EQUAL");
+		}
+	}
+
+	// rows come back in the same order as the table's other getters when it declares one
+	for (size_t i = 0; i < attributes.size(); i++)
+	{
+		if (attributes[i].getIsOrderBy())
+		{
+			orderBy = "ORDER BY " + attributes[i].getName();
+		}
+		else if (attributes[i].getIsOrderByDesc())
+		{
+			orderBy = "ORDER BY " + attributes[i].getName() + " DESC";
+		}
+	}
+	(*pDictionary)["INDEX_ORDER_BY"] = orderBy;
+
+	std::string columnList;
+	for (size_t i = 0; i < columns.size(); i++)
+	{
+		columnList += (i > 0 ? ", " : "") + columns[i];
+	}
+	(*pDictionary)["INDEX_NAME"] = index.getName();
+	(*pDictionary)["INDEX_COLUMNS"] = columnList;
+	(*pDictionary)["F_GET_BY_INDEX"] =
+			"db_get_" + entity.getName() + "s_by_" + index.getName() + functionSuffix;
+	(*pDictionary)["F_GET_COUNT_BY_INDEX"] =
+			"db_get_" + entity.getName() + "_count_by_" + index.getName() + functionSuffix;
+	(*pDictionary)["F_DELETE_BY_INDEX"] =
+			"db_delete_" + entity.getName() + "s_by_" + index.getName() + functionSuffix;
+}
+
 /*!
  * @copybrief Generate
  * @details
@@ -247,6 +318,7 @@ void CrudSchemaGenerator::Generate(std::vector<Entity> schema,
 					(*tableDict)["F_UPDATE_BY_PK"] = "db_update_" + entity.getName() + "_by_" + attribute->getName();
 					(*tableDict)["F_DELETE_BY_PK"] = "db_delete_" + entity.getName() + "_by_" + attribute->getName();
 					(*tableDict)["F_GET_BY_PK"] = "db_get_" + entity.getName() + "_by_" + attribute->getName();
+					(*tableDict)["F_UPSERT"] = "db_upsert_" + entity.getName();
 					pk = attribute->getName();
 
 					// only primary keys can be indexed
@@ -291,6 +363,13 @@ void CrudSchemaGenerator::Generate(std::vector<Entity> schema,
 				(*tableDict)["F_CLEAR_ATTRIBUTE"] = "db_clear_" + entity.getName() + "_" + attribute->getName();
 			}
 		}
+
+		std::vector<Index> indexes = entity.getIndexes();
+		std::vector<Index>::iterator idx;
+		for (idx = indexes.begin(); idx != indexes.end(); idx++)
+		{
+			fillIndexDictionary((*tableDict).AddSectionDictionary("INDEX"), entity, *idx);
+		}
 	}
 
 	// +1 more for the history table (an automatic table, not included in the schema map
@@ -371,6 +450,16 @@ void CrudSchemaGenerator::CreateDoc(std::vector<Entity> schema,
 			}
 		}
 
+		std::vector<Index> indexes = entity.getIndexes();
+		if (!indexes.empty())
+		{
+			schemaDoc << "Indexes: \n";
+			for (std::vector<Index>::iterator idx = indexes.begin(); idx != indexes.end(); idx++)
+			{
+				schemaDoc << "\t" << idx->getName() << "\n";
+			}
+		}
+
 		schemaDoc << "\n";
 	}
 
@@ -101,6 +101,18 @@ private:
 	static void fillAttributeDictionary(ctemplate::TemplateDictionary *pDictionary,
 			Attribute *pAttribute, int attributeIndex);
 
+	/*!
+	 * Fill the TemplateDictionary with a secondary index and the conditions used to query it
+	 * @param pDictionary
+	 * 		Dictionary to fill
+	 * @param entity
+	 * 		Entity the index belongs to. Used to look up the indexed Attributes
+	 * @param index
+	 * 		Index that will be used to fill the dictionary
+	 */
+	static void fillIndexDictionary(ctemplate::TemplateDictionary *pDictionary,
+			Entity &entity, Index &index);
+
 
 public:
 	/*!
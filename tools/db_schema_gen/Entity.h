@@ -33,6 +33,7 @@
 #include <string.h>
 #include "Attribute.h"
 #include "Relationship.h"
+#include "Index.h"
 
 #ifndef ENTITY_CPP_
 #define ENTITY_CPP_
@@ -96,6 +97,19 @@ public:
 		m_relationships.push_back(Relationship(name, relatedEntity, count));
 	}
 
+	/*!
+	 * Add a secondary index to the entity
+	 * @param column
+	 * 		Name of the leading column. Chain Index::thenBy to index more columns.
+	 * @return
+	 * 		Reference to the index added
+	 */
+	Index& addIndex(const std::string &column)
+	{
+		m_indexes.push_back(Index(column));
+		return m_indexes.back();
+	}
+
 	/*!
 	 * getAttributes
 	 * @return the Entity's attribute list
@@ -108,6 +122,12 @@ public:
 	 */
 	std::vector<Relationship> getRelationships() { return m_relationships; }
 
+	/*!
+	 * getIndexes
+	 * @return the Entity's secondary index list
+	 */
+	std::vector<Index> getIndexes() { return m_indexes; }
+
 	void includesHistory() { m_includesHistory = true; }
 	bool getIncludesHistory() { return m_includesHistory; }
 
@@ -116,6 +136,7 @@ private:
 	std::string m_description;
 	std::vector<Attribute> m_attributes;
 	std::vector<Relationship> m_relationships;
+	std::vector<Index> m_indexes;
 	bool m_includesHistory;
 };
 
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2015 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Intel Corporation nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This file contains the definition and implementation for the Index class
+ * which defines secondary indexes on @ref Entity Entities.
+ */
+
+#ifndef INDEX_H_
+#define INDEX_H_
+
+#include <string>
+#include <vector>
+
+/*!
+ * Represents a secondary index over one or more columns of an Entity.
+ * @ingroup code_gen
+ * @details
+ * For each Index the generator creates the SQLite index plus accessor functions that use it.
+ * Leading columns are matched for equality. If the last column is an integer it is matched
+ * as an inclusive range (min/max) and the results are ordered by it, newest first.
+ * A TEXT last column is matched for equality like the others.
+ */
+class Index
+{
+public:
+	/*!
+	 * Constructor
+	 * @param column
+	 * 		Name of the first (leading) column of the index
+	 */
+	Index(const std::string &column)
+	{
+		_columns.push_back(column);
+	}
+
+	/*!
+	 * Add another column to the index
+	 * @param column
+	 * 		Name of the next column
+	 * @return this
+	 * @details A fluent api function so columns can be chained:
+	 * entity.addIndex("dimm_guid").thenBy("time");
+	 */
+	Index& thenBy(const std::string &column)
+	{
+		_columns.push_back(column);
+		return *this;
+	}
+
+	/*!
+	 * Accessor for columns
+	 * @return the column names in index order
+	 */
+	std::vector<std::string> getColumns() { return _columns; }
+
+	/*!
+	 * Name used for the SQLite index and the generated functions
+	 * @return column names joined by '_'
+	 */
+	std::string getName()
+	{
+		std::string name;
+		for (size_t i = 0; i < _columns.size(); i++)
+		{
+			if (i > 0)
+			{
+				name += "_";
+			}
+			name += _columns[i];
+		}
+		return name;
+	}
+
+private:
+	std::vector<std::string> _columns;
+};
+
+#endif /* INDEX_H_ */
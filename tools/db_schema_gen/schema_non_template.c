@@ -7,6 +7,25 @@
 #define	SQLITE_PREPARE(db, sql, p_stmt) \
 		(sqlite3_prepare_v2((db), (sql), strlen(sql) + 1, (&p_stmt), NULL) == SQLITE_OK)
 
+/*!
+ * Get a statement from the PersistentStore statement cache, preparing it on first use.
+ * The connection mutex is held until the statement is released with SQLITE_RELEASE_CACHED
+ * so that concurrent users of the same PersistentStore never share a statement mid-step.
+ */
+#define	SQLITE_PREPARE_CACHED(p_ps, index, sql, p_stmt) \
+		(get_cached_stmt((p_ps), (index), (sql), (&p_stmt)) == SQLITE_OK)
+
+/*!
+ * Return a statement obtained with SQLITE_PREPARE_CACHED to the cache. The statement is
+ * reset and its bindings cleared so it is ready to be rebound by the next caller.
+ */
+#define	SQLITE_RELEASE_CACHED(p_ps, p_stmt) \
+	{ \
+		sqlite3_reset(p_stmt); \
+		sqlite3_clear_bindings(p_stmt); \
+		sqlite3_mutex_leave(sqlite3_db_mutex((p_ps)->db)); \
+	}
+
 /*!
  * copy a sqlite int64 column into the destination
  */
@@ -88,14 +107,66 @@ char *db_strcpy(char *dst, const char *src, size_t dst_size)
 #define	KEEP_DB_SUCCESS(rc, rc_new)	rc = (rc >= DB_SUCCESS) ? rc : rc_new;
 
 
+/*!
+ * How long a connection waits on a locked database before giving up. SQLite retries
+ * with an increasing back-off (1ms up to 100ms) until the timeout expires.
+ */
+#define	DB_BUSY_TIMEOUT_MS	30000
+
 /*
  *	SQL API
  */
 struct persistentStore
 {
 	sqlite3 *db;
+	sqlite3_stmt *stmt_cache[STMT_CACHE_COUNT]; // prepared on first use, see get_cached_stmt
 };
 
+/*
+ * Look up the prepared statement for a generated CRUD function, compiling the
+ * SQL only the first time it is used on this PersistentStore.
+ */
+int get_cached_stmt(const PersistentStore *p_ps, enum stmt_cache_index index,
+	const char *sql, sqlite3_stmt **pp_stmt)
+{
+	int rc = SQLITE_OK;
+	// the cache is an implementation detail of an otherwise const store
+	PersistentStore *p_store = (PersistentStore *)p_ps;
+
+	sqlite3_mutex_enter(sqlite3_db_mutex(p_store->db));
+	if (p_store->stmt_cache[index] == NULL)
+	{
+		rc = sqlite3_prepare_v2(p_store->db, sql, strlen(sql) + 1,
+			&p_store->stmt_cache[index], NULL);
+	}
+
+	if (rc == SQLITE_OK)
+	{
+		*pp_stmt = p_store->stmt_cache[index];
+	}
+	else
+	{
+		p_store->stmt_cache[index] = NULL;
+		sqlite3_mutex_leave(sqlite3_db_mutex(p_store->db));
+	}
+	return rc;
+}
+
+/*
+ * Finalize all statements in the PersistentStore statement cache
+ */
+void clear_stmt_cache(PersistentStore *p_ps)
+{
+	for (int i = 0; i < STMT_CACHE_COUNT; i++)
+	{
+		if (p_ps->stmt_cache[i] != NULL)
+		{
+			sqlite3_finalize(p_ps->stmt_cache[i]);
+			p_ps->stmt_cache[i] = NULL;
+		}
+	}
+}
+
 /*!
  * Returns the number of rows in the table name provided.  If there is an issue with the
  * query (or the table doesn't exist) will return 0.
@@ -219,7 +290,7 @@ int table_exists(sqlite3 *p_db, const char *table)
 
 PersistentStore *open_PersistentStore(const char *path)
 {
-	PersistentStore *result = (PersistentStore *)malloc(sizeof (PersistentStore));
+	PersistentStore *result = (PersistentStore *)calloc(1, sizeof (PersistentStore));
 	if (result != NULL)
 	{
 		if (sqlite3_open_v2(path, &(result->db),
@@ -230,13 +301,57 @@ PersistentStore *open_PersistentStore(const char *path)
 		else
 		{
 			// set a busy timeout to avoid file locking issues
-			sqlite3_busy_timeout(result->db, 30000);
+			sqlite3_busy_timeout(result->db, DB_BUSY_TIMEOUT_MS);
+		}
+	}
+
+	return result;
+}
+
+PersistentStore *open_PersistentStore_readonly(const char *path)
+{
+	PersistentStore *result = (PersistentStore *)calloc(1, sizeof (PersistentStore));
+	if (result != NULL)
+	{
+		if (sqlite3_open_v2(path, &(result->db),
+			SQLITE_OPEN_READONLY|SQLITE_OPEN_FULLMUTEX, NULL) != SQLITE_OK)
+		{
+			free_PersistentStore(&result);
+		}
+		else
+		{
+			sqlite3_busy_timeout(result->db, DB_BUSY_TIMEOUT_MS);
 		}
 	}
 
 	return result;
 }
 
+/*
+ * Switch the store to write-ahead logging so readers in other processes are
+ * not blocked by a writer (and vice versa).
+ */
+enum db_return_codes db_set_wal_mode(PersistentStore *p_ps, int checkpoint_pages)
+{
+	enum db_return_codes rc = DB_ERR_FAILURE;
+	char journal_mode[16];
+	// journal_mode reports the resulting mode rather than failing outright
+	if (run_text_scalar_sql(p_ps, "PRAGMA journal_mode=WAL",
+			journal_mode, sizeof (journal_mode)) == DB_SUCCESS &&
+		sqlite3_stricmp(journal_mode, "wal") == 0)
+	{
+		// NORMAL is durable across application crashes in WAL mode and
+		// avoids an fsync on every commit
+		rc = run_sql_no_results(p_ps->db, "PRAGMA synchronous=NORMAL");
+		if (rc == DB_SUCCESS &&
+			sqlite3_wal_autocheckpoint(p_ps->db, checkpoint_pages) != SQLITE_OK)
+		{
+			rc = DB_ERR_FAILURE;
+		}
+	}
+	return rc;
+}
+
 /*
  * Close the DB and release the memory for a PersistentStore object
  */
@@ -245,6 +360,8 @@ int free_PersistentStore(PersistentStore **pp_persistentStore)
 	int rc = DB_SUCCESS;
 	if (*pp_persistentStore != NULL && (*pp_persistentStore)->db != NULL)
 	{
+		// cached statements must be finalized before the connection can close
+		clear_stmt_cache(*pp_persistentStore);
 		if (sqlite3_close((*pp_persistentStore)->db) != SQLITE_OK)
 		{
 			rc = DB_ERR_FAILURE;
@@ -290,7 +407,9 @@ enum db_return_codes db_add_history(PersistentStore *p_ps,
 
 enum db_return_codes  db_begin_transaction(PersistentStore *p_ps)
 {
-	return run_sql_no_results(p_ps->db, "BEGIN TRANSACTION");
+	// take the write lock up front so a conflicting writer waits in the busy
+	// handler instead of failing when a deferred transaction is upgraded
+	return run_sql_no_results(p_ps->db, "BEGIN IMMEDIATE TRANSACTION");
 }
 
 enum db_return_codes  db_end_transaction(PersistentStore *p_ps)
@@ -303,6 +422,12 @@ enum db_return_codes  db_rollback_transaction(PersistentStore *p_ps)
 	return run_sql_no_results(p_ps->db, "ROLLBACK TRANSACTION");
 }
 
+int db_in_transaction(PersistentStore *p_ps)
+{
+	// a connection is only out of autocommit mode inside a transaction
+	return p_ps && p_ps->db && !sqlite3_get_autocommit(p_ps->db);
+}
+
 enum db_return_codes db_run_custom_sql(PersistentStore *p_ps, const char *sql)
 {
 	return run_sql_no_results(p_ps->db, sql);